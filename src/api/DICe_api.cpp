@@ -44,6 +44,9 @@
 #include <DICe_Parser.h>
 #include <DICe_ParameterUtilities.h>
 
+#include <cstring>
+#include <vector>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -281,6 +284,135 @@ DICE_LIB_DLL_EXPORT const int_t dice_correlate_conformal(scalar_t points[],
   return 0;
 }
 
+/// Correlation state of one dice_context (see DICe_api.h)
+struct dice_context{
+  /// the schema holds the subsets and the solution between calls
+  Teuchos::RCP<DICe::Schema> schema;
+  /// copy of the reference intensities (the schema image references them)
+  Teuchos::ArrayRCP<storage_t> ref_img;
+  /// width of the images
+  int_t img_w;
+  /// height of the images
+  int_t img_h;
+  /// number of points
+  int_t n_points;
+  /// solution of each frame in the latest batch, n_points*DICE_API_STRIDE values per frame
+  std::vector<scalar_t> results;
+  /// number of frames in results that were correlated
+  int_t num_results;
+};
+
+DICE_LIB_DLL_EXPORT dice_context * dice_create_context(const scalar_t points[], int_t n_points,
+                        int_t subset_size,
+                        const storage_t ref_img[], int_t ref_w, int_t ref_h,
+                        const Teuchos::ParameterList * input_params){
+  DEBUG_MSG("dice_create_context() called with n_points " << n_points << " subset_size " << subset_size <<
+    " ref_w " << ref_w << " ref_h " << ref_h);
+  if(points==0||ref_img==0) return 0;
+  if(subset_size < 1) return 0;
+  if(n_points < 1) return 0;
+  if(ref_w < 1||ref_h < 1) return 0;
+
+  dice_context * context = new dice_context();
+  context->img_w = ref_w;
+  context->img_h = ref_h;
+  context->n_points = n_points;
+  context->num_results = 0;
+  try{
+    // copy the parameters so the caller can reuse or change them while the context is in use
+    Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+    if(input_params!=0)
+      *params = *input_params;
+    else
+      DICe::tracking_default_params(params.getRawPtr());
+    Teuchos::ArrayRCP<scalar_t> coords_x(n_points,0.0);
+    Teuchos::ArrayRCP<scalar_t> coords_y(n_points,0.0);
+    for(int_t i=0;i<n_points;++i){
+      coords_x[i] = points[i*DICE_API_STRIDE + 0];
+      coords_y[i] = points[i*DICE_API_STRIDE + 1];
+    }
+    context->schema = Teuchos::rcp(new DICe::Schema(coords_x,coords_y,subset_size,Teuchos::null,Teuchos::null,params));
+    TEUCHOS_TEST_FOR_EXCEPTION(context->schema->shape_function_type()!=DICe::AFFINE_SF,std::runtime_error,
+      "Error, can only use AFFINE shape function for the api routines");
+    context->ref_img = Teuchos::ArrayRCP<storage_t>(ref_w*ref_h);
+    std::memcpy(context->ref_img.get(),ref_img,ref_w*ref_h*sizeof(storage_t));
+    context->schema->set_ref_image(ref_w,ref_h,context->ref_img);
+    // initial guess for the first frame
+    for(int_t i=0;i<n_points;++i){
+      context->schema->local_field_value(i,DICe::field_enums::SUBSET_DISPLACEMENT_X_FS) = points[i*DICE_API_STRIDE + 2];
+      context->schema->local_field_value(i,DICe::field_enums::SUBSET_DISPLACEMENT_Y_FS) = points[i*DICE_API_STRIDE + 3];
+      context->schema->local_field_value(i,DICe::field_enums::ROTATION_Z_FS)     = points[i*DICE_API_STRIDE + 4];
+      context->schema->local_field_value(i,DICe::field_enums::SIGMA_FS)          = points[i*DICE_API_STRIDE + 5];
+      context->schema->local_field_value(i,DICe::field_enums::GAMMA_FS)          = points[i*DICE_API_STRIDE + 6];
+      context->schema->local_field_value(i,DICe::field_enums::BETA_FS)           = points[i*DICE_API_STRIDE + 7];
+      context->schema->local_field_value(i,DICe::field_enums::STATUS_FLAG_FS)    = points[i*DICE_API_STRIDE + 8];
+    }
+  }
+  catch(std::exception & e){
+    std::cout << "Error, dice_create_context() failed: " << e.what() << std::endl;
+    delete context;
+    return 0;
+  }
+  return context;
+}
+
+DICE_LIB_DLL_EXPORT const int_t dice_correlate_frames(dice_context * context,
+                        const storage_t * const def_imgs[], int_t n_frames,
+                        int_t def_w, int_t def_h){
+  DEBUG_MSG("dice_correlate_frames() called with n_frames " << n_frames << " def_w " << def_w << " def_h " << def_h);
+  if(context==0||def_imgs==0) return -1;
+  // throw an error if the images are not of the same size
+  if(def_w!=context->img_w||def_h!=context->img_h) return -1;
+  if(n_frames < 1) return -1;
+
+  const int_t n_points = context->n_points;
+  const int_t img_size = def_w*def_h;
+  context->results.resize(n_frames*n_points*DICE_API_STRIDE);
+  context->num_results = 0;
+  try{
+    for(int_t frame=0;frame<n_frames;++frame){
+      TEUCHOS_TEST_FOR_EXCEPTION(def_imgs[frame]==0,std::runtime_error,"Error, null deformed image for frame " << frame);
+      // the image filters work in place so the intensities are copied rather than referenced
+      Teuchos::ArrayRCP<storage_t> def_rcp(img_size);
+      std::memcpy(def_rcp.get(),def_imgs[frame],img_size*sizeof(storage_t));
+      context->schema->set_def_image(def_w,def_h,def_rcp);
+      // the solution of the previous frame is still in the fields and is used as the initial guess
+      if(context->schema->execute_correlation()!=0) return -1;
+      scalar_t * result = &context->results[frame*n_points*DICE_API_STRIDE];
+      for(int_t i=0;i<n_points;++i){
+        result[i*DICE_API_STRIDE + 0] = context->schema->local_field_value(i,DICe::field_enums::SUBSET_COORDINATES_X_FS);
+        result[i*DICE_API_STRIDE + 1] = context->schema->local_field_value(i,DICe::field_enums::SUBSET_COORDINATES_Y_FS);
+        result[i*DICE_API_STRIDE + 2] = context->schema->local_field_value(i,DICe::field_enums::SUBSET_DISPLACEMENT_X_FS);
+        result[i*DICE_API_STRIDE + 3] = context->schema->local_field_value(i,DICe::field_enums::SUBSET_DISPLACEMENT_Y_FS);
+        result[i*DICE_API_STRIDE + 4] = context->schema->local_field_value(i,DICe::field_enums::ROTATION_Z_FS);
+        result[i*DICE_API_STRIDE + 5] = context->schema->local_field_value(i,DICe::field_enums::SIGMA_FS);
+        result[i*DICE_API_STRIDE + 6] = context->schema->local_field_value(i,DICe::field_enums::GAMMA_FS);
+        result[i*DICE_API_STRIDE + 7] = context->schema->local_field_value(i,DICe::field_enums::BETA_FS);
+        result[i*DICE_API_STRIDE + 8] = context->schema->local_field_value(i,DICe::field_enums::STATUS_FLAG_FS);
+      }
+      context->num_results = frame + 1;
+    }
+  }
+  catch(std::exception & e){
+    std::cout << "Error, dice_correlate_frames() failed: " << e.what() << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+DICE_LIB_DLL_EXPORT const int_t dice_fetch_results(const dice_context * context, int_t frame,
+                        scalar_t points[]){
+  if(context==0||points==0) return -1;
+  if(frame < 0||frame >= context->num_results) return -1;
+  const int_t stride = context->n_points*DICE_API_STRIDE;
+  std::memcpy(points,&context->results[frame*stride],stride*sizeof(scalar_t));
+  return 0;
+}
+
+DICE_LIB_DLL_EXPORT void dice_destroy_context(dice_context * context){
+  delete context;
+}
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -92,6 +92,9 @@ namespace Teuchos{
 
 /// \brief Function to execute a correlation on the data provided in points and the image arrays
 ///
+/// Note: the correlation state is kept in static data so only one correlation can be run per process
+/// with this function, use dice_create_context() to run several correlations concurrently.
+///
 /// \param points:      An array of (n_points * DICE_API_STRIDE) type Real values where
 ///                     the nine values mean:
 ///                     [x, y, u, v, theta, sigma, diagnostic_flag]
@@ -179,6 +182,71 @@ DICE_LIB_DLL_EXPORT const int_t dice_correlate_conformal(scalar_t points[],
                         const char* subset_file, const char* param_file=0,
                         const bool write_output=false);
 
+/// \brief Opaque correlation context
+///
+/// A context owns all of the state for one correlation (the reference image, the subsets and the solution
+/// of the latest frame), so several contexts can be used concurrently from different threads
+/// (one thread per context). The contexts are created with dice_create_context(), the deformed frames
+/// are correlated in batches with dice_correlate_frames(), the solutions are copied out with
+/// dice_fetch_results() and the context is freed with dice_destroy_context().
+typedef struct dice_context dice_context;
+
+/// \brief Create a correlation context
+///
+/// \param points:      An array of (n_points * DICE_API_STRIDE) type Real values with the same layout as for
+///                     dice_correlate(). The coordinates and the initial guess for the first frame are taken from
+///                     this array. The array is not modified and can be freed after this call.
+/// \param n_points:    The number of points.
+/// \param subset_size: The subset size to use for correlation.
+/// \param ref_img:     The reference image as (ref_w) * (ref_h) values. The intensities are copied
+///                     so the array can be freed after this call.
+/// \param ref_w:       The width of the reference image.
+/// \param ref_h:       The height of the reference image.
+/// \param input_params Optional ParameterList to change the default correlation parameters
+///
+/// Return values:
+/// A pointer to the new context or 0 if the context could not be created.
+DICE_LIB_DLL_EXPORT dice_context * dice_create_context(const scalar_t points[], int_t n_points,
+                        int_t subset_size,
+                        const storage_t ref_img[], int_t ref_w, int_t ref_h,
+                        const Teuchos::ParameterList * input_params=0);
+
+/// \brief Correlate a batch of deformed frames
+///
+/// The frames are correlated in order, each frame is initialized with the solution of the previous one
+/// (the first frame of a batch with the last frame of the previous batch). The subsets and the reference
+/// image are only set up once when the context is created.
+///
+/// \param context:     The correlation context
+/// \param def_imgs:    An array of n_frames pointers to the deformed images, each (def_w) * (def_h) values.
+///                     The intensities are copied so the images are not modified.
+/// \param n_frames:    The number of frames in the batch.
+/// \param def_w:       The width of the deformed images (must match the reference image).
+/// \param def_h:       The height of the deformed images (must match the reference image).
+///
+/// Return values:
+/// The function returns 0 on success, otherwise an error code is returned. The solutions of the frames
+/// that were correlated before an error occurred can still be fetched.
+DICE_LIB_DLL_EXPORT const int_t dice_correlate_frames(dice_context * context,
+                        const storage_t * const def_imgs[], int_t n_frames,
+                        int_t def_w, int_t def_h);
+
+/// \brief Copy the solution of one frame of the latest batch into a points array
+///
+/// \param context:     The correlation context
+/// \param frame:       The index of the frame in the latest batch passed to dice_correlate_frames()
+/// \param points:      An array of (n_points * DICE_API_STRIDE) type Real values that is filled
+///                     with the same layout as the output of dice_correlate()
+///
+/// Return values:
+/// The function returns 0 on success, -1 if the frame has no solution.
+DICE_LIB_DLL_EXPORT const int_t dice_fetch_results(const dice_context * context, int_t frame,
+                        scalar_t points[]);
+
+/// \brief Free a correlation context and all of its data
+/// \param context:     The correlation context (can be 0)
+DICE_LIB_DLL_EXPORT void dice_destroy_context(dice_context * context);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -164,6 +164,8 @@ const char* const use_integrated_dic = "use_integrated_dic";
 /// String parameter name
 const char* const interpolation_method = "interpolation_method";
 /// String parameter name
+const char* const interpolation_cache = "interpolation_cache";
+/// String parameter name
 const char* const gradient_method = "gradient_method";
 /// String parameter name
 const char* const compute_laplacian_image = "compute_laplacian_image";
@@ -270,6 +272,8 @@ const char* const output_delimiter = "output_delimiter";
 /// String parameter name
 const char* const omit_output_row_id = "omit_output_row_id";
 /// String parameter name
+const char* const output_buffer_size = "output_buffer_size";
+/// String parameter name
 const char* const obstruction_skin_factor = "obstruction_skin_factor";
 /// String parameter name
 const char* const use_tracking_default_params = "use_tracking_default_params";
@@ -376,6 +380,10 @@ const char* const write_exodus_output = "write_exodus_output";
 /// String parameter name
 const char* const threshold_block_size = "threshold_block_size";
 /// String parameter name
+const char* const num_threads = "num_threads";
+/// String parameter name
+const char* const num_prefetch_frames = "num_prefetch_frames";
+/// String parameter name
 const char* const subimage_width = "subimage_width";
 /// String parameter name
 const char* const subimage_height = "subimage_height";
@@ -575,6 +583,23 @@ const static char * gradientMethodStrings[] = {
   "CONVOLUTION_5_POINT"
 };
 
+/// Interpolation cache (trades memory for interpolation speed by precomputing
+/// the bicubic or keys fourth polynomial coefficients for every pixel)
+enum Interpolation_Cache {
+  NO_INTERPOLATION_CACHE=0,
+  INTENSITY_INTERPOLATION_CACHE,
+  FULL_INTERPOLATION_CACHE,
+  // DON'T ADD ANY BELOW MAX
+  MAX_INTERPOLATION_CACHE,
+  NO_SUCH_INTERPOLATION_CACHE
+};
+
+const static char * interpolationCacheStrings[] = {
+  "NO_INTERPOLATION_CACHE",
+  "INTENSITY_INTERPOLATION_CACHE",
+  "FULL_INTERPOLATION_CACHE"
+};
+
 
 /// Correlation routine (determines how the correlation steps are executed).
 /// Can be customized for a particular application
@@ -872,6 +897,16 @@ const Correlation_Parameter threshold_block_size_param(threshold_block_size,
   SIZE_PARAM,
   true,
   "The block size to use for the feature matching initializer when thresholding is enabled.");
+/// Correlation parameter and properties
+const Correlation_Parameter num_threads_param(num_threads,
+  SIZE_PARAM,
+  true,
+  "The number of threads to use on each processor when correlating subsets or assembling the global DIC system (0 uses all available hardware threads, default is 1). For stereo, the threads are split between the left and right cameras, which are then loaded and correlated concurrently.");
+/// Correlation parameter and properties
+const Correlation_Parameter num_prefetch_frames_param(num_prefetch_frames,
+  SIZE_PARAM,
+  true,
+  "The number of frames to load, filter and compute gradients for on background threads while the current frame is correlated (0 disables the prefetching, default is 0). The prefetched images are always full frames.");
 
 /// Correlation parameter and properties
 const Correlation_Parameter obstruction_skin_factor_param(obstruction_skin_factor,
@@ -971,6 +1006,11 @@ const Correlation_Parameter omit_output_row_id_param(omit_output_row_id,
   true,
   "True if the row id should be omitted from the output (column zero is skipped)");
 /// Correlation parameter and properties
+const Correlation_Parameter output_buffer_size_param(output_buffer_size,
+  SIZE_PARAM,
+  true,
+  "The amount of output (in megabytes) to hold in memory before it is appended to the files on a background thread when one output file is written for each subset (0 writes every frame directly, default is 0). All buffered output is written before the program exits.");
+/// Correlation parameter and properties
 const Correlation_Parameter mms_spec_param(mms_spec,
   STRING_PARAM,
   false, // turned off because this one is manually added to the template output files
@@ -1006,6 +1046,13 @@ const Correlation_Parameter interpolation_method_param(interpolation_method,
   interpolationMethodStrings,
   MAX_INTERPOLATION_METHOD);
 /// Correlation parameter and properties
+const Correlation_Parameter interpolation_cache_param(interpolation_cache,
+  STRING_PARAM,
+  true,
+  "Precompute the interpolation coefficients of the deformed images (16 values per pixel for the intensities only or 48 values per pixel to include the gradients) to speed up BICUBIC and KEYS_FOURTH interpolation",
+  interpolationCacheStrings,
+  MAX_INTERPOLATION_CACHE);
+/// Correlation parameter and properties
 const Correlation_Parameter gradient_method_param(gradient_method,
   STRING_PARAM,
   true,
@@ -1310,7 +1357,7 @@ const Correlation_Parameter remove_outlier_pixels_param(remove_outlier_pixels,
 // TODO don't forget to update this when adding a new one
 /// The total number of valid correlation parameters
 /// Vector of valid parameter names
-const int_t num_valid_correlation_params = 92;
+const int_t num_valid_correlation_params = 96;
 /// Vector oIf valid parameter names
 const Correlation_Parameter valid_correlation_params[num_valid_correlation_params] = {
   correlation_routine_param,
@@ -1404,7 +1451,11 @@ const Correlation_Parameter valid_correlation_params[num_valid_correlation_param
   compute_laplacian_image_param,
   enable_projection_shape_function_param,
   write_exodus_output_param,
-  threshold_block_size_param
+  threshold_block_size_param,
+  num_threads_param,
+  interpolation_cache_param,
+  num_prefetch_frames_param,
+  output_buffer_size_param
 };
 
 // TODO don't forget to update this when adding a new one
@@ -44,11 +44,14 @@
 #include <Teuchos_RCP.hpp>
 
 #include <map>
+#include <mutex>
 
 namespace DICe{
 
 static bool string_maps_created = false;
 static bool short_string_maps_created = false;
+/// guards the creation of the string maps (the maps may be first used by concurrent correlations)
+static std::mutex string_maps_mutex;
 static std::map<field_enums::Entity_Rank,std::string> entity_rank_string;
 static std::map<std::string,field_enums::Entity_Rank> string_entity_rank;
 static std::map<field_enums::Field_Type,std::string> field_type_string;
@@ -62,6 +65,7 @@ void create_string_maps();
 DICE_LIB_DLL_EXPORT
 void create_string_maps()
 {
+  std::lock_guard<std::mutex> lock(string_maps_mutex);
   if (string_maps_created)
   {
     return;
@@ -249,6 +253,7 @@ void create_short_string_maps();
 DICE_LIB_DLL_EXPORT
 void create_short_string_maps()
 {
+  std::lock_guard<std::mutex> lock(string_maps_mutex);
   if (short_string_maps_created)
   {
     return;
@@ -47,69 +47,145 @@
 
 #include <Teuchos_ParameterList.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 namespace DICe {
 
-const static scalar_t gf_coeffs_5[25] = {
-  1.96000000e-06,2.20360000e-04,8.79550000e-04,2.20360000e-04,1.96000000e-06,
-  2.20360000e-04,2.47747600e-02,9.88865500e-02,2.47747600e-02,2.20360000e-04,
-  8.79550000e-04,9.88865500e-02,3.94698062e-01,9.88865500e-02,8.79550000e-04,
-  2.20360000e-04,2.47747600e-02,9.88865500e-02,2.47747600e-02,2.20360000e-04,
-  1.96000000e-06,2.20360000e-04,8.79550000e-04,2.20360000e-04,1.96000000e-06
-};
-
-const static scalar_t gf_coeffs_7[49] = {
-  3.60000000e-05,3.63600000e-04,1.45080000e-03,2.29860000e-03,1.45080000e-03,3.63600000e-04,3.60000000e-05,
-  3.63600000e-04,3.67236000e-03,1.46530800e-02,2.32158600e-02,1.46530800e-02,3.67236000e-03,3.63600000e-04,
-  1.45080000e-03,1.46530800e-02,5.84672400e-02,9.26335800e-02,5.84672400e-02,1.46530800e-02,1.45080000e-03,
-  2.29860000e-03,2.32158600e-02,9.26335800e-02,1.46765610e-01,9.26335800e-02,2.32158600e-02,2.29860000e-03,
-  1.45080000e-03,1.46530800e-02,5.84672400e-02,9.26335800e-02,5.84672400e-02,1.46530800e-02,1.45080000e-03,
-  3.63600000e-04,3.67236000e-03,1.46530800e-02,2.32158600e-02,1.46530800e-02,3.67236000e-03,3.63600000e-04,
-  3.60000000e-05,3.63600000e-04,1.45080000e-03,2.29860000e-03,1.45080000e-03,3.63600000e-04,3.60000000e-05
-};
-
-const static scalar_t gf_coeffs_9[81] = {
-  4.90000000e-07,7.56000000e-06,5.23600000e-05,1.66880000e-04,2.45350000e-04,1.66880000e-04,5.23600000e-05,7.56000000e-06,4.90000000e-07,
-  7.56000000e-06,1.16640000e-04,8.07840000e-04,2.57472000e-03,3.78540000e-03,2.57472000e-03,8.07840000e-04,1.16640000e-04,7.56000000e-06,
-  5.23600000e-05,8.07840000e-04,5.59504000e-03,1.78323200e-02,2.62174000e-02,1.78323200e-02,5.59504000e-03,8.07840000e-04,5.23600000e-05,
-  1.66880000e-04,2.57472000e-03,1.78323200e-02,5.68345600e-02,8.35592000e-02,5.68345600e-02,1.78323200e-02,2.57472000e-03,1.66880000e-04,
-  2.45350000e-04,3.78540000e-03,2.62174000e-02,8.35592000e-02,1.22850250e-01,8.35592000e-02,2.62174000e-02,3.78540000e-03,2.45350000e-04,
-  1.66880000e-04,2.57472000e-03,1.78323200e-02,5.68345600e-02,8.35592000e-02,5.68345600e-02,1.78323200e-02,2.57472000e-03,1.66880000e-04,
-  5.23600000e-05,8.07840000e-04,5.59504000e-03,1.78323200e-02,2.62174000e-02,1.78323200e-02,5.59504000e-03,8.07840000e-04,5.23600000e-05,
-  7.56000000e-06,1.16640000e-04,8.07840000e-04,2.57472000e-03,3.78540000e-03,2.57472000e-03,8.07840000e-04,1.16640000e-04,7.56000000e-06,
-  4.90000000e-07,7.56000000e-06,5.23600000e-05,1.66880000e-04,2.45350000e-04,1.66880000e-04,5.23600000e-05,7.56000000e-06,4.90000000e-07
-};
-
-const static scalar_t gf_coeffs_11[121] = {
-  1.00000000e-08,1.70000000e-07,1.68000000e-06,8.70000000e-06,2.32800000e-05,3.23100000e-05,2.32800000e-05,8.70000000e-06,1.68000000e-06,1.70000000e-07,1.00000000e-08,
-  1.70000000e-07,2.89000000e-06,2.85600000e-05,1.47900000e-04,3.95760000e-04,5.49270000e-04,3.95760000e-04,1.47900000e-04,2.85600000e-05,2.89000000e-06,1.70000000e-07,
-  1.68000000e-06,2.85600000e-05,2.82240000e-04,1.46160000e-03,3.91104000e-03,5.42808000e-03,3.91104000e-03,1.46160000e-03,2.82240000e-04,2.85600000e-05,1.68000000e-06,
-  8.70000000e-06,1.47900000e-04,1.46160000e-03,7.56900000e-03,2.02536000e-02,2.81097000e-02,2.02536000e-02,7.56900000e-03,1.46160000e-03,1.47900000e-04,8.70000000e-06,
-  2.32800000e-05,3.95760000e-04,3.91104000e-03,2.02536000e-02,5.41958400e-02,7.52176800e-02,5.41958400e-02,2.02536000e-02,3.91104000e-03,3.95760000e-04,2.32800000e-05,
-  3.23100000e-05,5.49270000e-04,5.42808000e-03,2.81097000e-02,7.52176800e-02,1.04393610e-01,7.52176800e-02,2.81097000e-02,5.42808000e-03,5.49270000e-04,3.23100000e-05,
-  2.32800000e-05,3.95760000e-04,3.91104000e-03,2.02536000e-02,5.41958400e-02,7.52176800e-02,5.41958400e-02,2.02536000e-02,3.91104000e-03,3.95760000e-04,2.32800000e-05,
-  8.70000000e-06,1.47900000e-04,1.46160000e-03,7.56900000e-03,2.02536000e-02,2.81097000e-02,2.02536000e-02,7.56900000e-03,1.46160000e-03,1.47900000e-04,8.70000000e-06,
-  1.68000000e-06,2.85600000e-05,2.82240000e-04,1.46160000e-03,3.91104000e-03,5.42808000e-03,3.91104000e-03,1.46160000e-03,2.82240000e-04,2.85600000e-05,1.68000000e-06,
-  1.70000000e-07,2.89000000e-06,2.85600000e-05,1.47900000e-04,3.95760000e-04,5.49270000e-04,3.95760000e-04,1.47900000e-04,2.85600000e-05,2.89000000e-06,1.70000000e-07,
-  1.00000000e-08,1.70000000e-07,1.68000000e-06,8.70000000e-06,2.32800000e-05,3.23100000e-05,2.32800000e-05,8.70000000e-06,1.68000000e-06,1.70000000e-07,1.00000000e-08
-};
-
-const static scalar_t gf_coeffs_13[169] = {
-  1.00000000e-08,1.20000000e-07,8.50000000e-07,3.80000000e-06,1.10900000e-05,2.10800000e-05,2.61100000e-05,2.10800000e-05,1.10900000e-05,3.80000000e-06,8.50000000e-07,1.20000000e-07,1.00000000e-08,
-  1.20000000e-07,1.44000000e-06,1.02000000e-05,4.56000000e-05,1.33080000e-04,2.52960000e-04,3.13320000e-04,2.52960000e-04,1.33080000e-04,4.56000000e-05,1.02000000e-05,1.44000000e-06,1.20000000e-07,
-  8.50000000e-07,1.02000000e-05,7.22500000e-05,3.23000000e-04,9.42650000e-04,1.79180000e-03,2.21935000e-03,1.79180000e-03,9.42650000e-04,3.23000000e-04,7.22500000e-05,1.02000000e-05,8.50000000e-07,
-  3.80000000e-06,4.56000000e-05,3.23000000e-04,1.44400000e-03,4.21420000e-03,8.01040000e-03,9.92180000e-03,8.01040000e-03,4.21420000e-03,1.44400000e-03,3.23000000e-04,4.56000000e-05,3.80000000e-06,
-  1.10900000e-05,1.33080000e-04,9.42650000e-04,4.21420000e-03,1.22988100e-02,2.33777200e-02,2.89559900e-02,2.33777200e-02,1.22988100e-02,4.21420000e-03,9.42650000e-04,1.33080000e-04,1.10900000e-05,
-  2.10800000e-05,2.52960000e-04,1.79180000e-03,8.01040000e-03,2.33777200e-02,4.44366400e-02,5.50398800e-02,4.44366400e-02,2.33777200e-02,8.01040000e-03,1.79180000e-03,2.52960000e-04,2.10800000e-05,
-  2.61100000e-05,3.13320000e-04,2.21935000e-03,9.92180000e-03,2.89559900e-02,5.50398800e-02,6.81732100e-02,5.50398800e-02,2.89559900e-02,9.92180000e-03,2.21935000e-03,3.13320000e-04,2.61100000e-05,
-  2.10800000e-05,2.52960000e-04,1.79180000e-03,8.01040000e-03,2.33777200e-02,4.44366400e-02,5.50398800e-02,4.44366400e-02,2.33777200e-02,8.01040000e-03,1.79180000e-03,2.52960000e-04,2.10800000e-05,
-  1.10900000e-05,1.33080000e-04,9.42650000e-04,4.21420000e-03,1.22988100e-02,2.33777200e-02,2.89559900e-02,2.33777200e-02,1.22988100e-02,4.21420000e-03,9.42650000e-04,1.33080000e-04,1.10900000e-05,
-  3.80000000e-06,4.56000000e-05,3.23000000e-04,1.44400000e-03,4.21420000e-03,8.01040000e-03,9.92180000e-03,8.01040000e-03,4.21420000e-03,1.44400000e-03,3.23000000e-04,4.56000000e-05,3.80000000e-06,
-  8.50000000e-07,1.02000000e-05,7.22500000e-05,3.23000000e-04,9.42650000e-04,1.79180000e-03,2.21935000e-03,1.79180000e-03,9.42650000e-04,3.23000000e-04,7.22500000e-05,1.02000000e-05,8.50000000e-07,
-  1.20000000e-07,1.44000000e-06,1.02000000e-05,4.56000000e-05,1.33080000e-04,2.52960000e-04,3.13320000e-04,2.52960000e-04,1.33080000e-04,4.56000000e-05,1.02000000e-05,1.44000000e-06,1.20000000e-07,
-  1.00000000e-08,1.20000000e-07,8.50000000e-07,3.80000000e-06,1.10900000e-05,2.10800000e-05,2.61100000e-05,2.10800000e-05,1.10900000e-05,3.80000000e-06,8.50000000e-07,1.20000000e-07,1.00000000e-08
-};
+/// 1D gauss filter weights, the 2D masks are the outer products of these so the filter is applied as
+/// a pass along x followed by a pass along y
+const static scalar_t gf_weights_5[5] = {0.0014,0.1574,0.62825,0.1574,0.0014};
+const static scalar_t gf_weights_7[7] = {0.006,0.0606,0.2418,0.3831,0.2418,0.0606,0.006};
+const static scalar_t gf_weights_9[9] = {0.0007,0.0108,0.0748,0.2384,0.3505,0.2384,0.0748,0.0108,0.0007};
+const static scalar_t gf_weights_11[11] = {0.0001,0.0017,0.0168,0.0870,0.2328,0.3231,0.2328,0.0870,0.0168,0.0017,0.0001};
+const static scalar_t gf_weights_13[13] = {0.0001,0.0012,0.0085,0.0380,0.1109,0.2108,0.2611,0.2108,0.1109,0.0380,0.0085,0.0012,0.0001};
+
+/// 1D weights of the 5 point gradient smoothing (the 2D mask is the outer product)
+const static scalar_t grad_smooth_weights[5] = {0.0625,0.25,0.375,0.25,0.0625};
+
+/// filter one row along x: out[i] = sum_k weights[k]*in[x_begin+i+k-radius] for i in [0,count)
+/// (the loop over the pixels is innermost so that it vectorizes)
+template <typename T>
+inline void filter_row_x(const T * in,
+  const scalar_t * weights,
+  const int_t mask_size,
+  const int_t x_begin,
+  const int_t count,
+  scalar_t * out){
+  const T * src = in + x_begin - mask_size/2;
+  for(int_t i=0;i<count;++i)
+    out[i] = weights[0]*src[i];
+  for(int_t k=1;k<mask_size;++k){
+    const scalar_t w = weights[k];
+    const T * src_k = src + k;
+    for(int_t i=0;i<count;++i)
+      out[i] += w*src_k[i];
+  }
+}
+
+/// number of rows to filter at a time so that the work rows of a band stay in cache
+inline int_t filter_band_rows(const int_t row_width){
+  return std::max((int_t)8,(int_t)(32768/std::max(row_width,(int_t)1)));
+}
+
+/// \brief Applies a separable symmetric filter to rows [y_begin,y_end) of an image one band of rows at a time
+///
+/// source(y,rows) must fill rows[c] (for each of the num_channels channels) with row y already filtered along x,
+/// sink(y,rows) receives row y filtered along both directions. The source is called once for each row
+/// y_begin-radius to y_end+radius-1 in order and the sink once for each row y_begin to y_end-1 in order.
+/// The x filtered rows shared by neighboring bands are carried over rather than recomputed, and the source
+/// for a row is always called before the sink has written any row within radius of it, so the
+/// filtered values can be written back to the same array the source reads from.
+template <typename Source, typename Sink>
+void separable_filter_bands(const int_t y_begin,
+  const int_t y_end,
+  const int_t count,
+  const scalar_t * weights,
+  const int_t mask_size,
+  const int_t num_channels,
+  Source & source,
+  Sink & sink){
+  if(y_end<=y_begin||count<=0) return;
+  const int_t radius = mask_size/2;
+  const int_t band = filter_band_rows(count);
+  const int_t work_rows = band + 2*radius;
+  std::vector<scalar_t> work(num_channels*work_rows*count,0.0);
+  std::vector<scalar_t> out(num_channels*count,0.0);
+  std::vector<scalar_t*> src_rows(num_channels,NULL);
+  std::vector<const scalar_t*> out_rows(num_channels,NULL);
+  for(int_t c=0;c<num_channels;++c)
+    out_rows[c] = &out[c*count];
+  // work row r of channel c holds the x filtered image row y0-radius+r
+  int_t num_valid = 0; // rows at the start of the work array already filtered
+  for(int_t y0=y_begin;y0<y_end;y0+=band){
+    const int_t y1 = std::min(y0+band,y_end);
+    const int_t rows_needed = y1 - y0 + 2*radius;
+    for(int_t r=num_valid;r<rows_needed;++r){
+      for(int_t c=0;c<num_channels;++c)
+        src_rows[c] = &work[(c*work_rows+r)*count];
+      source(y0-radius+r,src_rows);
+    }
+    for(int_t y=y0;y<y1;++y){
+      for(int_t c=0;c<num_channels;++c){
+        const scalar_t * rows = &work[(c*work_rows+y-y0)*count];
+        scalar_t * acc = &out[c*count];
+        for(int_t i=0;i<count;++i)
+          acc[i] = weights[0]*rows[i];
+        for(int_t k=1;k<mask_size;++k){
+          const scalar_t w = weights[k];
+          const scalar_t * row_k = rows + k*count;
+          for(int_t i=0;i<count;++i)
+            acc[i] += w*row_k[i];
+        }
+      }
+      sink(y,out_rows);
+    }
+    // carry the rows that overlap the next band to the front of the work array
+    num_valid = 2*radius;
+    for(int_t c=0;c<num_channels;++c){
+      scalar_t * channel = &work[c*work_rows*count];
+      std::copy(channel+(y1-y0)*count,channel+rows_needed*count,channel);
+    }
+  }
+}
+
+/// finite difference gradients of one image row (fourth order in the interior, first order within two pixels of the edge)
+template <typename S>
+inline void finite_difference_row(const S * intensities,
+  const int_t width,
+  const int_t height,
+  const int_t y,
+  const scalar_t & c1,
+  const scalar_t & c2,
+  scalar_t * grad_x,
+  scalar_t * grad_y){
+  const S * row = &intensities[y*width];
+  for(int_t x=0;x<std::min((int_t)2,width);++x)
+    grad_x[x] = row[x+1] - row[x];
+  for(int_t x=2;x<width-2;++x)
+    grad_x[x] = c1*row[x-2] + c2*row[x-1] - c2*row[x+1] - c1*row[x+2];
+  for(int_t x=std::max((int_t)2,width-2);x<width;++x)
+    grad_x[x] = row[x] - row[x-1];
+  if(y<2){
+    const S * next = row + width;
+    for(int_t x=0;x<width;++x)
+      grad_y[x] = next[x] - row[x];
+  }
+  else if(y>=height-2){
+    const S * prev = row - width;
+    for(int_t x=0;x<width;++x)
+      grad_y[x] = row[x] - prev[x];
+  }
+  else{
+    const S * m2 = row - 2*width;
+    const S * m1 = row - width;
+    const S * p1 = row + width;
+    const S * p2 = row + 2*width;
+    for(int_t x=0;x<width;++x)
+      grad_y[x] = c1*m2[x] + c2*m1[x] - c2*p1[x] - c1*p2[x];
+  }
+}
 
 inline scalar_t keys_f0(const scalar_t & s){
   return 1.33333333333333*s*s*s - 2.33333333333333*s*s+ 1.0;
@@ -121,6 +197,65 @@ inline scalar_t keys_f2(const scalar_t & s){
   return 0.08333333333333*s*s*s - 0.66666666666666*s*s + 1.75*s - 1.5;
 }
 
+/// monomial coefficients (in t) of a*s^3 + b*s^2 + c*s + d for s = alpha*t + beta
+inline void cubic_in_t(const double a, const double b, const double c, const double d,
+  const double alpha, const double beta, double * coeffs){
+  coeffs[0] = a*beta*beta*beta + b*beta*beta + c*beta + d;
+  coeffs[1] = 3.0*a*alpha*beta*beta + 2.0*b*alpha*beta + c*alpha;
+  coeffs[2] = 3.0*a*alpha*alpha*beta + b*alpha*alpha;
+  coeffs[3] = a*alpha*alpha*alpha;
+}
+
+/// computes the bicubic polynomial coefficients for every interior cell of an array, the weight of
+/// neighbor k (counting from first_offset) is sum_p weights[k*4+p]*t^p for the fractional position t in the cell
+/// coefficient q*4+p multiplies y^q*x^p, cells whose stencil leaves the array are left zero
+template <typename T>
+void compute_cell_coefficients(const T * values,
+  const int_t width,
+  const int_t height,
+  const int_t stencil_size,
+  const int_t first_offset,
+  const double * weights,
+  scalar_t * coeffs){
+  const int_t last_offset = first_offset + stencil_size - 1;
+  double row_coeffs[6][4];
+  for(int_t y0=-first_offset;y0<height-last_offset;++y0){
+    for(int_t x0=-first_offset;x0<width-last_offset;++x0){
+      // collapse the stencil along x for each row
+      for(int_t l=0;l<stencil_size;++l){
+        const T * row = &values[(y0+first_offset+l)*width + x0+first_offset];
+        for(int_t p=0;p<4;++p){
+          double value = 0.0;
+          for(int_t k=0;k<stencil_size;++k)
+            value += weights[k*4+p]*row[k];
+          row_coeffs[l][p] = value;
+        }
+      }
+      // then along y
+      scalar_t * cell = &coeffs[(y0*width+x0)*16];
+      for(int_t q=0;q<4;++q){
+        for(int_t p=0;p<4;++p){
+          double value = 0.0;
+          for(int_t l=0;l<stencil_size;++l)
+            value += weights[l*4+q]*row_coeffs[l][p];
+          cell[q*4+p] = value;
+        }
+      }
+    }
+  }
+}
+
+/// evaluate the bicubic polynomial of a cell at the fractional position (x,y)
+inline scalar_t evaluate_cell(const scalar_t * cell,
+  const scalar_t & x,
+  const scalar_t & y){
+  const scalar_t c0 = ((cell[3]*x + cell[2])*x + cell[1])*x + cell[0];
+  const scalar_t c1 = ((cell[7]*x + cell[6])*x + cell[5])*x + cell[4];
+  const scalar_t c2 = ((cell[11]*x + cell[10])*x + cell[9])*x + cell[8];
+  const scalar_t c3 = ((cell[15]*x + cell[14])*x + cell[13])*x + cell[12];
+  return ((c3*y + c2)*y + c1)*y + c0;
+}
+
 template <typename S>
 Image_<S>::Image_(const char * file_name,
   const Teuchos::RCP<Teuchos::ParameterList> & params):
@@ -132,7 +267,9 @@ Image_<S>::Image_(const char * file_name,
   has_gauss_filter_(false),
   file_name_(file_name),
   has_file_name_(true),
-  gradient_method_(FINITE_DIFFERENCE)
+  gradient_method_(FINITE_DIFFERENCE),
+  interpolation_cache_(NO_INTERPOLATION_CACHE),
+  coefficients_method_(BILINEAR)
 {
   try{
     utils::read_image_dimensions(file_name,width_,height_);
@@ -161,7 +298,9 @@ Image_<S>::Image_(const int_t width,
   has_gauss_filter_(false),
   file_name_("(from scalar)"),
   has_file_name_(false),
-  gradient_method_(FINITE_DIFFERENCE)
+  gradient_method_(FINITE_DIFFERENCE),
+  interpolation_cache_(NO_INTERPOLATION_CACHE),
+  coefficients_method_(BILINEAR)
 {
   TEUCHOS_TEST_FOR_EXCEPTION(width_<0,std::invalid_argument,"Error, width cannot be negative or zero.");
   TEUCHOS_TEST_FOR_EXCEPTION(height_<0,std::invalid_argument,"Error, height cannot be negative or zero.");
@@ -181,7 +320,9 @@ Image_<S>::Image_(Teuchos::RCP<Image_> img,
   has_gauss_filter_(img->has_gauss_filter()),
   file_name_(img->file_name()),
   has_file_name_(img->has_file_name()),
-  gradient_method_(FINITE_DIFFERENCE)
+  gradient_method_(FINITE_DIFFERENCE),
+  interpolation_cache_(NO_INTERPOLATION_CACHE),
+  coefficients_method_(BILINEAR)
 {
   subimage_dims_from_params(params);
   TEUCHOS_TEST_FOR_EXCEPTION(offset_x_<0,std::invalid_argument,"Error, offset_x_ cannot be negative.");
@@ -237,6 +378,10 @@ Image_<S>::Image_(Teuchos::RCP<Image_> img,
         compute_gradients();
       }
     }
+    if(params->isParameter(DICe::interpolation_cache)){
+      compute_interpolation_coefficients(params->get<Interpolation_Method>(DICe::interpolation_method,KEYS_FOURTH),
+        params->get<Interpolation_Cache>(DICe::interpolation_cache));
+    }
   }
   assert(intensities_.size()>0);
 }
@@ -255,7 +400,9 @@ Image_<S>::Image_(const int_t array_width,
   has_gauss_filter_(false),
   file_name_("(from array)"),
   has_file_name_(false),
-  gradient_method_(FINITE_DIFFERENCE)
+  gradient_method_(FINITE_DIFFERENCE),
+  interpolation_cache_(NO_INTERPOLATION_CACHE),
+  coefficients_method_(BILINEAR)
 {
   if(params!=Teuchos::null){
     // Note for an image constructed from array, the offsets simply set the offset_x_ and offset_y_ values for this instance of the class
@@ -302,6 +449,8 @@ void
 Image_<S>::post_allocation_tasks(const Teuchos::RCP<Teuchos::ParameterList> & params){
   gauss_filter_mask_size_ = 7; // default sizes
   gauss_filter_half_mask_ = 4;
+  // the intensities have changed so any existing coefficients are stale, they are rebuilt below if requested
+  interpolation_cache_ = NO_INTERPOLATION_CACHE;
   if(params==Teuchos::null) return;
   gradient_method_ = params->get<Gradient_Method>(DICe::gradient_method,FINITE_DIFFERENCE);
   has_gauss_filter_ =  params->get<bool>(DICe::gauss_filter_images,false);
@@ -332,6 +481,11 @@ Image_<S>::post_allocation_tasks(const Teuchos::RCP<Teuchos::ParameterList> & pa
       }
     }
   }
+  if(params->isParameter(DICe::interpolation_cache)){
+    DEBUG_MSG("Image::post_allocation_tasks(): computing interpolation coefficients");
+    compute_interpolation_coefficients(params->get<Interpolation_Method>(DICe::interpolation_method,KEYS_FOURTH),
+      params->get<Interpolation_Cache>(DICe::interpolation_cache));
+  }
 }
 
 template <typename S>
@@ -839,15 +993,11 @@ Image_<S>::interpolate_keys_fourth_all(scalar_t & intensity_val,
     grad_x_val = 0.0;
     grad_y_val = 0.0;
   }
-  static std::vector<scalar_t> coeffs_x(6,0.0);
-  static std::vector<scalar_t> coeffs_y(6,0.0);
-  static scalar_t dx = 0.0;
-  static scalar_t dy = 0.0;
-  static int_t ix=0,iy=0;
-  //static intensity_t value=0.0;
-  static scalar_t cc = 0.0;
-  ix = (int_t)local_x;
-  iy = (int_t)local_y;
+  scalar_t coeffs_x[6];
+  scalar_t coeffs_y[6];
+  scalar_t cc = 0.0;
+  const int_t ix = (int_t)local_x;
+  const int_t iy = (int_t)local_y;
   if(local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5) {
     intensity_val  =  this->interpolate_bilinear(local_x,local_y);
     if (compute_gradient) {
@@ -855,8 +1005,8 @@ Image_<S>::interpolate_keys_fourth_all(scalar_t & intensity_val,
       grad_y_val = this->interpolate_grad_y_bilinear(local_x,local_y);
     }
   }
-  dx = local_x - ix;
-  dy = local_y - iy;
+  const scalar_t dx = local_x - ix;
+  const scalar_t dy = local_y - iy;
   coeffs_x[0] = keys_f2(dx+2.0);
   coeffs_x[1] = keys_f1(dx+1.0);
   coeffs_x[2] = keys_f0(dx);
@@ -887,21 +1037,184 @@ template DICE_LIB_DLL_EXPORT void Image_<storage_t>::interpolate_keys_fourth_all
 #endif
 template DICE_LIB_DLL_EXPORT void Image_<scalar_t>::interpolate_keys_fourth_all(scalar_t &, scalar_t &, scalar_t &, const bool, const scalar_t &, const scalar_t &) const;
 
+template <typename S>
+void
+Image_<S>::interpolate_batch(const Interpolation_Method interp,
+  const int_t num_points,
+  const int_t * indices,
+  const scalar_t * local_x,
+  const scalar_t * local_y,
+  scalar_t * intensity_vals,
+  scalar_t * grad_x_vals,
+  scalar_t * grad_y_vals,
+  const bool compute_gradient) const {
+  // the switch is hoisted out of the point loop so each loop calls a single interpolant
+  // directly (which can be inlined since it lives in this translation unit)
+  if(has_interpolation_coefficients(interp)){
+    for(int_t i=0;i<num_points;++i){
+      const int_t id = indices[i];
+      interpolate_cached_all(intensity_vals[id],grad_x_vals[id],grad_y_vals[id],compute_gradient,local_x[i],local_y[i]);
+    }
+  }
+  else if(interp==BILINEAR){
+    for(int_t i=0;i<num_points;++i){
+      const int_t id = indices[i];
+      interpolate_bilinear_all(intensity_vals[id],grad_x_vals[id],grad_y_vals[id],compute_gradient,local_x[i],local_y[i]);
+    }
+  }
+  else if(interp==BICUBIC){
+    for(int_t i=0;i<num_points;++i){
+      const int_t id = indices[i];
+      interpolate_bicubic_all(intensity_vals[id],grad_x_vals[id],grad_y_vals[id],compute_gradient,local_x[i],local_y[i]);
+    }
+  }
+  else if(interp==KEYS_FOURTH){
+    for(int_t i=0;i<num_points;++i){
+      const int_t id = indices[i];
+      interpolate_keys_fourth_all(intensity_vals[id],grad_x_vals[id],grad_y_vals[id],compute_gradient,local_x[i],local_y[i]);
+    }
+  }
+  else{
+    TEUCHOS_TEST_FOR_EXCEPTION(true,std::invalid_argument,
+      "Error, unknown interpolation method requested");
+  }
+}
+
+#ifndef STORAGE_SCALAR_SAME_TYPE
+template DICE_LIB_DLL_EXPORT void Image_<storage_t>::interpolate_batch(const Interpolation_Method,const int_t,const int_t *,const scalar_t *,const scalar_t *,scalar_t *,scalar_t *,scalar_t *,const bool) const;
+#endif
+template DICE_LIB_DLL_EXPORT void Image_<scalar_t>::interpolate_batch(const Interpolation_Method,const int_t,const int_t *,const scalar_t *,const scalar_t *,scalar_t *,scalar_t *,scalar_t *,const bool) const;
+
+template <typename S>
+void
+Image_<S>::compute_interpolation_coefficients(const Interpolation_Method interp,
+  const Interpolation_Cache cache){
+  if(cache==NO_INTERPOLATION_CACHE||interp==BILINEAR){
+    // bilinear interpolation is already a single cell evaluation so there is nothing to cache
+    interpolation_cache_ = NO_INTERPOLATION_CACHE;
+    intensity_coeffs_ = Teuchos::null;
+    grad_x_coeffs_ = Teuchos::null;
+    grad_y_coeffs_ = Teuchos::null;
+    return;
+  }
+  TEUCHOS_TEST_FOR_EXCEPTION(interp!=BICUBIC&&interp!=KEYS_FOURTH,std::invalid_argument,
+    "Error, unknown interpolation method requested");
+  TEUCHOS_TEST_FOR_EXCEPTION(cache!=INTENSITY_INTERPOLATION_CACHE&&cache!=FULL_INTERPOLATION_CACHE,std::invalid_argument,
+    "Error, unknown interpolation cache requested");
+  DEBUG_MSG("Image::compute_interpolation_coefficients(): method " << interp << " cache " << cache);
+  // weights of each neighbor as a cubic polynomial of the fractional position in the cell
+  int_t stencil_size = 0;
+  int_t first_offset = 0;
+  double weights[6*4];
+  if(interp==BICUBIC){
+    // the catmull-rom weights used in interpolate_bicubic()
+    const double bicubic_weights[4*4] = {
+      0.0, -0.5,  1.0, -0.5,
+      1.0,  0.0, -2.5,  1.5,
+      0.0,  0.5,  2.0, -1.5,
+      0.0,  0.0, -0.5,  0.5};
+    stencil_size = 4;
+    first_offset = -1;
+    for(int_t i=0;i<16;++i)
+      weights[i] = bicubic_weights[i];
+  }
+  else{
+    // the keys_f0, keys_f1, keys_f2 pieces used in interpolate_keys_fourth() in terms of the fractional position
+    stencil_size = 6;
+    first_offset = -2;
+    cubic_in_t(0.08333333333333,-0.66666666666666,1.75,-1.5,1.0,2.0,&weights[0]);        // keys_f2(t+2)
+    cubic_in_t(-0.58333333333333,3.0,-4.91666666666666,2.5,1.0,1.0,&weights[4]);         // keys_f1(t+1)
+    cubic_in_t(1.33333333333333,-2.33333333333333,0.0,1.0,1.0,0.0,&weights[8]);          // keys_f0(t)
+    cubic_in_t(1.33333333333333,-2.33333333333333,0.0,1.0,-1.0,1.0,&weights[12]);        // keys_f0(1-t)
+    cubic_in_t(-0.58333333333333,3.0,-4.91666666666666,2.5,-1.0,2.0,&weights[16]);       // keys_f1(2-t)
+    cubic_in_t(0.08333333333333,-0.66666666666666,1.75,-1.5,-1.0,3.0,&weights[20]);      // keys_f2(3-t)
+  }
+  const int_t num_coeffs = 16*width_*height_;
+  if(intensity_coeffs_.size()!=num_coeffs)
+    intensity_coeffs_ = Teuchos::ArrayRCP<scalar_t>(num_coeffs,0.0);
+  compute_cell_coefficients(intensities_.getRawPtr(),width_,height_,stencil_size,first_offset,weights,intensity_coeffs_.getRawPtr());
+  if(cache==FULL_INTERPOLATION_CACHE&&has_gradients_){
+    if(grad_x_coeffs_.size()!=num_coeffs)
+      grad_x_coeffs_ = Teuchos::ArrayRCP<scalar_t>(num_coeffs,0.0);
+    if(grad_y_coeffs_.size()!=num_coeffs)
+      grad_y_coeffs_ = Teuchos::ArrayRCP<scalar_t>(num_coeffs,0.0);
+    compute_cell_coefficients(grad_x_.getRawPtr(),width_,height_,stencil_size,first_offset,weights,grad_x_coeffs_.getRawPtr());
+    compute_cell_coefficients(grad_y_.getRawPtr(),width_,height_,stencil_size,first_offset,weights,grad_y_coeffs_.getRawPtr());
+  }
+  else{
+    // if the gradients have not been computed yet, the gradient coefficients are added
+    // by refresh_interpolation_coefficients() when compute_gradients() is called
+    grad_x_coeffs_ = Teuchos::null;
+    grad_y_coeffs_ = Teuchos::null;
+  }
+  interpolation_cache_ = cache;
+  coefficients_method_ = interp;
+}
+
+#ifndef STORAGE_SCALAR_SAME_TYPE
+template DICE_LIB_DLL_EXPORT void Image_<storage_t>::compute_interpolation_coefficients(const Interpolation_Method,const Interpolation_Cache);
+#endif
+template DICE_LIB_DLL_EXPORT void Image_<scalar_t>::compute_interpolation_coefficients(const Interpolation_Method,const Interpolation_Cache);
+
+template <typename S>
+void
+Image_<S>::refresh_interpolation_coefficients(){
+  if(interpolation_cache_==NO_INTERPOLATION_CACHE) return;
+  compute_interpolation_coefficients(coefficients_method_,interpolation_cache_);
+}
+
+template <typename S>
+void
+Image_<S>::interpolate_cached_all(scalar_t & intensity_val,
+       scalar_t & grad_x_val, scalar_t & grad_y_val, const bool compute_gradient,
+       const scalar_t & local_x, const scalar_t & local_y) const {
+  // same bounds as the uncached interpolants, outside of them bilinear interpolation is used
+  const bool out_of_bounds = coefficients_method_==BICUBIC ?
+      local_x<1.0||local_x>=width_-2.0||local_y<1.0||local_y>=height_-2.0 :
+      local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5;
+  if(out_of_bounds){
+    interpolate_bilinear_all(intensity_val,grad_x_val,grad_y_val,compute_gradient,local_x,local_y);
+    return;
+  }
+  const int_t x0 = (int_t)local_x;
+  const int_t y0 = (int_t)local_y;
+  const scalar_t x = local_x - x0;
+  const scalar_t y = local_y - y0;
+  const int_t cell = (y0*width_+x0)*16;
+  intensity_val = evaluate_cell(&intensity_coeffs_[cell],x,y);
+  if(compute_gradient){
+    if(interpolation_cache_==FULL_INTERPOLATION_CACHE&&has_gradients_){
+      grad_x_val = evaluate_cell(&grad_x_coeffs_[cell],x,y);
+      grad_y_val = evaluate_cell(&grad_y_coeffs_[cell],x,y);
+    }
+    else if(coefficients_method_==BICUBIC){
+      grad_x_val = interpolate_grad_x_bicubic(local_x,local_y);
+      grad_y_val = interpolate_grad_y_bicubic(local_x,local_y);
+    }
+    else{
+      grad_x_val = interpolate_grad_x_keys_fourth(local_x,local_y);
+      grad_y_val = interpolate_grad_y_keys_fourth(local_x,local_y);
+    }
+  }
+}
+
+#ifndef STORAGE_SCALAR_SAME_TYPE
+template DICE_LIB_DLL_EXPORT void Image_<storage_t>::interpolate_cached_all(scalar_t &,scalar_t &,scalar_t &,const bool,const scalar_t &,const scalar_t &) const;
+#endif
+template DICE_LIB_DLL_EXPORT void Image_<scalar_t>::interpolate_cached_all(scalar_t &,scalar_t &,scalar_t &,const bool,const scalar_t &,const scalar_t &) const;
+
 template <typename S>
 scalar_t
 Image_<S>::interpolate_keys_fourth(const scalar_t & local_x, const scalar_t & local_y) const{
-  static std::vector<scalar_t> coeffs_x(6,0.0);
-  static std::vector<scalar_t> coeffs_y(6,0.0);
-  static scalar_t dx = 0.0;
-  static scalar_t dy = 0.0;
-  static int_t ix=0,iy=0;
-  static scalar_t value=0.0;
-  ix = (int_t)local_x;
-  iy = (int_t)local_y;
+  scalar_t coeffs_x[6];
+  scalar_t coeffs_y[6];
+  scalar_t value = 0.0;
+  const int_t ix = (int_t)local_x;
+  const int_t iy = (int_t)local_y;
   if(local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5)
     return this->interpolate_bilinear(local_x,local_y);
-  dx = local_x - ix;
-  dy = local_y - iy;
+  const scalar_t dx = local_x - ix;
+  const scalar_t dy = local_y - iy;
   coeffs_x[0] = keys_f2(dx+2.0);
   coeffs_x[1] = keys_f1(dx+1.0);
   coeffs_x[2] = keys_f0(dx);
@@ -914,7 +1227,6 @@ Image_<S>::interpolate_keys_fourth(const scalar_t & local_x, const scalar_t & lo
   coeffs_y[3] = keys_f0(1.0-dy);
   coeffs_y[4] = keys_f1(2.0-dy);
   coeffs_y[5] = keys_f2(3.0-dy);
-  value = 0.0;
   for(int_t m=0;m<6;++m){
     for(int_t n=0;n<6;++n){
       value += coeffs_y[m]*coeffs_x[n]*intensities_[(iy-2+m)*width_ + ix-2+n];
@@ -931,18 +1243,15 @@ template DICE_LIB_DLL_EXPORT scalar_t Image_<scalar_t>::interpolate_keys_fourth(
 template <typename S>
 scalar_t
 Image_<S>::interpolate_grad_x_keys_fourth(const scalar_t & local_x, const scalar_t & local_y) const{
-  static std::vector<scalar_t> coeffs_x(6,0.0);
-  static std::vector<scalar_t> coeffs_y(6,0.0);
-  static scalar_t dx = 0.0;
-  static scalar_t dy = 0.0;
-  static int_t ix=0,iy=0;
-  static scalar_t value=0.0;
-  ix = (int_t)local_x;
-  iy = (int_t)local_y;
+  scalar_t coeffs_x[6];
+  scalar_t coeffs_y[6];
+  scalar_t value = 0.0;
+  const int_t ix = (int_t)local_x;
+  const int_t iy = (int_t)local_y;
   if(local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5)
     return this->interpolate_grad_x_bilinear(local_x,local_y);
-  dx = local_x - ix;
-  dy = local_y - iy;
+  const scalar_t dx = local_x - ix;
+  const scalar_t dy = local_y - iy;
   coeffs_x[0] = keys_f2(dx+2.0);
   coeffs_x[1] = keys_f1(dx+1.0);
   coeffs_x[2] = keys_f0(dx);
@@ -955,7 +1264,6 @@ Image_<S>::interpolate_grad_x_keys_fourth(const scalar_t & local_x, const scalar
   coeffs_y[3] = keys_f0(1.0-dy);
   coeffs_y[4] = keys_f1(2.0-dy);
   coeffs_y[5] = keys_f2(3.0-dy);
-  value = 0.0;
   for(int_t m=0;m<6;++m){
     for(int_t n=0;n<6;++n){
       value += coeffs_y[m]*coeffs_x[n]*grad_x_[(iy-2+m)*width_ + ix-2+n];
@@ -972,18 +1280,15 @@ template DICE_LIB_DLL_EXPORT scalar_t Image_<scalar_t>::interpolate_grad_x_keys_
 template <typename S>
 scalar_t
 Image_<S>::interpolate_grad_y_keys_fourth(const scalar_t & local_x, const scalar_t & local_y) const{
-  static std::vector<scalar_t> coeffs_x(6,0.0);
-  static std::vector<scalar_t> coeffs_y(6,0.0);
-  static scalar_t dx = 0.0;
-  static scalar_t dy = 0.0;
-  static int_t ix=0,iy=0;
-  static scalar_t value=0.0;
-  ix = (int_t)local_x;
-  iy = (int_t)local_y;
+  scalar_t coeffs_x[6];
+  scalar_t coeffs_y[6];
+  scalar_t value = 0.0;
+  const int_t ix = (int_t)local_x;
+  const int_t iy = (int_t)local_y;
   if(local_x<=2.5||local_x>=width_-3.5||local_y<=2.5||local_y>=height_-3.5)
     return this->interpolate_grad_y_bilinear(local_x,local_y);
-  dx = local_x - ix;
-  dy = local_y - iy;
+  const scalar_t dx = local_x - ix;
+  const scalar_t dy = local_y - iy;
   coeffs_x[0] = keys_f2(dx+2.0);
   coeffs_x[1] = keys_f1(dx+1.0);
   coeffs_x[2] = keys_f0(dx);
@@ -996,7 +1301,6 @@ Image_<S>::interpolate_grad_y_keys_fourth(const scalar_t & local_x, const scalar
   coeffs_y[3] = keys_f0(1.0-dy);
   coeffs_y[4] = keys_f1(2.0-dy);
   coeffs_y[5] = keys_f2(3.0-dy);
-  value = 0.0;
   for(int_t m=0;m<6;++m){
     for(int_t n=0;n<6;++n){
       value += coeffs_y[m]*coeffs_x[n]*grad_y_[(iy-2+m)*width_ + ix-2+n];
@@ -1019,10 +1323,40 @@ Image_<S>::compute_gradients(){
   }
   else if(gradient_method_==CONVOLUTION_5_POINT){
     DEBUG_MSG("Image::compute_gradients(): using CONVOLUTION_5_POINT");
-    compute_gradients_finite_difference();
-    smooth_gradients_convolution_5_point();
+    if(width_<5||height_<5){
+      compute_gradients_finite_difference();
+    }
+    else{
+      // the finite differences and the smoothing are done in the same sweep over the image
+      // so the unsmoothed gradients are never stored
+      const int_t count = width_ - 4;
+      std::vector<scalar_t> fd_x(width_,0.0);
+      std::vector<scalar_t> fd_y(width_,0.0);
+      auto source = [&](const int_t y, const std::vector<scalar_t*> & rows){
+        finite_difference_row(intensities_.getRawPtr(),width_,height_,y,grad_c1_,grad_c2_,&fd_x[0],&fd_y[0]);
+        // the edges are not smoothed
+        scalar_t * gx = &grad_x_[y*width_];
+        scalar_t * gy = &grad_y_[y*width_];
+        if(y<2||y>=height_-2){
+          std::copy(fd_x.begin(),fd_x.end(),gx);
+          std::copy(fd_y.begin(),fd_y.end(),gy);
+        }
+        else{
+          gx[0] = fd_x[0]; gx[1] = fd_x[1]; gx[width_-2] = fd_x[width_-2]; gx[width_-1] = fd_x[width_-1];
+          gy[0] = fd_y[0]; gy[1] = fd_y[1]; gy[width_-2] = fd_y[width_-2]; gy[width_-1] = fd_y[width_-1];
+        }
+        filter_row_x(&fd_x[0],grad_smooth_weights,5,2,count,rows[0]);
+        filter_row_x(&fd_y[0],grad_smooth_weights,5,2,count,rows[1]);
+      };
+      auto sink = [&](const int_t y, const std::vector<const scalar_t*> & rows){
+        std::copy(rows[0],rows[0]+count,&grad_x_[y*width_+2]);
+        std::copy(rows[1],rows[1]+count,&grad_y_[y*width_+2]);
+      };
+      separable_filter_bands(2,height_-2,count,grad_smooth_weights,5,2,source,sink);
+    }
   }
   has_gradients_ = true;
+  refresh_interpolation_coefficients();
 }
 #ifndef STORAGE_SCALAR_SAME_TYPE
 template DICE_LIB_DLL_EXPORT void Image_<storage_t>::compute_gradients();
@@ -1032,65 +1366,25 @@ template DICE_LIB_DLL_EXPORT void Image_<scalar_t>::compute_gradients();
 template <typename S>
 void
 Image_<S>::smooth_gradients_convolution_5_point(){
-
-  static scalar_t smooth_coeffs[][5] = {{0.00390625, 0.015625, 0.0234375, 0.015625, 0.00390625},
-                                        {0.015625,   0.0625,   0.09375,   0.0625,   0.015625},
-                                        {0.0234375,  0.09375,  0.140625,  0.09375,  0.0234375},
-                                        {0.015625,   0.0625,   0.09375,   0.0625,   0.015625},
-                                        {0.00390625, 0.015625, 0.0234375, 0.015625, 0.00390625}};
-  static int_t smooth_offsets[] =  {-2, -1, 0, 1, 2};
-
-  Teuchos::ArrayRCP<scalar_t> grad_x_temp(width_*height_,0.0);
-  Teuchos::ArrayRCP<scalar_t> grad_y_temp(width_*height_,0.0);
-  for(int_t i=0;i<width_*height_;++i){
-    grad_x_temp[i] = grad_x_[i];
-    grad_y_temp[i] = grad_y_[i];
-  }
-  for(int_t y=2;y<height_-2;++y){
-    for(int_t x=2;x<width_-2;++x){
-      scalar_t value_x = 0.0, value_y = 0.0;
-      for(int_t i=0;i<5;++i){
-        for(int_t j=0;j<5;++j){
-          value_x += smooth_coeffs[i][j] * grad_x_temp[(y + smooth_offsets[i])*width_ + x + smooth_offsets[j]];
-          value_y += smooth_coeffs[i][j] * grad_y_temp[(y + smooth_offsets[i])*width_ + x + smooth_offsets[j]];
-        }
-      }
-      grad_x_[y*width_+x] = value_x;
-      grad_y_[y*width_+x] = value_y;
-    }
-  }
+  if(width_<5||height_<5) return;
+  // separable 5x5 smoothing applied in place, the edges are left unchanged
+  const int_t count = width_ - 4;
+  auto source = [&](const int_t y, const std::vector<scalar_t*> & rows){
+    filter_row_x(&grad_x_[y*width_],grad_smooth_weights,5,2,count,rows[0]);
+    filter_row_x(&grad_y_[y*width_],grad_smooth_weights,5,2,count,rows[1]);
+  };
+  auto sink = [&](const int_t y, const std::vector<const scalar_t*> & rows){
+    std::copy(rows[0],rows[0]+count,&grad_x_[y*width_+2]);
+    std::copy(rows[1],rows[1]+count,&grad_y_[y*width_+2]);
+  };
+  separable_filter_bands(2,height_-2,count,grad_smooth_weights,5,2,source,sink);
 }
 
 template <typename S>
 void
 Image_<S>::compute_gradients_finite_difference(){
-  for(int_t y=0;y<height_;++y){
-    for(int_t x=0;x<width_;++x){
-      if(x<2){
-        grad_x_[y*width_+x] = intensities_[y*width_+x+1] - intensities_[y*width_+x];
-      }
-      /// check if this pixel is near the right edge
-      else if(x>=width_-2){
-        grad_x_[y*width_+x] = intensities_[y*width_+x] - intensities_[y*width_+x-1];
-      }
-      else{
-        grad_x_[y*width_+x] = grad_c1_*intensities_[y*width_+x-2] + grad_c2_*intensities_[y*width_+x-1]
-            - grad_c2_*intensities_[y*width_+x+1] - grad_c1_*intensities_[y*width_+x+2];
-      }
-      /// check if this pixel is near the top edge
-      if(y<2){
-        grad_y_[y*width_+x] = intensities_[(y+1)*width_+x] - intensities_[y*width_+x];
-      }
-      /// check if this pixel is near the bottom edge
-      else if(y>=height_-2){
-        grad_y_[y*width_+x] = intensities_[y*width_+x] - intensities_[(y-1)*width_+x];
-      }
-      else{
-        grad_y_[y*width_+x] = grad_c1_*intensities_[(y-2)*width_+x] + grad_c2_*intensities_[(y-1)*width_+x]
-            - grad_c2_*intensities_[(y+1)*width_+x] - grad_c1_*intensities_[(y+2)*width_+x];
-      }
-    }
-  }
+  for(int_t y=0;y<height_;++y)
+    finite_difference_row(intensities_.getRawPtr(),width_,height_,y,grad_c1_,grad_c2_,&grad_x_[y*width_],&grad_y_[y*width_]);
 }
 
 template <typename S>
@@ -1123,7 +1417,7 @@ Image_<S>::apply_mask(const Conformal_Area_Def & area_def,
     mask[(set_it->first - offset_y_)*width_+set_it->second - offset_x_] = 1.0;
   }
   if(smooth_edges){
-    static scalar_t smoothing_coeffs[5][5];
+    scalar_t smoothing_coeffs[5][5];
     std::vector<scalar_t> coeffs(5,0.0);
     coeffs[0] = 0.0014;coeffs[1] = 0.1574;coeffs[2] = 0.62825;
     coeffs[3] = 0.1574;coeffs[4] = 0.0014;
@@ -1154,6 +1448,7 @@ Image_<S>::apply_mask(const Conformal_Area_Def & area_def,
   }
   for(int_t i=0;i<num_pixels();++i)
     intensities_[i] = static_cast<S>(mask[i]*intensities_[i]);
+  refresh_interpolation_coefficients();
 }
 
 #ifndef STORAGE_SCALAR_SAME_TYPE
@@ -1198,18 +1493,18 @@ Image_<S>::gauss_filter(const int_t mask_size){
     gauss_filter_half_mask_ = gauss_filter_mask_size_/2+1;
   }
 
-  const scalar_t * coeffs;
+  const scalar_t * weights;
   // make sure the mask size is appropriate
   if(gauss_filter_mask_size_==5)
-    coeffs = &gf_coeffs_5[0];
+    weights = &gf_weights_5[0];
   else if (gauss_filter_mask_size_==7)
-    coeffs = &gf_coeffs_7[0];
+    weights = &gf_weights_7[0];
   else if (gauss_filter_mask_size_==9)
-    coeffs = &gf_coeffs_9[0];
+    weights = &gf_weights_9[0];
   else if (gauss_filter_mask_size_==11)
-    coeffs = &gf_coeffs_11[0];
+    weights = &gf_weights_11[0];
   else if (gauss_filter_mask_size_==13)
-    coeffs = &gf_coeffs_13[0];
+    weights = &gf_weights_13[0];
   else{
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::invalid_argument,
       "Error, the Gauss filter mask size is invalid (options include 5,7,9,11,13)");
@@ -1217,26 +1512,24 @@ Image_<S>::gauss_filter(const int_t mask_size){
   TEUCHOS_TEST_FOR_EXCEPTION(width_<gauss_filter_mask_size_||height_<gauss_filter_mask_size_,std::runtime_error,
     "Error, image too small (" << width_ << " x " << height_ << ") for gauss filtering with mask size " << gauss_filter_mask_size_);
 
-  // copy over the old intensities
-  /// device intensity work array
-  Teuchos::ArrayRCP<S> intensities_temp(width_*height_,0);
-  for(int_t i=0;i<num_pixels();++i)
-    intensities_temp[i] = intensities_[i];
-
-  for(int_t y=0;y<height_;++y){
-    for(int_t x=0;x<width_;++x){
-      if(x>=gauss_filter_half_mask_&&x<width_-gauss_filter_half_mask_&&y>=gauss_filter_half_mask_&&y<height_-gauss_filter_half_mask_){
-        scalar_t value = 0.0;
-        for(int_t i=0;i<gauss_filter_mask_size_;++i){
-          for(int_t j=0;j<gauss_filter_mask_size_;++j){
-            value += coeffs[i*gauss_filter_mask_size_+j]*intensities_temp[(y+(j-gauss_filter_half_mask_+1))*width_+x+(i-gauss_filter_half_mask_+1)];
-          } //j
-        } //i
-        intensities_[y*width_+x] = static_cast<S>(value);
-      }
-    }
-  }
+  // only pixels at least gauss_filter_half_mask_ from the edge are filtered, the filter is applied in place
+  // one band of rows at a time (see separable_filter_bands) so the image is not copied
+  const int_t x_begin = gauss_filter_half_mask_;
+  const int_t count = width_ - 2*gauss_filter_half_mask_;
+  S * intensities = intensities_.getRawPtr();
+  const int_t width = width_;
+  const int_t mask = gauss_filter_mask_size_;
+  auto source = [&](const int_t y, const std::vector<scalar_t*> & rows){
+    filter_row_x(&intensities[y*width],weights,mask,x_begin,count,rows[0]);
+  };
+  auto sink = [&](const int_t y, const std::vector<const scalar_t*> & rows){
+    S * row = &intensities[y*width+x_begin];
+    for(int_t i=0;i<count;++i)
+      row[i] = static_cast<S>(rows[0][i]);
+  };
+  separable_filter_bands(gauss_filter_half_mask_,height_-gauss_filter_half_mask_,count,weights,mask,1,source,sink);
   has_gauss_filter_ = true;
+  refresh_interpolation_coefficients();
 }
 
 /// returns true if the image is a frame from a video sequence cine or netcdf file
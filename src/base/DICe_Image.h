@@ -221,7 +221,10 @@ public:
   /// return function pointer to interpolant based on the interp type
   typedef void (Image_<S>::*interpolant)(scalar_t&,scalar_t&,scalar_t&,const bool,const scalar_t&,const scalar_t&) const;
   interpolant get_interpolant(const Interpolation_Method interp){
-    if(interp==BILINEAR){
+    if(has_interpolation_coefficients(interp)){
+      return &Image_<S>::interpolate_cached_all;
+    }
+    else if(interp==BILINEAR){
       return &Image_<S>::interpolate_bilinear_all;
     }
     else if(interp==BICUBIC){
@@ -236,6 +239,54 @@ public:
     }
   }
 
+  /// interpolate the intensity and gradients for a batch of points, the interpolation method is
+  /// dispatched once for the batch rather than for each point
+  /// \param interp the interpolation method
+  /// \param num_points the number of points to interpolate
+  /// \param indices the destination index in the output arrays for each point
+  /// \param local_x local image coordinate x of each point
+  /// \param local_y local image coordinate y of each point
+  /// \param intensity_vals [out] interpolated intensities, written at indices[i]
+  /// \param grad_x_vals [out] interpolated x gradients, written at indices[i]
+  /// \param grad_y_vals [out] interpolated y gradients, written at indices[i]
+  /// \param compute_gradient true if the gradients should be interpolated too
+  void interpolate_batch(const Interpolation_Method interp,
+    const int_t num_points,
+    const int_t * indices,
+    const scalar_t * local_x,
+    const scalar_t * local_y,
+    scalar_t * intensity_vals,
+    scalar_t * grad_x_vals,
+    scalar_t * grad_y_vals,
+    const bool compute_gradient) const;
+
+  /// precompute the interpolation polynomial coefficients for every pixel so that interpolating at
+  /// a point only requires evaluating one bicubic polynomial (the values are the same as the
+  /// interpolate_bicubic_all() or interpolate_keys_fourth_all() methods up to round off)
+  /// note: the coefficients are recomputed automatically if the intensities, gradients, or filter change
+  /// \param interp the interpolation method to compute the coefficients for (BILINEAR clears the cache)
+  /// \param cache INTENSITY_INTERPOLATION_CACHE stores 16 values per pixel for the intensities,
+  /// FULL_INTERPOLATION_CACHE stores 48 values per pixel to also cover the gradients
+  void compute_interpolation_coefficients(const Interpolation_Method interp,
+    const Interpolation_Cache cache);
+
+  /// returns the type of interpolation cache that is currently stored
+  Interpolation_Cache interpolation_cache()const{
+    return interpolation_cache_;
+  }
+
+  /// returns true if the interpolation coefficients have been computed for the given method
+  /// \param interp the interpolation method
+  bool has_interpolation_coefficients(const Interpolation_Method interp)const{
+    return interpolation_cache_!=NO_INTERPOLATION_CACHE&&interp==coefficients_method_;
+  }
+
+  /// interpolate intensity and gradients using the precomputed coefficients
+  /// (see compute_interpolation_coefficients())
+  void interpolate_cached_all(scalar_t & intensity_val,
+       scalar_t & grad_x_val, scalar_t & grad_y_val, const bool compute_gradient,
+       const scalar_t  & local_x, const scalar_t  & local_y) const;
+
   /// interpolate intensity and gradients
   void interpolate_keys_fourth_all(scalar_t & intensity_val,
        scalar_t & grad_x_val, scalar_t & grad_y_val, const bool compute_gradient,
@@ -394,10 +445,10 @@ public:
   /// compute the image gradients
   void compute_gradients();
 
-  /// compute the image gradients
+  /// smooth the image gradients with a 5x5 gaussian (applied as two separable passes, the two pixel border is not smoothed)
   void smooth_gradients_convolution_5_point();
 
-  /// compute the image gradients
+  /// compute the image gradients with finite differences
   void compute_gradients_finite_difference();
 
   /// returns true if the gradients have been computed
@@ -450,6 +501,9 @@ private:
   /// default constructor tasks
   void default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & params=Teuchos::null);
 
+  /// recompute the interpolation coefficients if they are in use (called when the intensities or gradients change)
+  void refresh_interpolation_coefficients();
+
   /// pixel container width_
   int_t width_;
   /// pixel container height_
@@ -486,6 +540,16 @@ private:
   bool has_file_name_;
   /// gradient method
   Gradient_Method gradient_method_;
+  /// type of interpolation coefficients stored
+  Interpolation_Cache interpolation_cache_;
+  /// interpolation method the coefficients were computed for
+  Interpolation_Method coefficients_method_;
+  /// bicubic polynomial coefficients of the intensities for the cell to the lower right of each pixel
+  Teuchos::ArrayRCP<scalar_t> intensity_coeffs_;
+  /// bicubic polynomial coefficients of the x gradients for the cell to the lower right of each pixel
+  Teuchos::ArrayRCP<scalar_t> grad_x_coeffs_;
+  /// bicubic polynomial coefficients of the y gradients for the cell to the lower right of each pixel
+  Teuchos::ArrayRCP<scalar_t> grad_y_coeffs_;
 };
 
 using Image = Image_<>;
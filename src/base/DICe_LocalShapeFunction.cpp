@@ -73,6 +73,40 @@ Local_Shape_Function::save_fields(Schema * schema,
     schema->global_field_value(subset_gid,it->first) = parameters_[it->second];
 }
 
+void
+Local_Shape_Function::batch_map(const int_t num_points,
+  const int_t * x,
+  const int_t * y,
+  const scalar_t & cx,
+  const scalar_t & cy,
+  scalar_t * out_x,
+  scalar_t * out_y){
+  for(int_t p=0;p<num_points;++p)
+    map(x[p],y[p],cx,cy,out_x[p],out_y[p]);
+}
+
+void
+Local_Shape_Function::batch_residuals(const int_t num_points,
+  const int_t * x,
+  const int_t * y,
+  const scalar_t & cx,
+  const scalar_t & cy,
+  const scalar_t * gx,
+  const scalar_t * gy,
+  scalar_t * residual_rows,
+  const int_t stride,
+  const bool use_ref_grads){
+  assert(stride>=num_points);
+  std::vector<scalar_t> point_residuals(num_params_,0.0);
+  for(int_t p=0;p<num_points;++p){
+    for(int_t i=0;i<num_params_;++i)
+      point_residuals[i] = 0.0;
+    residuals(x[p],y[p],cx,cy,gx[p],gy[p],point_residuals,use_ref_grads);
+    for(int_t i=0;i<num_params_;++i)
+      residual_rows[i*stride+p] = point_residuals[i];
+  }
+}
+
 void
 Local_Shape_Function::update(const std::vector<scalar_t> & update){
   assert(update.size()==parameters_.size());
@@ -225,10 +259,10 @@ Affine_Shape_Function::map(const scalar_t & x,
   scalar_t & out_x,
   scalar_t & out_y){
 
-  static scalar_t dx=0.0,dy=0.0;
-  static scalar_t Dx=0.0,Dy=0.0;
-  static scalar_t dispx=0.0,dispy=0.0,theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0;
-  static scalar_t cost=0.0,sint=0.0;
+  scalar_t dx=0.0,dy=0.0;
+  scalar_t Dx=0.0,Dy=0.0;
+  scalar_t dispx=0.0,dispy=0.0,theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0;
+  scalar_t cost=0.0,sint=0.0;
 
   dispx = parameters_[dx_ind_];
   dispy = parameters_[dy_ind_];
@@ -247,6 +281,33 @@ Affine_Shape_Function::map(const scalar_t & x,
   out_y = sint*Dx + cost*Dy + dispy + cy;
 }
 
+void
+Affine_Shape_Function::batch_map(const int_t num_points,
+  const int_t * x,
+  const int_t * y,
+  const scalar_t & cx,
+  const scalar_t & cy,
+  scalar_t * out_x,
+  scalar_t * out_y){
+  // same mapping as map(), the parameter dependent terms are evaluated once for the batch
+  const scalar_t dispx = parameters_[dx_ind_];
+  const scalar_t dispy = parameters_[dy_ind_];
+  const scalar_t theta = has_rotz_ ? parameters_[rotz_ind_] : 0.0;
+  const scalar_t dudx  = has_nsxx_ ? parameters_[nsxx_ind_] : 0.0;
+  const scalar_t dvdy  = has_nsyy_ ? parameters_[nsyy_ind_] : 0.0;
+  const scalar_t gxy   = has_ssxy_ ? parameters_[ssxy_ind_] : 0.0;
+  const scalar_t cost = cos(theta);
+  const scalar_t sint = sin(theta);
+  for(int_t p=0;p<num_points;++p){
+    const scalar_t dx = x[p] - cx;
+    const scalar_t dy = y[p] - cy;
+    const scalar_t Dx = (1.0+dudx)*dx + gxy*dy;
+    const scalar_t Dy = (1.0+dvdy)*dy + gxy*dx;
+    out_x[p] = cost*Dx - sint*Dy + dispx + cx;
+    out_y[p] = sint*Dx + cost*Dy + dispy + cy;
+  }
+}
+
 //FIXME make these check the field exists rather than if the schema has them enabled
 void
 Affine_Shape_Function::initialize_parameters_from_fields(Schema * schema,
@@ -358,9 +419,9 @@ Affine_Shape_Function::residuals(const scalar_t & x,
   const bool use_ref_grads){
   assert((int_t)residuals.size()==num_params_);
 
-  static scalar_t dx=0.0,dy=0.0,Dx=0.0,Dy=0.0,delTheta=0.0,delEx=0.0,delEy=0.0,delGxy=0.0;
-  static scalar_t Gx=0.0,Gy=0.0;
-  static scalar_t theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0,cosTheta=0.0,sinTheta=0.0;
+  scalar_t dx=0.0,dy=0.0,Dx=0.0,Dy=0.0,delTheta=0.0,delEx=0.0,delEy=0.0,delGxy=0.0;
+  scalar_t Gx=0.0,Gy=0.0;
+  scalar_t theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0,cosTheta=0.0,sinTheta=0.0;
   theta = has_rotz_ ? parameters_[rotz_ind_] : 0.0;
   dudx  = has_nsxx_ ? parameters_[nsxx_ind_] : 0.0;
   dvdy  = has_nsyy_ ? parameters_[nsyy_ind_] : 0.0;
@@ -395,6 +456,74 @@ Affine_Shape_Function::residuals(const scalar_t & x,
     residuals[ssxy_ind_] = delGxy;
 }
 
+void
+Affine_Shape_Function::batch_residuals(const int_t num_points,
+  const int_t * x,
+  const int_t * y,
+  const scalar_t & cx,
+  const scalar_t & cy,
+  const scalar_t * gx,
+  const scalar_t * gy,
+  scalar_t * residual_rows,
+  const int_t stride,
+  const bool use_ref_grads){
+  assert(stride>=num_points);
+  // same terms as residuals(), the parameter dependent values are computed once for the batch
+  // and each residual row is computed in its own loop so the loops vectorize
+  const scalar_t theta = has_rotz_ ? parameters_[rotz_ind_] : 0.0;
+  const scalar_t dudx  = has_nsxx_ ? parameters_[nsxx_ind_] : 0.0;
+  const scalar_t dvdy  = has_nsyy_ ? parameters_[nsyy_ind_] : 0.0;
+  const scalar_t gxy   = has_ssxy_ ? parameters_[ssxy_ind_] : 0.0;
+  const scalar_t cosTheta = std::cos(theta);
+  const scalar_t sinTheta = std::sin(theta);
+  scalar_t * Gx = residual_rows + dx_ind_*stride;
+  scalar_t * Gy = residual_rows + dy_ind_*stride;
+  if(use_ref_grads){
+    for(int_t p=0;p<num_points;++p){
+      Gx[p] = cosTheta*gx[p] - sinTheta*gy[p];
+      Gy[p] = sinTheta*gx[p] + cosTheta*gy[p];
+    }
+  }
+  else{
+    for(int_t p=0;p<num_points;++p){
+      Gx[p] = gx[p];
+      Gy[p] = gy[p];
+    }
+  }
+  if(has_rotz_){
+    scalar_t * delTheta = residual_rows + rotz_ind_*stride;
+    for(int_t p=0;p<num_points;++p){
+      const scalar_t dx = x[p] - cx;
+      const scalar_t dy = y[p] - cy;
+      const scalar_t Dx = (1.0+dudx)*(dx) + gxy*(dy);
+      const scalar_t Dy = (1.0+dvdy)*(dy) + gxy*(dx);
+      delTheta[p] = Gx[p]*(-sinTheta*Dx - cosTheta*Dy) + Gy[p]*(cosTheta*Dx - sinTheta*Dy);
+    }
+  }
+  if(has_nsxx_){
+    scalar_t * delEx = residual_rows + nsxx_ind_*stride;
+    for(int_t p=0;p<num_points;++p){
+      const scalar_t dx = x[p] - cx;
+      delEx[p] = Gx[p]*dx*cosTheta + Gy[p]*dx*sinTheta;
+    }
+  }
+  if(has_nsyy_){
+    scalar_t * delEy = residual_rows + nsyy_ind_*stride;
+    for(int_t p=0;p<num_points;++p){
+      const scalar_t dy = y[p] - cy;
+      delEy[p] = -Gx[p]*dy*sinTheta + Gy[p]*dy*cosTheta;
+    }
+  }
+  if(has_ssxy_){
+    scalar_t * delGxy = residual_rows + ssxy_ind_*stride;
+    for(int_t p=0;p<num_points;++p){
+      const scalar_t dx = x[p] - cx;
+      const scalar_t dy = y[p] - cy;
+      delGxy[p] = Gx[p]*(cosTheta*dy - sinTheta*dx) + Gy[p]*(sinTheta*dy + cosTheta*dx);
+    }
+  }
+}
+
 void
 Affine_Shape_Function::high_order_terms(const scalar_t & x,
   const scalar_t & y,
@@ -406,9 +535,9 @@ Affine_Shape_Function::high_order_terms(const scalar_t & x,
   const bool use_ref_grads){
   assert((int_t)high_order_terms.size()==4);
 
-  static scalar_t dx=0.0,dy=0.0,Dx=0.0,Dy=0.0;
-  static scalar_t Gx=0.0,Gy=0.0;
-  static scalar_t theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0,cosTheta=0.0,sinTheta=0.0;
+  scalar_t dx=0.0,dy=0.0,Dx=0.0,Dy=0.0;
+  scalar_t Gx=0.0,Gy=0.0;
+  scalar_t theta=0.0,dudx=0.0,dvdy=0.0,gxy=0.0,cosTheta=0.0,sinTheta=0.0;
   theta = has_rotz_ ? parameters_[rotz_ind_] : 0.0;
   dudx  = has_nsxx_ ? parameters_[nsxx_ind_] : 0.0;
   dvdy  = has_nsyy_ ? parameters_[nsyy_ind_] : 0.0;
@@ -519,6 +648,35 @@ Quadratic_Shape_Function::map(const scalar_t & x,
   out_y = parameter(QUAD_G_FS)*dx + parameter(QUAD_H_FS)*dy + parameter(QUAD_I_FS)*dx*dy + parameter(QUAD_J_FS)*dx*dx + parameter(QUAD_K_FS)*dy*dy + parameter(QUAD_L_FS) + cy;
 }
 
+void
+Quadratic_Shape_Function::batch_map(const int_t num_points,
+  const int_t * x,
+  const int_t * y,
+  const scalar_t & cx,
+  const scalar_t & cy,
+  scalar_t * out_x,
+  scalar_t * out_y){
+  // look up the parameters once for the batch rather than once per point
+  const scalar_t A = parameter(QUAD_A_FS);
+  const scalar_t B = parameter(QUAD_B_FS);
+  const scalar_t C = parameter(QUAD_C_FS);
+  const scalar_t D = parameter(QUAD_D_FS);
+  const scalar_t E = parameter(QUAD_E_FS);
+  const scalar_t F = parameter(QUAD_F_FS);
+  const scalar_t G = parameter(QUAD_G_FS);
+  const scalar_t H = parameter(QUAD_H_FS);
+  const scalar_t I = parameter(QUAD_I_FS);
+  const scalar_t J = parameter(QUAD_J_FS);
+  const scalar_t K = parameter(QUAD_K_FS);
+  const scalar_t L = parameter(QUAD_L_FS);
+  for(int_t p=0;p<num_points;++p){
+    const scalar_t dx = x[p] - cx;
+    const scalar_t dy = y[p] - cy;
+    out_x[p] = A*dx + B*dy + C*dx*dy + D*dx*dx + E*dy*dy + F + cx;
+    out_y[p] = G*dx + H*dy + I*dx*dy + J*dx*dx + K*dy*dy + L + cy;
+  }
+}
+
 void
 Quadratic_Shape_Function::add_translation(const scalar_t & u,
   const scalar_t & v){
@@ -613,6 +771,59 @@ Quadratic_Shape_Function::residuals(const scalar_t & x,
   residuals[spec_map_.find(QUAD_L_FS)->second] = Gy;
 }
 
+void
+Quadratic_Shape_Function::batch_residuals(const int_t num_points,
+  const int_t * x,
+  const int_t * y,
+  const scalar_t & cx,
+  const scalar_t & cy,
+  const scalar_t * gx,
+  const scalar_t * gy,
+  scalar_t * residual_rows,
+  const int_t stride,
+  const bool use_ref_grads){
+  assert(stride>=num_points);
+  // same terms as residuals(), with the rotation and the parameter lookups done once for the batch
+  scalar_t cosTheta = 1.0;
+  scalar_t sinTheta = 0.0;
+  if(use_ref_grads){
+    scalar_t u=0.0,v=0.0,theta=0.0;
+    map_to_u_v_theta(cx,cy,u,v,theta);
+    cosTheta = std::cos(theta);
+    sinTheta = std::sin(theta);
+  }
+  scalar_t * rA = residual_rows + spec_map_.find(QUAD_A_FS)->second*stride;
+  scalar_t * rB = residual_rows + spec_map_.find(QUAD_B_FS)->second*stride;
+  scalar_t * rC = residual_rows + spec_map_.find(QUAD_C_FS)->second*stride;
+  scalar_t * rD = residual_rows + spec_map_.find(QUAD_D_FS)->second*stride;
+  scalar_t * rE = residual_rows + spec_map_.find(QUAD_E_FS)->second*stride;
+  scalar_t * rF = residual_rows + spec_map_.find(QUAD_F_FS)->second*stride;
+  scalar_t * rG = residual_rows + spec_map_.find(QUAD_G_FS)->second*stride;
+  scalar_t * rH = residual_rows + spec_map_.find(QUAD_H_FS)->second*stride;
+  scalar_t * rI = residual_rows + spec_map_.find(QUAD_I_FS)->second*stride;
+  scalar_t * rJ = residual_rows + spec_map_.find(QUAD_J_FS)->second*stride;
+  scalar_t * rK = residual_rows + spec_map_.find(QUAD_K_FS)->second*stride;
+  scalar_t * rL = residual_rows + spec_map_.find(QUAD_L_FS)->second*stride;
+  for(int_t p=0;p<num_points;++p){
+    const scalar_t dx = x[p] - cx;
+    const scalar_t dy = y[p] - cy;
+    const scalar_t Gx = use_ref_grads ? cosTheta*gx[p] - sinTheta*gy[p] : gx[p];
+    const scalar_t Gy = use_ref_grads ? sinTheta*gx[p] + cosTheta*gy[p] : gy[p];
+    rA[p] = Gx*dx;
+    rB[p] = Gx*dy;
+    rC[p] = Gx*dx*dy;
+    rD[p] = Gx*dx*dx;
+    rE[p] = Gx*dy*dy;
+    rF[p] = Gx;
+    rG[p] = Gy*dx;
+    rH[p] = Gy*dy;
+    rI[p] = Gy*dx*dy;
+    rJ[p] = Gy*dx*dx;
+    rK[p] = Gy*dy*dy;
+    rL[p] = Gy;
+  }
+}
+
 void
 Quadratic_Shape_Function::save_fields(Schema * schema,
   const int_t subset_gid){
@@ -728,6 +939,37 @@ Projection_Shape_Function::residuals(const scalar_t & x,
   residuals[spec_map_.find(PROJECTION_PHI_FS)->second] = gx *dx[PHI][0] + gy * dy[PHI][0];
 }
 
+void
+Projection_Shape_Function::batch_residuals(const int_t num_points,
+  const int_t * x,
+  const int_t * y,
+  const scalar_t & cx,
+  const scalar_t & cy,
+  const scalar_t * gx,
+  const scalar_t * gy,
+  scalar_t * residual_rows,
+  const int_t stride,
+  const bool use_ref_grads) {
+  assert(stride>=num_points);
+  // project the whole batch with one call rather than one call per point
+  const std::vector<scalar_t> source_x(x,x+num_points);
+  const std::vector<scalar_t> source_y(y,y+num_points);
+  std::vector<scalar_t> target_x(num_points,0);
+  std::vector<scalar_t> target_y(num_points,0);
+  std::vector<std::vector<scalar_t> > dx(num_params_,std::vector<scalar_t>(num_points,0));
+  std::vector<std::vector<scalar_t> > dy(num_params_,std::vector<scalar_t>(num_points,0));
+  camera_system_->camera_to_camera_projection(source_cam_id_,target_cam_id_,
+    source_x,source_y,target_x,target_y,parameters_,dx,dy);
+  scalar_t * r_z = residual_rows + spec_map_.find(PROJECTION_Z_FS)->second*stride;
+  scalar_t * r_theta = residual_rows + spec_map_.find(PROJECTION_THETA_FS)->second*stride;
+  scalar_t * r_phi = residual_rows + spec_map_.find(PROJECTION_PHI_FS)->second*stride;
+  for(int_t p=0;p<num_points;++p){
+    r_z[p] = gx[p] * dx[ZP][p] + gy[p] * dy[ZP][p];
+    r_theta[p] = gx[p] * dx[THETA][p] + gy[p] * dy[THETA][p];
+    r_phi[p] = gx[p] * dx[PHI][p] + gy[p] * dy[PHI][p];
+  }
+}
+
 void
 Projection_Shape_Function::save_fields(Schema * schema,
   const int_t subset_gid) {
@@ -821,6 +1063,38 @@ Rigid_Body_Shape_Function::residuals(const scalar_t & x,
   residuals[spec_map_.find(ROT_TRANS_3D_TRANS_Z_FS)->second] = gx * dx[TRANS_Z][0] + gy * dy[TRANS_Z][0];
 }
 
+void
+Rigid_Body_Shape_Function::batch_residuals(const int_t num_points,
+  const int_t * x,
+  const int_t * y,
+  const scalar_t & cx,
+  const scalar_t & cy,
+  const scalar_t * gx,
+  const scalar_t * gy,
+  scalar_t * residual_rows,
+  const int_t stride,
+  const bool use_ref_grads) {
+  assert(stride>=num_points);
+  // project the whole batch with one call rather than one call per point
+  const std::vector<scalar_t> source_x(x,x+num_points);
+  const std::vector<scalar_t> source_y(y,y+num_points);
+  std::vector<scalar_t> mapped_x(num_points,0);
+  std::vector<scalar_t> mapped_y(num_points,0);
+  std::vector<std::vector<scalar_t> > dx(num_params_,std::vector<scalar_t>(num_points,0));
+  std::vector<std::vector<scalar_t> > dy(num_params_,std::vector<scalar_t>(num_points,0));
+  camera_system_->camera_to_camera_projection(0,0,source_x,source_y,mapped_x,mapped_y,facet_params_,dx,dy,parameters_);
+  const Field_Spec specs[6] = {ROT_TRANS_3D_ANG_X_FS,ROT_TRANS_3D_ANG_Y_FS,ROT_TRANS_3D_ANG_Z_FS,
+      ROT_TRANS_3D_TRANS_X_FS,ROT_TRANS_3D_TRANS_Y_FS,ROT_TRANS_3D_TRANS_Z_FS};
+  const int_t params[6] = {ANGLE_X,ANGLE_Y,ANGLE_Z,TRANS_X,TRANS_Y,TRANS_Z};
+  for(int_t i=0;i<6;++i){
+    scalar_t * row = residual_rows + spec_map_.find(specs[i])->second*stride;
+    const std::vector<scalar_t> & dx_i = dx[params[i]];
+    const std::vector<scalar_t> & dy_i = dy[params[i]];
+    for(int_t p=0;p<num_points;++p)
+      row[p] = gx[p] * dx_i[p] + gy[p] * dy_i[p];
+  }
+}
+
 void
 Rigid_Body_Shape_Function::save_fields(Schema * schema,
   const int_t subset_gid){
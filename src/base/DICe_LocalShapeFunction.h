@@ -139,6 +139,23 @@ public:
     scalar_t & out_x,
     scalar_t & out_y)=0;
 
+  /// map a batch of input coordinates to the output coordinates, the default implementation
+  /// calls map() for each point, derived classes override it with loops that vectorize
+  /// \param num_points the number of points in the batch
+  /// \param x input x coordinates
+  /// \param y input y coordinates
+  /// \param cx input centroid coordinate (dummy variable for some shape functions)
+  /// \param cy input centroid coordinate (dummy variable for some shape functions)
+  /// \param out_x [out] mapped x coordinates (must be sized at least num_points)
+  /// \param out_y [out] mapped y coordinates (must be sized at least num_points)
+  virtual void batch_map(const int_t num_points,
+    const int_t * x,
+    const int_t * y,
+    const scalar_t & cx,
+    const scalar_t & cy,
+    scalar_t * out_x,
+    scalar_t * out_y);
+
   /// add the specified translation to the shape function parameter values
   /// \param u displacement in x
   /// \param v displacement in y
@@ -223,6 +240,29 @@ public:
     std::vector<scalar_t> & residuals,
     const bool use_ref_grads=false)=0;
 
+  /// method that computes the residuals for a batch of points, the default implementation
+  /// calls residuals() for each point, derived classes override it with loops that vectorize
+  /// \param num_points the number of points in the batch
+  /// \param x x-coordinates of the points
+  /// \param y y-coordinates of the points
+  /// \param cx input centroid coordinate (dummy variable for some shape functions)
+  /// \param cy input centroid coordinate (dummy variable for some shape functions)
+  /// \param gx x image gradient for each point
+  /// \param gy y image gradient for each point
+  /// \param residual_rows [out] the residuals stored by parameter, the residual of parameter i for point p is residual_rows[i*stride+p]
+  /// \param stride the row stride of the residuals array (must be at least num_points)
+  /// \param use_ref_grads true if the gradients should be used from the reference image (so they need to be adjusted for the current def map)
+  virtual void batch_residuals(const int_t num_points,
+    const int_t * x,
+    const int_t * y,
+    const scalar_t & cx,
+    const scalar_t & cy,
+    const scalar_t * gx,
+    const scalar_t * gy,
+    scalar_t * residual_rows,
+    const int_t stride,
+    const bool use_ref_grads=false);
+
   /// method that computes the residuals for this shape function
   /// \param x x-coordinate of the point to compute for
   /// \param y y-coordinate of the point to compute for
@@ -331,6 +371,15 @@ public:
     scalar_t & out_x,
     scalar_t & out_y);
 
+  /// see base class description
+  virtual void batch_map(const int_t num_points,
+    const int_t * x,
+    const int_t * y,
+    const scalar_t & cx,
+    const scalar_t & cy,
+    scalar_t * out_x,
+    scalar_t * out_y);
+
   /// see base class description
   virtual void add_translation(const scalar_t & u,
     const scalar_t & v);
@@ -361,6 +410,18 @@ public:
     std::vector<scalar_t> & residuals,
     const bool use_ref_grads=false);
 
+  /// see base class description
+  virtual void batch_residuals(const int_t num_points,
+    const int_t * x,
+    const int_t * y,
+    const scalar_t & cx,
+    const scalar_t & cy,
+    const scalar_t * gx,
+    const scalar_t * gy,
+    scalar_t * residual_rows,
+    const int_t stride,
+    const bool use_ref_grads=false);
+
   /// see base class description
   virtual void high_order_terms(const scalar_t & x,
     const scalar_t & y,
@@ -427,6 +488,15 @@ public:
     scalar_t & out_x,
     scalar_t & out_y);
 
+  /// see base class description
+  virtual void batch_map(const int_t num_points,
+    const int_t * x,
+    const int_t * y,
+    const scalar_t & cx,
+    const scalar_t & cy,
+    scalar_t * out_x,
+    scalar_t * out_y);
+
   /// see base class description
   virtual void add_translation(const scalar_t & u,
     const scalar_t & v);
@@ -457,6 +527,18 @@ public:
     std::vector<scalar_t> & residuals,
     const bool use_ref_grads=false);
 
+  /// see base class description
+  virtual void batch_residuals(const int_t num_points,
+    const int_t * x,
+    const int_t * y,
+    const scalar_t & cx,
+    const scalar_t & cy,
+    const scalar_t * gx,
+    const scalar_t * gy,
+    scalar_t * residual_rows,
+    const int_t stride,
+    const bool use_ref_grads=false);
+
   /// see base class description
   virtual void high_order_terms(const scalar_t & x,
     const scalar_t & y,
@@ -542,6 +624,18 @@ public:
     std::vector<scalar_t> & residuals,
     const bool use_ref_grads = false);
 
+  /// see base class description
+  virtual void batch_residuals(const int_t num_points,
+    const int_t * x,
+    const int_t * y,
+    const scalar_t & cx,
+    const scalar_t & cy,
+    const scalar_t * gx,
+    const scalar_t * gy,
+    scalar_t * residual_rows,
+    const int_t stride,
+    const bool use_ref_grads = false);
+
   /// see base class description
   virtual void save_fields(Schema * schema,
     const int_t subset_gid);
@@ -635,6 +729,18 @@ public:
     std::vector<scalar_t> & residuals,
     const bool use_ref_grads = false);
 
+  /// see base class description
+  virtual void batch_residuals(const int_t num_points,
+    const int_t * x,
+    const int_t * y,
+    const scalar_t & cx,
+    const scalar_t & cy,
+    const scalar_t * gx,
+    const scalar_t * gy,
+    scalar_t * residual_rows,
+    const int_t stride,
+    const bool use_ref_grads = false);
+
   /// see base class description
   virtual void high_order_terms(const scalar_t & x,
     const scalar_t & y,
@@ -53,6 +53,7 @@
 #include <cassert>
 #include <array>
 #include <vector>
+#include <cmath>
 
 namespace DICe {
 
@@ -461,6 +462,53 @@ scalar_t one_norm(Matrix<Type,Rows,Cols> matrix){
   return norm;
 };
 
+/// \brief Solve A x = b in place for a symmetric positive definite matrix using a Cholesky factorization
+/// \param A [in/out] the matrix (only the lower triangle is used), on exit holds the Cholesky factor L
+/// \param b [in/out] the right hand side, on exit holds the solution x
+///
+/// Intended for the small tangent matrices in the subset optimization loops, no storage is allocated
+/// and the loops are fully unrolled if the dimensions are known at compile time. Returns false if the
+/// matrix is not positive definite (in which case A and b are left partially modified).
+template <typename Type, size_t Rows>
+bool cholesky_solve(Matrix<Type,Rows,Rows> & A,
+  Matrix<Type,Rows,1> & b){
+  static_assert(std::is_floating_point<Type>::value,"cholesky_solve requires a floating point type");
+  assert(A.rows()==A.cols());
+  assert(b.rows()==A.rows());
+  const size_t n = A.rows();
+  // factor A = L L^T, L is stored in the lower triangle of A
+  for(size_t j=0;j<n;++j){
+    Type d = A(j,j);
+    for(size_t k=0;k<j;++k)
+      d -= A(j,k)*A(j,k);
+    if(!(d>0.0)) return false; // also catches NaN
+    d = std::sqrt(d);
+    A(j,j) = d;
+    const Type inv_d = 1.0/d;
+    for(size_t i=j+1;i<n;++i){
+      Type s = A(i,j);
+      for(size_t k=0;k<j;++k)
+        s -= A(i,k)*A(j,k);
+      A(i,j) = s*inv_d;
+    }
+  }
+  // forward substitution L y = b
+  for(size_t i=0;i<n;++i){
+    Type s = b(i);
+    for(size_t k=0;k<i;++k)
+      s -= A(i,k)*b(k);
+    b(i) = s/A(i,i);
+  }
+  // back substitution L^T x = y
+  for(size_t i=n;i-->0;){
+    Type s = b(i);
+    for(size_t k=i+1;k<n;++k)
+      s -= A(k,i)*b(k);
+    b(i) = s/A(i,i);
+  }
+  return true;
+}
+
 }// End DICe Namespace
 
 #endif
@@ -328,6 +328,15 @@ public:
     return (*epetra_mv_)[field_index][local_id];
   }
 
+  /// \brief pointer to the contiguous local values of one field (NULL if there are no local values)
+  /// \param field_index the index of the field to access
+  ///
+  /// The pointer remains valid for the life of the MultiField (imports and exports write to the same storage)
+  precision_t * local_values(const int_t field_index=0){
+    if(epetra_mv_->MyLength()==0) return NULL;
+    return (*epetra_mv_)[field_index];
+  }
+
   /// \brief axpby for MultiField
   /// \param alpha Multiplier of the input MultiField
   /// \param multifield Input multifield
@@ -490,6 +499,20 @@ public:
     matrix_->InsertGlobalValues(global_row,vals.size(),&vals[0],&cols[0]);
   }
 
+  /// \brief Sum values into existing entries at the global indices given
+  ///
+  /// Unlike insert_global_values this can be called after fill_complete(), but only
+  /// for entries that are already in the matrix graph. Returns the Epetra error code
+  /// (non-zero if an entry was not in the graph)
+  /// \param global_row The global id of the row
+  /// \param cols An array of global column ids
+  /// \param vals An array of real values to add
+  int_t sum_into_global_values(const int_t global_row,
+    const Teuchos::ArrayView<const int_t> & cols,
+    const Teuchos::ArrayView<const precision_t> & vals){
+    return matrix_->SumIntoGlobalValues(global_row,vals.size(),&vals[0],&cols[0]);
+  }
+
   /// Replace values in the local indices given
   /// \param local_row The local id of the row to insert
   /// \param cols An array of local column ids
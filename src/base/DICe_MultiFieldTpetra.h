@@ -350,6 +350,15 @@ public:
     return tpetra_mv_->getLocalView<host_device_type>()(local_id,field_index);
   }
 
+  /// \brief pointer to the contiguous local values of one field (NULL if there are no local values)
+  /// \param field_index the index of the field to access
+  ///
+  /// The pointer remains valid for the life of the MultiField (imports and exports write to the same storage)
+  scalar_t * local_values(const int_t field_index=0){
+    if(tpetra_mv_->getLocalLength()==0) return NULL;
+    return &tpetra_mv_->getLocalView<host_device_type>()(0,field_index);
+  }
+
   /// \brief put that same value in all elements of this Multivector
   /// \param value The value to populate with
   void put_scalar(const scalar_t & value){
@@ -497,6 +506,20 @@ public:
     matrix_->insertGlobalValues (global_row,cols,vals);
   }
 
+  /// \brief Sum values into existing entries at the global indices given
+  ///
+  /// Only entries that are already in the matrix graph are summed into, the matrix
+  /// must be in fill mode (see resume_fill()). Returns zero if all the entries were found
+  /// \param global_row The global id of the row
+  /// \param cols An array of global column ids
+  /// \param vals An array of real values to add
+  int_t sum_into_global_values(const int_t global_row,
+    const Teuchos::ArrayView<const int_t> & cols,
+    const Teuchos::ArrayView<const scalar_t> & vals){
+    const int_t num_valid = matrix_->sumIntoGlobalValues(global_row,cols,vals);
+    return num_valid==(int_t)vals.size() ? 0 : 1;
+  }
+
   /// Replace values in the local indices given
   /// \param local_row The local id of the row to insert
   /// \param cols An array of local column ids
@@ -46,6 +46,40 @@
 
 namespace DICe {
 
+void
+Pixel_Mask::assign(const std::set<std::pair<int_t,int_t> > & coords){
+  clear();
+  if(coords.empty()) return;
+  // the set is ordered by y first so the y extents are the first and last entries
+  y_min_ = coords.begin()->first;
+  const int_t y_max = coords.rbegin()->first;
+  x_min_ = coords.begin()->second;
+  int_t x_max = x_min_;
+  std::set<std::pair<int_t,int_t> >::const_iterator it = coords.begin();
+  for(;it!=coords.end();++it){
+    if(it->second<x_min_) x_min_ = it->second;
+    if(it->second>x_max) x_max = it->second;
+  }
+  width_ = x_max - x_min_ + 1;
+  height_ = y_max - y_min_ + 1;
+  bits_.assign(((size_t)width_*(size_t)height_+63)/64,0);
+  for(it=coords.begin();it!=coords.end();++it){
+    const size_t bit = (size_t)(it->first-y_min_)*(size_t)width_ + (size_t)(it->second-x_min_);
+    bits_[bit>>6] |= (uint64_t)1<<(bit&63);
+  }
+  num_flagged_ = coords.size();
+}
+
+void
+Pixel_Mask::clear(){
+  x_min_ = 0;
+  y_min_ = 0;
+  width_ = 0;
+  height_ = 0;
+  num_flagged_ = 0;
+  bits_.clear();
+}
+
 Subset::Subset(int_t cx,
   int_t cy,
   Teuchos::ArrayRCP<int_t> x,
@@ -71,6 +105,9 @@ Subset::Subset(int_t cx,
   grad_y_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
   is_active_ = Teuchos::ArrayRCP<bool>(num_pixels_,true);
   is_deactivated_this_step_ = Teuchos::ArrayRCP<bool>(num_pixels_,false);
+  mapped_x_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
+  mapped_y_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
+  interp_ids_ = Teuchos::ArrayRCP<int_t>(num_pixels_,0);
   reset_is_active();
   reset_is_deactivated_this_step();
 }
@@ -108,6 +145,9 @@ Subset::Subset(const int_t cx,
   grad_y_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
   is_active_ = Teuchos::ArrayRCP<bool>(num_pixels_,true);
   is_deactivated_this_step_ = Teuchos::ArrayRCP<bool>(num_pixels_,false);
+  mapped_x_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
+  mapped_y_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
+  interp_ids_ = Teuchos::ArrayRCP<int_t>(num_pixels_,0);
   reset_is_active();
   reset_is_deactivated_this_step();
 }
@@ -150,6 +190,9 @@ Subset::Subset(const int_t cx,
   grad_y_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
   is_active_ = Teuchos::ArrayRCP<bool>(num_pixels_,true);
   is_deactivated_this_step_ = Teuchos::ArrayRCP<bool>(num_pixels_,false);
+  mapped_x_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
+  mapped_y_ = Teuchos::ArrayRCP<scalar_t>(num_pixels_,0.0);
+  interp_ids_ = Teuchos::ArrayRCP<int_t>(num_pixels_,0);
   reset_is_active();
   reset_is_deactivated_this_step();
 
@@ -160,10 +203,12 @@ Subset::Subset(const int_t cx,
     }
   }
   if(subset_def.has_obstructed_area()){
+    std::set<std::pair<int_t,int_t> > obstructed_coords;
     for(size_t i=0;i<subset_def.obstructed_area()->size();++i){
       std::set<std::pair<int_t,int_t> > obstructedArea = (*subset_def.obstructed_area())[i]->get_owned_pixels();
-      obstructed_coords_.insert(obstructedArea.begin(),obstructedArea.end());
+      obstructed_coords.insert(obstructedArea.begin(),obstructedArea.end());
     }
+    obstructed_coords_.assign(obstructed_coords);
   }
 }
 
@@ -392,38 +437,35 @@ Subset::initialize(Teuchos::RCP<Image_<S>> image,
   }
   else{
     int_t px,py;
+    const bool has_obstructions = !obstructed_coords_.empty();
     const bool has_blocks = !pixels_blocked_by_other_subsets_.empty();
-    // initialize the work variables
-    scalar_t mapped_x = 0.0;
-    scalar_t mapped_y = 0.0;
     const scalar_t ox=(scalar_t)offset_x,oy=(scalar_t)offset_y;
-    const bool has_gradients = image->has_gradients();
-    // function pointer to avoid having to set the interpolation method for each pixel
-    void (Image_<S>::*interp_func)(scalar_t&,scalar_t&,scalar_t&,const bool,const scalar_t&,const scalar_t&) const = image->get_interpolant(interp);
+    scalar_t * mapped_x = mapped_x_.getRawPtr();
+    scalar_t * mapped_y = mapped_y_.getRawPtr();
+    int_t * interp_ids = interp_ids_.getRawPtr();
+    // map all the pixel coordinates in one call
+    shape_function->batch_map(num_pixels_,x_.getRawPtr(),y_.getRawPtr(),cx_,cy_,mapped_x,mapped_y);
+    // deactivate the pixels that are out of bounds, obstructed, or blocked and compact the rest
+    // into a list of local image coordinates to interpolate (compacting in place is safe since num_interp <= i)
+    int_t num_interp = 0;
     for(int_t i=0;i<num_pixels_;++i){
-      shape_function->map(x_[i],y_[i],cx_,cy_,mapped_x,mapped_y);
-      px = ((int_t)(mapped_x + 0.5) == (int_t)(mapped_x)) ? (int_t)(mapped_x) : (int_t)(mapped_x) + 1;
-      py = ((int_t)(mapped_y + 0.5) == (int_t)(mapped_y)) ? (int_t)(mapped_y) : (int_t)(mapped_y) + 1;
+      px = ((int_t)(mapped_x[i] + 0.5) == (int_t)(mapped_x[i])) ? (int_t)(mapped_x[i]) : (int_t)(mapped_x[i]) + 1;
+      py = ((int_t)(mapped_y[i] + 0.5) == (int_t)(mapped_y[i])) ? (int_t)(mapped_y[i]) : (int_t)(mapped_y[i]) + 1;
       // out of image bounds ( 4 pixel buffer to ensure enough room to interpolate away from the sub image boundary)
-      if(px<offset_x+4||px>=offset_x+w-4||py<offset_y+4||py>=offset_y+h-4){
-        is_deactivated_this_step(i) = true;
-        continue;
-      }
-      if(is_obstructed_pixel(mapped_x,mapped_y)){
-        is_deactivated_this_step(i) = true;
-        continue;
-      }
-      if(has_blocks){
-        if(pixels_blocked_by_other_subsets_.find(std::pair<int_t,int_t>(py,px))
-            !=pixels_blocked_by_other_subsets_.end()){
-          is_deactivated_this_step(i) = true;
-          continue;
-        }
-      }
-      // if the code got here, the pixel is not deactivated
-      is_deactivated_this_step(i) = false;
-      (*image.*interp_func)(intensities[i], grad_x_[i], grad_y_[i],has_gradients, mapped_x-ox, mapped_y-oy);
+      bool deactivated = px<offset_x+4||px>=offset_x+w-4||py<offset_y+4||py>=offset_y+h-4;
+      if(!deactivated&&has_obstructions)
+        deactivated = is_obstructed_pixel(mapped_x[i],mapped_y[i]);
+      if(!deactivated&&has_blocks)
+        deactivated = pixels_blocked_by_other_subsets_.contains(px,py);
+      is_deactivated_this_step_[i] = deactivated;
+      if(deactivated) continue;
+      interp_ids[num_interp] = i;
+      mapped_x[num_interp] = mapped_x[i] - ox;
+      mapped_y[num_interp] = mapped_y[i] - oy;
+      num_interp++;
     }
+    image->interpolate_batch(interp,num_interp,interp_ids,mapped_x,mapped_y,
+      intensities.getRawPtr(),grad_x_.getRawPtr(),grad_y_.getRawPtr(),image->has_gradients());
   }
   // sync up the intensities:
   if(target==REF_INTENSITIES){
@@ -452,11 +494,7 @@ Subset::is_obstructed_pixel(const scalar_t & coord_x,
   int_t c_y = (int_t)coord_y;
   if(coord_y - (int_t)coord_y >= 0.5) c_y++;
   // now check if c_x and c_y are obstructed
-  // Note the x and y coordinates are switched because that is how they live in the set
-  // this was done for performance in loops over y then x
-  std::pair<int_t,int_t> point(c_y,c_x);
-  const bool obstructed = obstructed_coords_.find(point)!=obstructed_coords_.end();
-  return obstructed;
+  return obstructed_coords_.contains(c_x,c_y);
 }
 
 std::set<std::pair<int_t,int_t> >
@@ -478,25 +516,20 @@ void
 Subset::turn_off_obstructed_pixels(Teuchos::RCP<Local_Shape_Function> shape_function){
   assert(shape_function!=Teuchos::null);
 
-  scalar_t X=0.0,Y=0.0;
   int_t px=0,py=0;
   const bool has_blocks = !pixels_blocked_by_other_subsets_.empty();
   reset_is_deactivated_this_step();
 
+  scalar_t * X = mapped_x_.getRawPtr();
+  scalar_t * Y = mapped_y_.getRawPtr();
+  shape_function->batch_map(num_pixels_,x_.getRawPtr(),y_.getRawPtr(),cx_,cy_,X,Y);
   for(int_t i=0;i<num_pixels_;++i){
-    shape_function->map(x(i),y(i),cx_,cy_,X,Y);
-    if(is_obstructed_pixel(X,Y)){
-      is_deactivated_this_step(i) = true;
-    }
-    else{
-      is_deactivated_this_step(i) = false;
-    }
+    is_deactivated_this_step(i) = is_obstructed_pixel(X[i],Y[i]);
     // pixels blocked by other subsets:
     if(has_blocks){
-      px = ((int_t)(X + 0.5) == (int_t)(X)) ? (int_t)(X) : (int_t)(X) + 1;
-      py = ((int_t)(Y + 0.5) == (int_t)(Y)) ? (int_t)(Y) : (int_t)(Y) + 1;
-      if(pixels_blocked_by_other_subsets_.find(std::pair<int_t,int_t>(py,px))
-          !=pixels_blocked_by_other_subsets_.end()){
+      px = ((int_t)(X[i] + 0.5) == (int_t)(X[i])) ? (int_t)(X[i]) : (int_t)(X[i]) + 1;
+      py = ((int_t)(Y[i] + 0.5) == (int_t)(Y[i])) ? (int_t)(Y[i]) : (int_t)(Y[i]) + 1;
+      if(pixels_blocked_by_other_subsets_.contains(px,py)){
         is_deactivated_this_step(i) = true;
       }
     }
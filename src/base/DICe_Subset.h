@@ -49,6 +49,10 @@
 
 #include <Teuchos_ArrayRCP.hpp>
 
+#include <set>
+#include <vector>
+#include <stdint.h>
+
 /*!
  *  \namespace DICe
  *  @{
@@ -56,6 +60,65 @@
 /// generic DICe classes and functions
 namespace DICe {
 
+/// \class DICe::Pixel_Mask
+/// \brief Bitmap of flagged pixels over the bounding box of the flagged pixels,
+/// used for constant time lookups of obstructed or blocked pixel coordinates
+class DICE_LIB_DLL_EXPORT
+Pixel_Mask {
+public:
+  /// constructor
+  Pixel_Mask():
+    x_min_(0),
+    y_min_(0),
+    width_(0),
+    height_(0),
+    num_flagged_(0){};
+
+  /// replace the contents of the mask with a set of pixel coordinates
+  /// \param coords the pixel coordinates to flag
+  /// NOTE: The coordinates are switched in the set (i.e. (Y,X)) to match the shape classes
+  void assign(const std::set<std::pair<int_t,int_t> > & coords);
+
+  /// unflag all the pixels
+  void clear();
+
+  /// returns true if no pixels are flagged
+  bool empty()const{
+    return num_flagged_==0;
+  }
+
+  /// returns the number of flagged pixels
+  int_t size()const{
+    return num_flagged_;
+  }
+
+  /// returns true if the given pixel is flagged
+  /// \param x global x-coordinate of the pixel
+  /// \param y global y-coordinate of the pixel
+  bool contains(const int_t x,
+    const int_t y)const{
+    const int_t lx = x - x_min_;
+    const int_t ly = y - y_min_;
+    if(lx<0||lx>=width_||ly<0||ly>=height_) return false;
+    const size_t bit = (size_t)ly*(size_t)width_ + (size_t)lx;
+    return (bits_[bit>>6]>>(bit&63))&1;
+  }
+
+private:
+  /// left edge of the bounding box
+  int_t x_min_;
+  /// top edge of the bounding box
+  int_t y_min_;
+  /// width of the bounding box
+  int_t width_;
+  /// height of the bounding box
+  int_t height_;
+  /// number of flagged pixels
+  int_t num_flagged_;
+  /// one bit per pixel in the bounding box, stored row by row
+  std::vector<uint64_t> bits_;
+};
+
 /// \class DICe::Subset
 /// \brief Subsets are used to store temporary collections of pixels for comparison between the
 /// reference and deformed images. The data that is stored by a subset is a list of x and y
@@ -292,8 +355,8 @@ public:
   bool is_obstructed_pixel(const scalar_t & coord_x,
     const scalar_t & coord_y)const;
 
-  /// \brief EXPERIMENTAL Returns a pointer to the set of pixels currently obstructed by another subset
-  std::set<std::pair<int_t,int_t> > * pixels_blocked_by_other_subsets(){
+  /// \brief EXPERIMENTAL Returns a pointer to the mask of pixels currently obstructed by another subset
+  Pixel_Mask * pixels_blocked_by_other_subsets(){
     return & pixels_blocked_by_other_subsets_;
   }
 
@@ -322,14 +385,16 @@ private:
   Teuchos::ArrayRCP<int_t> x_;
   /// initial x position of the pixels in the reference image
   Teuchos::ArrayRCP<int_t> y_;
+  /// mapped x position of the pixels (scratch space for initialize())
+  Teuchos::ArrayRCP<scalar_t> mapped_x_;
+  /// mapped y position of the pixels (scratch space for initialize())
+  Teuchos::ArrayRCP<scalar_t> mapped_y_;
+  /// indices of the pixels to interpolate (scratch space for initialize())
+  Teuchos::ArrayRCP<int_t> interp_ids_;
   /// \brief EXPERIMENTAL Holds the obstruction coordinates if they exist.
-  /// NOTE: The coordinates are switched for this (i.e. (Y,X)) so that
-  /// the loops over y then x will be more efficient
-  std::set<std::pair<int_t,int_t> > obstructed_coords_;
+  Pixel_Mask obstructed_coords_;
   /// \brief EXPERIMENTAL Holds the pixels blocked by other subsets if they exist.
-  /// NOTE: The coordinates are switched for this (i.e. (Y,X)) so that
-  /// the loops over y then x will be more efficient
-  std::set<std::pair<int_t,int_t> > pixels_blocked_by_other_subsets_;
+  Pixel_Mask pixels_blocked_by_other_subsets_;
   /// centroid location x
   int_t cx_; // assumed to be the middle of the pixel
   /// centroid location y
@@ -0,0 +1,127 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+#ifndef DICE_TANGENT_H
+#define DICE_TANGENT_H
+
+#include <DICe.h>
+
+#include <cassert>
+
+namespace DICe {
+
+/// number of pixels gathered into each block for the tangent accumulation
+#define DICE_TANGENT_BLOCK_SIZE 64
+
+/// number of independent partial sums in the dot products of the tangent accumulation,
+//  the partial sums map directly onto SIMD lanes (8 doubles fill an AVX-512 register or two AVX2 registers)
+//  so the compiler can vectorize the sums without having to reassociate the floating point additions
+#define DICE_TANGENT_LANES 8
+
+/// \brief Dot product of two arrays accumulated in double precision
+/// \param a the first array
+/// \param b the second array
+/// \param num_values the number of values in each array
+inline double
+tangent_dot(const scalar_t * a,
+  const scalar_t * b,
+  const int_t num_values){
+  double partial[DICE_TANGENT_LANES] = {0.0};
+  int_t p = 0;
+  for(;p+DICE_TANGENT_LANES<=num_values;p+=DICE_TANGENT_LANES)
+    for(int_t l=0;l<DICE_TANGENT_LANES;++l)
+      partial[l] += static_cast<double>(a[p+l])*static_cast<double>(b[p+l]);
+  for(;p<num_values;++p)
+    partial[0] += static_cast<double>(a[p])*static_cast<double>(b[p]);
+  double sum = 0.0;
+  for(int_t l=0;l<DICE_TANGENT_LANES;++l)
+    sum += partial[l];
+  return sum;
+}
+
+/// \brief Accumulate the Gauss-Newton tangent and gradient for a block of pixels
+/// \param num_params the number of shape function parameters (must equal N if N is not zero)
+/// \param num_pixels the number of pixels in the block
+/// \param residuals the residuals for each pixel, one row per parameter (the residual for parameter i
+/// and pixel p is residuals[i*stride+p])
+/// \param stride the row stride of the residuals
+/// \param gmf the intensity difference for each pixel (deformed minus reference, zero mean)
+/// \param H [in/out] row major tangent storage with leading dimension num_params, only the upper triangle is accumulated
+/// \param q [in/out] gradient storage
+///
+/// The template parameter N is the number of shape function parameters if known at compile time (zero otherwise).
+/// The pixels are expected to be packed so that only active pixels are in the block. Since the tangent is
+/// symmetric only the upper triangle is computed, the caller is responsible for filling in the lower triangle
+/// once all the blocks have been accumulated (see tangent_fill_lower())
+template <size_t N>
+void
+accumulate_tangent(const int_t num_params,
+  const int_t num_pixels,
+  const scalar_t * residuals,
+  const int_t stride,
+  const scalar_t * gmf,
+  double * H,
+  double * q){
+  const int_t n = N > 0 ? (int_t)N : num_params;
+  assert(N==0||(int_t)N==num_params);
+  assert(stride>=num_pixels);
+  for(int_t i=0;i<n;++i){
+    const scalar_t * row_i = residuals + i*stride;
+    q[i] += tangent_dot(gmf,row_i,num_pixels);
+    for(int_t j=i;j<n;++j)
+      H[i*n+j] += tangent_dot(row_i,residuals + j*stride,num_pixels);
+  }
+}
+
+/// \brief Copy the upper triangle of a row major tangent into the lower triangle
+/// \param num_params the number of shape function parameters
+/// \param H [in/out] row major tangent storage with leading dimension num_params
+inline void
+tangent_fill_lower(const int_t num_params,
+  double * H){
+  for(int_t i=1;i<num_params;++i)
+    for(int_t j=0;j<i;++j)
+      H[i*num_params+j] = H[j*num_params+i];
+}
+
+}// End DICe Namespace
+
+#endif
@@ -0,0 +1,359 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+#ifndef DICE_THREADPOOL_H
+#define DICE_THREADPOOL_H
+
+#include <DICe.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*!
+ *  \namespace DICe
+ *  @{
+ */
+/// generic DICe classes and functions
+namespace DICe {
+
+/// \class DICe::Thread_Pool
+/// \brief Fixed set of worker threads used for on-node parallelism
+///
+/// The pool holds num_threads-1 workers; the thread that calls parallel_for()
+/// participates in the loop so that num_threads threads in total do the work.
+/// Loop indices are handed out dynamically in chunks from a shared atomic counter
+/// so that expensive iterations (e.g. subsets that need many solver iterations)
+/// do not stall a statically assigned block. parallel_for() is safe to call from
+/// inside a task that is already running on the pool: if no workers are free the
+/// caller simply executes all of the iterations itself.
+class Thread_Pool{
+public:
+  /// \brief Constructor
+  /// \param num_threads total number of threads including the calling thread,
+  /// a value less than 1 uses the hardware concurrency
+  explicit Thread_Pool(const int_t num_threads):
+  shutdown_(false){
+    const int_t total = num_threads < 1 ? hardware_threads() : num_threads;
+    for(int_t i=1;i<total;++i)
+      workers_.emplace_back(&Thread_Pool::worker_loop,this);
+  }
+
+  /// Destructor, waits for queued tasks to complete
+  ~Thread_Pool(){
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      shutdown_ = true;
+    }
+    queue_cv_.notify_all();
+    for(size_t i=0;i<workers_.size();++i)
+      if(workers_[i].joinable()) workers_[i].join();
+  }
+
+  /// no copies allowed
+  Thread_Pool(const Thread_Pool &) = delete;
+  /// no copies allowed
+  Thread_Pool & operator=(const Thread_Pool &) = delete;
+
+  /// returns the total number of threads that participate in a parallel_for (workers plus the caller)
+  int_t num_threads()const{
+    return (int_t)workers_.size() + 1;
+  }
+
+  /// returns the number of hardware threads available (at least 1)
+  static int_t hardware_threads(){
+    const int_t hw = (int_t)std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+  }
+
+  /// \brief Queue a task for asynchronous execution
+  /// \param func the callable to execute
+  ///
+  /// If the pool has no worker threads the task is executed immediately on the calling thread.
+  /// Exceptions thrown by the task are rethrown from the returned future's get()
+  template <typename F>
+  auto submit(F && func) -> std::future<decltype(func())>{
+    typedef decltype(func()) return_type;
+    std::shared_ptr<std::packaged_task<return_type()> > task =
+        std::make_shared<std::packaged_task<return_type()> >(std::forward<F>(func));
+    std::future<return_type> result = task->get_future();
+    if(workers_.empty()){
+      (*task)();
+      return result;
+    }
+    enqueue([task](){(*task)();});
+    return result;
+  }
+
+  /// \brief Execute func(i,thread_id) for every i in [begin,end)
+  /// \param begin first index
+  /// \param end one past the last index
+  /// \param func callable with signature void(const int_t index, const int_t thread_id),
+  /// thread_id is unique among the threads working on this loop and lies in [0,num_threads())
+  /// \param chunk number of consecutive indices claimed at a time
+  ///
+  /// Returns once every iteration has completed. If any iteration throws, the remaining
+  /// unclaimed iterations are abandoned and the first exception is rethrown on the calling thread.
+  template <typename F>
+  void parallel_for(const int_t begin,
+    const int_t end,
+    const F & func,
+    const int_t chunk=1){
+    if(end<=begin) return;
+    const int_t step = std::max(chunk,(int_t)1);
+    const int_t num_helpers = std::min((int_t)workers_.size(),(end-begin-1)/step);
+    if(num_helpers<=0){
+      for(int_t i=begin;i<end;++i)
+        func(i,0);
+      return;
+    }
+    std::shared_ptr<Loop_State> state = std::make_shared<Loop_State>(begin);
+    // the helpers reference func through the loop state, which is only valid while this
+    // call is active, helpers that start after the loop is closed return without touching it
+    const F * func_ptr = &func;
+    for(int_t t=1;t<=num_helpers;++t){
+      enqueue([state,func_ptr,end,step,t](){
+        {
+          std::unique_lock<std::mutex> lock(state->mutex_);
+          if(state->closed_) return;
+          state->running_++;
+        }
+        run_chunks(*state,*func_ptr,end,step,t);
+        {
+          std::unique_lock<std::mutex> lock(state->mutex_);
+          state->running_--;
+        }
+        state->cv_.notify_all();
+      });
+    }
+    run_chunks(*state,func,end,step,0);
+    std::unique_lock<std::mutex> lock(state->mutex_);
+    state->closed_ = true;
+    state->cv_.wait(lock,[&state](){return state->running_==0;});
+    if(state->error_) std::rethrow_exception(state->error_);
+  }
+
+  /// \brief Execute func(i,thread_id) for every node i of a dependency graph
+  /// \param predecessors for each node, the list of nodes that have to complete before it can start
+  /// \param func callable with signature void(const int_t index, const int_t thread_id),
+  /// see parallel_for()
+  ///
+  /// Every predecessor index has to be less than the index of the node that depends on it, which
+  /// guarantees the graph is acyclic and that executing the nodes in index order is a valid schedule.
+  /// Nodes are started as soon as all of their predecessors have completed (in index order among
+  /// the nodes that are ready), so independent chains proceed concurrently as wavefronts.
+  /// If any node throws, nodes that have not started are abandoned and the first exception
+  /// is rethrown on the calling thread.
+  template <typename F>
+  void parallel_for_dag(const std::vector<std::vector<int_t> > & predecessors,
+    const F & func){
+    const int_t num_nodes = (int_t)predecessors.size();
+    if(num_nodes==0) return;
+    std::vector<int_t> num_pending(num_nodes,0);
+    std::vector<std::vector<int_t> > successors(num_nodes);
+    for(int_t i=0;i<num_nodes;++i){
+      for(size_t j=0;j<predecessors[i].size();++j){
+        const int_t pred = predecessors[i][j];
+        if(pred<0||pred>=i)
+          throw std::invalid_argument("Thread_Pool::parallel_for_dag(): predecessors must have a lower index than the node that depends on them");
+        successors[pred].push_back(i);
+        num_pending[i]++;
+      }
+    }
+    if(workers_.empty()){
+      for(int_t i=0;i<num_nodes;++i)
+        func(i,0);
+      return;
+    }
+    Graph_State state;
+    for(int_t i=0;i<num_nodes;++i)
+      if(num_pending[i]==0) state.ready_.push_back(i);
+    // each slot of this loop runs a scheduler that pulls ready nodes until the graph is done
+    parallel_for(0,num_threads(),[&](const int_t, const int_t thread_id){
+      while(true){
+        int_t node = -1;
+        {
+          std::unique_lock<std::mutex> lock(state.mutex_);
+          state.cv_.wait(lock,[&](){return state.abort_||state.completed_==num_nodes||!state.ready_.empty();});
+          if(state.abort_||state.completed_==num_nodes) return;
+          node = state.ready_.front();
+          state.ready_.pop_front();
+        }
+        try{
+          func(node,thread_id);
+        }
+        catch(...){
+          {
+            std::unique_lock<std::mutex> lock(state.mutex_);
+            state.abort_ = true;
+            if(!state.error_) state.error_ = std::current_exception();
+          }
+          state.cv_.notify_all();
+          return;
+        }
+        {
+          std::unique_lock<std::mutex> lock(state.mutex_);
+          state.completed_++;
+          for(size_t j=0;j<successors[node].size();++j){
+            const int_t succ = successors[node][j];
+            if(--num_pending[succ]==0) state.ready_.push_back(succ);
+          }
+        }
+        state.cv_.notify_all();
+      }
+    });
+    if(state.error_) std::rethrow_exception(state.error_);
+  }
+
+private:
+  /// shared bookkeeping for one parallel_for_dag call
+  struct Graph_State{
+    Graph_State():
+      completed_(0),
+      abort_(false){}
+    /// nodes whose predecessors have all completed
+    std::deque<int_t> ready_;
+    /// number of nodes that have completed
+    int_t completed_;
+    /// set if a node threw an exception
+    bool abort_;
+    /// first exception thrown by a node
+    std::exception_ptr error_;
+    /// guards all of the above and the pending counts
+    std::mutex mutex_;
+    /// signaled when nodes become ready or the graph completes
+    std::condition_variable cv_;
+  };
+
+  /// shared bookkeeping for one parallel_for call
+  struct Loop_State{
+    explicit Loop_State(const int_t begin):
+      next_(begin),
+      running_(0),
+      closed_(false){}
+    /// next unclaimed index
+    std::atomic<int_t> next_;
+    /// number of helpers currently executing iterations
+    int_t running_;
+    /// set once the calling thread has finished its share, late helpers do nothing
+    bool closed_;
+    /// first exception thrown by an iteration
+    std::exception_ptr error_;
+    /// guards running_, closed_ and error_
+    std::mutex mutex_;
+    /// signaled when a helper finishes
+    std::condition_variable cv_;
+  };
+
+  /// claim chunks of indices from the shared counter until none are left
+  template <typename F>
+  static void run_chunks(Loop_State & state,
+    const F & func,
+    const int_t end,
+    const int_t step,
+    const int_t thread_id){
+    try{
+      while(true){
+        const int_t start = state.next_.fetch_add(step);
+        if(start>=end) break;
+        const int_t stop = std::min(start+step,end);
+        for(int_t i=start;i<stop;++i)
+          func(i,thread_id);
+      }
+    }
+    catch(...){
+      std::unique_lock<std::mutex> lock(state.mutex_);
+      if(!state.error_) state.error_ = std::current_exception();
+      // abandon the rest of the loop
+      state.next_.store(end);
+    }
+  }
+
+  /// add a task to the queue and wake a worker
+  void enqueue(std::function<void()> task){
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    queue_cv_.notify_one();
+  }
+
+  /// main loop for each worker thread
+  void worker_loop(){
+    while(true){
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_cv_.wait(lock,[this](){return shutdown_||!tasks_.empty();});
+        if(shutdown_&&tasks_.empty()) return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  /// worker threads
+  std::vector<std::thread> workers_;
+  /// queued tasks
+  std::deque<std::function<void()> > tasks_;
+  /// guards the task queue and the shutdown flag
+  std::mutex queue_mutex_;
+  /// signaled when a task is queued or the pool shuts down
+  std::condition_variable queue_cv_;
+  /// true once the destructor has been called
+  bool shutdown_;
+};
+
+}// End DICe Namespace
+
+/*! @} End of Doxygen namespace*/
+
+#endif
@@ -47,6 +47,8 @@
 
 #include <Teuchos_oblackholestream.hpp>
 
+#include <algorithm>
+
 namespace DICe {
 
 Decomp::Decomp(const Teuchos::RCP<Teuchos::ParameterList> & input_params,
@@ -109,11 +111,14 @@ Decomp::initialize(const Teuchos::ArrayRCP<scalar_t> subset_centroids_x,
   for(int_t i=0;i<id_decomp_map_->get_num_local_elements();++i)
     this_proc_gid_order_[i] = id_decomp_map_->get_global_element(i);
 
+  // give each processor a spatially compact region of subsets:
+  create_spatial_dist_map(subset_centroids_x,subset_centroids_y);
+
   // if there are blocking subsets, they need to be on the same processor and put in order:
   create_obstruction_dist_map(obstructing_subset_ids);
 
   // if there are seeds involved, the decomp must respect these
-  create_seed_dist_map(neighbor_ids,obstructing_subset_ids,correlation_params);
+  create_seed_dist_map(neighbor_ids,obstructing_subset_ids,correlation_params,subset_centroids_x,subset_centroids_y);
 
   // at this point the id_decomp_map should be one-to-one in all circumstances
   TEUCHOS_TEST_FOR_EXCEPTION(!id_decomp_map_->is_one_to_one(),std::runtime_error,"");
@@ -456,7 +461,9 @@ Decomp::create_obstruction_dist_map(Teuchos::RCP<std::map<int_t,std::vector<int_
 void
 Decomp::create_seed_dist_map(Teuchos::RCP<std::vector<int_t> > & neighbor_ids,
   Teuchos::RCP<std::map<int_t,std::vector<int_t> > > & obstructing_subset_ids,
-  const Teuchos::RCP<Teuchos::ParameterList> & correlation_params){
+  const Teuchos::RCP<Teuchos::ParameterList> & correlation_params,
+  const Teuchos::ArrayRCP<scalar_t> & subset_centroids_x,
+  const Teuchos::ArrayRCP<scalar_t> & subset_centroids_y){
 
   if(neighbor_ids==Teuchos::null) return;
 
@@ -501,9 +508,113 @@ Decomp::create_seed_dist_map(Teuchos::RCP<std::vector<int_t> > & neighbor_ids,
   }
 
   // process zero divies up the subsets:
+  std::vector<std::vector<int_t> > ids_on_each_proc(num_procs);
+  if(proc_id==0){
+    TEUCHOS_TEST_FOR_EXCEPTION((int_t)neighbor_ids->size()!=num_global_subsets_,std::runtime_error,"");
+    TEUCHOS_TEST_FOR_EXCEPTION(subset_centroids_x.size()!=num_global_subsets_||subset_centroids_y.size()!=num_global_subsets_,std::runtime_error,"");
+    std::vector<int_t> this_group_gids;
+    std::vector<std::vector<int_t> > seed_groupings;
+    for(int_t i=num_global_subsets_-1;i>=0;--i){
+      this_group_gids.push_back(i);
+      // if this subset is a seed, break this grouping and insert it in the set
+      if((*neighbor_ids)[i]==-1){
+        seed_groupings.push_back(this_group_gids);
+        this_group_gids.clear();
+      }
+    }
+    // reverse all the seed groupings:
+    for(size_t i=0;i<seed_groupings.size();++i){
+      std::reverse(seed_groupings[i].begin(), seed_groupings[i].end());
+    }
+    // split the groups among processors, groups that are close to each other go to the same processor
+    // (each group is represented by the centroid of its subsets and weighted by the weight of all its subsets)
+    const std::vector<scalar_t> weights = subset_weights();
+    std::vector<scalar_t> group_x(seed_groupings.size(),0.0);
+    std::vector<scalar_t> group_y(seed_groupings.size(),0.0);
+    std::vector<scalar_t> group_weights(seed_groupings.size(),0.0);
+    for(size_t i=0;i<seed_groupings.size();++i){
+      for(size_t j=0;j<seed_groupings[i].size();++j){
+        group_x[i] += subset_centroids_x[seed_groupings[i][j]];
+        group_y[i] += subset_centroids_y[seed_groupings[i][j]];
+        group_weights[i] += weights[seed_groupings[i][j]];
+      }
+      group_x[i] /= seed_groupings[i].size();
+      group_y[i] /= seed_groupings[i].size();
+    }
+    const std::vector<int_t> send_to_proc = recursive_coordinate_bisection(group_x,group_y,group_weights,num_procs);
+    // stack the ids in processor order
+    for(size_t i=0;i<seed_groupings.size();++i)
+      ids_on_each_proc[send_to_proc[i]].insert(ids_on_each_proc[send_to_proc[i]].end(),seed_groupings[i].begin(),seed_groupings[i].end());
+  }// end processor 0
+  distribute_ids_from_proc_zero(ids_on_each_proc);
+  DEBUG_MSG("[PROC "<<proc_id <<"] Decomp::create_seed_dist_map(): num local subsets " << this_proc_gid_order_.size());
+}
+
+void
+Decomp::create_spatial_dist_map(const Teuchos::ArrayRCP<scalar_t> & subset_centroids_x,
+  const Teuchos::ArrayRCP<scalar_t> & subset_centroids_y){
+  const int_t num_procs = comm_->get_size();
+  if(num_procs==1) return;
+  std::vector<std::vector<int_t> > ids_on_each_proc(num_procs);
+  if(comm_->get_rank()==0){
+    TEUCHOS_TEST_FOR_EXCEPTION(subset_centroids_x.size()!=num_global_subsets_||subset_centroids_y.size()!=num_global_subsets_,std::runtime_error,"");
+    std::vector<scalar_t> coords_x(num_global_subsets_,0.0);
+    std::vector<scalar_t> coords_y(num_global_subsets_,0.0);
+    for(int_t i=0;i<num_global_subsets_;++i){
+      coords_x[i] = subset_centroids_x[i];
+      coords_y[i] = subset_centroids_y[i];
+    }
+    const std::vector<int_t> parts = recursive_coordinate_bisection(coords_x,coords_y,subset_weights(),num_procs);
+    for(int_t i=0;i<num_global_subsets_;++i)
+      ids_on_each_proc[parts[i]].push_back(i);
+  }
+  distribute_ids_from_proc_zero(ids_on_each_proc);
+  DEBUG_MSG("[PROC "<< comm_->get_rank() <<"] Decomp::create_spatial_dist_map(): num local subsets " << this_proc_gid_order_.size());
+}
+
+std::vector<scalar_t>
+Decomp::subset_weights()const{
+  std::vector<scalar_t> weights(num_global_subsets_,1.0);
+  if(subset_info_==Teuchos::null) return weights;
+  if(subset_info_->conformal_area_defs==Teuchos::null) return weights;
+  // square subsets are all the same size, so only the conformal subsets need a different weight
+  // (relative to the average size of the conformal subsets)
+  scalar_t total_pixels = 0.0;
+  int_t num_conformal = 0;
+  std::map<int_t,DICe::Conformal_Area_Def>::const_iterator it = subset_info_->conformal_area_defs->begin();
+  for(;it!=subset_info_->conformal_area_defs->end();++it){
+    if(it->first<0||it->first>=num_global_subsets_||!it->second.has_boundary()) continue;
+    scalar_t num_pixels = 0.0;
+    for(size_t i=0;i<it->second.boundary()->size();++i)
+      num_pixels += (*it->second.boundary())[i]->get_owned_pixels().size();
+    weights[it->first] = num_pixels;
+    total_pixels += num_pixels;
+    num_conformal++;
+  }
+  if(num_conformal==0||total_pixels<=0.0) return std::vector<scalar_t>(num_global_subsets_,1.0);
+  // the square subsets get the average conformal subset weight
+  const scalar_t average = total_pixels/num_conformal;
+  for(int_t i=0;i<num_global_subsets_;++i){
+    if(subset_info_->conformal_area_defs->find(i)==subset_info_->conformal_area_defs->end())
+      weights[i] = average;
+    weights[i] /= average;
+  }
+  return weights;
+}
+
+void
+Decomp::distribute_ids_from_proc_zero(const std::vector<std::vector<int_t> > & ids_on_each_proc){
+  const int_t proc_id = comm_->get_rank();
+  const int_t num_procs = comm_->get_size();
+
   Teuchos::Array<int_t> field_zero_owned_ids;
   if(proc_id==0){
-    field_zero_owned_ids = Teuchos::Array<int_t>(num_global_subsets_);
+    TEUCHOS_TEST_FOR_EXCEPTION((int_t)ids_on_each_proc.size()!=num_procs,std::runtime_error,"");
+    int_t num_ids = 0;
+    for(int_t proc=0;proc<num_procs;++proc)
+      num_ids += ids_on_each_proc[proc].size();
+    TEUCHOS_TEST_FOR_EXCEPTION(num_ids>num_global_subsets_,std::runtime_error,"");
+    field_zero_owned_ids = Teuchos::Array<int_t>(num_ids);
   }
   for(int_t i=0;i<field_zero_owned_ids.size();++i){
     field_zero_owned_ids[i] = i;
@@ -525,43 +636,14 @@ Decomp::create_seed_dist_map(Teuchos::RCP<std::vector<int_t> > & neighbor_ids,
   Teuchos::RCP<MultiField> all_data = Teuchos::rcp(new MultiField(all_map,2,true));
 
   if(proc_id==0){
-    std::vector<int_t> local_subset_gids_grouped_by_roi;
-    TEUCHOS_TEST_FOR_EXCEPTION((int_t)neighbor_ids->size()!=num_global_subsets_,std::runtime_error,"");
-    std::vector<int_t> this_group_gids;
-    std::vector<std::vector<int_t> > seed_groupings;
-    for(int_t i=num_global_subsets_-1;i>=0;--i){
-      this_group_gids.push_back(i);
-      // if this subset is a seed, break this grouping and insert it in the set
-      if((*neighbor_ids)[i]==-1){
-        seed_groupings.push_back(this_group_gids);
-        this_group_gids.clear();
-      }
-    }
-    // reverse all the seed groupings:
-    for(size_t i=0;i<seed_groupings.size();++i){
-      std::reverse(seed_groupings[i].begin(), seed_groupings[i].end());
-    }
-    // split the groups among processors
-    std::vector<int_t> send_to_proc(seed_groupings.size(),0);
-    int_t p_id = 0;
-    for(size_t i=0;i<seed_groupings.size();++i){
-      send_to_proc[i] = p_id++;
-      if(p_id==num_procs) p_id=0;
-    }
-    // restack the ids in processor order
+    // stack the ids in processor order
     int_t id_count = 0;
     for(int_t proc=0;proc<num_procs;++proc){
       zero_data->local_value(proc,0) = id_count;
-      for(size_t i=0;i<seed_groupings.size();++i){
-        if(send_to_proc[i]==(int_t)proc){
-          for(size_t j=0;j<seed_groupings[i].size();++j){
-            field_zero_data->local_value(id_count++) = seed_groupings[i][j];
-          }
-        } // end proc id matches
-      } // end loop over seed groupings
+      for(size_t j=0;j<ids_on_each_proc[proc].size();++j)
+        field_zero_data->local_value(id_count++) = ids_on_each_proc[proc][j];
       zero_data->local_value(proc,1) = id_count - 1;
     } // end proc loop
-    // now field zero list is ordered by groupings and processors
   }// end processor 0
 
   // communicate the extents of the ordered list to all procs:
@@ -570,35 +652,30 @@ Decomp::create_seed_dist_map(Teuchos::RCP<std::vector<int_t> > & neighbor_ids,
   const int_t start_id = all_data->local_value(0,0);
   const int_t end_id = all_data->local_value(0,1);
   const int_t num_ids = end_id - start_id + 1;
-  DEBUG_MSG("[PROC "<<proc_id <<"] Decomp::create_seed_dist_map(): owns neigbor id list elements " << start_id << " through " << end_id << " num ids " << num_ids);
+  DEBUG_MSG("[PROC "<<proc_id <<"] Decomp::distribute_ids_from_proc_zero(): owns id list elements " << start_id << " through " << end_id << " num ids " << num_ids);
 
-  // create the dist map for the neigh ids:
+  // create the dist map for the ids:
   Teuchos::Array<int_t> field_all_owned_ids(num_ids);
   for(int_t i=0;i<field_all_owned_ids.size();++i){
     field_all_owned_ids[i] = start_id + i;
   }
   Teuchos::RCP<MultiField_Map> field_all_map = Teuchos::rcp (new MultiField_Map(-1, field_all_owned_ids,0,*comm_));
   Teuchos::RCP<MultiField> field_all_data = Teuchos::rcp(new MultiField(field_all_map,1,true));
-  // import the neigh ids local to this processor:
+  // import the ids local to this processor:
   MultiField_Exporter field_exporter(*field_all_map,*field_zero_data->get_map());
   field_all_data->do_import(field_zero_data,field_exporter,INSERT);
   const int_t num_local_subsets = field_all_data->get_map()->get_num_local_elements();
-  for(int_t i=0;i<num_local_subsets;++i)
-    DEBUG_MSG("[PROC " << proc_id << "] Decomp::create_seed_dist_map(): proc has subset id " << field_all_data->local_value(i));
 
   // copy the ids in order
   this_proc_gid_order_ = std::vector<int_t>(num_local_subsets,-1);
   for(int_t i=0;i<num_local_subsets;++i)
     this_proc_gid_order_[i] = field_all_data->local_value(i);
 
-  std::vector<int_t> ordered_local_list(num_local_subsets);
-  for(int_t i=0;i<num_local_subsets;++i)
-    ordered_local_list[i] = field_all_data->local_value(i);
-
   // sort the vector so the map is not in execution order
+  std::vector<int_t> ordered_local_list = this_proc_gid_order_;
   std::sort(ordered_local_list.begin(),ordered_local_list.end());
-  Teuchos::ArrayView<const int_t> lids_grouped_by_roi(&ordered_local_list[0],num_local_subsets);
-  id_decomp_map_ = Teuchos::rcp(new MultiField_Map(num_global_subsets_,lids_grouped_by_roi,0,*comm_));
+  Teuchos::ArrayView<const int_t> local_gids(num_local_subsets>0 ? &ordered_local_list[0] : 0,num_local_subsets);
+  id_decomp_map_ = Teuchos::rcp(new MultiField_Map(num_global_subsets_,local_gids,0,*comm_));
 }
 
 void
@@ -863,6 +940,84 @@ Decomp::populate_coordinate_vectors(const std::string & image_file_name,
   num_global_subsets_ = all_data->local_value(0);
 }
 
+namespace {
+
+/// assign the points ids[begin,end) to the parts [first_part,first_part+num_parts) by recursive bisection
+void
+bisect_points(std::vector<int_t> & ids,
+  const size_t begin,
+  const size_t end,
+  const std::vector<scalar_t> & coords_x,
+  const std::vector<scalar_t> & coords_y,
+  const std::vector<scalar_t> & weights,
+  const int_t first_part,
+  const int_t num_parts,
+  std::vector<int_t> & parts){
+  if(begin==end) return;
+  if(num_parts==1){
+    for(size_t i=begin;i<end;++i)
+      parts[ids[i]] = first_part;
+    return;
+  }
+  // cut across the longer side of the bounding box
+  scalar_t min_x = coords_x[ids[begin]];
+  scalar_t max_x = min_x;
+  scalar_t min_y = coords_y[ids[begin]];
+  scalar_t max_y = min_y;
+  scalar_t total_weight = 0.0;
+  for(size_t i=begin;i<end;++i){
+    min_x = std::min(min_x,coords_x[ids[i]]);
+    max_x = std::max(max_x,coords_x[ids[i]]);
+    min_y = std::min(min_y,coords_y[ids[i]]);
+    max_y = std::max(max_y,coords_y[ids[i]]);
+    total_weight += weights[ids[i]];
+  }
+  const bool cut_x = max_x - min_x >= max_y - min_y;
+  const std::vector<scalar_t> & coords = cut_x ? coords_x : coords_y;
+  const std::vector<scalar_t> & other_coords = cut_x ? coords_y : coords_x;
+  // ties are broken by the other coordinate and the id so the result does not depend on the sort implementation
+  std::sort(ids.begin()+begin,ids.begin()+end,[&coords,&other_coords](const int_t a, const int_t b){
+    if(coords[a]!=coords[b]) return coords[a]<coords[b];
+    if(other_coords[a]!=other_coords[b]) return other_coords[a]<other_coords[b];
+    return a<b;
+  });
+  // the weight on each side is proportional to the number of parts on that side
+  const int_t left_parts = num_parts/2;
+  const scalar_t left_target = total_weight*left_parts/num_parts;
+  size_t split = begin;
+  scalar_t left_weight = 0.0;
+  while(split<end&&left_weight + 0.5*weights[ids[split]] < left_target){
+    left_weight += weights[ids[split]];
+    ++split;
+  }
+  // make sure there is at least one point for each part if there are enough points
+  if(end - begin >= (size_t)num_parts){
+    split = std::max(split,begin + left_parts);
+    split = std::min(split,end - (num_parts - left_parts));
+  }
+  bisect_points(ids,begin,split,coords_x,coords_y,weights,first_part,left_parts,parts);
+  bisect_points(ids,split,end,coords_x,coords_y,weights,first_part+left_parts,num_parts-left_parts,parts);
+}
+
+}
+
+DICE_LIB_DLL_EXPORT
+std::vector<int_t>
+recursive_coordinate_bisection(const std::vector<scalar_t> & coords_x,
+  const std::vector<scalar_t> & coords_y,
+  const std::vector<scalar_t> & weights,
+  const int_t num_parts){
+  TEUCHOS_TEST_FOR_EXCEPTION(num_parts<1,std::runtime_error,"Error, invalid number of parts: " << num_parts);
+  TEUCHOS_TEST_FOR_EXCEPTION(coords_y.size()!=coords_x.size()||weights.size()!=coords_x.size(),std::runtime_error,
+    "Error, the coordinates and weights must be the same size");
+  std::vector<int_t> parts(coords_x.size(),0);
+  std::vector<int_t> ids(coords_x.size(),0);
+  for(size_t i=0;i<ids.size();++i)
+    ids[i] = i;
+  bisect_points(ids,0,ids.size(),coords_x,coords_y,weights,0,num_parts,parts);
+  return parts;
+}
+
 DICE_LIB_DLL_EXPORT
 void
 create_regular_grid_of_correlation_points(std::vector<scalar_t> & correlation_points,
@@ -1087,8 +1242,8 @@ bool valid_correlation_point(const int_t x_coord,
   // only the centroid has to be inside the ROI
   if(coords.find(std::pair<int_t,int_t>(y_coord,x_coord))==coords.end()) return false;
 
-  static std::vector<int_t> corners_x(4);
-  static std::vector<int_t> corners_y(4);
+  std::vector<int_t> corners_x(4);
+  std::vector<int_t> corners_y(4);
   corners_x[0] = x_coord - subset_size/2;  corners_y[0] = y_coord - subset_size/2;
   corners_x[1] = corners_x[0]+subset_size; corners_y[1] = corners_y[0];
   corners_x[2] = corners_x[0]+subset_size; corners_y[2] = corners_y[0] + subset_size;
@@ -167,17 +167,37 @@ private:
     Teuchos::RCP<std::vector<int_t> > & neighbor_ids,
     Teuchos::RCP<std::map<int_t,std::vector<int_t> > > & obstructing_subset_ids);
 
+  /// split the subsets into spatially compact regions, one per processor, by recursive coordinate bisection
+  /// weighted by the number of pixels in each subset (replaces the evenly split map of contiguous ids)
+  /// \param subset_centroids_x x coordinates of all global points (only needed on processor 0)
+  /// \param subset_centroids_y y coordinates of all global points (only needed on processor 0)
+  void create_spatial_dist_map(const Teuchos::ArrayRCP<scalar_t> & subset_centroids_x,
+    const Teuchos::ArrayRCP<scalar_t> & subset_centroids_y);
+
+  /// returns the weight of each global subset for balancing the decomposition (the number of pixels for conformal
+  /// subsets, otherwise 1 since all square subsets are the same size)
+  std::vector<scalar_t> subset_weights()const;
+
+  /// distribute lists of subset ids from processor 0 and reset the one-to-one decomp map and the execution order
+  /// \param ids_on_each_proc (only used on processor 0) the ids for each processor in execution order
+  void distribute_ids_from_proc_zero(const std::vector<std::vector<int_t> > & ids_on_each_proc);
+
   /// redo the ordering and decomposition of points if there are obstructions involved
   /// \param obstructing_subset_ids map giving the obstructions for each subset
   void create_obstruction_dist_map( Teuchos::RCP<std::map<int_t,std::vector<int_t> > > & obstructing_subset_ids);
 
-  /// redo the ordering and decomposition to include seeds
+  /// redo the ordering and decomposition to include seeds (each chain of subsets that starts at a seed
+  /// stays on one processor, the chains are grouped spatially)
   /// \param neighbor_ids vector of neighbor ids for each global point
   /// \param obstructing_subset_ids used to make sure both obstructions and seeds aren's used together
   /// \param correlation_params correlation parameters from xml file
+  /// \param subset_centroids_x x coordinates of all global points (only needed on processor 0)
+  /// \param subset_centroids_y y coordinates of all global points (only needed on processor 0)
   void create_seed_dist_map(Teuchos::RCP<std::vector<int_t> > & neighbor_ids,
     Teuchos::RCP<std::map<int_t,std::vector<int_t> > > & obstructing_subset_ids,
-    const Teuchos::RCP<Teuchos::ParameterList> & correlation_params);
+    const Teuchos::RCP<Teuchos::ParameterList> & correlation_params,
+    const Teuchos::ArrayRCP<scalar_t> & subset_centroids_x,
+    const Teuchos::ArrayRCP<scalar_t> & subset_centroids_y);
 
   /// total number of points in the discretization
   int_t num_global_subsets_;
@@ -203,6 +223,21 @@ private:
   Teuchos::RCP<DICe::Subset_File_Info> subset_info_;
 };
 
+/// \brief Splits a set of weighted points into spatially compact parts by recursive coordinate bisection
+/// \param coords_x x coordinates of the points
+/// \param coords_y y coordinates of the points
+/// \param weights weight of each point (for example the number of pixels in a subset)
+/// \param num_parts the number of parts
+///
+/// Each bisection cuts the longer side of the bounding box of the points so that the weight on each side is
+/// proportional to the number of parts on that side. Returns the part id of each point. If there are fewer
+/// points than parts, some of the parts are empty.
+DICE_LIB_DLL_EXPORT
+std::vector<int_t> recursive_coordinate_bisection(const std::vector<scalar_t> & coords_x,
+  const std::vector<scalar_t> & coords_y,
+  const std::vector<scalar_t> & weights,
+  const int_t num_parts);
+
 // free functions to help with creating grids:
 /// \brief Creates a regular square grid of correlation points
 /// \param correlation_points Vector of global point coordinates
@@ -0,0 +1,164 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+#include <DICe_ImagePrefetcher.h>
+#include <DICe_ImageIO.h>
+
+#include <algorithm>
+
+namespace DICe {
+
+Image_Prefetcher::Image_Prefetcher(const std::vector<std::string> & file_names,
+  const int_t first_index,
+  const Teuchos::ParameterList & params,
+  const int_t queue_size):
+  file_names_(file_names),
+  next_index_(first_index),
+  next_queued_(first_index),
+  next_decode_(first_index),
+  queue_size_(queue_size),
+  decode_params_(params){
+  TEUCHOS_TEST_FOR_EXCEPTION(queue_size_<=0,std::runtime_error,"Error, the prefetch queue size must be greater than 0");
+  TEUCHOS_TEST_FOR_EXCEPTION(first_index<0,std::runtime_error,"Error, invalid first index for the image prefetcher");
+  // the filter and gradients are computed outside of the decode turn so that they can be done concurrently
+  gauss_filter_images_ = decode_params_.get<bool>(DICe::gauss_filter_images,false);
+  gauss_filter_mask_size_ = decode_params_.get<int>(DICe::gauss_filter_mask_size,7);
+  compute_gradients_ = decode_params_.get<bool>(DICe::compute_image_gradients,false);
+  decode_params_.set(DICe::gauss_filter_images,false);
+  decode_params_.set(DICe::compute_image_gradients,false);
+  // queued images must own their intensities since the cine buffer gets refilled while they wait
+  decode_params_.set(DICe::buffer_persistence_guaranteed,false);
+  DEBUG_MSG("Image_Prefetcher::Image_Prefetcher(): loading up to " << queue_size_ << " images ahead starting with " <<
+    (has_next() ? file_names_[first_index] : "(none)"));
+  // one worker per image in flight (the thread pool counts the calling thread as one of its threads)
+  thread_pool_ = Teuchos::rcp(new Thread_Pool(queue_size_+1));
+  fill_queue();
+}
+
+Image_Prefetcher::~Image_Prefetcher(){
+  // make sure the workers are done before the members they use go away
+  for(size_t i=0;i<queue_.size();++i)
+    if(queue_[i].valid()) queue_[i].wait();
+  thread_pool_ = Teuchos::null;
+}
+
+void
+Image_Prefetcher::fill_queue(){
+  while((int_t)queue_.size()<queue_size_&&next_queued_<(int_t)file_names_.size()){
+    const int_t index = next_queued_++;
+    DEBUG_MSG("Image_Prefetcher::fill_queue(): queuing image " << file_names_[index]);
+    queue_.push_back(thread_pool_->submit([this,index](){return load(index);}));
+  }
+}
+
+Teuchos::RCP<Image>
+Image_Prefetcher::next(){
+  TEUCHOS_TEST_FOR_EXCEPTION(!has_next()||queue_.empty(),std::runtime_error,"Error, no images left in the prefetch queue");
+  std::future<Teuchos::RCP<Image> > front = std::move(queue_.front());
+  queue_.pop_front();
+  next_index_++;
+  // keep the workers busy while the caller waits for this image
+  fill_queue();
+  return front.get();
+}
+
+Teuchos::RCP<Image>
+Image_Prefetcher::load(const int_t index){
+  const std::string & file_name = file_names_[index];
+  Teuchos::RCP<Image> image;
+  {
+    // wait for this image's turn to be decoded
+    std::unique_lock<std::mutex> lock(decode_mutex_);
+    decode_cv_.wait(lock,[this,index](){return next_decode_==index;});
+    try{
+      if(utils::image_file_type(file_name.c_str())==CINE)
+        update_cine_buffer(file_name);
+      Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList(decode_params_));
+      image = Teuchos::rcp(new Image(file_name.c_str(),params));
+    }
+    catch(...){
+      // hand the turn to the next image before reporting the error
+      next_decode_++;
+      lock.unlock();
+      decode_cv_.notify_all();
+      throw;
+    }
+    next_decode_++;
+  }
+  decode_cv_.notify_all();
+  if(gauss_filter_images_)
+    image->gauss_filter(gauss_filter_mask_size_);
+  if(compute_gradients_)
+    image->compute_gradients();
+  image->set_file_name(file_name);
+  DEBUG_MSG("Image_Prefetcher::load(): image " << file_name << " is ready");
+  return image;
+}
+
+void
+Image_Prefetcher::update_cine_buffer(const std::string & file_name){
+  int_t start_index = 0, end_index = -1;
+  bool is_avg = false;
+  utils::video_index(file_name.c_str(),start_index,end_index,is_avg);
+  if(is_avg) return; // averaged frames are read directly from the file
+  const std::string cine_file = utils::video_file_name(file_name.c_str());
+  std::map<std::string,std::pair<int_t,int_t> >::const_iterator it = cine_buffer_frames_.find(cine_file);
+  if(it!=cine_buffer_frames_.end()&&start_index>=it->second.first&&start_index<=it->second.second) return;
+  // buffer up to the last frame of this cine file that is part of the sequence
+  int_t last_frame = start_index;
+  for(int_t i=(int_t)file_names_.size()-1;i>=0;--i){
+    if(utils::image_file_type(file_names_[i].c_str())!=CINE) continue;
+    if(utils::video_file_name(file_names_[i].c_str())!=cine_file) continue;
+    int_t last_start = 0, last_end = -1;
+    bool last_is_avg = false;
+    utils::video_index(file_names_[i].c_str(),last_start,last_end,last_is_avg);
+    last_frame = std::max(last_frame,last_start);
+    break;
+  }
+  const int_t frame_count = std::min((int_t)CINE_BUFFER_NUM_FRAMES,last_frame-start_index+1);
+  const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type = decode_params_.get<bool>(DICe::convert_cine_to_8_bit,true) ?
+      hypercine::HyperCine::TO_8_BIT : hypercine::HyperCine::QUAD_10_TO_12;
+  DEBUG_MSG("Image_Prefetcher::update_cine_buffer(): reading cine buffer, frame id " << start_index << " count " << frame_count);
+  utils::cine_file_read_buffer(cine_file,conversion_type,start_index,frame_count);
+  cine_buffer_frames_[cine_file] = std::pair<int_t,int_t>(start_index,start_index+frame_count-1);
+}
+
+}// End DICe Namespace
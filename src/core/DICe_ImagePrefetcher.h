@@ -0,0 +1,160 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+#ifndef DICE_IMAGEPREFETCHER_H
+#define DICE_IMAGEPREFETCHER_H
+
+#include <DICe.h>
+#include <DICe_Image.h>
+#include <DICe_ThreadPool.h>
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_ParameterList.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*!
+ *  \namespace DICe
+ *  @{
+ */
+/// generic DICe classes and functions
+namespace DICe {
+
+/// \class DICe::Image_Prefetcher
+/// \brief Loads a sequence of images on background threads ahead of when they are needed
+///
+/// At most queue_size images are in flight (loading or loaded but not yet handed out) at any time,
+/// which bounds the extra memory to queue_size images. Decoding the files is done one image at a time
+/// in sequence order (the cine and video readers are shared singletons and read the frames sequentially),
+/// the gauss filter and the image gradients are then computed concurrently for the images in flight.
+/// The images are always full frames since the image extents of a frame depend on the solution of the
+/// previous frame. Images from cine files are deep copied out of the cine buffer so that refilling
+/// the buffer does not change images that are still queued.
+class DICE_LIB_DLL_EXPORT
+Image_Prefetcher{
+public:
+  /// \brief Constructor, starts loading the first images right away
+  /// \param file_names the list of image file names
+  /// \param first_index the index in file_names of the first image to load
+  /// \param params the image parameters (gauss filter, gradients, cine conversion, undistortion, etc.)
+  /// \param queue_size the maximum number of images loaded ahead
+  Image_Prefetcher(const std::vector<std::string> & file_names,
+    const int_t first_index,
+    const Teuchos::ParameterList & params,
+    const int_t queue_size);
+
+  /// Destructor, waits for the images in flight to finish loading
+  ~Image_Prefetcher();
+
+  /// no copies allowed
+  Image_Prefetcher(const Image_Prefetcher &) = delete;
+  /// no copies allowed
+  Image_Prefetcher & operator=(const Image_Prefetcher &) = delete;
+
+  /// \brief Returns the next image in the sequence, blocks until it has been loaded
+  ///
+  /// Exceptions thrown while loading the image are rethrown here
+  Teuchos::RCP<Image> next();
+
+  /// returns true if there are images left in the sequence
+  bool has_next()const{
+    return next_index_<(int_t)file_names_.size();
+  }
+
+  /// returns the maximum number of images loaded ahead
+  int_t queue_size()const{
+    return queue_size_;
+  }
+
+private:
+  /// queue loads until the queue is full or the end of the sequence is reached
+  void fill_queue();
+
+  /// load, filter and compute the gradients for one image (executed on a worker thread)
+  /// \param index the index of the file in file_names_
+  Teuchos::RCP<Image> load(const int_t index);
+
+  /// read the block of cine frames that contains the given frame into the cine buffer if needed
+  /// (called while holding the decode turn)
+  /// \param file_name the decorated cine file name
+  void update_cine_buffer(const std::string & file_name);
+
+  /// image file names
+  std::vector<std::string> file_names_;
+  /// index of the next image handed out by next()
+  int_t next_index_;
+  /// index of the next image to queue
+  int_t next_queued_;
+  /// index of the image whose turn it is to be decoded
+  int_t next_decode_;
+  /// maximum number of images in flight
+  int_t queue_size_;
+  /// true if the gauss filter should be applied
+  bool gauss_filter_images_;
+  /// mask size for the gauss filter
+  int_t gauss_filter_mask_size_;
+  /// true if the image gradients should be computed
+  bool compute_gradients_;
+  /// parameters used to decode the images (filtering and gradients are done separately)
+  Teuchos::ParameterList decode_params_;
+  /// range of frames [first,last] currently in the buffer of each cine file
+  std::map<std::string,std::pair<int_t,int_t> > cine_buffer_frames_;
+  /// images in flight, in sequence order
+  std::deque<std::future<Teuchos::RCP<Image> > > queue_;
+  /// guards next_decode_
+  std::mutex decode_mutex_;
+  /// signaled when next_decode_ changes
+  std::condition_variable decode_cv_;
+  /// worker threads that load the images
+  Teuchos::RCP<Thread_Pool> thread_pool_;
+};
+
+}// End DICe Namespace
+
+/*! @} End of Doxygen namespace*/
+
+#endif
@@ -49,10 +49,12 @@
 #include <Teuchos_LAPACK.hpp>
 #include <Teuchos_SerialDenseMatrix.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <math.h>
 #include <cassert>
+#include <mutex>
 
 #include <Teuchos_TimeMonitor.hpp>
 
@@ -303,7 +305,17 @@ void
 Phase_Correlation_Initializer::pre_execution_tasks(){
   assert(schema_->prev_img()!=Teuchos::null);
   assert(schema_->def_img()!=Teuchos::null);
-  DICe::phase_correlate_x_y(schema_->prev_img(),schema_->def_img(),phase_cor_u_x_,phase_cor_u_y_);
+  const int_t w = schema_->def_img()->width();
+  const int_t h = schema_->def_img()->height();
+  if(phase_correlator_==Teuchos::null||phase_correlator_->width()!=w||phase_correlator_->height()!=h){
+    DEBUG_MSG("Phase_Correlation_Initializer::pre_execution_tasks(): creating phase correlator for " << w << " x " << h << " images");
+    phase_correlator_ = Teuchos::rcp(new Phase_Correlator(w,h));
+  }
+  // the deformed image of the last frame is usually the previous image of this one,
+  // in that case its spectrum is already the reference
+  if(!phase_correlator_->reference_matches(*schema_->prev_img()))
+    phase_correlator_->set_reference(*schema_->prev_img());
+  phase_correlator_->correlate(*schema_->def_img(),phase_cor_u_x_,phase_cor_u_y_,0,0,true);
   DEBUG_MSG("Phase_Correlation_Initializer::pre_execution_tasks(): initial displacements ux: " << phase_cor_u_x_ << " uy: " << phase_cor_u_y_);
 }
 
@@ -355,38 +367,62 @@ Search_Initializer::initial_guess(const int_t subset_gid,
   scalar_t min_u = 0.0;
   scalar_t min_v = 0.0;
   scalar_t min_theta = 0.0;
-  // search in u, v, and theta
   DEBUG_MSG("Search ranges " << start_u << " to " << end_u << " " << start_v << " to " << end_v << " " << start_t << " to " << end_t);
-  for(scalar_t trial_v = start_v;trial_v<=end_v;trial_v+=step_size_u_){
-    for(scalar_t trial_u = start_u;trial_u<=end_u;trial_u+=step_size_v_){
-      for(scalar_t trial_t = start_t;trial_t<=end_t;trial_t+=step_size_theta_){
-        shape_function->insert_motion(trial_u,trial_v,trial_t);
-        subset_->initialize(schema_->def_img(),DEF_INTENSITIES,shape_function);
-        // assumes that the reference subset has already been initialized
-        scalar_t gamma = 100.0;
-        try{
-          gamma = subset_->gamma();
-          if(gamma<0.0) gamma = 4.0; // catch a failed gamma eval
-        }
-        catch(...){
-          gamma = 100.0;
-        }
-        //DEBUG_MSG("search pos " << trial_u << " " << trial_v << " " << trial_t << " gamma " << gamma);
-        if(gamma < min_gamma){
-          min_gamma = gamma;
-          min_u = trial_u;
-          min_v = trial_v;
-          min_theta = trial_t;
-        }
-        if(gamma < gamma_good_enough){
-          DEBUG_MSG("Found very small gamma: " << gamma << " skipping the rest of the search");
-          DEBUG_MSG("Search initialization values: u, " << min_u << " v, "
-            << min_v << " theta, " << min_theta);
-          return INITIALIZE_SUCCESSFUL;
-        }
-      } // theta loop
+  typedef std::pair<scalar_t,def_triad> scored_trial;
+  auto lower_score = [](const scored_trial & lhs, const scored_trial & rhs){return lhs.first < rhs.first;};
+  // rank the translations using a subsample of the pixels
+  const int_t coarse_stride = subset_->num_pixels() >= 400 ? 4 : 1;
+  const size_t num_translations_kept = 16;
+  std::vector<scored_trial> translations;
+  for(scalar_t trial_v = start_v;trial_v<=end_v;trial_v+=step_size_v_){
+    for(scalar_t trial_u = start_u;trial_u<=end_u;trial_u+=step_size_u_){
+      shape_function->insert_motion(trial_u,trial_v,orig_t);
+      const scalar_t score = nearest_pixel_gamma(shape_function,coarse_stride);
+      translations.push_back(scored_trial(score<0.0 ? 100.0 : score,def_triad(trial_u,trial_v,orig_t)));
     } // u loop
   } // v loop
+  const size_t num_translations = std::min(num_translations_kept,translations.size());
+  std::partial_sort(translations.begin(),translations.begin()+num_translations,translations.end(),lower_score);
+  // search in theta only around the best translations, using all the pixels
+  const size_t num_trials_kept = 8;
+  std::vector<scored_trial> trials;
+  for(size_t i=0;i<num_translations;++i){
+    for(scalar_t trial_t = start_t;trial_t<=end_t;trial_t+=step_size_theta_){
+      shape_function->insert_motion(translations[i].second.u_,translations[i].second.v_,trial_t);
+      const scalar_t score = nearest_pixel_gamma(shape_function,1);
+      trials.push_back(scored_trial(score<0.0 ? 100.0 : score,def_triad(translations[i].second.u_,translations[i].second.v_,trial_t)));
+    } // theta loop
+  }
+  const size_t num_trials = std::min(num_trials_kept,trials.size());
+  std::partial_sort(trials.begin(),trials.begin()+num_trials,trials.end(),lower_score);
+  // evaluate gamma for the best trials with the interpolated subset
+  for(size_t i=0;i<num_trials;++i){
+    const def_triad & trial = trials[i].second;
+    shape_function->insert_motion(trial.u_,trial.v_,trial.t_);
+    subset_->initialize(schema_->def_img(),DEF_INTENSITIES,shape_function);
+    // assumes that the reference subset has already been initialized
+    scalar_t gamma = 100.0;
+    try{
+      gamma = subset_->gamma();
+      if(gamma<0.0) gamma = 4.0; // catch a failed gamma eval
+    }
+    catch(...){
+      gamma = 100.0;
+    }
+    //DEBUG_MSG("search pos " << trial.u_ << " " << trial.v_ << " " << trial.t_ << " gamma " << gamma);
+    if(gamma < min_gamma){
+      min_gamma = gamma;
+      min_u = trial.u_;
+      min_v = trial.v_;
+      min_theta = trial.t_;
+    }
+    if(gamma < gamma_good_enough){
+      DEBUG_MSG("Found very small gamma: " << gamma << " skipping the rest of the search");
+      DEBUG_MSG("Search initialization values: u, " << min_u << " v, "
+        << min_v << " theta, " << min_theta);
+      return INITIALIZE_SUCCESSFUL;
+    }
+  }
   DEBUG_MSG("Search initialization values: " << min_u << " " << min_v << " " << min_theta << " gamma: " << min_gamma);
   shape_function->insert_motion(min_u,min_v,min_theta);
   if(min_gamma < 1.0)
@@ -395,6 +431,58 @@ Search_Initializer::initial_guess(const int_t subset_gid,
     return INITIALIZE_FAILED;
 };
 
+scalar_t
+Search_Initializer::nearest_pixel_gamma(Teuchos::RCP<Local_Shape_Function> shape_function,
+  const int_t stride){
+  const int_t num_pixels = subset_->num_pixels();
+  if(num_pixels<=0) return -1.0;
+  mapped_x_.resize(num_pixels);
+  mapped_y_.resize(num_pixels);
+  shape_function->batch_map(num_pixels,&subset_->x(0),&subset_->y(0),subset_->centroid_x(),subset_->centroid_y(),
+    &mapped_x_[0],&mapped_y_[0]);
+  const Image & def_img = *schema_->def_img();
+  const int_t offset_x = def_img.offset_x();
+  const int_t offset_y = def_img.offset_y();
+  const int_t w = def_img.width();
+  const int_t h = def_img.height();
+  sampled_ref_.clear();
+  sampled_def_.clear();
+  int_t num_sampled = 0;
+  for(int_t i=0;i<num_pixels;i+=stride){
+    if(!subset_->is_active(i)) continue;
+    num_sampled++;
+    const int_t px = (int_t)std::floor(mapped_x_[i] + 0.5) - offset_x;
+    const int_t py = (int_t)std::floor(mapped_y_[i] + 0.5) - offset_y;
+    if(px<0||px>=w||py<0||py>=h) continue;
+    sampled_ref_.push_back(subset_->ref_intensities(i));
+    sampled_def_.push_back(def_img(px,py));
+  }
+  // trials that push most of the subset out of the image are not scored
+  const int_t num_valid = sampled_ref_.size();
+  if(num_valid<2||2*num_valid<num_sampled) return -1.0;
+  scalar_t mean_ref = 0.0, mean_def = 0.0;
+  for(int_t i=0;i<num_valid;++i){
+    mean_ref += sampled_ref_[i];
+    mean_def += sampled_def_[i];
+  }
+  mean_ref /= num_valid;
+  mean_def /= num_valid;
+  scalar_t sum_ref = 0.0, sum_def = 0.0;
+  for(int_t i=0;i<num_valid;++i){
+    sum_ref += (sampled_ref_[i]-mean_ref)*(sampled_ref_[i]-mean_ref);
+    sum_def += (sampled_def_[i]-mean_def)*(sampled_def_[i]-mean_def);
+  }
+  sum_ref = std::sqrt(sum_ref);
+  sum_def = std::sqrt(sum_def);
+  if(sum_ref==0.0||sum_def==0.0) return -1.0;
+  scalar_t gamma = 0.0;
+  for(int_t i=0;i<num_valid;++i){
+    const scalar_t value = (sampled_def_[i]-mean_def)/sum_def - (sampled_ref_[i]-mean_ref)/sum_ref;
+    gamma += value*value;
+  }
+  return gamma;
+}
+
 Status_Flag
 Field_Value_Initializer::initial_guess(const int_t subset_gid,
   Teuchos::RCP<Local_Shape_Function> shape_function){
@@ -451,8 +539,12 @@ Feature_Matching_Initializer::pre_execution_tasks(){
   std::vector<scalar_t> left_y;
   std::vector<scalar_t> right_x;
   std::vector<scalar_t> right_y;
-  Teuchos::RCP<Teuchos::Time> match_time  = Teuchos::TimeMonitor::getNewCounter("match features");
   {
+    // the timer and the debug image written by match_features are shared, so the left and right
+    // schemas of a stereo analysis (which are correlated concurrently) take turns matching features
+    static std::mutex match_mutex;
+    std::lock_guard<std::mutex> match_lock(match_mutex);
+    Teuchos::RCP<Teuchos::Time> match_time  = Teuchos::TimeMonitor::getNewCounter("match features");
     Teuchos::TimeMonitor match_time_monitor(*match_time);
     const float tol = 0.005f;
     std::stringstream outname;
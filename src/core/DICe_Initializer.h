@@ -57,6 +57,7 @@
 #include <opencv2/opencv.hpp>
 
 #include <set>
+#include <vector>
 #include <cassert>
 
 
@@ -250,6 +251,8 @@ private:
   Teuchos::RCP<Point_Cloud_3D<scalar_t> > point_cloud_;
 };
 
+class Phase_Correlator;
+
 /// \class DICe::Phase_Correlation_Initializer
 /// \brief A class that computes the phase correlation of the
 /// whole image to get the initial values of displacement in x and y.
@@ -278,10 +281,17 @@ protected:
   scalar_t phase_cor_u_x_;
   /// phase correlation displacement y estimate from previous frame
   scalar_t phase_cor_u_y_;
+  /// keeps the FFT plans and the spectrum of the last deformed image between frames
+  Teuchos::RCP<Phase_Correlator> phase_correlator_;
 };
 
 /// \class DICe::Search_Initializer
 /// \brief A class that searches a nearby neighborhood for the subset
+///
+/// The trial motions are ranked coarse to fine before any subset is interpolated: first the translations
+/// are scored using a subsample of the subset pixels, then the rotations are scored around the best
+/// translations using all of the pixels. Both of these use the nearest deformed image pixel instead of
+/// interpolating. Only the best few trials are evaluated with a full subset initialization and gamma.
 class DICE_LIB_DLL_EXPORT
 Search_Initializer : public Initializer{
 public:
@@ -315,6 +325,13 @@ public:
     Teuchos::RCP<Local_Shape_Function> shape_function);
 
 protected:
+  /// \brief Returns the zero-normalized sum of squared differences between the reference subset intensities and
+  /// the nearest pixels of the deformed image (no interpolation), or -1.0 if the score could not be computed
+  /// \param shape_function the trial motion
+  /// \param stride only every stride-th subset pixel is used
+  scalar_t nearest_pixel_gamma(Teuchos::RCP<Local_Shape_Function> shape_function,
+    const int_t stride);
+
   /// pointer to a specific subset
   Teuchos::RCP<Subset> subset_;
   /// search step size in x and y
@@ -327,6 +344,14 @@ protected:
   scalar_t step_size_theta_;
   /// extent of search in theta
   scalar_t search_dim_theta_;
+  /// mapped pixel x coordinates used to score the trial motions
+  std::vector<scalar_t> mapped_x_;
+  /// mapped pixel y coordinates used to score the trial motions
+  std::vector<scalar_t> mapped_y_;
+  /// sampled reference intensities used to score the trial motions
+  std::vector<scalar_t> sampled_ref_;
+  /// sampled deformed intensities used to score the trial motions
+  std::vector<scalar_t> sampled_def_;
 };
 
 
@@ -45,11 +45,13 @@
 #include <DICe_ImageIO.h>
 #include <DICe_Schema.h>
 #include <DICe_Triangulation.h>
+#include <DICe_ThreadPool.h>
 #ifdef DICE_ENABLE_TRACKLIB
 #include <tracklib.h>
 #endif
 
 #include <fstream>
+#include <functional>
 
 #include <Teuchos_TimeMonitor.hpp>
 
@@ -59,6 +61,28 @@
 
 using namespace DICe;
 
+/// execute the tasks for the left and right cameras, concurrently if a thread pool is given
+/// (the right camera task runs on the pool while the calling thread executes the left camera task)
+void execute_left_and_right(const Teuchos::RCP<Thread_Pool> & pool,
+  const std::function<void()> & left_task,
+  const std::function<void()> & right_task){
+  if(pool==Teuchos::null){
+    left_task();
+    right_task();
+    return;
+  }
+  std::future<void> right_done = pool->submit([&right_task](){right_task();});
+  try{
+    left_task();
+  }
+  catch(...){
+    // the right task references the caller's state so it has to finish before unwinding
+    right_done.wait();
+    throw;
+  }
+  right_done.get();
+}
+
 int main(int argc, char *argv[]) {
   Teuchos::RCP<Teuchos::Time> total_time  = Teuchos::TimeMonitor::getNewCounter("## Total Time ##");
   Teuchos::RCP<Teuchos::Time> cross_time  = Teuchos::TimeMonitor::getNewCounter("Cross-correlation");
@@ -318,44 +342,78 @@ int main(int argc, char *argv[]) {
       // go ahead and set up the model coordinates field
       schema->execute_triangulation(triangulation,stereo_schema);
 
+      // optionally load, filter and compute gradients for the upcoming deformed images on background threads
+      // while the current frame is correlated
+      Teuchos::RCP<Image_Prefetcher> prefetcher = schema->def_image_prefetcher(image_files,1);
+      Teuchos::RCP<Image_Prefetcher> stereo_prefetcher;
+      if(is_stereo&&prefetcher!=Teuchos::null)
+        stereo_prefetcher = stereo_schema->def_image_prefetcher(stereo_image_files,1);
+      if(prefetcher!=Teuchos::null)
+        *outStream << "Loading up to " << prefetcher->queue_size() << " frames ahead on background threads" << std::endl;
+
+      // for stereo, the left and right images are loaded and correlated concurrently if more than one thread
+      // is available, the threads are split between the two schemas (not enabled for MPI builds since both
+      // schemas communicate over the same communicator)
+      Teuchos::RCP<Thread_Pool> stereo_pool;
+#if !DICE_MPI
+      if(is_stereo&&schema->num_threads()>1){
+        const int_t total_threads = schema->num_threads();
+        schema->set_num_threads(total_threads - total_threads/2);
+        stereo_schema->set_num_threads(total_threads/2);
+        stereo_pool = Teuchos::rcp(new Thread_Pool(2)); // one worker for the right camera, the left camera uses this thread
+        *outStream << "Left and right images will be correlated concurrently using " << schema->num_threads() << " and "
+            << stereo_schema->num_threads() << " threads" << std::endl;
+      }
+#endif
+
       // iterate through the images and perform the correlation:
       bool failed_step = false;
 
       for(int_t image_it=1;image_it<=num_frames;++image_it){
         *outStream << "Processing frame: " << image_it << " of " << num_frames << ", " << image_files[image_it] << std::endl;
-        if(schema->use_incremental_formulation()&&image_it>1){
-          schema->set_ref_image(schema->prev_img()); // prev image since def and prev get swapped after each frame
-        }
-        schema->update_extents();
-        schema->set_def_image(image_files[image_it]);
-        if(is_stereo){
-          if(stereo_schema->use_incremental_formulation()&&image_it>1){
-            stereo_schema->set_ref_image(stereo_schema->prev_img()); // prev image since def and prev get swapped after each frame
-          }
-          stereo_schema->update_extents();
-          stereo_schema->set_def_image(stereo_image_files[image_it]);
-          //if(stereo_schema->use_nonlinear_projection())
-          //  stereo_schema->project_right_image_into_left_frame(triangulation,false);
-        }
+        execute_left_and_right(stereo_pool,
+          [&](){
+            if(schema->use_incremental_formulation()&&image_it>1){
+              schema->set_ref_image(schema->prev_img()); // prev image since def and prev get swapped after each frame
+            }
+            schema->update_extents();
+            if(prefetcher!=Teuchos::null)
+              schema->set_def_image(prefetcher->next());
+            else
+              schema->set_def_image(image_files[image_it]);
+          },
+          [&](){
+            if(!is_stereo) return;
+            if(stereo_schema->use_incremental_formulation()&&image_it>1){
+              stereo_schema->set_ref_image(stereo_schema->prev_img()); // prev image since def and prev get swapped after each frame
+            }
+            stereo_schema->update_extents();
+            if(stereo_prefetcher!=Teuchos::null)
+              stereo_schema->set_def_image(stereo_prefetcher->next());
+            else
+              stereo_schema->set_def_image(stereo_image_files[image_it]);
+            //if(stereo_schema->use_nonlinear_projection())
+            //  stereo_schema->project_right_image_into_left_frame(triangulation,false);
+          });
         { // start the timer
           Teuchos::TimeMonitor corr_time_monitor(*corr_time);
-          int_t corr_error = schema->execute_correlation();
-          if(corr_error)
+          int_t corr_error = 0;
+          int_t stereo_corr_error = 0;
+          execute_left_and_right(stereo_pool,
+            [&](){corr_error = schema->execute_correlation();},
+            [&](){if(is_stereo) stereo_corr_error = stereo_schema->execute_correlation();});
+          if(corr_error||stereo_corr_error)
             failed_step = true;
-          if(is_stereo){
-            corr_error = stereo_schema->execute_correlation();
-            if(corr_error)
-              failed_step = true;
-          }
           schema->execute_triangulation(triangulation,stereo_schema);
           schema->execute_post_processors();
         }
         // write the output
         const bool no_text_output = input_params->get<bool>(DICe::no_text_output_files,false);
         const bool write_mat_output = input_params->get<bool>(DICe::write_mat_output_files,false);
+        const bool write_binary_output = input_params->get<bool>(DICe::write_binary_output_files,false);
         {
           Teuchos::TimeMonitor write_time_monitor(*write_time);
-          schema->write_output(output_folder,file_prefix,separate_output_file_for_each_subset,separate_header_file,no_text_output,write_mat_output);
+          schema->write_output(output_folder,file_prefix,separate_output_file_for_each_subset,separate_header_file,no_text_output,write_mat_output,write_binary_output);
           schema->post_execution_tasks();
           // print the timing data with or without verbose flag
           if(input_params->get<bool>(DICe::print_stats,false)){
@@ -366,13 +424,21 @@ int main(int argc, char *argv[]) {
           //}
           if(is_stereo){
             if(input_params->get<bool>(DICe::output_stereo_files,false)){
-              stereo_schema->write_output(output_folder,stereo_file_prefix,separate_output_file_for_each_subset,separate_header_file,no_text_output);
+              stereo_schema->write_output(output_folder,stereo_file_prefix,separate_output_file_for_each_subset,separate_header_file,no_text_output,false,write_binary_output);
             }
             stereo_schema->post_execution_tasks();
           }
         }
       } // image loop
 
+      // write any output still held in memory
+      {
+        Teuchos::TimeMonitor write_time_monitor(*write_time);
+        schema->flush_output();
+        if(is_stereo)
+          stereo_schema->flush_output();
+      }
+
       schema->write_stats(output_folder,file_prefix);
       if(is_stereo)
         stereo_schema->write_stats(output_folder,stereo_file_prefix);
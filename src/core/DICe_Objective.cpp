@@ -42,9 +42,8 @@
 #include <DICe_Objective.h>
 #include <DICe_ImageUtils.h>
 #include <DICe_Simplex.h>
-
-#include <Teuchos_LAPACK.hpp>
-#include <Teuchos_SerialDenseMatrix.hpp>
+#include <DICe_Matrix.h>
+#include <DICe_Tangent.h>
 
 #include <iostream>
 #include <iomanip>
@@ -57,6 +56,12 @@ using namespace field_enums;
 
 scalar_t
 Objective::gamma( Teuchos::RCP<Local_Shape_Function> shape_function) const {
+  return gamma(shape_function,schema_->normalize_gamma_with_active_pixels());
+}
+
+scalar_t
+Objective::gamma( Teuchos::RCP<Local_Shape_Function> shape_function,
+  const bool normalize_with_active_pixels) const {
   try{
     subset_->initialize(schema_->def_img(subset_->sub_image_id()),DEF_INTENSITIES,shape_function,schema_->interpolation_method());
   }
@@ -64,7 +69,7 @@ Objective::gamma( Teuchos::RCP<Local_Shape_Function> shape_function) const {
     return -1.0;
   }
   scalar_t gamma = subset_->gamma();
-  if(schema_->normalize_gamma_with_active_pixels()){
+  if(normalize_with_active_pixels){
     int_t num_active_pixels = 0;
     for(int_t i=0;i<subset_->num_pixels();++i)
       if(subset_->is_active(i)) num_active_pixels++;
@@ -79,9 +84,9 @@ scalar_t
 Objective::beta(Teuchos::RCP<Local_Shape_Function> shape_function) const {
   // for now return -1 for beta if affine shape functions are used
 
-  // for beta we don't want the gamma values normalized by the number of pixels:
-  const bool original_normalize_flag = schema_->normalize_gamma_with_active_pixels();
-  schema_->set_normalize_gamma_with_active_pixels(false);
+  // for beta we don't want the gamma values normalized by the number of pixels
+  // (the flag is passed explicitly rather than toggled on the schema so that subsets
+  // can be correlated concurrently)
   std::vector<scalar_t> epsilon(3);
   epsilon[0] = 1.0E-1;
   epsilon[1] = 1.0E-1;
@@ -91,7 +96,7 @@ Objective::beta(Teuchos::RCP<Local_Shape_Function> shape_function) const {
   factor[1] = 1.0E-3;
   factor[2] = 1.0E-1;
   scalar_t temp_u=0.0,temp_v=0.0,temp_t=0.0;
-  const scalar_t gamma_0 = gamma(shape_function);
+  const scalar_t gamma_0 = gamma(shape_function,false);
   std::vector<scalar_t> dir_beta(3,0.0);
   Teuchos::RCP<Local_Shape_Function> temp_lsf = shape_function_factory(schema_);
   for(size_t i=0;i<3;++i){
@@ -106,7 +111,7 @@ Objective::beta(Teuchos::RCP<Local_Shape_Function> shape_function) const {
       temp_t += epsilon[i];
     }
     temp_lsf->insert_motion(temp_u,temp_v,temp_t);
-    const scalar_t gamma_p = gamma(temp_lsf);
+    const scalar_t gamma_p = gamma(temp_lsf,false);
     if(i==0){
       temp_u -= 2*epsilon[i];
     }else if(i==1){
@@ -116,12 +121,10 @@ Objective::beta(Teuchos::RCP<Local_Shape_Function> shape_function) const {
     }
     temp_lsf->insert_motion(temp_u,temp_v,temp_t);
     // mod the def vector -
-    const scalar_t gamma_m = gamma(temp_lsf);
+    const scalar_t gamma_m = gamma(temp_lsf,false);
     if(std::abs(gamma_m - gamma_0)<1.0E-10||std::abs(gamma_p - gamma_0)<1.0E-10){
       // abort because the slope is so bad that beta is infinite
       DEBUG_MSG("Objective::beta(): return value -1.0");
-      // replace the correct normalization flag:
-      schema_->set_normalize_gamma_with_active_pixels(original_normalize_flag);
       // re-initialize the subset with the original deformation solution
       subset_->initialize(schema_->def_img(subset_->sub_image_id()),DEF_INTENSITIES,shape_function,schema_->interpolation_method());
       return -1.0;
@@ -139,9 +142,6 @@ Objective::beta(Teuchos::RCP<Local_Shape_Function> shape_function) const {
   mag_dir_beta = std::sqrt(mag_dir_beta);
   DEBUG_MSG("Objective::beta(): return value " << mag_dir_beta);
 
-  // replace the correct normalization flag:
-  schema_->set_normalize_gamma_with_active_pixels(original_normalize_flag);
-
   // re-initialize the subset with the original deformation solution
   subset_->initialize(schema_->def_img(subset_->sub_image_id()),DEF_INTENSITIES,shape_function,schema_->interpolation_method());
   return mag_dir_beta;
@@ -427,31 +427,81 @@ Objective_ZNSSD::gradient_norm(Teuchos::RCP<Local_Shape_Function> shape_function
   return std::sqrt(grad_q);
 }
 
+namespace {
+
+/// scratch vectors for the shape function calls in the Gauss-Newton iterations,
+/// one set per thread so that they are reused across subsets and iterations
+/// rather than allocated for every call to computeUpdateFast()
+struct Fast_Solve_Workspace{
+  /// the parameters from the previous iteration (to test for convergence)
+  std::vector<scalar_t> def_old;
+  /// the update to the parameters for this iteration
+  std::vector<scalar_t> def_update;
+  /// the update from the previous iteration (used for momentum)
+  std::vector<scalar_t> def_update_old;
+  /// size the vectors for N parameters and zero them (only allocates the first time a size is seen)
+  void reset(const size_t N){
+    def_old.assign(N,0.0);
+    def_update.assign(N,0.0);
+    def_update_old.assign(N,0.0);
+  }
+};
+
+Fast_Solve_Workspace &
+fast_solve_workspace(){
+  static thread_local Fast_Solve_Workspace workspace;
+  return workspace;
+}
+
+} // end anonymous namespace
+
 Status_Flag
 Objective_ZNSSD::computeUpdateFast(Teuchos::RCP<Local_Shape_Function> shape_function,
   int_t & num_iterations,
   const bool debug){
   TEUCHOS_TEST_FOR_EXCEPTION(!subset_->has_gradients(),std::runtime_error,"Error, image gradients have not been computed but are needed here.");
+  // dispatch to a tangent sized at compile time for the common shape functions:
+  // translation only (2), translation and rotation or the 3d projection (3), affine or
+  // 3d rigid body (6) and quadratic (12), other combinations are sized at run time
+  switch(shape_function->num_params()){
+  case 2: return gauss_newton_solve<2>(shape_function,num_iterations,debug);
+  case 3: return gauss_newton_solve<3>(shape_function,num_iterations,debug);
+  case 6: return gauss_newton_solve<6>(shape_function,num_iterations,debug);
+  case 12: return gauss_newton_solve<12>(shape_function,num_iterations,debug);
+  default: return gauss_newton_solve<0>(shape_function,num_iterations,debug);
+  }
+}
+
+template <size_t N_fixed>
+Status_Flag
+Objective_ZNSSD::gauss_newton_solve(Teuchos::RCP<Local_Shape_Function> shape_function,
+  int_t & num_iterations,
+  const bool debug){
   // TODO catch the case where the initial gamma is good enough (possibly do this at the image level, not subset?):
-  int_t N = shape_function->num_params(); // one degree of freedom for each shape function parameter
+  const int_t N = N_fixed > 0 ? (int_t)N_fixed : shape_function->num_params(); // one degree of freedom for each shape function parameter
   assert(N>=2);
-  scalar_t tolerance = schema_->fast_solver_tolerance();
+  assert(N==shape_function->num_params());
+  TEUCHOS_TEST_FOR_EXCEPTION(N>MAX_MATRIX_DIM,std::runtime_error,"Error, too many shape function parameters for the fast solver");
+  const scalar_t tolerance = schema_->fast_solver_tolerance();
   const int_t max_solve_its = schema_->max_solver_iterations_fast();
-  int *IPIV = new int[N+1];
-  int LWORK = N*N;
-  int INFO = 0;
-  // using type double here because LAPACK doesn't support float.
-  double *WORK = new double[LWORK];
-  Teuchos::LAPACK<int_t,double> lapack;
-
-  // Initialize storage:
-  Teuchos::SerialDenseMatrix<int_t,double> H(N,N, true);
-  Teuchos::ArrayRCP<double> q(N,0.0);
-  std::vector<scalar_t> residuals(N,0.0);
+
+  // Initialize storage (on the stack, using type double here for accuracy in the accumulation):
+  const size_t storage_dim = N_fixed > 0 ? N_fixed : MAX_MATRIX_DIM;
+  Matrix<double,storage_dim> H(N,N);
+  Matrix<double,storage_dim,1> q(N);
+  // blocks of packed active pixels
+  int_t block_x[DICE_TANGENT_BLOCK_SIZE];
+  int_t block_y[DICE_TANGENT_BLOCK_SIZE];
+  scalar_t block_gx[DICE_TANGENT_BLOCK_SIZE];
+  scalar_t block_gy[DICE_TANGENT_BLOCK_SIZE];
+  scalar_t block_gmf[DICE_TANGENT_BLOCK_SIZE];
+  scalar_t block_residuals[storage_dim*DICE_TANGENT_BLOCK_SIZE];
+  Fast_Solve_Workspace & workspace = fast_solve_workspace();
+  workspace.reset(N);
   //std::vector<scalar_t> high_order_terms(4,0.0);
-  std::vector<scalar_t> def_old(N,0.0);    // save off the previous value to test for convergence
-  std::vector<scalar_t> def_update(N,0.0); // save off the previous value to test for convergence
-  std::vector<scalar_t> def_update_old(N,0.0);
+  std::vector<scalar_t> & def_old = workspace.def_old;    // save off the previous value to test for convergence
+  std::vector<scalar_t> & def_update = workspace.def_update; // save off the previous value to test for convergence
+  std::vector<scalar_t> & def_update_old = workspace.def_update_old;
 
   // note this creates a pointer to the array so
   // the values are updated each frame if compute_grad_def_images is on
@@ -499,9 +549,6 @@ Objective_ZNSSD::computeUpdateFast(Teuchos::RCP<Local_Shape_Function> shape_func
       subset_->initialize(schema_->def_img(subset_->sub_image_id()),DEF_INTENSITIES,shape_function,schema_->interpolation_method());
     }
     catch (...) {
-      // clean up storage for lapack:
-      delete [] WORK;
-      delete [] IPIV;
       return SUBSET_CONSTRUCTION_FAILED;
     }
 
@@ -519,31 +566,35 @@ Objective_ZNSSD::computeUpdateFast(Teuchos::RCP<Local_Shape_Function> shape_func
     // the gradients are taken from the def images rather than the ref
     const bool use_ref_grads = schema_->def_img()->has_gradients() ? false : true;
 
-    scalar_t GmF = 0.0;
+    // the active pixels are packed into blocks (structure of arrays) so that the residuals are computed
+    // for the whole block by the shape function and the tangent accumulation vectorizes over the pixels
+    int_t block_size = 0;
+    auto accumulate_block = [&](){
+      shape_function->batch_residuals(block_size,block_x,block_y,cx,cy,block_gx,block_gy,block_residuals,DICE_TANGENT_BLOCK_SIZE,use_ref_grads);
+      accumulate_tangent<N_fixed>(N,block_size,block_residuals,DICE_TANGENT_BLOCK_SIZE,block_gmf,H.data(),q.data());
+      block_size = 0;
+    };
     for(int_t index=0;index<subset_->num_pixels();++index){
       if(subset_->is_deactivated_this_step(index)||!subset_->is_active(index)) continue;
-      GmF = (subset_->def_intensities(index) - meanG) - (subset_->ref_intensities(index) - meanF);
-      //GmF = (subset_->def_intensities(index) - meanG)/denomG - (subset_->ref_intensities(index) - meanF)/denomF;
-      for(int_t i=0;i<N;++i)
-        residuals[i] = 0.0;
-      //for(int_t i=0;i<4;++i)
-      //  high_order_terms[i] = 0.0;
-      shape_function->residuals(subset_->x(index),subset_->y(index),cx,cy,gradGx[index],gradGy[index],residuals,use_ref_grads);
-      //shape_function->high_order_terms(subset_->x(index),subset_->y(index),cx,cy,gradGx[index],gradGy[index],high_order_terms,use_ref_grads);
-      for(int_t i=0;i<N;++i){
-        q[i] += GmF*residuals[i];
-        for(int_t j=0;j<N;++j)
-          H(i,j) += residuals[i]*residuals[j];
-      }
-      // TODO needs test on the size of H (which shape functions are active?)
-      //H(2,2) += GmF * high_order_terms[0];
-      //H(2,3) += GmF * high_order_terms[1];
-      //H(2,4) += GmF * high_order_terms[2];
-      //H(2,5) += GmF * high_order_terms[3];
-      //H(3,2) += GmF * high_order_terms[1];
-      //H(4,2) += GmF * high_order_terms[2];
-      //H(5,2) += GmF * high_order_terms[3];
+      block_x[block_size] = subset_->x(index);
+      block_y[block_size] = subset_->y(index);
+      block_gx[block_size] = gradGx[index];
+      block_gy[block_size] = gradGy[index];
+      block_gmf[block_size] = (subset_->def_intensities(index) - meanG) - (subset_->ref_intensities(index) - meanF);
+      //block_gmf[block_size] = (subset_->def_intensities(index) - meanG)/denomG - (subset_->ref_intensities(index) - meanF)/denomF;
+      if(++block_size==DICE_TANGENT_BLOCK_SIZE) accumulate_block();
     }
+    if(block_size>0) accumulate_block();
+    // only the upper triangle was accumulated
+    tangent_fill_lower(N,H.data());
+    // TODO needs test on the size of H (which shape functions are active?)
+    //H(2,2) += GmF * high_order_terms[0];
+    //H(2,3) += GmF * high_order_terms[1];
+    //H(2,4) += GmF * high_order_terms[2];
+    //H(2,5) += GmF * high_order_terms[3];
+    //H(3,2) += GmF * high_order_terms[1];
+    //H(4,2) += GmF * high_order_terms[2];
+    //H(5,2) += GmF * high_order_terms[3];
 
     if(schema_->use_objective_regularization()){ // TODO test for affine shape functions too
       // add the penalty terms
@@ -563,48 +614,33 @@ Objective_ZNSSD::computeUpdateFast(Teuchos::RCP<Local_Shape_Function> shape_func
       cond_2x2 = norm_H * norm_Hi;
     }
 
-    // clear temp storage
-    for(int_t i=0;i<LWORK;++i) WORK[i] = 0.0;
-    for(int_t i=0;i<N+1;++i) {IPIV[i] = 0;}
-    try
-    {
-      lapack.GETRF(N,N,H.values(),N,IPIV,&INFO);
-      if(correlation_point_global_id_>=0)
-        schema_->global_field_value(correlation_point_global_id_,CONDITION_NUMBER_FS) = cond_2x2;
-      if(cond_2x2 > 1.0E12){
-        // clean up storage for lapack:
-        delete [] WORK;
-        delete [] IPIV;
-        return HESSIAN_SINGULAR;
-      }
-    }
-    catch(std::exception &e){
-      std::cout << e.what() << '\n';
-      // clean up storage for lapack:
-      delete [] WORK;
-      delete [] IPIV;
-      return LINEAR_SOLVE_FAILED;
-    }
-    for(int_t i=0;i<LWORK;++i) WORK[i] = 0.0;
-    try
-    {
-      lapack.GETRI(N,H.values(),N,IPIV,WORK,LWORK,&INFO);
-    }
-    catch(std::exception &e){
-      std::cout << e.what() << '\n';
-      // clean up storage for lapack:
-      delete [] WORK;
-      delete [] IPIV;
-      return LINEAR_SOLVE_FAILED;
+    if(correlation_point_global_id_>=0)
+      schema_->global_field_value(correlation_point_global_id_,CONDITION_NUMBER_FS) = cond_2x2;
+    if(cond_2x2 > 1.0E12){
+      return HESSIAN_SINGULAR;
     }
+
     // save off last step
     for(int_t i=0;i<N;++i)
       def_old[i] = (*shape_function)(i);
+
+#ifdef DICE_DEBUG_MSG
+    scalar_t grad_r = 0.0;
+    for(int_t r=0;r<N;++r)
+      grad_r += q(r)*q(r);
+    grad_r = std::sqrt(grad_r);
+#endif
+
+    // solve H * update = -q, H is symmetric positive semi-definite by construction so a Cholesky
+    // factorization is used rather than forming the inverse
     for(int_t i=0;i<N;++i)
-      def_update[i] = 0.0;
+      q(i) = -1.0*q(i);
+    if(!cholesky_solve(H,q)){
+      DEBUG_MSG("Subset " << correlation_point_global_id_ << " Hessian is not positive definite");
+      return HESSIAN_SINGULAR;
+    }
     for(int_t i=0;i<N;++i)
-      for(int_t j=0;j<N;++j)
-        def_update[i] += H(i,j)*(-1.0)*q[j];
+      def_update[i] = q(i);
 
     if(schema_->use_momentum()){
       const scalar_t momentum = schema_->momentum_factor();
@@ -617,10 +653,6 @@ Objective_ZNSSD::computeUpdateFast(Teuchos::RCP<Local_Shape_Function> shape_func
     shape_function->update(def_update);
 
 #ifdef DICE_DEBUG_MSG
-    scalar_t grad_r = 0.0;
-    for(int_t r=0;r<N;++r)
-      grad_r += q[r]*q[r];
-    grad_r = std::sqrt(grad_r);
     std::ios  state(NULL);
     state.copyfmt(std::cout);
     std::stringstream iteration_info;
@@ -641,15 +673,10 @@ Objective_ZNSSD::computeUpdateFast(Teuchos::RCP<Local_Shape_Function> shape_func
     }
 
     // zero out the storage
-    H.putScalar(0.0);
-    for(int_t i=0;i<N;++i)
-      q[i] = 0.0;
+    H.put_value(0.0);
+    q.put_value(0.0);
   } // end solve iteration loop
 
-  // clean up storage for lapack:
-  delete [] WORK;
-  delete [] IPIV;
-
   if(solve_it>max_solve_its){
     return MAX_ITERATIONS_REACHED;
   }
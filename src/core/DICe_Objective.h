@@ -131,6 +131,12 @@ const int_t y):
   /// \param shape_function pointer to the class that holds the deformation parameter values
   scalar_t gamma( Teuchos::RCP<Local_Shape_Function> shape_function) const;
 
+  /// \brief Correlation criteria with explicit control of the active pixel normalization
+  /// \param shape_function pointer to the class that holds the deformation parameter values
+  /// \param normalize_with_active_pixels true if gamma should be divided by the number of active pixels
+  scalar_t gamma( Teuchos::RCP<Local_Shape_Function> shape_function,
+    const bool normalize_with_active_pixels) const;
+
   /// \brief Uncertainty measure for solution
   /// \param shape_function [out] pointer to the class that holds the deformation parameter values
   /// \param noise_level [out] Returned as the standard deviation estimate of the image noise sigma_g from Sutton et.al.
@@ -285,6 +291,19 @@ public:
   /// See base class documentation
   using Objective::gradSampleMin2D;
 
+private:
+  /// \brief Gauss-Newton iterations behind computeUpdateFast() with the tangent sized at compile time
+  /// \param shape_function pointer to the class that holds the deformation parameter values
+  /// \param num_iterations [out] the number of iterations taken
+  /// \param debug true if the subset images should be written for each iteration
+  ///
+  /// The template parameter is the number of shape function parameters. If N is zero the number of
+  /// parameters is taken from the shape function at run time and MAX_MATRIX_DIM storage is used.
+  template <size_t N>
+  Status_Flag gauss_newton_solve(Teuchos::RCP<Local_Shape_Function> shape_function,
+    int_t & num_iterations,
+    const bool debug);
+
 };
 
 }// End DICe Namespace
@@ -138,6 +138,11 @@ const std::string to_string(Gradient_Method in){
   return gradientMethodStrings[in];
 }
 DICE_LIB_DLL_EXPORT
+const std::string to_string(Interpolation_Cache in){
+  assert(in < MAX_INTERPOLATION_CACHE);
+  return interpolationCacheStrings[in];
+}
+DICE_LIB_DLL_EXPORT
 const std::string to_string(Global_EQ_Term in){
   assert(in < NO_SUCH_GLOBAL_EQ_TERM);
   const static char * eqTermStrings[] = {
@@ -269,6 +274,17 @@ Gradient_Method string_to_gradient_method(std::string & in){
   return NO_SUCH_GRADIENT_METHOD; // prevent no return errors
 }
 DICE_LIB_DLL_EXPORT
+Interpolation_Cache string_to_interpolation_cache(std::string & in){
+  // convert the string to uppercase
+  stringToUpper(in);
+  for(int_t i=0;i<MAX_INTERPOLATION_CACHE;++i){
+    if(interpolationCacheStrings[i]==in) return static_cast<Interpolation_Cache>(i);
+  }
+  std::cout << "Error: Interpolation_Cache " << in << " does not exist." << std::endl;
+  TEUCHOS_TEST_FOR_EXCEPTION(true,std::invalid_argument,"");
+  return NO_SUCH_INTERPOLATION_CACHE; // prevent no return errors
+}
+DICE_LIB_DLL_EXPORT
 Shape_Function_Type string_to_shape_function_type(std::string & in){
   // convert the string to uppercase
   stringToUpper(in);
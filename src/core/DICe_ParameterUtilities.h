@@ -95,6 +95,10 @@ const std::string to_string(Interpolation_Method in);
 DICE_LIB_DLL_EXPORT
 const std::string to_string(Gradient_Method in);
 
+/// Convert a DICe::Interpolation_Cache to string
+DICE_LIB_DLL_EXPORT
+const std::string to_string(Interpolation_Cache in);
+
 /// Convert a DICe::Global_EQ_Term to string
 DICE_LIB_DLL_EXPORT
 const std::string to_string(Global_EQ_Term in);
@@ -131,6 +135,10 @@ Interpolation_Method string_to_interpolation_method(std::string & in);
 DICE_LIB_DLL_EXPORT
 Gradient_Method string_to_gradient_method(std::string & in);
 
+/// Convert a string to a DICe::Interpolation_Cache
+DICE_LIB_DLL_EXPORT
+Interpolation_Cache string_to_interpolation_cache(std::string & in);
+
 /// Convert a string to a DICe::Shape_Function_Type
 DICE_LIB_DLL_EXPORT
 Shape_Function_Type string_to_shape_function_type(std::string & in);
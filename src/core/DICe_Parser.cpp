@@ -393,6 +393,10 @@ Teuchos::RCP<Teuchos::ParameterList> read_correlation_params(const std::string &
         diceParams->set(DICe::gradient_method,DICe::string_to_gradient_method(
           stringParams->get<std::string>(it->first)));
       }
+      else if(paramName == DICe::interpolation_cache){
+        diceParams->set(DICe::interpolation_cache,DICe::string_to_interpolation_cache(
+          stringParams->get<std::string>(it->first)));
+      }
       else if(paramName == DICe::optimization_method){
         diceParams->set(DICe::optimization_method,DICe::string_to_optimization_method(
           stringParams->get<std::string>(it->first)));
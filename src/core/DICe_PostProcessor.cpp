@@ -49,6 +49,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <algorithm>
 #include <fstream>
 
 namespace DICe {
@@ -924,13 +925,88 @@ VSG_Strain_Post_Processor::pre_execution_tasks(){
     std::runtime_error,"Error: invalid field selections");
   TEUCHOS_TEST_FOR_EXCEPTION(coords_x_spec.get_rank()!=coords_y_spec.get_rank(),
     std::runtime_error,"Error: invalid field selections");
+  // the stencils depend on the neighbor geometry so they are recomputed for the new neighborhoods
+  stencil_neigh_valid_.assign(local_num_points_,std::vector<bool>());
+  stencil_weights_x_.assign(local_num_points_,std::vector<double>());
+  stencil_weights_y_.assign(local_num_points_,std::vector<double>());
+  stencil_singular_.assign(local_num_points_,0);
   DEBUG_MSG("VSG_Strain_Post_Processor pre_execution_tasks() end");
 }
 
+void
+VSG_Strain_Post_Processor::compute_stencil(const int_t subset,
+  const std::vector<bool> & neigh_valid){
+  const int_t num_neigh = neighbor_list_[subset].size();
+  stencil_neigh_valid_[subset] = neigh_valid;
+  stencil_weights_x_[subset].assign(num_neigh,0.0);
+  stencil_weights_y_[subset].assign(num_neigh,0.0);
+  stencil_singular_[subset] = 0;
+
+  // set up X^T*X for the fit u = a + b*dx + c*dy (symmetric so only the upper triangle is accumulated)
+  double sum_1 = 0.0, sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0, sum_yy = 0.0;
+  for(int_t j=0;j<num_neigh;++j){
+    if(!neigh_valid[j]) continue;
+    const double dx = neighbor_dist_x_[subset][j];
+    const double dy = neighbor_dist_y_[subset][j];
+    sum_1 += 1.0;
+    sum_x += dx;
+    sum_y += dy;
+    sum_xx += dx*dx;
+    sum_xy += dx*dy;
+    sum_yy += dy*dy;
+  }
+  const double X_t_X[3][3] = {{sum_1,sum_x,sum_y},{sum_x,sum_xx,sum_xy},{sum_y,sum_xy,sum_yy}};
+
+  // closed form inverse of the 3x3 system from the cofactors
+  double inv[3][3];
+  inv[0][0] = X_t_X[1][1]*X_t_X[2][2] - X_t_X[1][2]*X_t_X[2][1];
+  inv[0][1] = X_t_X[0][2]*X_t_X[2][1] - X_t_X[0][1]*X_t_X[2][2];
+  inv[0][2] = X_t_X[0][1]*X_t_X[1][2] - X_t_X[0][2]*X_t_X[1][1];
+  inv[1][0] = X_t_X[1][2]*X_t_X[2][0] - X_t_X[1][0]*X_t_X[2][2];
+  inv[1][1] = X_t_X[0][0]*X_t_X[2][2] - X_t_X[0][2]*X_t_X[2][0];
+  inv[1][2] = X_t_X[0][2]*X_t_X[1][0] - X_t_X[0][0]*X_t_X[1][2];
+  inv[2][0] = X_t_X[1][0]*X_t_X[2][1] - X_t_X[1][1]*X_t_X[2][0];
+  inv[2][1] = X_t_X[0][1]*X_t_X[2][0] - X_t_X[0][0]*X_t_X[2][1];
+  inv[2][2] = X_t_X[0][0]*X_t_X[1][1] - X_t_X[0][1]*X_t_X[1][0];
+  const double det = X_t_X[0][0]*inv[0][0] + X_t_X[0][1]*inv[1][0] + X_t_X[0][2]*inv[2][0];
+  if(det==0.0){
+    stencil_singular_[subset] = 1;
+    return;
+  }
+  for(int_t k=0;k<3;++k)
+    for(int_t m=0;m<3;++m)
+      inv[k][m] /= det;
+
+  // reciprocal condition number in the 1-norm
+  double anorm = 0.0;
+  double inv_norm = 0.0;
+  for(int_t m=0;m<3;++m){
+    anorm = std::max(anorm,std::abs(X_t_X[0][m])+std::abs(X_t_X[1][m])+std::abs(X_t_X[2][m]));
+    inv_norm = std::max(inv_norm,std::abs(inv[0][m])+std::abs(inv[1][m])+std::abs(inv[2][m]));
+  }
+  const double rcond = 1.0/(anorm*inv_norm);
+  DEBUG_MSG("Subset " << subset << " VSG X^T*X RCOND(H): "<< rcond);
+  if(rcond < 1.0E-12){
+    stencil_singular_[subset] = 1;
+    return;
+  }
+
+  // the gradient rows of (X^T*X)^-1*X^T
+  for(int_t j=0;j<num_neigh;++j){
+    if(!neigh_valid[j]) continue;
+    const double dx = neighbor_dist_x_[subset][j];
+    const double dy = neighbor_dist_y_[subset][j];
+    stencil_weights_x_[subset][j] = inv[1][0] + inv[1][1]*dx + inv[1][2]*dy;
+    stencil_weights_y_[subset][j] = inv[2][0] + inv[2][1]*dx + inv[2][2]*dy;
+  }
+}
+
 void
 VSG_Strain_Post_Processor::execute(Teuchos::RCP<Image> ref_img, Teuchos::RCP<Image> def_img){
   DEBUG_MSG("VSG_Strain_Post_Processor execute() begin");
   if(!neighborhood_initialized_) pre_execution_tasks();
+  TEUCHOS_TEST_FOR_EXCEPTION((int_t)stencil_singular_.size()!=local_num_points_,std::runtime_error,
+    "Error, the stencils have not been allocated");
 
   // gather an all owned fields here
   DICe::field_enums::Field_Spec disp_x_spec = mesh_->get_field_spec(disp_x_name_);
@@ -952,187 +1028,93 @@ VSG_Strain_Post_Processor::execute(Teuchos::RCP<Image> ref_img, Teuchos::RCP<Ima
   }
   // get the sigma field:
   Teuchos::RCP<MultiField> sigma = mesh_->get_overlap_field(DICe::field_enums::SIGMA_FS);
-  // get pointers to the local fields
-  Teuchos::RCP<DICe::MultiField> vsg_strain_xx_rcp = mesh_->get_field(DICe::field_enums::VSG_STRAIN_XX_FS);
-  Teuchos::RCP<DICe::MultiField> vsg_strain_yy_rcp = mesh_->get_field(DICe::field_enums::VSG_STRAIN_YY_FS);
-  Teuchos::RCP<DICe::MultiField> vsg_strain_xy_rcp = mesh_->get_field(DICe::field_enums::VSG_STRAIN_XY_FS);
-  Teuchos::RCP<DICe::MultiField> vsg_dudx_rcp = mesh_->get_field(DICe::field_enums::VSG_DUDX_FS);
-  Teuchos::RCP<DICe::MultiField> vsg_dudy_rcp = mesh_->get_field(DICe::field_enums::VSG_DUDY_FS);
-  Teuchos::RCP<DICe::MultiField> vsg_dvdx_rcp = mesh_->get_field(DICe::field_enums::VSG_DVDX_FS);
-  Teuchos::RCP<DICe::MultiField> vsg_dvdy_rcp = mesh_->get_field(DICe::field_enums::VSG_DVDY_FS);
-  Teuchos::RCP<DICe::MultiField> match = mesh_->get_field(DICe::field_enums::MATCH_FS);
-
-  const int_t N = 3;
-  int *IPIV = new int[N+1];
-  int LWORK = N*N;
-  int INFO = 0;
-  double *WORK = new double[LWORK];
-  double *GWORK = new double[10*N];
-  int *IWORK = new int[LWORK];
-  // Note, LAPACK does not allow templating on long int or scalar_t...must use int and double
-  Teuchos::LAPACK<int,double> lapack;
-
-  int_t num_neigh = 0;
-  std::vector<bool> neigh_valid;
-  int_t neigh_id = 0;
-  for(int_t subset=0;subset<local_num_points_;++subset){
-    DEBUG_MSG("Processing subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << ", " << subset + 1 << " of " << local_num_points_);
+  // resolve the local values up front, the subsets are processed in parallel so the loop only touches raw arrays
+  const precision_t * disp_values = disp->local_values();
+  const precision_t * sigma_values = sigma->local_values();
+  precision_t * vsg_strain_xx = mesh_->get_field(DICe::field_enums::VSG_STRAIN_XX_FS)->local_values();
+  precision_t * vsg_strain_yy = mesh_->get_field(DICe::field_enums::VSG_STRAIN_YY_FS)->local_values();
+  precision_t * vsg_strain_xy = mesh_->get_field(DICe::field_enums::VSG_STRAIN_XY_FS)->local_values();
+  precision_t * vsg_dudx = mesh_->get_field(DICe::field_enums::VSG_DUDX_FS)->local_values();
+  precision_t * vsg_dudy = mesh_->get_field(DICe::field_enums::VSG_DUDY_FS)->local_values();
+  precision_t * vsg_dvdx = mesh_->get_field(DICe::field_enums::VSG_DVDX_FS)->local_values();
+  precision_t * vsg_dvdy = mesh_->get_field(DICe::field_enums::VSG_DVDY_FS)->local_values();
+  precision_t * match = mesh_->get_field(DICe::field_enums::MATCH_FS)->local_values();
+
+  for_each_local_point([&](const int_t subset){
+    const int_t num_neigh = neighbor_list_[subset].size();
     // search the neighbors to see how many valid neighbors exist:
-    num_neigh = neighbor_list_[subset].size();
-    neigh_valid.resize(num_neigh);
+    std::vector<bool> neigh_valid(num_neigh,false);
     int_t num_valid_neigh = 0;
     for(int_t j=0;j<num_neigh;++j){
-      if(sigma->local_value(neighbor_list_[subset][j])>=0.0){
+      if(sigma_values[neighbor_list_[subset][j]]>=0.0){
         neigh_valid[j] = true;
         num_valid_neigh++;
-      }else{
-        neigh_valid[j] = false;
       }
     }
-    DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " num valid neighbors: " << num_valid_neigh);
-    if(num_valid_neigh < 3 || sigma->local_value(neighbor_list_[subset][0]) < 0.0){
-      vsg_dudx_rcp->local_value(subset) = 0.0;
-      vsg_dudy_rcp->local_value(subset) = 0.0;
-      vsg_dvdx_rcp->local_value(subset) = 0.0;
-      vsg_dvdy_rcp->local_value(subset) = 0.0;
-      vsg_strain_xx_rcp->local_value(subset) = 0.0;
-      vsg_strain_yy_rcp->local_value(subset) = 0.0;
-      vsg_strain_xy_rcp->local_value(subset) = 0.0;
+    if(num_valid_neigh < 3 || sigma_values[neighbor_list_[subset][0]] < 0.0){
+      vsg_dudx[subset] = 0.0;
+      vsg_dudy[subset] = 0.0;
+      vsg_dvdx[subset] = 0.0;
+      vsg_dvdy[subset] = 0.0;
+      vsg_strain_xx[subset] = 0.0;
+      vsg_strain_yy[subset] = 0.0;
+      vsg_strain_xy[subset] = 0.0;
       DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " failed subset (sigma=-1) or not enough neighbors to calculate VSG strain."
           " Setting all strain values to zero.");
-      match->local_value(subset) = -1;
-    }else{
-      Teuchos::ArrayRCP<double> u_x(num_valid_neigh,0.0);
-      Teuchos::ArrayRCP<double> u_y(num_valid_neigh,0.0);
-      Teuchos::ArrayRCP<double> X_t_u_x(N,0.0);
-      Teuchos::ArrayRCP<double> X_t_u_y(N,0.0);
-      Teuchos::ArrayRCP<double> coeffs_x(N,0.0);
-      Teuchos::ArrayRCP<double> coeffs_y(N,0.0);
-      Teuchos::SerialDenseMatrix<int_t,double> X_t(N,num_valid_neigh, true);
-      Teuchos::SerialDenseMatrix<int_t,double> X_t_X(N,N,true);
-
-      // gather the displacements of the neighbors
-      int_t valid_id = 0;
-      for(int_t j=0;j<num_neigh;++j){
-        if(!neigh_valid[j])continue;
-        neigh_id = neighbor_list_[subset][j];
-        assert(sigma->local_value(neigh_id)>=0.0);
-        u_x[valid_id] = disp->local_value(neigh_id*spa_dim+0);
-        u_y[valid_id] = disp->local_value(neigh_id*spa_dim+1);
-        // set up the X^T matrix
-        X_t(0,valid_id) = 1.0;
-        X_t(1,valid_id) = neighbor_dist_x_[subset][j];
-        X_t(2,valid_id) = neighbor_dist_y_[subset][j];
-        valid_id++;
-      }
-
-      // set up X^T*X
-      for(int_t k=0;k<N;++k){
-        for(int_t m=0;m<N;++m){
-          for(int_t j=0;j<num_valid_neigh;++j){
-            X_t_X(k,m) += X_t(k,j)*X_t(m,j);
-          }
-        }
-      }
-      //X_t_X.print(std::cout);
-
-      // Invert X^T*X
-      // TODO: remove for performance?
-      // compute the 1-norm of H:
-      std::vector<double> colTotals(X_t_X.numCols(),0.0);
-      for(int_t i=0;i<X_t_X.numCols();++i){
-        for(int_t j=0;j<X_t_X.numRows();++j){
-          colTotals[i]+=std::abs(X_t_X(j,i));
-        }
-      }
-      double anorm = 0.0;
-      for(int_t i=0;i<X_t_X.numCols();++i){
-        if(colTotals[i] > anorm) anorm = colTotals[i];
-      }
-      DEBUG_MSG("Subset " << subset << " anorm " << anorm);
-      double rcond=0.0; // reciporical condition number
-      try
-      {
-        lapack.GETRF(X_t_X.numRows(),X_t_X.numCols(),X_t_X.values(),X_t_X.numRows(),IPIV,&INFO);
-        lapack.GECON('1',X_t_X.numRows(),X_t_X.values(),X_t_X.numRows(),anorm,&rcond,GWORK,IWORK,&INFO);
-        DEBUG_MSG("Subset " << subset << " VSG X^T*X RCOND(H): "<< rcond);
-        if(rcond < 1.0E-12) {
-          vsg_dudx_rcp->local_value(subset) = 0.0;
-          vsg_dudy_rcp->local_value(subset) = 0.0;
-          vsg_dvdx_rcp->local_value(subset) = 0.0;
-          vsg_dvdy_rcp->local_value(subset) = 0.0;
-          vsg_strain_xx_rcp->local_value(subset) = 0.0;
-          vsg_strain_yy_rcp->local_value(subset) = 0.0;
-          vsg_strain_xy_rcp->local_value(subset) = 0.0;
-          DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " failed subset, the pseudo-inverse of the VSG strain calculation is (or is near) singular."
-              " Setting all strain values to zero.");
-          match->local_value(subset) = -1;
-          continue;
-          //std::cout << "Error: The pseudo-inverse of the VSG strain calculation is (or is near) singular." << std::endl;
-          //TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"");
-        }
-      }
-      catch(std::exception &e){
-        std::cout << e.what() << '\n';
-        std::cout << "Error: Something went wrong in the condition number calculation" << std::endl;
-        TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"");
-      }
-      try
-      {
-        lapack.GETRI(X_t_X.numRows(),X_t_X.values(),X_t_X.numRows(),IPIV,WORK,LWORK,&INFO);
-      }
-      catch(std::exception &e){
-        std::cout << e.what() << '\n';
-        std::cout << "Error: Something went wrong in the inverse calculation of X^T*X " << std::endl;
-      }
-
-      // compute X^T*u
-      for(int_t i=0;i<N;++i){
-        for(int_t j=0;j<num_valid_neigh;++j){
-          X_t_u_x[i] += X_t(i,j)*u_x[j];
-          X_t_u_y[i] += X_t(i,j)*u_y[j];
-        }
-      }
-
-      // compute the coeffs
-      for(int_t i=0;i<N;++i){
-        for(int_t j=0;j<N;++j){
-          coeffs_x[i] += X_t_X(i,j)*X_t_u_x[j];
-          coeffs_y[i] += X_t_X(i,j)*X_t_u_y[j];
-        }
-      }
+      match[subset] = -1;
+      return;
+    }
+    // the stencil only changes when a neighbor fails or recovers
+    if(neigh_valid!=stencil_neigh_valid_[subset])
+      compute_stencil(subset,neigh_valid);
+    if(stencil_singular_[subset]){
+      vsg_dudx[subset] = 0.0;
+      vsg_dudy[subset] = 0.0;
+      vsg_dvdx[subset] = 0.0;
+      vsg_dvdy[subset] = 0.0;
+      vsg_strain_xx[subset] = 0.0;
+      vsg_strain_yy[subset] = 0.0;
+      vsg_strain_xy[subset] = 0.0;
+      DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " failed subset, the pseudo-inverse of the VSG strain calculation is (or is near) singular."
+          " Setting all strain values to zero.");
+      match[subset] = -1;
+      return;
+    }
 
-      // update the field values
-      const double dudx = coeffs_x[1];
-      const double dudy = coeffs_x[2];
-      const double dvdx = coeffs_y[1];
-      const double dvdy = coeffs_y[2];
-      vsg_dudx_rcp->local_value(subset) = dudx;
-      vsg_dudy_rcp->local_value(subset) = dudy;
-      vsg_dvdx_rcp->local_value(subset) = dvdx;
-      vsg_dvdy_rcp->local_value(subset) = dvdy;
-
-      DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " dudx " << dudx << " dudy " << dudy <<
-        " dvdx " << dvdx << " dvdy " << dvdy);
-
-      // compute the Green-Lagrange strain based on the derivatives computed above:
-      const scalar_t GL_xx = 0.5*(2.0*dudx + dudx*dudx + dvdx*dvdx);
-      const scalar_t GL_yy = 0.5*(2.0*dvdy + dudy*dudy + dvdy*dvdy);
-      const scalar_t GL_xy = 0.5*(dudy + dvdx + dudx*dudy + dvdx*dvdy);
-      vsg_strain_xx_rcp->local_value(subset) = GL_xx;
-      vsg_strain_yy_rcp->local_value(subset) = GL_yy;
-      vsg_strain_xy_rcp->local_value(subset) = GL_xy;
-
-      DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " VSG Green-Lagrange strain XX: " << GL_xx << " YY: " << GL_yy <<
-        " XY: " << GL_xy);
-    } // end has enough valid neighbors to compute strain check
-
-  } // end subset loop
+    // apply the stencil to the neighbor displacements (the weights of invalid neighbors are zero)
+    const std::vector<double> & weights_x = stencil_weights_x_[subset];
+    const std::vector<double> & weights_y = stencil_weights_y_[subset];
+    double dudx = 0.0, dudy = 0.0, dvdx = 0.0, dvdy = 0.0;
+    for(int_t j=0;j<num_neigh;++j){
+      if(!neigh_valid[j]) continue;
+      const int_t neigh_id = neighbor_list_[subset][j];
+      const double u_x = disp_values[neigh_id*spa_dim+0];
+      const double u_y = disp_values[neigh_id*spa_dim+1];
+      dudx += weights_x[j]*u_x;
+      dudy += weights_y[j]*u_x;
+      dvdx += weights_x[j]*u_y;
+      dvdy += weights_y[j]*u_y;
+    }
+    vsg_dudx[subset] = dudx;
+    vsg_dudy[subset] = dudy;
+    vsg_dvdx[subset] = dvdx;
+    vsg_dvdy[subset] = dvdy;
+
+    DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " dudx " << dudx << " dudy " << dudy <<
+      " dvdx " << dvdx << " dvdy " << dvdy);
+
+    // compute the Green-Lagrange strain based on the derivatives computed above:
+    const scalar_t GL_xx = 0.5*(2.0*dudx + dudx*dudx + dvdx*dvdx);
+    const scalar_t GL_yy = 0.5*(2.0*dvdy + dudy*dudy + dvdy*dvdy);
+    const scalar_t GL_xy = 0.5*(dudy + dvdx + dudx*dudy + dvdx*dvdy);
+    vsg_strain_xx[subset] = GL_xx;
+    vsg_strain_yy[subset] = GL_yy;
+    vsg_strain_xy[subset] = GL_xy;
+
+    DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " VSG Green-Lagrange strain XX: " << GL_xx << " YY: " << GL_yy <<
+      " XY: " << GL_xy);
+  });
 
-  delete [] WORK;
-  delete [] GWORK;
-  delete [] IWORK;
-  delete [] IPIV;
   DEBUG_MSG("VSG_Strain_Post_Processor execute() end");
 }
 
@@ -1188,6 +1170,26 @@ NLVC_Strain_Post_Processor::pre_execution_tasks(){
     std::runtime_error,"Error: invalid field selections");
   TEUCHOS_TEST_FOR_EXCEPTION(coords_x_spec.get_rank()!=coords_y_spec.get_rank(),
     std::runtime_error,"Error: invalid field selections");
+  // the kernel only depends on the neighbor geometry so the weights are computed once here
+  kernel_weights_x_.assign(local_num_points_,std::vector<scalar_t>());
+  kernel_weights_y_.assign(local_num_points_,std::vector<scalar_t>());
+  scalar_t kx = 0.0;
+  scalar_t ky = 0.0;
+  for(int_t subset=0;subset<local_num_points_;++subset){
+    const int_t num_neigh = neighbor_dist_x_[subset].size();
+    // neighbor 0 is yourself
+    if(num_neigh < 2) continue;
+    const scalar_t nearest_neigh_dist = std::sqrt(neighbor_dist_x_[subset][1]*neighbor_dist_x_[subset][1] +
+      neighbor_dist_y_[subset][1]*neighbor_dist_y_[subset][1]);
+    const scalar_t patch_area = nearest_neigh_dist*nearest_neigh_dist;
+    kernel_weights_x_[subset].resize(num_neigh);
+    kernel_weights_y_[subset].resize(num_neigh);
+    for(int_t j=0;j<num_neigh;++j){
+      compute_kernel(neighbor_dist_x_[subset][j],neighbor_dist_y_[subset][j],kx,ky);
+      kernel_weights_x_[subset][j] = kx*patch_area;
+      kernel_weights_y_[subset][j] = ky*patch_area;
+    }
+  }
 }
 
 void
@@ -1195,8 +1197,8 @@ NLVC_Strain_Post_Processor::compute_kernel(const scalar_t & dx,
   const scalar_t & dy,
   scalar_t & kx,
   scalar_t & ky){
-  static scalar_t h = (scalar_t)horizon_*0.5;
-  static scalar_t s = h / 3.0;
+  const scalar_t h = (scalar_t)horizon_*0.5;
+  const scalar_t s = h / 3.0;
   const scalar_t r = std::sqrt(dx*dx+dy*dy);
   kx = s==0.0?0.0:1.0/(2*DICE_PI*s*s)*(-2*dx/(2*s*s))*exp(-(r*r/(2*s*s)));
   ky = s==0.0?0.0:1.0/(2*DICE_PI*s*s)*(-2*dy/(2*s*s))*exp(-(r*r/(2*s*s)));
@@ -1229,105 +1231,88 @@ NLVC_Strain_Post_Processor::execute(Teuchos::RCP<Image> ref_img, Teuchos::RCP<Im
   // get the sigma field:
   Teuchos::RCP<MultiField> sigma = mesh_->get_overlap_field(DICe::field_enums::SIGMA_FS);
   // get pointers to the local fields
-  Teuchos::RCP<DICe::MultiField> nlvc_strain_xx_rcp = mesh_->get_field(DICe::field_enums::NLVC_STRAIN_XX_FS);
-  Teuchos::RCP<DICe::MultiField> nlvc_strain_yy_rcp = mesh_->get_field(DICe::field_enums::NLVC_STRAIN_YY_FS);
-  Teuchos::RCP<DICe::MultiField> nlvc_strain_xy_rcp = mesh_->get_field(DICe::field_enums::NLVC_STRAIN_XY_FS);
-  Teuchos::RCP<DICe::MultiField> nlvc_dudx_rcp = mesh_->get_field(DICe::field_enums::NLVC_DUDX_FS);
-  Teuchos::RCP<DICe::MultiField> nlvc_dudy_rcp = mesh_->get_field(DICe::field_enums::NLVC_DUDY_FS);
-  Teuchos::RCP<DICe::MultiField> nlvc_dvdx_rcp = mesh_->get_field(DICe::field_enums::NLVC_DVDX_FS);
-  Teuchos::RCP<DICe::MultiField> nlvc_dvdy_rcp = mesh_->get_field(DICe::field_enums::NLVC_DVDY_FS);
-  Teuchos::RCP<DICe::MultiField> f9_rcp = mesh_->get_field(DICe::field_enums::FIELD_9_FS);
-  Teuchos::RCP<DICe::MultiField> f10_rcp = mesh_->get_field(DICe::field_enums::FIELD_10_FS);
-  Teuchos::RCP<DICe::MultiField> match = mesh_->get_field(DICe::field_enums::MATCH_FS);
-
-  std::vector<bool> neigh_valid;
-  for(int_t subset=0;subset<local_num_points_;++subset){
-    DEBUG_MSG("Processing subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << ", " << subset + 1 << " of " << local_num_points_);
-    scalar_t dudx = 0.0;
-    scalar_t dudy = 0.0;
-    scalar_t dvdx = 0.0;
-    scalar_t dvdy = 0.0;
-    scalar_t ux = 0.0;
-    scalar_t uy = 0.0;
-    scalar_t dx = 0.0;
-    scalar_t dy = 0.0;
-    scalar_t sum_int_x = 0.0;
-    scalar_t sum_int_y = 0.0;
-    scalar_t kx = 0.0;
-    scalar_t ky = 0.0;
-    int_t neigh_id = 0;
+  // resolve the local values up front, the points are processed in parallel so the loop only touches raw arrays
+  const precision_t * disp_values = disp->local_values();
+  const precision_t * sigma_values = sigma->local_values();
+  precision_t * nlvc_strain_xx = mesh_->get_field(DICe::field_enums::NLVC_STRAIN_XX_FS)->local_values();
+  precision_t * nlvc_strain_yy = mesh_->get_field(DICe::field_enums::NLVC_STRAIN_YY_FS)->local_values();
+  precision_t * nlvc_strain_xy = mesh_->get_field(DICe::field_enums::NLVC_STRAIN_XY_FS)->local_values();
+  precision_t * nlvc_dudx = mesh_->get_field(DICe::field_enums::NLVC_DUDX_FS)->local_values();
+  precision_t * nlvc_dudy = mesh_->get_field(DICe::field_enums::NLVC_DUDY_FS)->local_values();
+  precision_t * nlvc_dvdx = mesh_->get_field(DICe::field_enums::NLVC_DVDX_FS)->local_values();
+  precision_t * nlvc_dvdy = mesh_->get_field(DICe::field_enums::NLVC_DVDY_FS)->local_values();
+  precision_t * f9 = mesh_->get_field(DICe::field_enums::FIELD_9_FS)->local_values();
+  precision_t * f10 = mesh_->get_field(DICe::field_enums::FIELD_10_FS)->local_values();
+  precision_t * match = mesh_->get_field(DICe::field_enums::MATCH_FS)->local_values();
+  TEUCHOS_TEST_FOR_EXCEPTION((int_t)kernel_weights_x_.size()!=local_num_points_,std::runtime_error,
+    "Error, the kernel weights have not been computed");
+
+  for_each_local_point([&](const int_t subset){
     const int_t num_neigh = neighbor_dist_x_[subset].size();
-    neigh_valid.resize(num_neigh);
     int_t num_valid_neigh = 0;
     for(int_t j=0;j<num_neigh;++j){
-      if(sigma->local_value(neighbor_list_[subset][j])>=0.0){
-        neigh_valid[j] = true;
+      if(sigma_values[neighbor_list_[subset][j]]>=0.0)
         num_valid_neigh++;
-      }else{
-        neigh_valid[j] = false;
-      }
     }
-    DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " num valid neighbors: " << num_valid_neigh);
-    if(num_valid_neigh < 3 || sigma->local_value(neighbor_list_[subset][0])<0.0){
-      nlvc_dudx_rcp->local_value(subset) = 0.0;
-      nlvc_dudy_rcp->local_value(subset) = 0.0;
-      nlvc_dvdx_rcp->local_value(subset) = 0.0;
-      nlvc_dvdy_rcp->local_value(subset) = 0.0;
-      nlvc_strain_xx_rcp->local_value(subset) = 0.0;
-      nlvc_strain_yy_rcp->local_value(subset) = 0.0;
-      nlvc_strain_xy_rcp->local_value(subset) = 0.0;
+    if(num_valid_neigh < 3 || sigma_values[neighbor_list_[subset][0]]<0.0){
+      nlvc_dudx[subset] = 0.0;
+      nlvc_dudy[subset] = 0.0;
+      nlvc_dvdx[subset] = 0.0;
+      nlvc_dvdy[subset] = 0.0;
+      nlvc_strain_xx[subset] = 0.0;
+      nlvc_strain_yy[subset] = 0.0;
+      nlvc_strain_xy[subset] = 0.0;
       DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " failed subset (sigma=-1) or not enough neighbors to calculate NLVC strain."
           " Setting all strain values to zero.");
-      match->local_value(subset) = -1;
-    }else{
-      assert(neighbor_dist_x_[subset].size()>1);
-      assert(neighbor_dist_y_[subset].size()>1);
-      // neighbor 0 is yourself
-      const scalar_t nearest_neigh_dist = std::sqrt(neighbor_dist_x_[subset][1]*neighbor_dist_x_[subset][1] +
-        neighbor_dist_y_[subset][1]*neighbor_dist_y_[subset][1]);
-      const scalar_t patch_area = nearest_neigh_dist*nearest_neigh_dist;
-      for(int_t j=0;j<num_neigh;++j){
-        if(!neigh_valid[j]) continue;
-        neigh_id = neighbor_list_[subset][j];
-        assert(sigma->local_value(neigh_id)>=0.0);
-        ux = disp->local_value(neigh_id*spa_dim+0);
-        uy = disp->local_value(neigh_id*spa_dim+1);
-        dx = neighbor_dist_x_[subset][j];
-        dy = neighbor_dist_y_[subset][j];
-        compute_kernel(dx,dy,kx,ky);
-        sum_int_x += kx*patch_area;
-        sum_int_y += ky*patch_area;
-        dudx -= ux * kx*patch_area;
-        dudy -= ux * ky*patch_area;
-        dvdx -= uy * kx*patch_area;
-        dvdy -= uy * ky*patch_area;
-      } // neighbor loop
-      nlvc_dudx_rcp->local_value(subset) = dudx;
-      nlvc_dudy_rcp->local_value(subset) = dudy;
-      nlvc_dvdx_rcp->local_value(subset) = dvdx;
-      nlvc_dvdy_rcp->local_value(subset) = dvdy;
-      f9_rcp->local_value(subset) = sum_int_x;
-      f10_rcp->local_value(subset) = sum_int_y;
-
-      DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " dudx " << dudx << " dudy " << dudy <<
-        " dvdx " << dvdx << " dvdy " << dvdy);
-      DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " sum_int_x " << sum_int_x <<
-        " sum_int_y " << sum_int_y);
-
-      // compute the Green-Lagrange strain based on the derivatives computed above:
-      const scalar_t GL_xx = 0.5*(2.0*dudx + dudx*dudx + dvdx*dvdx);
-      const scalar_t GL_yy = 0.5*(2.0*dvdy + dudy*dudy + dvdy*dvdy);
-      const scalar_t GL_xy = 0.5*(dudy + dvdx + dudx*dudy + dvdx*dvdy);
-      nlvc_strain_xx_rcp->local_value(subset) = GL_xx;
-      nlvc_strain_yy_rcp->local_value(subset) = GL_yy;
-      nlvc_strain_xy_rcp->local_value(subset) = GL_xy;
-      if(sum_int_x > 0.01 || sum_int_y > 0.01 || sum_int_x < -0.01 || sum_int_y < -0.01){
-        match->local_value(subset) = -1;
-      }
-      DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " NLVC Green-Lagrange strain XX: " << GL_xx << " YY: " << GL_yy <<
-        " XY: " << GL_xy);
+      match[subset] = -1;
+      return;
+    }
+    assert((int_t)kernel_weights_x_[subset].size()==num_neigh);
+    const std::vector<scalar_t> & weights_x = kernel_weights_x_[subset];
+    const std::vector<scalar_t> & weights_y = kernel_weights_y_[subset];
+    scalar_t dudx = 0.0;
+    scalar_t dudy = 0.0;
+    scalar_t dvdx = 0.0;
+    scalar_t dvdy = 0.0;
+    scalar_t sum_int_x = 0.0;
+    scalar_t sum_int_y = 0.0;
+    for(int_t j=0;j<num_neigh;++j){
+      const int_t neigh_id = neighbor_list_[subset][j];
+      if(sigma_values[neigh_id]<0.0) continue;
+      const scalar_t ux = disp_values[neigh_id*spa_dim+0];
+      const scalar_t uy = disp_values[neigh_id*spa_dim+1];
+      sum_int_x += weights_x[j];
+      sum_int_y += weights_y[j];
+      dudx -= ux * weights_x[j];
+      dudy -= ux * weights_y[j];
+      dvdx -= uy * weights_x[j];
+      dvdy -= uy * weights_y[j];
+    } // neighbor loop
+    nlvc_dudx[subset] = dudx;
+    nlvc_dudy[subset] = dudy;
+    nlvc_dvdx[subset] = dvdx;
+    nlvc_dvdy[subset] = dvdy;
+    f9[subset] = sum_int_x;
+    f10[subset] = sum_int_y;
+
+    DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " dudx " << dudx << " dudy " << dudy <<
+      " dvdx " << dvdx << " dvdy " << dvdy);
+    DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " sum_int_x " << sum_int_x <<
+      " sum_int_y " << sum_int_y);
+
+    // compute the Green-Lagrange strain based on the derivatives computed above:
+    const scalar_t GL_xx = 0.5*(2.0*dudx + dudx*dudx + dvdx*dvdx);
+    const scalar_t GL_yy = 0.5*(2.0*dvdy + dudy*dudy + dvdy*dvdy);
+    const scalar_t GL_xy = 0.5*(dudy + dvdx + dudx*dudy + dvdx*dvdy);
+    nlvc_strain_xx[subset] = GL_xx;
+    nlvc_strain_yy[subset] = GL_yy;
+    nlvc_strain_xy[subset] = GL_xy;
+    if(sum_int_x > 0.01 || sum_int_y > 0.01 || sum_int_x < -0.01 || sum_int_y < -0.01){
+      match[subset] = -1;
     }
-  } // subset loop
+    DEBUG_MSG("Subset gid " << mesh_->get_scalar_node_dist_map()->get_global_element(subset) << " NLVC Green-Lagrange strain XX: " << GL_xx << " YY: " << GL_yy <<
+      " XY: " << GL_xy);
+  });
 
   DEBUG_MSG("NLVC_Strain_Post_Processor execute() end");
 }
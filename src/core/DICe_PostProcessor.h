@@ -46,6 +46,7 @@
 #include <DICe_Mesh.h>
 #include <DICe_PointCloud.h>
 #include <DICe_Triangulation.h>
+#include <DICe_ThreadPool.h>
 
 #include <Teuchos_ParameterList.hpp>
 
@@ -173,6 +174,12 @@ public:
     current_frame_id_ = frame_id;
   }
 
+  /// \brief set the thread pool used to process the points in parallel
+  /// \param thread_pool the pool (null to process the points serially)
+  void set_thread_pool(const Teuchos::RCP<Thread_Pool> & thread_pool){
+    thread_pool_ = thread_pool;
+  }
+
   /// Execute the post processor
   virtual void execute(Teuchos::RCP<Image> ref_img, Teuchos::RCP<Image> def_img)=0;
 
@@ -182,6 +189,18 @@ public:
   }
 
 protected:
+  /// \brief call func(point) for each local point, in parallel if a thread pool has been set
+  /// \param func callable with signature void(const int_t point), must only write the values of its own point
+  template <typename F>
+  void for_each_local_point(const F & func){
+    if(thread_pool_!=Teuchos::null&&thread_pool_->num_threads()>1){
+      thread_pool_->parallel_for(0,local_num_points_,[&](const int_t point, const int_t){func(point);},16);
+    }else{
+      for(int_t point=0;point<local_num_points_;++point)
+        func(point);
+    }
+  }
+
   /// Pointer to the mesh to access fields and discretization
   Teuchos::RCP<DICe::mesh::Mesh> mesh_;
   /// String name of this post processor
@@ -214,6 +233,8 @@ protected:
   bool has_custom_field_names_;
   /// store the current frame number for output if needed
   int current_frame_id_;
+  /// thread pool used to process the points (null if the points are processed serially)
+  Teuchos::RCP<Thread_Pool> thread_pool_;
 };
 
 /// \class DICe::VSG_Strain_Post_Processor
@@ -259,8 +280,25 @@ public:
   using Post_Processor::field_specs;
 
 private:
+  /// \brief compute the least squares stencil of a subset for the given set of valid neighbors
+  /// \param subset the local id of the subset
+  /// \param neigh_valid flag for each neighbor, true if the neighbor is included in the fit
+  ///
+  /// The stencil weights applied to the neighbor displacements give the x and y derivatives of the
+  /// fitted plane, i.e. they are the gradient rows of the pseudo-inverse (X^T*X)^-1*X^T
+  void compute_stencil(const int_t subset,
+    const std::vector<bool> & neigh_valid);
+
   /// Window size for the virtual strain gauge (in pixels)
   int_t window_size_;
+  /// valid neighbor flags the stencil of each subset was computed for (empty if not computed yet)
+  std::vector<std::vector<bool> > stencil_neigh_valid_;
+  /// weights for each neighbor that give the x derivative of the displacement
+  std::vector<std::vector<double> > stencil_weights_x_;
+  /// weights for each neighbor that give the y derivative of the displacement
+  std::vector<std::vector<double> > stencil_weights_y_;
+  /// 1 if the least squares system of the subset's stencil is (or is near) singular
+  std::vector<char> stencil_singular_;
 };
 
 /// \class DICe::Distortion_Correction_Post_Processor
@@ -353,6 +391,10 @@ public:
 private:
   /// Neighborhood diameter (circular distance around the point of interest where the interaction is non-negligible)
   int_t horizon_;
+  /// kernel value in x times the patch area for each neighbor of each point (fixed by the neighbor geometry)
+  std::vector<std::vector<scalar_t> > kernel_weights_x_;
+  /// kernel value in y times the patch area for each neighbor of each point
+  std::vector<std::vector<scalar_t> > kernel_weights_y_;
 };
 
 /// \class DICe::Altitude_Post_Processor
@@ -69,7 +69,9 @@
 #include <math.h>
 
 #include <cassert>
+#include <cstring>
 #include <set>
+#include <mutex>
 
 namespace DICe {
 
@@ -182,18 +184,8 @@ Schema::set_def_image(const std::string & defName){
 //  swap_def_prev_images();
   assert(def_imgs_.size()>0);
   Teuchos::RCP<Teuchos::ParameterList> imgParams = Teuchos::rcp(new Teuchos::ParameterList());
-  imgParams->set(DICe::compute_image_gradients,compute_def_gradients_);
-  imgParams->set(DICe::gauss_filter_images,gauss_filter_images_);
-  imgParams->set(DICe::gauss_filter_mask_size,gauss_filter_mask_size_);
-  imgParams->set(DICe::gradient_method,gradient_method_);
-  imgParams->set(DICe::filter_failed_cine_pixels,filter_failed_cine_pixels_);
-  imgParams->set(DICe::convert_cine_to_8_bit,convert_cine_to_8_bit_);
+  def_image_params(*imgParams);
   imgParams->set(DICe::buffer_persistence_guaranteed,true);
-  if(init_params_!=Teuchos::null){
-    if(init_params_->isSublist(undistort_images)){
-      imgParams->set(undistort_images,init_params_->sublist(undistort_images));
-    }
-  }
   const bool has_motion_window = motion_window_params_->size()>0;
   DEBUG_MSG("Schema::set_def_image(): has motion window " << has_motion_window);
 
@@ -215,43 +207,104 @@ Schema::set_def_image(const std::string & defName){
   }
 
   // if the image is from a cine file, load a large chunk of frames into the memory buffer
-  const int_t num_buffer_frames = !has_extents_ || has_motion_window ? CINE_BUFFER_NUM_FRAMES : 1; // the extents update after each frame so can only put one frame in the buffer
-  if((frame_id_-first_frame_id_)%num_buffer_frames==0){
-    if(DICe::utils::image_file_type(defName.c_str())==CINE){
-      std::string undecorated_cine_file = DICe::utils::video_file_name(defName.c_str());
-      // test if this is a cross-correlation (if so, don't use a buffer since only one frame is needed)
-      // if it is a cross-correlation setting the def image, the ref and def images will come from different files
-      // hence the check below on the cine file name
-      assert(ref_img_!=Teuchos::null);
-      std::string undecorated_ref_cine_file = DICe::utils::video_file_name(ref_img_->file_name().c_str());
-      if(undecorated_cine_file==undecorated_ref_cine_file){ // assumes ref image has already been set
-        // check if the window params are already set and just the frame needs to be updated
-        const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type = convert_cine_to_8_bit_ ? hypercine::HyperCine::TO_8_BIT :
-            hypercine::HyperCine::QUAD_10_TO_12;
-        // get last frame of cine file:
-        const int_t frame_count = frame_id_ + num_buffer_frames >= first_frame_id_ + num_frames_ ?
-            first_frame_id_+num_frames_-frame_id_ : num_buffer_frames;
-        DEBUG_MSG("Schema::set_def_image(): *** reading cine buffer, frame id " << frame_id_ << " count " << frame_count);
-        if((frame_id_-first_frame_id_==0&&has_motion_window)||has_extents_){
-          hypercine::HyperCine::HyperFrame hf(frame_id_,frame_count);
-          if(has_motion_window){
-            for(std::map<int_t,Motion_Window_Params>::iterator it=motion_window_params_->begin();it!=motion_window_params_->end();++it){
-              hf.add_window(it->second.start_x_,
-                it->second.end_x_-it->second.start_x_,
-                it->second.start_y_,
-                it->second.end_y_ - it->second.start_y_);
+  const int_t num_buffer_frames = !has_extents_ || has_motion_window ? cine_buffer_num_frames_ : 1; // the extents update after each frame so can only put one frame in the buffer
+  if(DICe::utils::image_file_type(defName.c_str())==CINE){
+    std::string undecorated_cine_file = DICe::utils::video_file_name(defName.c_str());
+    // test if this is a cross-correlation (if so, don't use a buffer since only one frame is needed)
+    // if it is a cross-correlation setting the def image, the ref and def images will come from different files
+    // hence the check below on the cine file name
+    assert(ref_img_!=Teuchos::null);
+    std::string undecorated_ref_cine_file = DICe::utils::video_file_name(ref_img_->file_name().c_str());
+    if(undecorated_cine_file==undecorated_ref_cine_file){ // assumes ref image has already been set
+      const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type = convert_cine_to_8_bit_ ? hypercine::HyperCine::TO_8_BIT :
+          hypercine::HyperCine::QUAD_10_TO_12;
+      const int_t frame_in_buffer = (frame_id_-first_frame_id_)%num_buffer_frames;
+      if(frame_in_buffer==0){
+        // use the buffer that was read ahead in the background if it has the frames and windows needed
+        bool used_read_ahead = false;
+        std::vector<utils::Cine_Window> read_ahead_windows;
+        if(DICe::utils::cine_file_read_ahead_ready(undecorated_cine_file,conversion_type,frame_id_,read_ahead_windows)){
+          if(has_extents_&&!has_motion_window){
+            // the read ahead window was predicted from the previous extents, it is used
+            // as the sub image (instead of the extents) if it covers the current extents
+            if(read_ahead_windows.size()==1&&
+                read_ahead_windows[0].x<=offset_x&&read_ahead_windows[0].x+read_ahead_windows[0].width>=offset_x+sub_width&&
+                read_ahead_windows[0].y<=offset_y&&read_ahead_windows[0].y+read_ahead_windows[0].height>=offset_y+sub_height){
+              offset_x = read_ahead_windows[0].x;
+              offset_y = read_ahead_windows[0].y;
+              sub_width = read_ahead_windows[0].width;
+              sub_height = read_ahead_windows[0].height;
+              end_x = offset_x + sub_width;
+              end_y = offset_y + sub_height;
+              used_read_ahead = true;
             }
           }else{
-            hf.add_window(offset_x,sub_width,offset_y,sub_height);
+            // full frames and motion windows do not change from one buffer to the next
+            used_read_ahead = true;
+          }
+          if(used_read_ahead){
+            DEBUG_MSG("Schema::set_def_image(): *** using cine buffer read ahead, frame id " << frame_id_);
+            DICe::utils::cine_file_swap_read_ahead(undecorated_cine_file,conversion_type);
           }
-          DICe::utils::cine_file_read_buffer(undecorated_cine_file,conversion_type,hf);
-        }else{
-          DICe::utils::cine_file_read_buffer(undecorated_cine_file,conversion_type,frame_id_,frame_count);
         }
-      }else{
-        DEBUG_MSG("Schema::set_def_image(): skipping reading cine buffer since the ref and def images come from different cine files (likely cross-correlation)");
+        if(!used_read_ahead){
+          // get last frame of cine file:
+          const int_t frame_count = frame_id_ + num_buffer_frames >= first_frame_id_ + num_frames_ ?
+              first_frame_id_+num_frames_-frame_id_ : num_buffer_frames;
+          DEBUG_MSG("Schema::set_def_image(): *** reading cine buffer, frame id " << frame_id_ << " count " << frame_count);
+          if(has_motion_window||has_extents_){
+            hypercine::HyperCine::HyperFrame hf(frame_id_,frame_count);
+            if(has_motion_window){
+              for(std::map<int_t,Motion_Window_Params>::iterator it=motion_window_params_->begin();it!=motion_window_params_->end();++it){
+                hf.add_window(it->second.start_x_,
+                  it->second.end_x_-it->second.start_x_,
+                  it->second.start_y_,
+                  it->second.end_y_ - it->second.start_y_);
+              }
+            }else{
+              hf.add_window(offset_x,sub_width,offset_y,sub_height);
+            }
+            DICe::utils::cine_file_read_buffer(undecorated_cine_file,conversion_type,hf);
+          }else{
+            DICe::utils::cine_file_read_buffer(undecorated_cine_file,conversion_type,frame_id_,frame_count);
+          }
+        }
+      }
+      // start reading the next buffer on the I/O thread. For multi-frame buffers this waits until the second
+      // frame of the current buffer so that the previous image no longer points into the buffer being refilled.
+      // Single frame buffers (extents) are refilled right away, so the images are copied out of the buffer.
+      if(num_buffer_frames==1)
         imgParams->set(DICe::buffer_persistence_guaranteed,false);
+      if(frame_in_buffer==(num_buffer_frames>1?1:0)){
+        const int_t next_frame = frame_id_ - frame_in_buffer + num_buffer_frames;
+        if(next_frame<first_frame_id_+num_frames_){
+          const int_t next_count = std::min(num_buffer_frames,first_frame_id_+num_frames_-next_frame);
+          std::vector<utils::Cine_Window> windows;
+          if(has_motion_window){
+            for(std::map<int_t,Motion_Window_Params>::iterator it=motion_window_params_->begin();it!=motion_window_params_->end();++it){
+              utils::Cine_Window window;
+              window.x = it->second.start_x_;
+              window.width = it->second.end_x_-it->second.start_x_;
+              window.y = it->second.start_y_;
+              window.height = it->second.end_y_ - it->second.start_y_;
+              windows.push_back(window);
+            }
+          }else if(has_extents_){
+            // predict the next extents as the current ones plus a margin for the motion between frames
+            const int_t margin = 50;
+            utils::Cine_Window window;
+            window.x = std::max(offset_x - margin,(int_t)0);
+            window.y = std::max(offset_y - margin,(int_t)0);
+            window.width = std::min(offset_x + sub_width + margin,w) - window.x;
+            window.height = std::min(offset_y + sub_height + margin,h) - window.y;
+            windows.push_back(window);
+          }
+          DICe::utils::cine_file_read_ahead(undecorated_cine_file,conversion_type,next_frame,next_count,windows);
+        }
       }
+    }else{
+      DEBUG_MSG("Schema::set_def_image(): skipping reading cine buffer since the ref and def images come from different cine files (likely cross-correlation)");
+      imgParams->set(DICe::buffer_persistence_guaranteed,false);
     }
   }
 
@@ -299,9 +352,79 @@ Schema::set_def_image(const std::string & defName){
       def_imgs_[id] = def_imgs_[id]->apply_rotation(def_image_rotation_);
     }
     def_imgs_[id]->set_file_name(defName);
+    cache_def_image_interpolation_coefficients(id);
+  }
+}
+
+void
+Schema::set_num_threads(const int_t num_threads){
+  TEUCHOS_TEST_FOR_EXCEPTION(num_threads<0,std::runtime_error,"Error, num_threads must be 0 (use all hardware threads) or greater");
+  num_threads_ = num_threads==0 ? Thread_Pool::hardware_threads() : num_threads;
+#ifndef HAVE_TEUCHOS_THREAD_SAFE
+  // Teuchos::RCP reference counts are only atomic if Trilinos was built with thread safety enabled
+  if(num_threads_>1){
+    if(comm_->get_rank()==0) std::cout << "***WARNING***: num_threads > 1 requires Trilinos to be built with Teuchos_ENABLE_THREAD_SAFE=ON, "
+        "subsets will be correlated using a single thread" << std::endl;
+    num_threads_ = 1;
+  }
+#endif
+  if(num_threads_>1){
+    DEBUG_MSG("Subsets will be correlated using " << num_threads_ << " threads per processor");
+    if(thread_pool_==Teuchos::null||thread_pool_->num_threads()!=num_threads_)
+      thread_pool_ = Teuchos::rcp(new Thread_Pool(num_threads_));
+  }
+  else{
+    thread_pool_ = Teuchos::null;
   }
 }
 
+void
+Schema::def_image_params(Teuchos::ParameterList & params) const{
+  params.set(DICe::compute_image_gradients,compute_def_gradients_);
+  params.set(DICe::gauss_filter_images,gauss_filter_images_);
+  params.set(DICe::gauss_filter_mask_size,gauss_filter_mask_size_);
+  params.set(DICe::gradient_method,gradient_method_);
+  params.set(DICe::filter_failed_cine_pixels,filter_failed_cine_pixels_);
+  params.set(DICe::convert_cine_to_8_bit,convert_cine_to_8_bit_);
+  undistort_image_params(params,def_camera_id_);
+}
+
+void
+Schema::undistort_image_params(Teuchos::ParameterList & params,
+  const int_t camera_id) const{
+  if(init_params_==Teuchos::null||!init_params_->isSublist(undistort_images)) return;
+  const Teuchos::ParameterList & undistort_sublist = init_params_->sublist(undistort_images);
+  std::stringstream camera_name;
+  camera_name << "camera_" << camera_id;
+  Teuchos::ParameterList cal_sublist;
+  if(undistort_sublist.isSublist(camera_name.str())){
+    cal_sublist = undistort_sublist.sublist(camera_name.str());
+  }
+  else{
+    // a single calibration is only valid for the left (or only) camera
+    TEUCHOS_TEST_FOR_EXCEPTION(camera_id!=0,std::runtime_error,
+      "Error, undistort_images requires a " << camera_name.str() << " sublist with the calibration of each camera for stereo");
+    cal_sublist = undistort_sublist;
+  }
+  // the remap tables are kept per camera
+  cal_sublist.set("camera_id",camera_id);
+  params.set(undistort_images,cal_sublist);
+}
+
+Teuchos::RCP<Image_Prefetcher>
+Schema::def_image_prefetcher(const std::vector<std::string> & file_names,
+  const int_t first_index){
+  if(num_prefetch_frames_<=0) return Teuchos::null;
+  if(motion_window_params_->size()>0){
+    DEBUG_MSG("Schema::def_image_prefetcher(): images are not prefetched when motion windows are used");
+    return Teuchos::null;
+  }
+  DEBUG_MSG("Schema::def_image_prefetcher(): prefetching " << num_prefetch_frames_ << " deformed images");
+  Teuchos::ParameterList imgParams;
+  def_image_params(imgParams);
+  return Teuchos::rcp(new Image_Prefetcher(file_names,first_index,imgParams,num_prefetch_frames_));
+}
+
 void
 Schema::set_def_image(Teuchos::RCP<Image> img,
   const int_t id){
@@ -322,6 +445,7 @@ Schema::set_def_image(Teuchos::RCP<Image> img,
     imgParams->set(DICe::gradient_method,gradient_method_);
     def_imgs_[id] = def_imgs_[id]->apply_rotation(def_image_rotation_,imgParams);
   }
+  cache_def_image_interpolation_coefficients(id);
 }
 
 void
@@ -345,6 +469,18 @@ Schema::set_def_image(const int_t img_width,
   if(def_image_rotation_!=ZERO_DEGREES){
     def_imgs_[id] = def_imgs_[id]->apply_rotation(def_image_rotation_);
   }
+  cache_def_image_interpolation_coefficients(id);
+}
+
+void
+Schema::cache_def_image_interpolation_coefficients(const int_t id){
+  if(interpolation_cache_==NO_INTERPOLATION_CACHE) return;
+  assert(id<(int_t)def_imgs_.size());
+  if(def_imgs_[id]==Teuchos::null) return;
+  // the coefficients are computed once per frame and shared by all subsets and solver iterations
+  if(def_imgs_[id]->has_interpolation_coefficients(interpolation_method_)&&def_imgs_[id]->interpolation_cache()==interpolation_cache_) return;
+  DEBUG_MSG("Schema::cache_def_image_interpolation_coefficients(): computing coefficients for deformed image " << id);
+  def_imgs_[id]->compute_interpolation_coefficients(interpolation_method_,interpolation_cache_);
 }
 
 void
@@ -358,11 +494,7 @@ Schema::set_ref_image(const std::string & refName){
   imgParams->set(DICe::compute_laplacian_image,compute_laplacian_image_);
   imgParams->set(DICe::filter_failed_cine_pixels,filter_failed_cine_pixels_);
   imgParams->set(DICe::convert_cine_to_8_bit,convert_cine_to_8_bit_);
-  if(init_params_!=Teuchos::null){
-    if(init_params_->isSublist(undistort_images)){
-      imgParams->set(undistort_images,init_params_->sublist(undistort_images));
-    }
-  }
+  undistort_image_params(*imgParams,camera_id_);
   if(has_extents_){
     utils::read_image_dimensions(refName.c_str(),full_ref_img_width_,full_ref_img_height_);
     const int_t buffer = 100; // if the extents are within 100 pixels of the image boundary use the whole image
@@ -449,6 +581,7 @@ Schema::default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & c
     const Teuchos::RCP<Teuchos::ParameterList> & input_params){
   global_num_subsets_ = 0;
   local_num_subsets_ = 0;
+  num_resolved_fields_ = 0;
   subset_dim_ = -1;
   step_size_x_ = -1;
   step_size_y_ = -1;
@@ -486,6 +619,12 @@ Schema::default_constructor_tasks(const Teuchos::RCP<Teuchos::ParameterList> & c
   read_full_images_ = false;
   sort_txt_output_ = false;
   threshold_block_size_ = -1;
+  num_threads_ = 1;
+  interpolation_cache_ = NO_INTERPOLATION_CACHE;
+  num_prefetch_frames_ = 0;
+  cine_buffer_num_frames_ = CINE_BUFFER_NUM_FRAMES;
+  camera_id_ = 0;
+  def_camera_id_ = 0;
   set_params(corr_params);
   prev_imgs_.push_back(Teuchos::null);
   def_imgs_.push_back(Teuchos::null);
@@ -658,6 +797,7 @@ Schema::set_params(const Teuchos::RCP<Teuchos::ParameterList> & params){
   projection_method_ = diceParams->get<Projection_Method>(DICe::projection_method);
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::interpolation_method),std::runtime_error,"");
   interpolation_method_ = diceParams->get<Interpolation_Method>(DICe::interpolation_method);
+  interpolation_cache_ = diceParams->get<Interpolation_Cache>(DICe::interpolation_cache,NO_INTERPOLATION_CACHE);
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::gradient_method),std::runtime_error,"");
   gradient_method_ = diceParams->get<Gradient_Method>(DICe::gradient_method);
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::max_evolution_iterations),std::runtime_error,"");
@@ -731,6 +871,17 @@ Schema::set_params(const Teuchos::RCP<Teuchos::ParameterList> & params){
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::write_exodus_output),std::runtime_error,"");
   write_exodus_output_ = diceParams->get<bool>(DICe::write_exodus_output);
   threshold_block_size_ = diceParams->get<int>(DICe::threshold_block_size,-1);
+  set_num_threads(diceParams->get<int_t>(DICe::num_threads,1));
+  num_prefetch_frames_ = diceParams->get<int_t>(DICe::num_prefetch_frames,0);
+  TEUCHOS_TEST_FOR_EXCEPTION(num_prefetch_frames_<0,std::runtime_error,"Error, num_prefetch_frames must be 0 (disabled) or greater");
+#ifndef HAVE_TEUCHOS_THREAD_SAFE
+  // the prefetched images are created on worker threads
+  if(num_prefetch_frames_>0){
+    if(proc_rank==0) std::cout << "***WARNING***: num_prefetch_frames > 0 requires Trilinos to be built with Teuchos_ENABLE_THREAD_SAFE=ON, "
+        "images will not be prefetched" << std::endl;
+    num_prefetch_frames_ = 0;
+  }
+#endif
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::use_search_initialization_for_failed_steps),std::runtime_error,"");
   use_search_initialization_for_failed_steps_ = diceParams->get<bool>(DICe::use_search_initialization_for_failed_steps);
   TEUCHOS_TEST_FOR_EXCEPTION(!diceParams->isParameter(DICe::normalize_gamma_with_active_pixels),std::runtime_error,"");
@@ -866,6 +1017,14 @@ Schema::set_params(const Teuchos::RCP<Teuchos::ParameterList> & params){
   const bool omit_row_id = diceParams->get<bool>(DICe::omit_output_row_id,false);
   output_spec_ = Teuchos::rcp(new DICe::Output_Spec(this,omit_row_id,outputParams,delimiter));
   has_output_spec_ = true;
+  const int_t output_buffer_size = diceParams->get<int_t>(DICe::output_buffer_size,0);
+  TEUCHOS_TEST_FOR_EXCEPTION(output_buffer_size<0,std::runtime_error,"Error, output_buffer_size cannot be negative");
+  if(output_buffer_size>0){
+    if(proc_rank == 0) DEBUG_MSG("Buffering " << output_buffer_size << " MB of output before writing to file");
+    output_buffer_ = Teuchos::rcp(new DICe::Output_File_Buffer((size_t)output_buffer_size*1024*1024));
+  }
+  else
+    output_buffer_ = Teuchos::null;
 
   if(diceParams->isParameter(DICe::exact_solution_constant_value_x)||diceParams->isParameter(DICe::exact_solution_constant_value_y)){
     TEUCHOS_TEST_FOR_EXCEPTION(diceParams->get<bool>(DICe::estimate_resolution_error,false),std::runtime_error,"");
@@ -1153,6 +1312,8 @@ Schema::initialize(const Teuchos::RCP<Teuchos::ParameterList> & input_params,
   std::string output_prefix = input_params->get<std::string>(DICe::output_prefix,"DICe_solution");
   output_prefix += "_stereo";
   init_params_->set(DICe::output_prefix,output_prefix);
+  // all of the images for this schema come from the right camera
+  set_camera_ids(1,1);
 
   if(analysis_type_==GLOBAL_DIC){
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"Error, global stereo has not been implemented yet");
@@ -1220,6 +1381,10 @@ Schema::initialize(const Teuchos::RCP<Teuchos::ParameterList> & input_params,
   std::set<int_t> neumann_boundary_nodes;
   std::set<int_t> lagrange_boundary_nodes;
 
+  // the handles point into the fields of the old mesh
+  field_handles_.clear();
+  subset_local_ids_.clear();
+  subset_global_ids_.clear();
   mesh_ = DICe::mesh::create_point_or_tri_mesh(DICe::mesh::MESHLESS,
     overlap_coords_x,
     overlap_coords_y,
@@ -1343,6 +1508,10 @@ Schema::create_mesh(Teuchos::RCP<Decomp> decomp){
   std::vector<std::pair<int_t,int_t> > dirichlet_boundary_nodes;
   std::set<int_t> neumann_boundary_nodes;
   std::set<int_t> lagrange_boundary_nodes;
+  // the handles point into the fields of the old mesh
+  field_handles_.clear();
+  subset_local_ids_.clear();
+  subset_global_ids_.clear();
   mesh_ = DICe::mesh::create_point_or_tri_mesh(DICe::mesh::MESHLESS,
     decomp->overlap_coords_x(),
     decomp->overlap_coords_y(),
@@ -1359,6 +1528,38 @@ Schema::create_mesh(Teuchos::RCP<Decomp> decomp){
   create_mesh_fields();
 }
 
+void
+Schema::update_field_handles(){
+  if(mesh_==Teuchos::null) return;
+  DICe::mesh::field_registry * registry = mesh_->get_field_registry();
+  // fields are never removed from the registry, so if none were added the handles are still valid
+  // (returning early also means other threads reading the handles of this schema are not disturbed)
+  if(!subset_global_ids_.empty()&&registry->size()==num_resolved_fields_) return;
+  field_handles_.clear();
+  subset_local_ids_.clear();
+  subset_global_ids_.clear();
+  num_resolved_fields_ = registry->size();
+  for(DICe::mesh::field_registry::const_iterator it=registry->begin();it!=registry->end();++it){
+    if(it->second==Teuchos::null) continue;
+    const size_t index = field_handle_index(it->first);
+    if(index>=field_handles_.size())
+      field_handles_.resize(index+1);
+    field_handles_[index] = Field_Handle(it->second);
+  }
+  Teuchos::RCP<MultiField_Map> map = mesh_->get_scalar_node_dist_map();
+  const int_t num_local = map->get_num_local_elements();
+  subset_global_ids_.resize(num_local);
+  int_t max_gid = -1;
+  for(int_t i=0;i<num_local;++i){
+    subset_global_ids_[i] = map->get_global_element(i);
+    max_gid = std::max(max_gid,subset_global_ids_[i]);
+  }
+  subset_local_ids_.assign(max_gid+1,-1);
+  for(int_t i=0;i<num_local;++i)
+    if(subset_global_ids_[i]>=0)
+      subset_local_ids_[subset_global_ids_[i]] = i;
+}
+
 void
 Schema::create_mesh_fields(const bool is_stereo){
   mesh_->create_field(field_enums::SUBSET_COORDINATES_X_FS);
@@ -1430,6 +1631,8 @@ Schema::create_mesh_fields(const bool is_stereo){
     mesh_->get_field(field_enums::ACCUMULATED_DISP_FS)->put_scalar(0.0);
   }
 
+  update_field_handles();
+
   // fill the subset coordinates field:
   Teuchos::RCP<MultiField> coords = mesh_->get_field(field_enums::INITIAL_COORDINATES_FS);
   for(int_t i=0;i<local_num_subsets_;++i){
@@ -1499,6 +1702,9 @@ Schema::execute_cross_correlation(){
   assert(local_num_subsets_>0);
   const int_t proc_id = comm_->get_rank();
   const int_t num_procs = comm_->get_size();
+  // resolve the field handles up front since the subsets may be correlated concurrently
+  update_field_handles();
+
   DEBUG_MSG("********************");
   std::stringstream progress;
   progress << "[PROC " << proc_id << " of " << num_procs << "] processing cross correlation";
@@ -1643,6 +1849,8 @@ Schema::execute_correlation(){
   assert(local_num_subsets_>0);
   const int_t proc_id = comm_->get_rank();
   const int_t num_procs = comm_->get_size();
+  // resolve the field handles up front since the subsets may be correlated concurrently
+  update_field_handles();
 
   DEBUG_MSG("********************");
   std::stringstream progress;
@@ -1675,9 +1883,11 @@ Schema::execute_correlation(){
   }
   // reset the sigma field for feature matching initializer
   if(initialization_method_==USE_FEATURE_MATCHING){
+    const Field_Handle neighbor_id = field_handle(NEIGHBOR_ID_FS);
+    const Field_Handle sigma = field_handle(SIGMA_FS);
     for(int_t i=0;i<local_num_subsets_;++i){
       // only turn the point back on if the point didn't fail the cross-correlation sgnified by NEIGH_ID = -2
-      if(local_field_value(i,NEIGHBOR_ID_FS)>-2.0) local_field_value(i,SIGMA_FS) = 0.0;
+      if(neighbor_id[i]>-2.0) sigma[i] = 0.0;
     }
   }
 #ifdef DICE_ENABLE_GLOBAL
@@ -1713,17 +1923,38 @@ Schema::execute_correlation(){
     TEUCHOS_TEST_FOR_EXCEPTION(motion_window_params_->size()!=0,std::runtime_error,
       "Error, motion windows are intended only for the TRACKING_ROUTINE");
     prepare_optimization_initializers();
-    for(int_t subset_index=0;subset_index<local_num_subsets_;++subset_index){
-      DEBUG_MSG("Schema::execute_correlation(): creating Objective for subset " << this_proc_gid_order_[subset_index]);
+    // each subset only reads the shared images and writes its own entries in the fields
+    // so the subsets can be distributed over threads as long as no subset is initialized
+    // from a neighbor's solution in this frame
+    auto correlate_subset = [this](const int_t subset_index, const int_t){
+      const int_t subset_gid = this_proc_gid_order_[subset_index];
+      DEBUG_MSG("Schema::execute_correlation(): creating Objective for subset " << subset_gid);
       try{
-        Teuchos::RCP<Objective> obj = Teuchos::rcp(new Objective_ZNSSD(this,this_proc_gid_order_[subset_index]));
+        Teuchos::RCP<Objective> obj = Teuchos::rcp(new Objective_ZNSSD(this,subset_gid));
         DEBUG_MSG("Schema::execute_correlation(): Objective creation successful");
         generic_correlation_routine(obj);
       }
       catch(...){
-        DEBUG_MSG("Schema::execute_correlation(): subset " << this_proc_gid_order_[subset_index] << " failed");
-        record_failed_step(this_proc_gid_order_[subset_index],static_cast<int_t>(INITIALIZE_FAILED_BY_EXCEPTION),-1);
+        DEBUG_MSG("Schema::execute_correlation(): subset " << subset_gid << " failed");
+        record_failed_step(subset_gid,static_cast<int_t>(INITIALIZE_FAILED_BY_EXCEPTION),-1);
       }
+    };
+    // the debugging images are written to shared directories so those runs stay serial
+    const bool use_threads = thread_pool_!=Teuchos::null&&
+        !output_deformed_subset_intensity_images_&&!output_evolved_subset_images_;
+    if(use_threads&&subsets_are_independent()){
+      DEBUG_MSG("Schema::execute_correlation(): correlating subsets using " << thread_pool_->num_threads() << " threads");
+      thread_pool_->parallel_for(0,local_num_subsets_,correlate_subset);
+    }
+    else if(use_threads){
+      // subsets are initialized from their neighbors so they have to wait for the neighbor's solution,
+      // independent seed chains are correlated concurrently
+      DEBUG_MSG("Schema::execute_correlation(): correlating neighbor dependent subsets using " << thread_pool_->num_threads() << " threads");
+      thread_pool_->parallel_for_dag(subset_dependencies(),correlate_subset);
+    }
+    else{
+      for(int_t subset_index=0;subset_index<local_num_subsets_;++subset_index)
+        correlate_subset(subset_index,0);
     }
   }
   // In this routine there are usually only a handful of subsets, but thousands of images.
@@ -1793,6 +2024,8 @@ Schema::execute_correlation(){
 
 void
 Schema::save_cross_correlation_fields(){
+  // the deformed images are from the left camera again after the cross correlation
+  set_camera_ids(camera_id_,camera_id_);
   Teuchos::RCP<MultiField> ux = mesh_->get_field(SUBSET_DISPLACEMENT_X_FS);
   Teuchos::RCP<MultiField> uy = mesh_->get_field(SUBSET_DISPLACEMENT_Y_FS);
   Teuchos::RCP<MultiField> cross_q = mesh_->get_field(CROSS_CORR_Q_FS);
@@ -1824,6 +2057,7 @@ Schema::execute_post_processors(){
   // compute post-processed quantities
   for(size_t i=0;i<post_processors_.size();++i){
     post_processors_[i]->update_current_frame_id(frame_id_-frame_skip_); // decrement frame skip since the frame id got updated by execute_correlation
+    post_processors_[i]->set_thread_pool(thread_pool_);
     post_processors_[i]->execute(ref_img_,def_imgs_[0]);
   }
   DEBUG_MSG("[PROC " << comm_->get_rank() << "] post processing complete");
@@ -1955,6 +2189,42 @@ Schema::motion_detected(const int_t subset_gid){
   }
 }
 
+bool
+Schema::subsets_are_independent()const{
+  if(initialization_method_==USE_NEIGHBOR_VALUES) return false;
+  if(initialization_method_==USE_NEIGHBOR_VALUES_FIRST_STEP_ONLY&&frame_id_==first_frame_id_) return false;
+  return true;
+}
+
+std::vector<std::vector<int_t> >
+Schema::subset_dependencies(){
+  std::vector<std::vector<int_t> > predecessors(local_num_subsets_);
+  if(subsets_are_independent()) return predecessors;
+  // position of each local subset in the execution order
+  std::vector<int_t> order_index(local_num_subsets_,-1);
+  for(int_t i=0;i<local_num_subsets_;++i){
+    const int_t lid = subset_local_id(this_proc_gid_order_[i]);
+    TEUCHOS_TEST_FOR_EXCEPTION(lid<0,std::runtime_error,"Error, subset in the gid order is not local to this process");
+    order_index[lid] = i;
+  }
+  int_t num_edges = 0;
+  for(int_t i=0;i<local_num_subsets_;++i){
+    const int_t subset_gid = this_proc_gid_order_[i];
+    const int_t neigh_gid = static_cast<int_t>(global_field_value(subset_gid,NEIGHBOR_ID_FS));
+    if(neigh_gid<0||neigh_gid==subset_gid) continue;
+    const int_t neigh_lid = subset_local_id(neigh_gid);
+    if(neigh_lid<0) continue; // the initializer will fail the same way it does in serial
+    const int_t j = order_index[neigh_lid];
+    // the serial loop reads the neighbor's values as they are when the subset is reached,
+    // so keep the same relative order whether the neighbor comes before or after the subset
+    if(j<i) predecessors[i].push_back(j);
+    else predecessors[j].push_back(i);
+    num_edges++;
+  }
+  DEBUG_MSG("Schema::subset_dependencies(): " << num_edges << " neighbor dependencies among " << local_num_subsets_ << " subsets");
+  return predecessors;
+}
+
 void
 Schema::record_failed_step(const int_t subset_gid,
   const int_t status,
@@ -1971,16 +2241,17 @@ Schema::record_failed_step(const int_t subset_gid,
     };
     shape_function->save_fields(this,subset_gid);
   }
-  global_field_value(subset_gid,SIGMA_FS) = -1.0;
-  global_field_value(subset_gid,MATCH_FS) = -1.0;
-  global_field_value(subset_gid,GAMMA_FS) = -1.0;
-  global_field_value(subset_gid,BETA_FS) = -1.0;
-  global_field_value(subset_gid,OMEGA_FS) = -1.0;
-  global_field_value(subset_gid,NOISE_LEVEL_FS) = -1.0;
-  global_field_value(subset_gid,CONTRAST_LEVEL_FS) = -1.0;
-  global_field_value(subset_gid,ACTIVE_PIXELS_FS) = -1.0;
-  global_field_value(subset_gid,STATUS_FLAG_FS) = status;
-  global_field_value(subset_gid,ITERATIONS_FS) = num_iterations;
+  const int_t subset_lid = subset_local_id(subset_gid);
+  local_field_value(subset_lid,SIGMA_FS) = -1.0;
+  local_field_value(subset_lid,MATCH_FS) = -1.0;
+  local_field_value(subset_lid,GAMMA_FS) = -1.0;
+  local_field_value(subset_lid,BETA_FS) = -1.0;
+  local_field_value(subset_lid,OMEGA_FS) = -1.0;
+  local_field_value(subset_lid,NOISE_LEVEL_FS) = -1.0;
+  local_field_value(subset_lid,CONTRAST_LEVEL_FS) = -1.0;
+  local_field_value(subset_lid,ACTIVE_PIXELS_FS) = -1.0;
+  local_field_value(subset_lid,STATUS_FLAG_FS) = status;
+  local_field_value(subset_lid,ITERATIONS_FS) = num_iterations;
 }
 
 void
@@ -1997,15 +2268,16 @@ Schema::record_step(const int_t subset_gid,
   const int_t num_iterations){
   DEBUG_MSG("Subset " << subset_gid << " record step");
   shape_function->save_fields(this,subset_gid);
-  global_field_value(subset_gid,SIGMA_FS) = sigma;
-  global_field_value(subset_gid,MATCH_FS) = match; // 0 means data is successful
-  global_field_value(subset_gid,GAMMA_FS) = gamma;
-  global_field_value(subset_gid,BETA_FS) = beta;
-  global_field_value(subset_gid,NOISE_LEVEL_FS) = noise;
-  global_field_value(subset_gid,CONTRAST_LEVEL_FS) = contrast;
-  global_field_value(subset_gid,ACTIVE_PIXELS_FS) = active_pixels;
-  global_field_value(subset_gid,STATUS_FLAG_FS) = status;
-  global_field_value(subset_gid,ITERATIONS_FS) = num_iterations;
+  const int_t subset_lid = subset_local_id(subset_gid);
+  local_field_value(subset_lid,SIGMA_FS) = sigma;
+  local_field_value(subset_lid,MATCH_FS) = match; // 0 means data is successful
+  local_field_value(subset_lid,GAMMA_FS) = gamma;
+  local_field_value(subset_lid,BETA_FS) = beta;
+  local_field_value(subset_lid,NOISE_LEVEL_FS) = noise;
+  local_field_value(subset_lid,CONTRAST_LEVEL_FS) = contrast;
+  local_field_value(subset_lid,ACTIVE_PIXELS_FS) = active_pixels;
+  local_field_value(subset_lid,STATUS_FLAG_FS) = status;
+  local_field_value(subset_lid,ITERATIONS_FS) = num_iterations;
 }
 
 Status_Flag
@@ -2852,6 +3124,13 @@ Schema::space_fill_correlate(const int_t seed_gid,
   TEUCHOS_TEST_FOR_EXCEPTION(in_gids.size()==0,std::runtime_error,"");
   out_gids.clear();
 
+  // claim the neighbors of the current front in the same order as a serial sweep,
+  // a neighbor is claimed by the first subset that reaches it whether or not its correlation
+  // succeeds, so the claims do not depend on the correlation results
+  std::vector<int_t> claimed_ids; // local ids of the claimed neighbors
+  std::vector<int_t> claimed_by;  // global id of the subset that claimed the neighbor
+  std::vector<scalar_t> init_u;   // displacement of the subset that claimed the neighbor
+  std::vector<scalar_t> init_v;
   for(size_t s=0;s<in_gids.size();++s){
     const int_t subset_gid = in_gids[s];
     DEBUG_MSG("Schema::space_fill_correlate: spreading to neighbors of SUBSET " << subset_gid);
@@ -2867,61 +3146,82 @@ Schema::space_fill_correlate(const int_t seed_gid,
     kd_tree->knnSearch(&query_pt[0],num_neigh,&ret_index[0],&out_dist_sqr[0]);
     for(int_t i=0;i<num_neigh;++i){
       const int_t neigh_id = ret_index[i];
-      const int_t neigh_gid = subset_global_id(neigh_id);
       if(local_field_value(neigh_id,NEIGHBOR_ID_FS)!=0) continue;
-      DEBUG_MSG("Schema::space_fill_correlate: neigh global id " << neigh_gid <<
+      DEBUG_MSG("Schema::space_fill_correlate: neigh global id " << subset_global_id(neigh_id) <<
         " cx " << local_field_value(neigh_id,SUBSET_COORDINATES_X_FS) << " cy " << local_field_value(neigh_id,SUBSET_COORDINATES_Y_FS) <<
         " dist " << std::sqrt(out_dist_sqr[i]));
       local_field_value(neigh_id,FIELD_10_FS) = seed_gid;
       local_field_value(neigh_id,NEIGHBOR_ID_FS) = -1;
+      claimed_ids.push_back(neigh_id);
+      claimed_by.push_back(subset_gid);
+      init_u.push_back(subset_u);
+      init_v.push_back(subset_v);
+    }
+  }
+
+  // correlate the claimed neighbors, each one only depends on the subset that claimed it
+  // so this wavefront can be correlated concurrently
+  const int_t num_claimed = claimed_ids.size();
+  std::vector<int_t> corr_status(num_claimed,static_cast<int_t>(CORRELATION_FAILED));
+  std::vector<scalar_t> cross_sigma(num_claimed,-1.0);
+  std::vector<scalar_t> cross_u(num_claimed,0.0);
+  std::vector<scalar_t> cross_v(num_claimed,0.0);
+  auto correlate_neighbor = [&](const int_t c, const int_t){
+    const int_t neigh_id = claimed_ids[c];
+    int_t num_iterations = -1;
+    Teuchos::RCP<Objective> obj = Teuchos::rcp(new Objective_ZNSSD(this,this_proc_gid_order_[neigh_id]));
+    Teuchos::RCP<Local_Shape_Function> neigh_shape_function = Teuchos::rcp(new Affine_Shape_Function(true,true,true));
+    neigh_shape_function->insert_motion(init_u[c],init_v[c]);
+    corr_status[c] = static_cast<int_t>(obj->computeUpdateFast(neigh_shape_function,num_iterations));
+    scalar_t noise_std_dev = 0.0;
+    cross_sigma[c] = obj->sigma(neigh_shape_function,noise_std_dev);
+    scalar_t cross_t = 0.0;
+    neigh_shape_function->map_to_u_v_theta(local_field_value(neigh_id,SUBSET_COORDINATES_X_FS),
+      local_field_value(neigh_id,SUBSET_COORDINATES_Y_FS),cross_u[c],cross_v[c],cross_t);
+  };
+  if(thread_pool_!=Teuchos::null)
+    thread_pool_->parallel_for(0,num_claimed,correlate_neighbor);
+  else
+    for(int_t c=0;c<num_claimed;++c)
+      correlate_neighbor(c,0);
 
-      // correlate
-      int_t num_iterations = -1;
-      Teuchos::RCP<Objective> obj = Teuchos::rcp(new Objective_ZNSSD(this,this_proc_gid_order_[neigh_id]));
-      Teuchos::RCP<Local_Shape_Function> neigh_shape_function = Teuchos::rcp(new Affine_Shape_Function(true,true,true));
-      neigh_shape_function->insert_motion(subset_u,subset_v);
-      Status_Flag corr_status = obj->computeUpdateFast(neigh_shape_function,num_iterations);
-
-      // check the sigma values and status flag
-      scalar_t noise_std_dev = 0.0;
-      const scalar_t cross_sigma = obj->sigma(neigh_shape_function,noise_std_dev);
-      local_field_value(neigh_id,SIGMA_FS) = cross_sigma;
-      if(cross_sigma<0.0){
-        DEBUG_MSG("Schema::space_fill_correlate(): failed cross init sigma");
-        continue;
-      }
-      // check correlation was successful
-      if(corr_status!=CORRELATION_SUCCESSFUL){
-        local_field_value(neigh_id,SIGMA_FS) = -1.0;
-        DEBUG_MSG("Schema::space_fill_correlate(): failed correlation");
-        continue;
-      }
-      // check epipolar error
-      scalar_t cross_t = 0.0, cross_u = 0.0, cross_v = 0.0;
-      neigh_shape_function->map_to_u_v_theta(local_field_value(neigh_id,SUBSET_COORDINATES_X_FS),
-        local_field_value(neigh_id,SUBSET_COORDINATES_Y_FS),cross_u,cross_v,cross_t);
-      const float a = local_field_value(neigh_id,EPI_A_FS);
-      const float b = local_field_value(neigh_id,EPI_B_FS);
-      const float c = local_field_value(neigh_id,EPI_C_FS);
-      const float stereo_x = local_field_value(neigh_id,SUBSET_COORDINATES_X_FS) + cross_u;
-      const float stereo_y = local_field_value(neigh_id,SUBSET_COORDINATES_Y_FS) + cross_v;
-      std::vector<scalar_t> sx(1,stereo_x);
-      std::vector<scalar_t> sy(1,stereo_y);
-      tri->undistort_points(sx,sy,1); // right camera
-      const float dist = (std::abs(a*sx[0]+b*sy[0]+c)/std::sqrt(a*a+b*b));
-      DEBUG_MSG("Schema::space_fill_correlate(): epipolar error for neighbor " << i << " gid " << neigh_gid << ": " << dist);
-      if(dist>epi_error_tol){
-        local_field_value(neigh_id,SIGMA_FS) = -1.0;
-        DEBUG_MSG("Schema::space_fill_correlate(): subset " << neigh_gid << " failed epipolar distance threshold, epipolar dist: " << dist);
-        continue;
-      }
-      // assume success at this point, set the field values
-      local_field_value(neigh_id,SUBSET_DISPLACEMENT_X_FS) = cross_u;
-      local_field_value(neigh_id,SUBSET_DISPLACEMENT_Y_FS) = cross_v;
-      local_field_value(neigh_id,NEIGHBOR_ID_FS) = subset_gid;
-
-      out_gids.push_back(neigh_gid);
-    }
+  // record the results in claim order
+  for(int_t c=0;c<num_claimed;++c){
+    const int_t neigh_id = claimed_ids[c];
+    const int_t neigh_gid = subset_global_id(neigh_id);
+    // check the sigma values and status flag
+    local_field_value(neigh_id,SIGMA_FS) = cross_sigma[c];
+    if(cross_sigma[c]<0.0){
+      DEBUG_MSG("Schema::space_fill_correlate(): failed cross init sigma");
+      continue;
+    }
+    // check correlation was successful
+    if(corr_status[c]!=static_cast<int_t>(CORRELATION_SUCCESSFUL)){
+      local_field_value(neigh_id,SIGMA_FS) = -1.0;
+      DEBUG_MSG("Schema::space_fill_correlate(): failed correlation");
+      continue;
+    }
+    // check epipolar error
+    const float a = local_field_value(neigh_id,EPI_A_FS);
+    const float b = local_field_value(neigh_id,EPI_B_FS);
+    const float c_epi = local_field_value(neigh_id,EPI_C_FS);
+    const float stereo_x = local_field_value(neigh_id,SUBSET_COORDINATES_X_FS) + cross_u[c];
+    const float stereo_y = local_field_value(neigh_id,SUBSET_COORDINATES_Y_FS) + cross_v[c];
+    std::vector<scalar_t> sx(1,stereo_x);
+    std::vector<scalar_t> sy(1,stereo_y);
+    tri->undistort_points(sx,sy,1); // right camera
+    const float dist = (std::abs(a*sx[0]+b*sy[0]+c_epi)/std::sqrt(a*a+b*b));
+    DEBUG_MSG("Schema::space_fill_correlate(): epipolar error for neighbor gid " << neigh_gid << ": " << dist);
+    if(dist>epi_error_tol){
+      local_field_value(neigh_id,SIGMA_FS) = -1.0;
+      DEBUG_MSG("Schema::space_fill_correlate(): subset " << neigh_gid << " failed epipolar distance threshold, epipolar dist: " << dist);
+      continue;
+    }
+    // assume success at this point, set the field values
+    local_field_value(neigh_id,SUBSET_DISPLACEMENT_X_FS) = cross_u[c];
+    local_field_value(neigh_id,SUBSET_DISPLACEMENT_Y_FS) = cross_v[c];
+    local_field_value(neigh_id,NEIGHBOR_ID_FS) = claimed_by[c];
+    out_gids.push_back(neigh_gid);
   }
 }
 
@@ -2992,13 +3292,9 @@ Schema::march_from_neighbor_init(const Direction & neighbor_direction,
   const int_t num_rows = (schema->ref_img()->height() - 2*schema->subset_dim())/schema->step_size_y() + 1;
   assert(step>0.0);
   const scalar_t sssig_threshold = 150.0; // fixed for now, could add to input
-  int_t num_iterations = -1;
   int_t dir = 1; // -1 based on direction DOWN and RIGHT reverse iterate
-  int_t id_start = 0;
-  if(neighbor_direction==DOWN||neighbor_direction==RIGHT){
+  if(neighbor_direction==DOWN||neighbor_direction==RIGHT)
     dir = -1;
-    id_start = schema->local_num_subsets() - 1;
-  }
   int_t neigh_increment = -1; // based on direction LEFT
   if(neighbor_direction==RIGHT)
     neigh_increment = 1;
@@ -3007,14 +3303,22 @@ Schema::march_from_neighbor_init(const Direction & neighbor_direction,
   else if(neighbor_direction==DOWN)
     neigh_increment = num_cols;
 
-  for(int_t local_id = id_start; 0 <= local_id && local_id < schema->local_num_subsets(); local_id+= dir){
+  // each subset depends only on its neighbor in the marching direction so every row (LEFT, RIGHT)
+  // or column (UP, DOWN) is an independent chain, the chains are marched concurrently
+  const bool march_rows = neighbor_direction==LEFT||neighbor_direction==RIGHT;
+  const int_t num_chains = march_rows ? num_rows : num_cols;
+  const int_t chain_length = march_rows ? num_cols : num_rows;
+  // guards the rectified points and the debug image which are shared by all chains
+  std::mutex output_mutex;
+  auto march_subset = [&](const int_t local_id){
     const int_t row = local_id/num_cols;
     const int_t col = local_id%num_cols;
-    if(row==0||row>=num_rows-1||col==0||col>=num_cols-1)continue; // skip the boarders
+    if(row==0||row>=num_rows-1||col==0||col>=num_cols-1)return; // skip the boarders
+    int_t num_iterations = -1;
     const int_t neigh_id = local_id + neigh_increment;
-    if(schema->local_field_value(local_id,SSSIG_FS) < sssig_threshold) continue; // not enough gradient information
-    if(schema->local_field_value(local_id,SIGMA_FS) > 0.0) continue; // positive sigma means it converged in a previous step
-    if(schema->local_field_value(neigh_id,SIGMA_FS) < 0.0) continue; // bad neigh
+    if(schema->local_field_value(local_id,SSSIG_FS) < sssig_threshold) return; // not enough gradient information
+    if(schema->local_field_value(local_id,SIGMA_FS) > 0.0) return; // positive sigma means it converged in a previous step
+    if(schema->local_field_value(neigh_id,SIGMA_FS) < 0.0) return; // bad neigh
     const int_t my_x = schema->local_field_value(local_id,SUBSET_COORDINATES_X_FS);
     const int_t my_y = schema->local_field_value(local_id,SUBSET_COORDINATES_Y_FS);
     const int_t neigh_x = schema->local_field_value(neigh_id,SUBSET_COORDINATES_X_FS);
@@ -3060,6 +3364,7 @@ Schema::march_from_neighbor_init(const Direction & neighbor_direction,
           std::vector<scalar_t> params(sf->num_params(),0.0);
           for(int_t i=0;i<sf->num_params();++i)
             params[i] = (*sf)(i);
+          std::lock_guard<std::mutex> lock(output_mutex);
           rectified_points.insert(std::make_pair(std::make_pair((int_t)subset_x,(int_t)subset_y),params)); // cast coords to ints to make comparison easier
         }
       }
@@ -3071,6 +3376,7 @@ Schema::march_from_neighbor_init(const Direction & neighbor_direction,
     }
     if(shape_function_params_valid(sf,obj,gamma_tol,-1.0,v_tol,-1.0,corr_status,cross_gamma,cross_sigma)){
       schema->record_step(schema->subset_global_id(local_id),sf,cross_sigma,1,cross_gamma,0.0,0.0,0.0,0,corr_status,num_iterations);
+      std::lock_guard<std::mutex> lock(output_mutex);
       cv::Point pt1(my_x,my_y);
       cv::circle(debug_img, pt1, dot_size, cv::Scalar(color),3);
       std::vector<scalar_t> params(sf->num_params(),0.0);
@@ -3081,7 +3387,22 @@ Schema::march_from_neighbor_init(const Direction & neighbor_direction,
       DEBUG_MSG("Schema::march_from_neighbor_init(): failed correlation at local id");
       schema->record_failed_step(schema->subset_global_id(local_id),corr_status,num_iterations);
     }
-  }
+  };
+  auto march_chain = [&](const int_t chain, const int_t){
+    for(int_t k=0;k<chain_length;++k){
+      const int_t pos = dir==1 ? k : chain_length - 1 - k;
+      const int_t local_id = march_rows ? chain*num_cols + pos : pos*num_cols + chain;
+      if(local_id>=schema->local_num_subsets()) continue;
+      march_subset(local_id);
+    }
+  };
+  // the subsets belong to the target schema, so its pool decides how they are run
+  Teuchos::RCP<Thread_Pool> pool = schema->thread_pool();
+  if(pool!=Teuchos::null)
+    pool->parallel_for(0,num_chains,march_chain);
+  else
+    for(int_t chain=0;chain<num_chains;++chain)
+      march_chain(chain,0);
   cv::imwrite(debug_img_name,debug_img);
 }
 
@@ -3134,6 +3455,8 @@ int_t
 Schema::initialize_cross_correlation(Teuchos::RCP<Triangulation> tri,
   const Teuchos::RCP<Teuchos::ParameterList> & input_params){
   DEBUG_MSG("Schema::initialize_cross_correlation(): cross init type " << to_string(cross_initialization_method_));
+  // the deformed image for the cross correlation is from the right camera
+  set_camera_ids(camera_id_,1);
 
   const int_t proc_rank = comm_->get_rank();
 
@@ -3279,6 +3602,8 @@ Schema::initialize_cross_correlation(Teuchos::RCP<Triangulation> tri,
     schema_params->set(DICe::enable_shear_strain,true);
     schema_params->set(DICe::enable_normal_strain,true);
     schema_params->set(DICe::max_solver_iterations_fast,250);
+    // march the coarse grid with the same number of threads as this schema
+    schema_params->set(DICe::num_threads,num_threads_);
     const scalar_t sssig_threshold = 150.0; // fixed for now, could add to input
     const int_t step_size = 31; // also could add as input param
     const int_t subset_size = 31;
@@ -4126,11 +4451,6 @@ Schema::execute_triangulation(Teuchos::RCP<Triangulation> tri,
   Teuchos::RCP<MultiField> model_disp_x = mesh_->get_field(MODEL_DISPLACEMENT_X_FS);
   Teuchos::RCP<MultiField> model_disp_y = mesh_->get_field(MODEL_DISPLACEMENT_Y_FS);
   Teuchos::RCP<MultiField> model_disp_z = mesh_->get_field(MODEL_DISPLACEMENT_Z_FS);
-  scalar_t X=0.0,Y=0.0,Z=0.0;
-  scalar_t Xw=0.0,Yw=0.0,Zw=0.0;
-  scalar_t xl=0.0,yl=0.0;
-  scalar_t xr=0.0,yr=0.0;
-  scalar_t max_m_value = 0.0;
   // if this is the first frame and a best fit plane is being used, clear the transform entries in case they have already been specified by the user
 
   bool best_fit = false;
@@ -4144,38 +4464,43 @@ Schema::execute_triangulation(Teuchos::RCP<Triangulation> tri,
       tri->reset_cam_0_to_world();
     }
   }
+  std::vector<scalar_t> xl(local_num_subsets_,0.0);
+  std::vector<scalar_t> yl(local_num_subsets_,0.0);
+  std::vector<scalar_t> xr(local_num_subsets_,0.0);
+  std::vector<scalar_t> yr(local_num_subsets_,0.0);
   for(int_t i=0;i<local_num_subsets_;++i){
-    xl = coords_x->local_value(i) + disp_x->local_value(i);
-    yl = coords_y->local_value(i) + disp_y->local_value(i);
-    xr = stereo_coords_x->local_value(i) + my_stereo_disp_x->local_value(i);
-    yr = stereo_coords_y->local_value(i) + my_stereo_disp_y->local_value(i);
-    max_m_value = tri->triangulate(xl,yl,xr,yr,X,Y,Z,Xw,Yw,Zw);
-    max_m->local_value(i) = max_m_value;
+    xl[i] = coords_x->local_value(i) + disp_x->local_value(i);
+    yl[i] = coords_y->local_value(i) + disp_y->local_value(i);
+    xr[i] = stereo_coords_x->local_value(i) + my_stereo_disp_x->local_value(i);
+    yr[i] = stereo_coords_y->local_value(i) + my_stereo_disp_y->local_value(i);
+  }
+  std::vector<scalar_t> Xw;
+  std::vector<scalar_t> Yw;
+  std::vector<scalar_t> Zw;
+  std::vector<scalar_t> max_m_values;
+  tri->triangulate(xl,yl,xr,yr,Xw,Yw,Zw,&max_m_values,false,thread_pool_);
+  for(int_t i=0;i<local_num_subsets_;++i){
+    max_m->local_value(i) = max_m_values[i];
     if(frame_id_==first_frame_id_){
-      model_x->local_value(i) = Xw; // w-coordinates have been transformed by a user defined transform to world or model coords
-      model_y->local_value(i) = Yw;
-      model_z->local_value(i) = Zw;
+      model_x->local_value(i) = Xw[i]; // w-coordinates have been transformed by a user defined transform to world or model coords
+      model_y->local_value(i) = Yw[i];
+      model_z->local_value(i) = Zw[i];
     }
     else{
-      model_disp_x->local_value(i) = Xw - model_x->local_value(i); // w-coordinates have been transformed by a user defined transform to world or model coords
-      model_disp_y->local_value(i) = Yw - model_y->local_value(i);
-      model_disp_z->local_value(i) = Zw - model_z->local_value(i);
+      model_disp_x->local_value(i) = Xw[i] - model_x->local_value(i); // w-coordinates have been transformed by a user defined transform to world or model coords
+      model_disp_y->local_value(i) = Yw[i] - model_y->local_value(i);
+      model_disp_z->local_value(i) = Zw[i] - model_z->local_value(i);
     }
-    //std::cout << " xl " << xl << " yl " << yl << " xr " << xr << " yr " << yr << " X " << Xw << " Y " << Yw << " Z " << Zw << std::endl;
   }
   if(frame_id_==first_frame_id_ && best_fit){
     Teuchos::RCP<MultiField> sigma = mesh_->get_field(SIGMA_FS);
     tri->best_fit_plane(model_x,model_y,model_z,sigma);
     // retriangulate the coordinate in the first frame
+    tri->triangulate(xl,yl,xr,yr,Xw,Yw,Zw,NULL,false,thread_pool_);
     for(int_t i=0;i<local_num_subsets_;++i){
-      xl = coords_x->local_value(i) + disp_x->local_value(i);
-      yl = coords_y->local_value(i) + disp_y->local_value(i);
-      xr = stereo_coords_x->local_value(i) + my_stereo_disp_x->local_value(i);
-      yr = stereo_coords_y->local_value(i) + my_stereo_disp_y->local_value(i);
-      tri->triangulate(xl,yl,xr,yr,X,Y,Z,Xw,Yw,Zw);
-      model_x->local_value(i) = Xw; // w-coordinates have been transformed by a user defined transform to world or model coords
-      model_y->local_value(i) = Yw;
-      model_z->local_value(i) = Zw;
+      model_x->local_value(i) = Xw[i]; // w-coordinates have been transformed by a user defined transform to world or model coords
+      model_y->local_value(i) = Yw[i];
+      model_z->local_value(i) = Zw[i];
     }
   }
   return 0;
@@ -4323,13 +4648,48 @@ Schema::write_mat_output(const std::string & output_folder,
   fclose(fp);
 }
 
+void
+Schema::write_binary_output(const std::string & output_folder,
+  const std::string & prefix){
+  if(analysis_type_==GLOBAL_DIC)
+    return;
+  TEUCHOS_TEST_FOR_EXCEPTION(output_spec_==Teuchos::null,std::runtime_error,"");
+  output_spec_->gather_fields();
+  const int_t proc_size = comm_->get_size();
+  std::stringstream fName;
+  fName << output_folder << prefix;
+  if(proc_size>1)
+    fName << "." << proc_size << "." << comm_->get_rank();
+  fName << ".dbin";
+  if(frame_id_==first_frame_id_+frame_skip_){
+    std::FILE * filePtr = fopen(fName.str().c_str(),"wb"); // overwrite the file if it exists
+    TEUCHOS_TEST_FOR_EXCEPTION(filePtr==NULL,std::runtime_error,"Error, could not open output file " << fName.str());
+    std::vector<int_t> row_ids(local_num_subsets_,0);
+    for(int_t i=0;i<local_num_subsets_;++i)
+      row_ids[i] = subset_global_id(i);
+    output_spec_->write_binary_header(filePtr,row_ids);
+    fclose(filePtr);
+  }
+  std::FILE * filePtr = fopen(fName.str().c_str(),"ab");
+  TEUCHOS_TEST_FOR_EXCEPTION(filePtr==NULL,std::runtime_error,"Error, could not open output file " << fName.str());
+  output_spec_->write_binary_frame(filePtr,frame_id_-frame_skip_,local_num_subsets_); // frame is decremented because write gets called after update_frame
+  fclose(filePtr);
+}
+
+void
+Schema::flush_output(){
+  if(output_buffer_!=Teuchos::null)
+    output_buffer_->flush();
+}
+
 void
 Schema::write_output(const std::string & output_folder,
   const std::string & prefix,
   const bool separate_files_per_subset,
   const bool separate_header_file,
   const bool no_text_output,
-  const bool write_mat_file){
+  const bool write_mat_file,
+  const bool write_binary_file){
   if(analysis_type_==GLOBAL_DIC){
     return;
   }
@@ -4352,11 +4712,13 @@ Schema::write_output(const std::string & output_folder,
 
   if(write_mat_file) write_mat_output(output_folder,prefix);
 
+  if(write_binary_file) write_binary_output(output_folder,prefix);
 
   if(no_text_output) return;
 
-  // populate the RCP vector of fields in the output spec
-  output_spec_->gather_fields();
+  // populate the RCP vector of fields in the output spec (already done if the binary output was written)
+  if(!write_binary_file)
+    output_spec_->gather_fields();
 
   // only process 0 actually writes the output
   //if(my_proc!=0) return;
@@ -4365,6 +4727,10 @@ Schema::write_output(const std::string & output_folder,
   infoName << output_folder << prefix << ".info";
 
   if(separate_files_per_subset){
+    // make sure no buffered rows are still being appended to the files when they get overwritten below
+    if(output_buffer_!=Teuchos::null&&frame_id_==first_frame_id_+frame_skip_)
+      output_buffer_->flush();
+    std::string row; // one row of buffered output (reused for each subset)
     for(int_t subset=0;subset<local_num_subsets_;++subset){
       // determine the number of digits to append:
       int_t num_digits_total = 0;
@@ -4400,10 +4766,19 @@ Schema::write_output(const std::string & output_folder,
         fclose (filePtr);
       }
       // append the latest result to the file
-      std::FILE * filePtr = fopen(fName.str().c_str(),"a");
-      output_spec_->write_frame(filePtr,frame_id_-frame_skip_,subset_global_id(subset)); // frame is decremented because write gets called after update_frame
-      fclose (filePtr);
+      if(output_buffer_!=Teuchos::null){
+        row.clear();
+        output_spec_->write_frame(row,frame_id_-frame_skip_,subset_global_id(subset)); // frame is decremented because write gets called after update_frame
+        output_buffer_->append(fName.str(),row);
+      }
+      else{
+        std::FILE * filePtr = fopen(fName.str().c_str(),"a");
+        output_spec_->write_frame(filePtr,frame_id_-frame_skip_,subset_global_id(subset)); // frame is decremented because write gets called after update_frame
+        fclose (filePtr);
+      }
     } // subset loop
+    if(output_buffer_!=Teuchos::null)
+      output_buffer_->flush_if_full();
   }
   else{
     std::stringstream fName;
@@ -4534,10 +4909,8 @@ Schema::check_for_blocking_subsets(const int_t subset_global_id){
   const int_t subset_lid = subset_local_id(subset_global_id);
 
   // turn off pixels in this subset that are blocked by another
-  // get a pointer to the member data in the subset that will store the list of blocked pixels
-  std::set<std::pair<int_t,int_t> > & blocked_pixels =
-      *obj_vec_[subset_lid]->subset()->pixels_blocked_by_other_subsets();
-  blocked_pixels.clear();
+  // collect the blocked pixels, then store them in the subset's mask
+  std::set<std::pair<int_t,int_t> > blocked_pixels;
 
   // get the list of subsets that block this one
   std::vector<int_t> * obst_ids = &obstructing_subset_ids_->find(subset_global_id)->second;
@@ -4554,6 +4927,7 @@ Schema::check_for_blocking_subsets(const int_t subset_global_id){
         obj_vec_[local_ss]->subset()->deformed_shapes(shape_function,cx,cy,obstruction_skin_factor_);
     blocked_pixels.insert(subset_pixels.begin(),subset_pixels.end());
   } // blocking subsets loop
+  obj_vec_[subset_lid]->subset()->pixels_blocked_by_other_subsets()->assign(blocked_pixels);
 }
 
 void
@@ -4942,6 +5316,128 @@ Output_Spec::write_frame(std::FILE * file,
   fprintf(file,"\n"); // the space before end of line is important for parsing in the output diff tool
 }
 
+void
+Output_Spec::write_binary_header(std::FILE * file,
+  const std::vector<int_t> & row_ids){
+  assert(file);
+  std::vector<char> header(binary_output_magic,binary_output_magic+sizeof(binary_output_magic));
+  const auto append_int32 = [&header](const int32_t value){
+    const char * bytes = reinterpret_cast<const char*>(&value);
+    header.insert(header.end(),bytes,bytes+sizeof(int32_t));
+  };
+  const auto append_string = [&header,&append_int32](const std::string & str){
+    append_int32((int32_t)str.size());
+    header.insert(header.end(),str.begin(),str.end());
+  };
+  append_int32(binary_output_version);
+  append_int32((int32_t)field_names_.size());
+  append_int32((int32_t)row_ids.size());
+  append_int32(omit_row_id_ ? 1 : 0);
+  append_string(delimiter_);
+  for(size_t i=0;i<field_names_.size();++i)
+    append_string(field_names_[i]);
+  for(size_t i=0;i<row_ids.size();++i)
+    append_int32((int32_t)row_ids[i]);
+  // pad so that the frame chunks (and the columns in them) are 8 byte aligned
+  header.resize((header.size()+7)/8*8,'\0');
+  const size_t num_written = fwrite(&header[0],1,header.size(),file);
+  TEUCHOS_TEST_FOR_EXCEPTION(num_written!=header.size(),std::runtime_error,"Error, failed writing the binary output header");
+}
+
+void
+Output_Spec::write_binary_frame(std::FILE * file,
+  const int_t frame,
+  const int_t num_rows){
+  assert(file);
+  const size_t num_cols = field_names_.size();
+  // the frame number takes the first double sized slot of the chunk
+  binary_chunk_.resize(1+num_cols*num_rows);
+  const int64_t frame_id = frame;
+  std::memcpy(&binary_chunk_[0],&frame_id,sizeof(int64_t));
+  for(size_t i=0;i<num_cols;++i){
+    double * column = &binary_chunk_[1+i*num_rows];
+    if(field_vec_[i]==Teuchos::null){
+      std::fill(column,column+num_rows,0.0);
+      continue;
+    }
+    for(int_t j=0;j<num_rows;++j)
+      column[j] = field_vec_[i]->local_value(j);
+  }
+  const size_t num_written = fwrite(&binary_chunk_[0],sizeof(double),binary_chunk_.size(),file);
+  TEUCHOS_TEST_FOR_EXCEPTION(num_written!=binary_chunk_.size(),std::runtime_error,"Error, failed writing the binary output for frame " << frame);
+}
+
+void
+Output_Spec::write_frame(std::string & buffer,
+  const int_t row_index,
+  const int_t field_value_index){
+  char value_str[64];
+  if(!omit_row_id_){
+    snprintf(value_str,sizeof(value_str),"%i",row_index);
+    buffer += value_str;
+    buffer += delimiter_;
+  }
+  for(size_t i=0;i<field_names_.size();++i)
+  {
+    scalar_t value = 0.0;
+    if(field_vec_[i]!=Teuchos::null)
+      value = field_vec_[i]->local_value(field_value_index);
+    if(i!=0)
+      buffer += delimiter_;
+    snprintf(value_str,sizeof(value_str),"%4.4E",value);
+    buffer += value_str;
+  }
+  buffer += "\n";
+}
+
+Output_File_Buffer::~Output_File_Buffer(){
+  try{
+    flush();
+  }
+  catch(std::exception & e){
+    std::cerr << "Error, failed to write the buffered output: " << e.what() << std::endl;
+  }
+}
+
+void
+Output_File_Buffer::wait(){
+  if(pending_write_.valid())
+    pending_write_.get(); // rethrows any exception from the background write
+}
+
+void
+Output_File_Buffer::flush_if_full(){
+  if(size_<capacity_) return;
+  DEBUG_MSG("Output_File_Buffer::flush_if_full(): writing " << size_ << " bytes for " << texts_.size() << " files");
+  // only one batch in flight so the rows are appended in order
+  wait();
+  std::map<std::string,std::string> batch;
+  batch.swap(texts_);
+  size_ = 0;
+  pending_write_ = std::async(std::launch::async,[](const std::map<std::string,std::string> & texts){write_files(texts);},std::move(batch));
+}
+
+void
+Output_File_Buffer::flush(){
+  wait();
+  std::map<std::string,std::string> batch;
+  batch.swap(texts_);
+  size_ = 0;
+  write_files(batch);
+}
+
+void
+Output_File_Buffer::write_files(const std::map<std::string,std::string> & texts){
+  for(std::map<std::string,std::string>::const_iterator it=texts.begin();it!=texts.end();++it){
+    if(it->second.empty()) continue;
+    std::FILE * filePtr = fopen(it->first.c_str(),"a");
+    TEUCHOS_TEST_FOR_EXCEPTION(filePtr==NULL,std::runtime_error,"Error, could not open output file " << it->first);
+    const size_t num_written = fwrite(it->second.data(),1,it->second.size(),filePtr);
+    fclose(filePtr);
+    TEUCHOS_TEST_FOR_EXCEPTION(num_written!=it->second.size(),std::runtime_error,"Error, failed writing to output file " << it->first);
+  }
+}
+
 bool frame_should_be_skipped(const int_t trigger_based_frame_index,
   std::vector<int_t> & frame_id_vector){
   DEBUG_MSG("frame_should_be_skipped(): vector size " << frame_id_vector.size());
@@ -55,6 +55,8 @@
 #include <DICe_FieldEnums.h>
 #include <DICe_Decomp.h>
 #include <DICe_LocalShapeFunction.h>
+#include <DICe_ThreadPool.h>
+#include <DICe_ImagePrefetcher.h>
 
 #ifdef DICE_TPETRA
   #include "DICe_MultiFieldTpetra.h"
@@ -65,6 +67,7 @@
 #include <Teuchos_ParameterList.hpp>
 #include <Teuchos_SerialDenseMatrix.hpp>
 
+#include <future>
 #include <map>
 
 namespace DICe {
@@ -75,6 +78,9 @@ class Objective;
 // forward declaration of Output_Spec
 class Output_Spec;
 
+// forward declaration of Output_File_Buffer
+class Output_File_Buffer;
+
 // forward declaration of Post_Processor
 class Post_Processor;
 
@@ -192,6 +198,51 @@ private:
   std::map<int_t,std::vector<int_t> > failed_init_frames_;
 };
 
+/// \class DICe::Field_Handle
+/// \brief A resolved view of the local values of one field
+///
+/// Indexing a handle is a plain array access so loops over many subsets avoid the field registry
+/// lookup and the multivector view in Schema::local_field_value(). The values are not copied, the
+/// handle points into the DICe::MultiField storage so it can still be used for communication.
+/// A handle is only valid as long as the mesh that owns the field exists.
+class DICE_LIB_DLL_EXPORT
+Field_Handle {
+public:
+  /// default constructor, creates a null handle
+  Field_Handle():
+  values_(NULL),
+  size_(0){};
+
+  /// \brief constructor
+  /// \param field the field to view (must not be null)
+  Field_Handle(const Teuchos::RCP<MultiField> & field):
+  values_(field->local_values()),
+  size_(field->get_map()->get_num_local_elements()){};
+
+  /// \brief value accessor
+  /// \param local_id the local id of the element
+  precision_t & operator[](const int_t local_id)const{
+    assert(local_id>=0&&local_id<size_);
+    return values_[local_id];
+  }
+
+  /// returns the number of local values
+  int_t size()const{
+    return size_;
+  }
+
+  /// returns true if the handle does not point to any values
+  bool is_null()const{
+    return values_==NULL;
+  }
+
+private:
+  /// pointer to the local values
+  precision_t * values_;
+  /// number of local values
+  int_t size_;
+};
+
 /// \class DICe::Schema
 /// \brief The centralized container for the correlation plan and parameters
 ///
@@ -321,6 +372,32 @@ public:
   void set_def_image(Teuchos::RCP<Image> img,
     const int_t id=0);
 
+  /// Precompute the interpolation coefficients for a deformed image if an interpolation cache is enabled
+  /// \param id the sub image id of the deformed image
+  void cache_def_image_interpolation_coefficients(const int_t id=0);
+
+  /// Populate the image parameters used to read the deformed images (filtering, gradients, cine options, undistortion)
+  /// \param params [out] the parameter list to populate
+  void def_image_params(Teuchos::ParameterList & params) const;
+
+  /// \brief Add the undistort_images parameters for the given camera to a set of image parameters
+  ///
+  /// The undistort_images sublist either holds the calibration directly (single camera) or one
+  /// sublist per camera named camera_0, camera_1 (stereo), nothing is added if the images are not undistorted
+  /// \param params [out] the parameter list to populate
+  /// \param camera_id the camera the image comes from
+  void undistort_image_params(Teuchos::ParameterList & params,
+    const int_t camera_id) const;
+
+  /// \brief Create a prefetcher that loads the deformed images on background threads
+  /// \param file_names the list of deformed image file names
+  /// \param first_index the index of the first image to load
+  ///
+  /// Returns null if prefetching is disabled (num_prefetch_frames is 0) or not possible (motion windows are used).
+  /// The images handed out by the prefetcher should be set using set_def_image(Teuchos::RCP<Image>)
+  Teuchos::RCP<Image_Prefetcher> def_image_prefetcher(const std::vector<std::string> & file_names,
+    const int_t first_index);
+
   /// Rotate the deformed image if requested
   void rotate_def_image();
 
@@ -425,6 +502,59 @@ public:
     return max_solver_iterations_fast_;
   }
 
+  /// Returns the number of threads used to correlate subsets on this processor
+  int_t num_threads()const{
+    return num_threads_;
+  }
+
+  /// \brief Set the number of threads used to correlate subsets on this processor
+  /// \param num_threads the number of threads (0 uses all hardware threads)
+  ///
+  /// Falls back to one thread if Trilinos was not built with Teuchos_ENABLE_THREAD_SAFE
+  void set_num_threads(const int_t num_threads);
+
+  /// Returns the pool of worker threads (null if only one thread is used)
+  Teuchos::RCP<Thread_Pool> thread_pool()const{
+    return thread_pool_;
+  }
+
+  /// Returns the number of deformed images loaded ahead on background threads
+  int_t num_prefetch_frames()const{
+    return num_prefetch_frames_;
+  }
+
+  /// Returns the number of frames read into the cine buffer at a time (when extents are not used)
+  int_t cine_buffer_num_frames()const{
+    return cine_buffer_num_frames_;
+  }
+
+  /// Sets the number of frames read into the cine buffer at a time (defaults to CINE_BUFFER_NUM_FRAMES)
+  /// \param num_frames the number of frames per buffer
+  void set_cine_buffer_num_frames(const int_t num_frames){
+    TEUCHOS_TEST_FOR_EXCEPTION(num_frames<=0,std::runtime_error,"Error, the cine buffer must hold at least one frame");
+    cine_buffer_num_frames_ = num_frames;
+  }
+
+  /// Returns the camera the reference images come from (0 left, 1 right)
+  int_t camera_id()const{
+    return camera_id_;
+  }
+
+  /// Returns the camera the deformed images come from (the right camera for the left schema during cross correlation)
+  int_t def_camera_id()const{
+    return def_camera_id_;
+  }
+
+  /// \brief Sets the camera the images come from, used to pick the undistortion parameters for stereo
+  /// \param camera_id the camera of the reference images
+  /// \param def_camera_id the camera of the deformed images
+  void set_camera_ids(const int_t camera_id,
+    const int_t def_camera_id){
+    TEUCHOS_TEST_FOR_EXCEPTION(camera_id<0||def_camera_id<0,std::runtime_error,"Error, invalid camera id");
+    camera_id_ = camera_id;
+    def_camera_id_ = def_camera_id;
+  }
+
   /// Returns the max solver iterations allowed for the robust (simplex) algorithm
   int_t max_solver_iterations_robust()const{
     return max_solver_iterations_robust_;
@@ -552,9 +682,30 @@ public:
     const DICe::field_enums::Field_Spec spec){
     assert(local_id<local_num_subsets_);
     assert(local_id>=0);
+    const size_t index = field_handle_index(spec);
+    if(index<field_handles_.size()&&!field_handles_[index].is_null())
+      return field_handles_[index][local_id];
     return mesh_->get_field(spec)->local_value(local_id);
   }
 
+  /// \brief Return a handle to the local values of the given field
+  /// \param spec the Field_Spec of the requested field
+  ///
+  /// The handle is indexed by the subset local id (see subset_local_id())
+  Field_Handle field_handle(const DICe::field_enums::Field_Spec & spec){
+    const size_t index = field_handle_index(spec);
+    if(index<field_handles_.size()&&!field_handles_[index].is_null())
+      return field_handles_[index];
+    return Field_Handle(mesh_->get_field(spec));
+  }
+
+  /// \brief Resolve the handles for all the fields in the mesh and the tables that map subset global and local ids
+  ///
+  /// Called after the mesh fields are created and at the start of each frame. Fields created after this call
+  /// are still accessible, but are looked up in the mesh field registry until the handles are updated again.
+  /// Must not be called while subsets are being correlated on other threads.
+  void update_field_handles();
+
   /// \brief Save off the current solution into the storage for frame n - 1 (only used if projection_method is VELOCITY_BASED)
   /// \param global_id global ID of correlation point
   void save_off_fields(const int_t global_id){
@@ -590,6 +741,11 @@ public:
     return interpolation_method_;
   }
 
+  /// Returns the type of precomputed interpolation coefficients stored with the deformed images
+  Interpolation_Cache interpolation_cache()const{
+    return interpolation_cache_;
+  }
+
   /// Returns the interpolation method (see DICe_Types.h for valid values)
   Gradient_Method gradient_method()const{
     return gradient_method_;
@@ -644,12 +800,30 @@ public:
   /// \param separate_header_file place the run information in another file rather than the header of the results
   /// \param no_text_output if true the text output files are not written
   /// \param write_mat_output true if the .mat file should be written
+  /// \param write_binary_file true if the results should also be appended to the binary columnar output file
   void write_output(const std::string & output_folder,
     const std::string & prefix="DICe_solution",
     const bool separate_files_per_subset=false,
     const bool separate_header_file=false,
     const bool no_text_output=false,
-    const bool write_mat_file=false);
+    const bool write_mat_file=false,
+    const bool write_binary_file=false);
+
+  /// \brief Append the results for the current frame to the binary columnar output file
+  ///
+  /// The file is named <prefix>.dbin and is created when the first frame is written. The fields and their
+  /// order come from the output spec. See Output_Spec::write_binary_header() for the file layout and
+  /// the DICe_BinaryToText tool to convert the file to the text output format.
+  /// \param output_folder Name of the folder for output
+  /// \param prefix the file prefix
+  void write_binary_output(const std::string & output_folder,
+    const std::string & prefix);
+
+  /// \brief Writes any buffered output to the output files and waits for the writes to finish
+  ///
+  /// Only has an effect if the output_buffer_size parameter is greater than zero. The remaining
+  /// output is also written when the schema is destroyed, but errors are only reported from here.
+  void flush_output();
 
   /// \brief Write the solution vector to a .mat file
   /// \param output_folder Name of the folder for output (the file name is fixed)
@@ -696,7 +870,7 @@ public:
   /// an initial guess of the displacements or where the deformation is changing rapidly in x or y
   /// \param neighbor_direction which neighbor to use
   /// \param step the step size of the marching
-  /// \param schema pointer to the the schema with the field values
+  /// \param schema pointer to the the schema with the field values (the subsets are correlated with its thread pool)
   /// \param gamma_tol used for testing the solution
   /// \param v_tol also use for testing the solution
   void march_from_neighbor_init(const Direction & neighbor_direction,
@@ -737,6 +911,19 @@ public:
   /// \param obj A single DICe::Objective that has a DICe::subset as part of its member data
   void generic_correlation_routine(Teuchos::RCP<Objective> obj);
 
+  /// Returns true if the subsets in the current frame can be correlated in any order
+  /// (i.e. the initial guess for a subset does not depend on the solution of a neighbor
+  /// in this frame), which is the requirement for correlating them concurrently
+  bool subsets_are_independent()const;
+
+  /// \brief Returns the dependencies among the subsets for the current frame
+  ///
+  /// The return value has one entry per position in the execution order (this_proc_gid_order_),
+  /// each entry lists the positions that have to be correlated first. If neighbor values are
+  /// used for initialization, a subset depends on its neighbor (NEIGHBOR_ID_FS). The lists are
+  /// empty if the subsets are independent.
+  std::vector<std::vector<int_t> > subset_dependencies();
+
   /// Returns true if the user has requested testing for motion in the frame
   /// and the motion was detected by diffing pixel values:
   /// \param subset_gid the global id of the subset to test for motion
@@ -1088,12 +1275,16 @@ public:
   /// Return the global id of a subset local id
   /// \param local_id the input local id to tranlate to global
   int_t subset_global_id(const int_t local_id){
+    if(local_id>=0&&local_id<(int_t)subset_global_ids_.size())
+      return subset_global_ids_[local_id];
     return mesh_->get_scalar_node_dist_map()->get_global_element(local_id);
   }
 
-  /// Return the local id of a subset global id
+  /// Return the local id of a subset global id (-1 if the subset is not local to this process)
   /// \param global_id the input global id to tranlate to local
   int_t subset_local_id(const int_t global_id){
+    if(global_id>=0&&global_id<(int_t)subset_local_ids_.size())
+      return subset_local_ids_[global_id];
     return mesh_->get_scalar_node_dist_map()->get_local_element(global_id);
   }
 
@@ -1128,6 +1319,12 @@ public:
   }
 
 private:
+  /// \brief position of a field in field_handles_ (the field registry is keyed by the field name and state)
+  /// \param spec the field spec
+  static size_t field_handle_index(const DICe::field_enums::Field_Spec & spec){
+    return (size_t)spec.get_name()*(DICe::field_enums::STATE_N_PLUS_ONE+1) + spec.get_state();
+  }
+
   /// \brief Initializes the data structures for the schema
   /// \param input_params pointer to the initialization parameters
   /// \param correlation_params pointer to the correlation parameters
@@ -1239,6 +1436,16 @@ private:
   bool has_output_spec_;
   /// Determines how the output is formatted
   Teuchos::RCP<DICe::Output_Spec> output_spec_;
+  /// Holds the per-subset output in memory until it is appended to the files (null if output_buffer_size is 0)
+  Teuchos::RCP<DICe::Output_File_Buffer> output_buffer_;
+  /// Resolved field handles indexed by field_handle_index()
+  std::vector<Field_Handle> field_handles_;
+  /// Dense table of subset local ids indexed by global id (-1 if not local)
+  std::vector<int_t> subset_local_ids_;
+  /// Table of subset global ids indexed by local id
+  std::vector<int_t> subset_global_ids_;
+  /// Number of fields in the mesh field registry when the field handles were resolved
+  size_t num_resolved_fields_;
   /// Stores current fame number for a sequence of images
   int_t frame_id_;
   /// Stores the offset to the first image's index (cine files can start with a negative index)
@@ -1384,8 +1591,27 @@ private:
   bool compute_laplacian_image_;
   /// size of threshold to use for feature matching when thresholding is included
   int_t threshold_block_size_;
+  /// number of threads used to correlate subsets on this processor
+  int_t num_threads_;
+  /// DICe::Interpolation_Cache used for the deformed images
+  Interpolation_Cache interpolation_cache_;
+  /// number of deformed images loaded ahead on background threads
+  int_t num_prefetch_frames_;
+  /// number of frames read into the cine buffer at a time
+  int_t cine_buffer_num_frames_;
+  /// camera the reference images come from
+  int_t camera_id_;
+  /// camera the deformed images come from
+  int_t def_camera_id_;
+  /// pool of worker threads (only constructed if num_threads_ > 1)
+  Teuchos::RCP<Thread_Pool> thread_pool_;
 };
 
+/// identifies DICe binary columnar output files (see Output_Spec::write_binary_header())
+const char binary_output_magic[8] = {'D','I','C','E','B','I','N','\0'};
+/// version of the binary columnar output layout
+const int32_t binary_output_version = 1;
+
 /// \class DICe::Output_Spec
 /// \brief A simple class to hold the fields to write to the output files and the order to write them
 ///
@@ -1432,6 +1658,37 @@ public:
     const int_t row_index,
     const int_t field_value_index);
 
+  /// \brief Appends the fields for the current frame to a string, formatted the same way as write_frame() for a file
+  /// \param buffer The string to append the row to
+  /// \param row_index The label for the current row (typically frame_number or subset_id)
+  /// \param field_value_index Index of the field values (see the file version of write_frame())
+  void write_frame(std::string & buffer,
+    const int_t row_index,
+    const int_t field_value_index);
+
+  /// \brief Writes the header of a binary columnar output file
+  ///
+  /// The binary file is a header followed by one chunk per frame. All values are in the native byte order.
+  /// The header holds: the 8 character binary_output_magic, the int32 binary_output_version, the int32
+  /// number of columns (fields), the int32 number of rows (subsets), an int32 flag that is 1 if the row id
+  /// should be omitted from the text output, the int32 length and characters of the delimiter and the int32
+  /// length and characters of each field name, followed by the int32 global id of each row. The header is
+  /// zero padded to a multiple of 8 bytes. Each frame chunk is the int64 frame number followed by the double
+  /// values of each column in turn (all rows of the first field, then all rows of the second, etc.), so every
+  /// column in the file is 8 byte aligned and the file can be memory mapped.
+  /// \param file Pointer to the output file (must already be open in binary mode)
+  /// \param row_ids the global id of each row, the frames must be written with the same number of rows
+  void write_binary_header(std::FILE * file,
+    const std::vector<int_t> & row_ids);
+
+  /// \brief Appends the fields for the current frame to a binary columnar output file as one chunk
+  /// \param file Pointer to the output file (must already be open in binary mode)
+  /// \param frame The frame number
+  /// \param num_rows The number of rows (field values) to write for each column
+  void write_binary_frame(std::FILE * file,
+    const int_t frame,
+    const int_t num_rows);
+
   /// provide access to the field_vec
   std::vector<Teuchos::RCP<MultiField> > * field_vec(){
     return &field_vec_;
@@ -1451,6 +1708,73 @@ private:
   bool omit_row_id_;
   /// Vector of pointers to mesh fields to use for output
   std::vector<Teuchos::RCP<MultiField> > field_vec_;
+  /// Storage for one frame of binary output (reused between frames)
+  std::vector<double> binary_chunk_;
+};
+
+/// \class DICe::Output_File_Buffer
+/// \brief Holds text destined for a set of output files in memory and appends it to the files in large batches
+///
+/// When one output file is written per subset, opening and closing every file for every frame dominates the
+/// cost of the output for large numbers of subsets. This class collects the rows for each file in memory and,
+/// once the buffered text reaches the capacity, hands it to a background thread that opens each file once and
+/// appends all its rows. Only one batch is written at a time so the rows in each file stay in frame order.
+/// Everything still in memory is written by flush() or when the buffer is destroyed.
+class DICE_LIB_DLL_EXPORT
+Output_File_Buffer {
+public:
+  /// \brief Constructor
+  /// \param capacity the number of bytes to hold in memory before the text is written to the files
+  Output_File_Buffer(const size_t capacity):
+  capacity_(capacity),
+  size_(0){};
+
+  /// Destructor, writes the remaining text to the files
+  ~Output_File_Buffer();
+
+  /// no copies allowed
+  Output_File_Buffer(const Output_File_Buffer &) = delete;
+  /// no copies allowed
+  Output_File_Buffer & operator=(const Output_File_Buffer &) = delete;
+
+  /// \brief Appends text to the pending text for the given file
+  /// \param file_name the name of the file the text will be appended to
+  /// \param text the text to append
+  void append(const std::string & file_name,
+    const std::string & text){
+    texts_[file_name] += text;
+    size_ += text.size();
+  }
+
+  /// returns the number of bytes held in memory that have not been handed off for writing
+  size_t size()const{
+    return size_;
+  }
+
+  /// \brief Starts writing the buffered text on a background thread if the buffer has reached its capacity
+  ///
+  /// Errors from the previous background write are rethrown here
+  void flush_if_full();
+
+  /// \brief Writes all the buffered text to the files and waits for any background write to finish
+  void flush();
+
+private:
+  /// wait for the background write (if any) to complete, rethrows any errors that occurred while writing
+  void wait();
+
+  /// append the text to each file (opening each file only once)
+  /// \param texts map of file names to the text to append
+  static void write_files(const std::map<std::string,std::string> & texts);
+
+  /// number of bytes to buffer before writing
+  size_t capacity_;
+  /// number of bytes in texts_
+  size_t size_;
+  /// text waiting to be written for each file
+  std::map<std::string,std::string> texts_;
+  /// the background write in progress
+  std::future<void> pending_write_;
 };
 
 /// free function given a std::vector to determine if a frame index should be skipped or not
@@ -47,6 +47,9 @@
 #include <DICe_ImageIO.h>
 
 #include <Teuchos_LAPACK.hpp>
+
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 namespace DICe {
@@ -699,144 +702,160 @@ scalar_t Triangulation::triangulate(const scalar_t & x0,
   scalar_t & zw_out,
   const bool correct_lens_distortion) const{
   DEBUG_MSG("Triangulation::triangulate(): camera 0 sensor coords " << x0 << " " << y0 << " camera 1 sensor coords " << x1 << " " << y1);
-  static scalar_t xc0 = 0.0;
-  static scalar_t yc0 = 0.0;
-  static scalar_t xc1 = 0.0;
-  static scalar_t yc1 = 0.0;
-  xc0 = x0;
-  yc0 = y0;
-  xc1 = x1;
-  yc1 = y1;
-  if(correct_lens_distortion){
-    correct_lens_distortion_radial(xc0,yc0,0);
-    correct_lens_distortion_radial(xc1,yc1,1);
-    DEBUG_MSG("Triangulation::triangulate(): distortion corrected camera 0 sensor coords " << xc0 << " " << yc0 << " camera 1 sensor coords " << xc1 << " " << yc1);
-  }
-
-  static Teuchos::SerialDenseMatrix<int_t,double> M(4,3,true);
-  static Teuchos::SerialDenseMatrix<int_t,double> MTM(3,3,true);
-  static Teuchos::SerialDenseMatrix<int_t,double> MTMMT(3,4,true);
-  static Teuchos::LAPACK<int_t,double> lapack;
-  static std::vector<scalar_t> r(4,0.0);
-  static std::vector<scalar_t> XYZc0(4,0.0); // camera 0 coords
-  static std::vector<scalar_t> XYZ(4,0.0); // world coords
-  static scalar_t cmx = 0.0;
-  static scalar_t cmy = 0.0;
-  static std::vector<int> IPIV(4,0.0);
-  int * IPIV_ptr = &IPIV[0];
-  static int LWORK = 9;
-  static std::vector<double> WORK(LWORK,0.0);
-  double * WORK_ptr = &WORK[0];
-  static int INFO = 0;
-
-  // clear the storage
-  for(int_t i=0;i<3;++i){
-    for(int_t j=0;j<4;++j){
-      M(j,i) = 0.0;
-      MTMMT(i,j) = 0.0;
-    }
-    for(int_t j=0;j<3;++j)
-      MTM(j,i) = 0.0;
-  }
-  for(int_t i=0;i<4;++i){
-    XYZc0[i] = 0.0;
-    XYZ[i] = 0.0;
-    IPIV[i] = 0;
-    r[i] = 0.0;
-  }
-  for(int_t i=0;i<LWORK;++i)
-    WORK[i] = 0.0;
-
-  // calculate the M matrix
-  M(0,0) = cal_intrinsics_[0][Camera::FX]; // fx0
-  M(0,1) = cal_intrinsics_[0][Camera::FS]; // fs0
-  M(0,2) = cal_intrinsics_[0][Camera::CX] - xc0; // cx1 - xs1
-  M(1,1) = cal_intrinsics_[0][Camera::FY]; // fy1
-  M(1,2) = cal_intrinsics_[0][Camera::CY] - yc0; // cy1 - ys1
-  cmx = cal_intrinsics_[1][Camera::CX] - xc1; // cx2 - xs2
-  cmy = cal_intrinsics_[1][Camera::CY] - yc1; // cy2 - ys2
-  // (cx2-xs2)*R31 + fx2*R11 + fs2*R21
-  M(2,0) = cmx*cam_0_to_cam_1_(2,0) + cal_intrinsics_[1][Camera::FX]*cam_0_to_cam_1_(0,0) + cal_intrinsics_[1][Camera::FS]*cam_0_to_cam_1_(1,0);
-  // (cx2-xs2)*R32 + fx2*R12 + fs2*R22
-  M(2,1) = cmx*cam_0_to_cam_1_(2,1) + cal_intrinsics_[1][Camera::FX]*cam_0_to_cam_1_(0,1) + cal_intrinsics_[1][Camera::FS]*cam_0_to_cam_1_(1,1);
-  // (cx2-xs2)*R33 + fx2*R13 + fs2*R23
-  M(2,2) = cmx*cam_0_to_cam_1_(2,2) + cal_intrinsics_[1][Camera::FX]*cam_0_to_cam_1_(0,2) + cal_intrinsics_[1][Camera::FS]*cam_0_to_cam_1_(1,2);
-  // (cy2-ys2)*R31 + fy2*R21
-  M(3,0) = cmy*cam_0_to_cam_1_(2,0) + cal_intrinsics_[1][Camera::FY]*cam_0_to_cam_1_(1,0);
-  // (cy2-ys2)*R32 + fy2*R22
-  M(3,1) = cmy*cam_0_to_cam_1_(2,1) + cal_intrinsics_[1][Camera::FY]*cam_0_to_cam_1_(1,1);
-  // (cy2-ys2)*R33 + fy2*R23
-  M(3,2) = cmy*cam_0_to_cam_1_(2,2) + cal_intrinsics_[1][Camera::FY]*cam_0_to_cam_1_(1,2);
-  //-fx2tx - fs2ty -(cx2-xs2)*tz
-  r[2] = -cal_intrinsics_[1][Camera::FX]*cam_0_to_cam_1_(0,3) - cal_intrinsics_[1][Camera::FS]*cam_0_to_cam_1_(1,3) - cmx*cam_0_to_cam_1_(2,3);
-  //-fy2ty -(cy2-ys2)*tz
-  r[3] = -cal_intrinsics_[1][Camera::FY]*cam_0_to_cam_1_(1,3) - cmy*cam_0_to_cam_1_(2,3);
-
-//  std::cout << " M matrix: " << std::endl;
-//  for(int_t i=0;i<4;++i){
-//    for(int_t j=0;j<3;++j){
-//      std::cout << M(i,j) << " ";
-//    }
-//    std::cout << std::endl;
-//  }
+  scalar_t max_m = 0.0;
+  triangulate_block(1,&x0,&y0,&x1,&y1,&xc_out,&yc_out,&zc_out,&xw_out,&yw_out,&zw_out,&max_m,correct_lens_distortion);
+  DEBUG_MSG("Triangulation::triangulate(): camera 0 coordinates X " << xc_out << " Y " << yc_out << " Z "  << zc_out);
+  DEBUG_MSG("Triangulation::triangulate(): world coordinates X " << xw_out << " Y " << yw_out << " Z "  << zw_out);
+  return max_m;
+}
 
-  // compute M^TM
-  for(int_t i=0;i<3;++i){
-    for(int_t j=0;j<3;++j){
-      for(int_t k=0;k<4;++k){
-        MTM(i,j) += M(k,i)*M(k,j);
-      }
-    }
+void
+Triangulation::triangulate(const std::vector<scalar_t> & x0,
+  const std::vector<scalar_t> & y0,
+  const std::vector<scalar_t> & x1,
+  const std::vector<scalar_t> & y1,
+  std::vector<scalar_t> & xw_out,
+  std::vector<scalar_t> & yw_out,
+  std::vector<scalar_t> & zw_out,
+  std::vector<scalar_t> * max_m_out,
+  const bool correct_lens_distortion,
+  const Teuchos::RCP<Thread_Pool> & thread_pool) const{
+  TEUCHOS_TEST_FOR_EXCEPTION(cal_intrinsics_.size()<2,std::runtime_error,"Error, triangulation requires the intrinsics of two cameras");
+  TEUCHOS_TEST_FOR_EXCEPTION(y0.size()!=x0.size()||x1.size()!=x0.size()||y1.size()!=x0.size(),std::runtime_error,
+    "Error, the sensor coordinate arrays must all be the same size");
+  const int_t num_points = x0.size();
+  DEBUG_MSG("Triangulation::triangulate(): triangulating " << num_points << " points");
+  xw_out.resize(num_points);
+  yw_out.resize(num_points);
+  zw_out.resize(num_points);
+  if(max_m_out) max_m_out->resize(num_points);
+  if(num_points==0) return;
+
+  const int_t block_size = 256;
+  const int_t num_blocks = (num_points + block_size - 1)/block_size;
+  auto triangulate_one_block = [&](const int_t block, const int_t){
+    const int_t begin = block*block_size;
+    const int_t block_points = std::min(block_size,num_points-begin);
+    // the camera 0 coordinates (and max m if not requested) are only scratch for the batch
+    scalar_t xc[block_size];
+    scalar_t yc[block_size];
+    scalar_t zc[block_size];
+    scalar_t max_m[block_size];
+    triangulate_block(block_points,&x0[begin],&y0[begin],&x1[begin],&y1[begin],xc,yc,zc,
+      &xw_out[begin],&yw_out[begin],&zw_out[begin],max_m_out ? &(*max_m_out)[begin] : max_m,correct_lens_distortion);
+  };
+  if(thread_pool!=Teuchos::null&&thread_pool->num_threads()>1&&num_blocks>1){
+    thread_pool->parallel_for(0,num_blocks,triangulate_one_block);
+  }else{
+    for(int_t block=0;block<num_blocks;++block)
+      triangulate_one_block(block,0);
   }
+}
 
-  // compute the inverse of M^TM
-  lapack.GETRF(3,3,MTM.values(),3,IPIV_ptr,&INFO);
-  try
-  {
-    lapack.GETRI(3,MTM.values(),3,IPIV_ptr,WORK_ptr,LWORK,&INFO);
-  }
-  catch(std::exception &e){
-    std::cout << e.what() << '\n';
-    TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,
-      "Error, could not invert the M matrix in triangulation");
-  }
-  // now MTM is inverted
-  // compute MTM*MT
+void
+Triangulation::triangulate_block(const int_t num_points,
+  const scalar_t * x0,
+  const scalar_t * y0,
+  const scalar_t * x1,
+  const scalar_t * y1,
+  scalar_t * xc_out,
+  scalar_t * yc_out,
+  scalar_t * zc_out,
+  scalar_t * xw_out,
+  scalar_t * yw_out,
+  scalar_t * zw_out,
+  scalar_t * max_m_out,
+  const bool correct_lens_distortion) const{
+  // gather the calibration terms that are the same for all the points
+  const double fx0 = cal_intrinsics_[0][Camera::FX];
+  const double fy0 = cal_intrinsics_[0][Camera::FY];
+  const double fs0 = cal_intrinsics_[0][Camera::FS];
+  const double cx0 = cal_intrinsics_[0][Camera::CX];
+  const double cy0 = cal_intrinsics_[0][Camera::CY];
+  const double fx1 = cal_intrinsics_[1][Camera::FX];
+  const double fy1 = cal_intrinsics_[1][Camera::FY];
+  const double fs1 = cal_intrinsics_[1][Camera::FS];
+  const double cx1 = cal_intrinsics_[1][Camera::CX];
+  const double cy1 = cal_intrinsics_[1][Camera::CY];
+  double R[3][3];
+  double T[3];
+  double W[3][4];
   for(int_t i=0;i<3;++i){
-    for(int_t j=0;j<4;++j){
-      for(int_t k=0;k<3;++k){
-        MTMMT(i,j) += MTM(i,k)*M(j,k);
-      }
-    }
+    for(int_t j=0;j<3;++j)
+      R[i][j] = cam_0_to_cam_1_(i,j);
+    T[i] = cam_0_to_cam_1_(i,3);
+    for(int_t j=0;j<4;++j)
+      W[i][j] = cam_0_to_world_(i,j);
   }
-
-  scalar_t max_m = std::abs(M(0,0));
-  if(std::abs(M(1,1)) > max_m) max_m = std::abs(M(1,1));
-  if(std::abs(M(2,2)) > max_m) max_m = std::abs(M(2,2));
-
-  // compute the 3d point
-  for(int_t i=0;i<3;++i){
-    for(int_t j=0;j<4;++j){
-      XYZc0[i] += MTMMT(i,j)*r[j];
-    }
+  // the parts of the camera 1 rows of M that do not depend on the sensor coordinates:
+  // fx2*R1j + fs2*R2j and fy2*R2j
+  double P[3];
+  double Q[3];
+  for(int_t j=0;j<3;++j){
+    P[j] = fx1*R[0][j] + fs1*R[1][j];
+    Q[j] = fy1*R[1][j];
   }
-  XYZc0[3] = 1.0;
-  xc_out = XYZc0[0];
-  yc_out = XYZc0[1];
-  zc_out = XYZc0[2];
-  DEBUG_MSG("Triangulation::triangulate(): camera 0 coordinates X " << XYZc0[0] << " Y " << XYZc0[1] << " Z "  << XYZc0[2]);
-
-  // apply the camera 0 to world coord transform
-  for(int_t i=0;i<4;++i){
-    for(int_t j=0;j<4;++j){
-      XYZ[i] += cam_0_to_world_(i,j)*XYZc0[j];
+  const double p_t = -fx1*T[0] - fs1*T[1];
+  const double q_t = -fy1*T[1];
+
+  for(int_t p=0;p<num_points;++p){
+    scalar_t xs0 = x0[p];
+    scalar_t ys0 = y0[p];
+    scalar_t xs1 = x1[p];
+    scalar_t ys1 = y1[p];
+    if(correct_lens_distortion){
+      correct_lens_distortion_radial(xs0,ys0,0);
+      correct_lens_distortion_radial(xs1,ys1,1);
     }
+    // the M matrix (4x3), row 0 is [fx0 fs0 cx0-xs0], row 1 is [0 fy0 cy0-ys0]
+    const double m02 = cx0 - xs0;
+    const double m12 = cy0 - ys0;
+    const double cmx = cx1 - xs1; // cx2 - xs2
+    const double cmy = cy1 - ys1; // cy2 - ys2
+    // (cx2-xs2)*R3j + fx2*R1j + fs2*R2j
+    const double m20 = cmx*R[2][0] + P[0];
+    const double m21 = cmx*R[2][1] + P[1];
+    const double m22 = cmx*R[2][2] + P[2];
+    // (cy2-ys2)*R3j + fy2*R2j
+    const double m30 = cmy*R[2][0] + Q[0];
+    const double m31 = cmy*R[2][1] + Q[1];
+    const double m32 = cmy*R[2][2] + Q[2];
+    // the right hand side r = [0 0 -fx2tx-fs2ty-(cx2-xs2)*tz -fy2ty-(cy2-ys2)*tz]
+    const double r2 = p_t - cmx*T[2];
+    const double r3 = q_t - cmy*T[2];
+
+    // M^T*M (symmetric)
+    const double a00 = fx0*fx0 + m20*m20 + m30*m30;
+    const double a01 = fx0*fs0 + m20*m21 + m30*m31;
+    const double a02 = fx0*m02 + m20*m22 + m30*m32;
+    const double a11 = fs0*fs0 + fy0*fy0 + m21*m21 + m31*m31;
+    const double a12 = fs0*m02 + fy0*m12 + m21*m22 + m31*m32;
+    const double a22 = m02*m02 + m12*m12 + m22*m22 + m32*m32;
+    // M^T*r
+    const double b0 = m20*r2 + m30*r3;
+    const double b1 = m21*r2 + m31*r3;
+    const double b2 = m22*r2 + m32*r3;
+    // solve M^T*M*X = M^T*r in closed form using the cofactors
+    const double c00 = a11*a22 - a12*a12;
+    const double c01 = a02*a12 - a01*a22;
+    const double c02 = a01*a12 - a02*a11;
+    const double c11 = a00*a22 - a02*a02;
+    const double c12 = a01*a02 - a00*a12;
+    const double c22 = a00*a11 - a01*a01;
+    const double inv_det = 1.0/(a00*c00 + a01*c01 + a02*c02);
+    const double xc = (c00*b0 + c01*b1 + c02*b2)*inv_det;
+    const double yc = (c01*b0 + c11*b1 + c12*b2)*inv_det;
+    const double zc = (c02*b0 + c12*b1 + c22*b2)*inv_det;
+    xc_out[p] = xc;
+    yc_out[p] = yc;
+    zc_out[p] = zc;
+    max_m_out[p] = std::max(std::abs(fx0),std::max(std::abs(fy0),std::abs(m22)));
+
+    // apply the camera 0 to world coord transform
+    xw_out[p] = W[0][0]*xc + W[0][1]*yc + W[0][2]*zc + W[0][3];
+    yw_out[p] = W[1][0]*xc + W[1][1]*yc + W[1][2]*zc + W[1][3];
+    zw_out[p] = W[2][0]*xc + W[2][1]*yc + W[2][2]*zc + W[2][3];
   }
-  xw_out = XYZ[0];
-  yw_out = XYZ[1];
-  zw_out = XYZ[2];
-  DEBUG_MSG("Triangulation::triangulate(): world coordinates X " << xw_out << " Y " << yw_out << " Z "  << zw_out);
-  return max_m;
 }
 
 void
@@ -844,14 +863,10 @@ Triangulation::correct_lens_distortion_radial(scalar_t & x_s,
   scalar_t & y_s,
   const int_t camera_id) const{
   assert(cal_intrinsics_.size()>0);
-  static scalar_t rho_tilde = 0.0; // = rho^2
-  static scalar_t r1 = 0.0;
-  static scalar_t r2 = 0.0;
-  static scalar_t factor = 0.0;
-  r1 = (x_s-cal_intrinsics_[camera_id][Camera::CX])/cal_intrinsics_[camera_id][Camera::CX]; // tested above to see that cx > 0 and cy > 0 when cal parameters loaded
-  r2 = (y_s-cal_intrinsics_[camera_id][Camera::CY])/cal_intrinsics_[camera_id][Camera::CY];
-  rho_tilde = r1*r1 + r2*r2;
-  factor = (cal_intrinsics_[camera_id][Camera::K1]*rho_tilde + cal_intrinsics_[camera_id][Camera::K2]*rho_tilde*rho_tilde
+  const scalar_t r1 = (x_s-cal_intrinsics_[camera_id][Camera::CX])/cal_intrinsics_[camera_id][Camera::CX]; // tested above to see that cx > 0 and cy > 0 when cal parameters loaded
+  const scalar_t r2 = (y_s-cal_intrinsics_[camera_id][Camera::CY])/cal_intrinsics_[camera_id][Camera::CY];
+  const scalar_t rho_tilde = r1*r1 + r2*r2; // = rho^2
+  const scalar_t factor = (cal_intrinsics_[camera_id][Camera::K1]*rho_tilde + cal_intrinsics_[camera_id][Camera::K2]*rho_tilde*rho_tilde
       + cal_intrinsics_[camera_id][Camera::K3]*rho_tilde*rho_tilde*rho_tilde);
   //DEBUG_MSG("Triangulation::correct_lens_distortion(): corrections x " << factor*r1*cal_intrinsics_[camera_id][0] << " y " << factor*r2*cal_intrinsics_[camera_id][1]);
   x_s = x_s - factor*r1*cal_intrinsics_[camera_id][Camera::CX];
@@ -1181,7 +1196,7 @@ Triangulation::estimate_projective_transform(Teuchos::RCP<Image> left_img,
     int WINFO = 0;
     double *WWORK = new double[WLWORK];
     // invert the WKTK matrix
-    static Teuchos::LAPACK<int_t,double> lapack;
+    Teuchos::LAPACK<int_t,double> lapack;
     lapack.GETRF(WKTK.numRows(),WKTK.numCols(),WKTK.values(),WKTK.numRows(),WIPIV,&WINFO);
     lapack.GETRI(WKTK.numRows(),WKTK.values(),WKTK.numRows(),WIPIV,WWORK,WLWORK,&WINFO);
     // compute K^T*F
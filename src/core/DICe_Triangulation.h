@@ -47,6 +47,7 @@
 #include <DICe_Matrix.h>
 #include <DICe_Camera.h>
 #include <DICe_CameraSystem.h>
+#include <DICe_ThreadPool.h>
 #ifdef DICE_TPETRA
   #include "DICe_MultiFieldTpetra.h"
 #else
@@ -194,6 +195,33 @@ public:
     std::vector<scalar_t> & yw_out,
     std::vector<scalar_t> & zw_out) const;
 
+  /// \brief triangulate a batch of stereo points in 3D
+  ///
+  /// Gives the same result as calling the single point triangulate() for each point, but the
+  /// calibration terms are gathered once for the batch and the points are processed in blocks
+  /// (in parallel if a thread pool is given). This method has no shared state so it can be called
+  /// from several threads at once.
+  /// \param x0 sensor x coordinates of the points in camera 0
+  /// \param y0 sensor y coordinates of the points in camera 0
+  /// \param x1 sensor x coordinates of the points in camera 1
+  /// \param y1 sensor y coordinates of the points in camera 1
+  /// \param xw_out global x positions in world coords (resized to the number of points)
+  /// \param yw_out global y positions in world coords (resized to the number of points)
+  /// \param zw_out global z positions in world coords (resized to the number of points)
+  /// \param max_m_out if not null, the max value of the psuedo matrix for each point (resized to the number of points)
+  /// \param correct_lens_distortion correct for lens distortion
+  /// \param thread_pool if not null, the pool used to triangulate the blocks of points in parallel
+  void triangulate(const std::vector<scalar_t> & x0,
+    const std::vector<scalar_t> & y0,
+    const std::vector<scalar_t> & x1,
+    const std::vector<scalar_t> & y1,
+    std::vector<scalar_t> & xw_out,
+    std::vector<scalar_t> & yw_out,
+    std::vector<scalar_t> & zw_out,
+    std::vector<scalar_t> * max_m_out,
+    const bool correct_lens_distortion = false,
+    const Teuchos::RCP<Thread_Pool> & thread_pool = Teuchos::null) const;
+
   /// compute the fundamental matrix and return it as an opencv mat
   cv::Mat fundamental_matrix() const{
     DICe::Matrix<DICe::scalar_t,3> F = camera_system_->fundamental_matrix();
@@ -303,6 +331,22 @@ private:
   /// \param param_file_name File name of the cal parameters file
   void load_calibration_parameters(const std::string & param_file_name);
 
+  /// \brief triangulate a block of points, see triangulate() for the arguments
+  /// \param num_points the number of points in the block, all of the arrays must hold at least this many values
+  void triangulate_block(const int_t num_points,
+    const scalar_t * x0,
+    const scalar_t * y0,
+    const scalar_t * x1,
+    const scalar_t * y1,
+    scalar_t * xc_out,
+    scalar_t * yc_out,
+    scalar_t * zc_out,
+    scalar_t * xw_out,
+    scalar_t * yw_out,
+    scalar_t * zw_out,
+    scalar_t * max_m_out,
+    const bool correct_lens_distortion) const;
+
   /// vector camera intrinsics vectors, one for camera 0 and one for camera 1
   /// See Camera::Cam_Intrinsic_Param for the ordering of the parameters in the vector
   std::vector<std::vector<scalar_t> > cal_intrinsics_;
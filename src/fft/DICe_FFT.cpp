@@ -44,6 +44,7 @@
 #include <Teuchos_ArrayRCP.hpp>
 
 #include <cassert>
+#include <cmath>
 
 namespace DICe {
 
@@ -287,6 +288,292 @@ DICE_LIB_DLL_EXPORT
 scalar_t phase_correlate_x_y(Teuchos::RCP<Scalar_Image>,Teuchos::RCP<Scalar_Image>,scalar_t &,scalar_t &,const bool);
 #endif
 
+Phase_Correlator::Phase_Correlator(const int_t width,
+  const int_t height,
+  const bool hamming_filter):
+  w_(width),
+  h_(height),
+  half_w_(width/2+1),
+  hamming_filter_(hamming_filter),
+  has_reference_(false),
+  row_forward_(NULL),
+  row_inverse_(NULL),
+  col_forward_(NULL),
+  col_inverse_(NULL){
+  TEUCHOS_TEST_FOR_EXCEPTION(w_<=8||h_<=8,std::invalid_argument,"Error, phase correlation window is too small: " << w_ << " x " << h_);
+  row_forward_ = kiss_fft_alloc(w_,0,0,0);
+  row_inverse_ = kiss_fft_alloc(w_,1,0,0);
+  col_forward_ = kiss_fft_alloc(h_,0,0,0);
+  col_inverse_ = kiss_fft_alloc(h_,1,0,0);
+  hamming_x_.resize(w_,1.0);
+  hamming_y_.resize(h_,1.0);
+  if(hamming_filter_){
+    for(int_t i=0;i<w_;++i)
+      hamming_x_[i] = 0.54 - 0.46*std::cos(DICE_TWOPI*i/(w_-1));
+    for(int_t i=0;i<h_;++i)
+      hamming_y_[i] = 0.54 - 0.46*std::cos(DICE_TWOPI*i/(h_-1));
+  }
+  intensities_.resize(w_*h_,0.0);
+  ref_intensities_.resize(w_*h_,0.0);
+  surface_.resize(w_*h_,0.0);
+  kiss_fft_cpx zero;
+  zero.r = 0.0;
+  zero.i = 0.0;
+  ref_spectrum_.resize(h_*half_w_,zero);
+  spectrum_.resize(h_*half_w_,zero);
+  row_.resize(w_,zero);
+  row_out_.resize(w_,zero);
+  col_.resize(h_,zero);
+  col_out_.resize(h_,zero);
+}
+
+Phase_Correlator::~Phase_Correlator(){
+  free(row_forward_);
+  free(row_inverse_);
+  free(col_forward_);
+  free(col_inverse_);
+}
+
+template <typename S>
+void
+Phase_Correlator::load_window(const Image_<S> & image,
+  const int_t origin_x,
+  const int_t origin_y){
+  TEUCHOS_TEST_FOR_EXCEPTION(origin_x<0||origin_y<0||origin_x+w_>image.width()||origin_y+h_>image.height(),std::invalid_argument,
+    "Error, phase correlation window (" << origin_x << "," << origin_y << ") " << w_ << " x " << h_ <<
+    " is not inside the image " << image.width() << " x " << image.height());
+  for(int_t y=0;y<h_;++y)
+    for(int_t x=0;x<w_;++x)
+      intensities_[y*w_+x] = image(origin_x+x,origin_y+y);
+}
+
+void
+Phase_Correlator::forward(kiss_fft_cpx * spectrum){
+  // two real rows are transformed at once as the real and imaginary parts of one complex row,
+  // the two spectra are then separated using the symmetry of the transform of a real signal
+  for(int_t y=0;y<h_;y+=2){
+    const bool pair = y+1<h_;
+    for(int_t x=0;x<w_;++x){
+      row_[x].r = intensities_[y*w_+x]*hamming_x_[x]*hamming_y_[y];
+      row_[x].i = pair ? intensities_[(y+1)*w_+x]*hamming_x_[x]*hamming_y_[y+1] : 0.0;
+    }
+    kiss_fft(row_forward_,&row_[0],&row_out_[0]);
+    for(int_t k=0;k<half_w_;++k){
+      const kiss_fft_cpx & z = row_out_[k];
+      const kiss_fft_cpx & z_conj = row_out_[(w_-k)%w_];
+      spectrum[y*half_w_+k].r = 0.5*(z.r + z_conj.r);
+      spectrum[y*half_w_+k].i = 0.5*(z.i - z_conj.i);
+      if(pair){
+        spectrum[(y+1)*half_w_+k].r = 0.5*(z.i + z_conj.i);
+        spectrum[(y+1)*half_w_+k].i = 0.5*(z_conj.r - z.r);
+      }
+    }
+  }
+  // only the non-redundant columns are transformed
+  for(int_t k=0;k<half_w_;++k){
+    for(int_t y=0;y<h_;++y)
+      col_[y] = spectrum[y*half_w_+k];
+    kiss_fft(col_forward_,&col_[0],&col_out_[0]);
+    for(int_t y=0;y<h_;++y)
+      spectrum[y*half_w_+k] = col_out_[y];
+  }
+}
+
+void
+Phase_Correlator::inverse(){
+  for(int_t k=0;k<half_w_;++k){
+    for(int_t y=0;y<h_;++y)
+      col_[y] = spectrum_[y*half_w_+k];
+    kiss_fft(col_inverse_,&col_[0],&col_out_[0]);
+    for(int_t y=0;y<h_;++y)
+      spectrum_[y*half_w_+k] = col_out_[y];
+  }
+  // each row is now the spectrum of a real row, the missing half is the conjugate of the stored half
+  // and two rows are inverted at once as the real and imaginary parts of one complex row
+  const scalar_t scale = 1.0/(w_*h_);
+  for(int_t y=0;y<h_;y+=2){
+    const bool pair = y+1<h_;
+    for(int_t k=0;k<w_;++k){
+      const bool stored = k<half_w_;
+      const int_t j = stored ? k : w_-k;
+      const scalar_t sign = stored ? 1.0 : -1.0;
+      const kiss_fft_cpx & a = spectrum_[y*half_w_+j];
+      row_[k].r = a.r;
+      row_[k].i = sign*a.i;
+      if(pair){
+        const kiss_fft_cpx & b = spectrum_[(y+1)*half_w_+j];
+        // add i times the spectrum of the second row
+        row_[k].r -= sign*b.i;
+        row_[k].i += b.r;
+      }
+    }
+    kiss_fft(row_inverse_,&row_[0],&row_out_[0]);
+    for(int_t x=0;x<w_;++x){
+      surface_[y*w_+x] = row_out_[x].r*scale;
+      if(pair)
+        surface_[(y+1)*w_+x] = row_out_[x].i*scale;
+    }
+  }
+}
+
+scalar_t
+Phase_Correlator::find_peak(scalar_t & u_x,
+  scalar_t & u_y)const{
+  // same peak selection as phase_correlate_x_y()
+  scalar_t max_real = 0.0;
+  scalar_t next_real = 0.0;
+  int_t peak_x = 0;
+  int_t peak_y = 0;
+  int_t next_x = 0;
+  int_t next_y = 0;
+  for(int_t y=0;y<h_;++y){
+    for(int_t x=0;x<w_;++x){
+      const scalar_t test_real = std::abs(surface_[y*w_+x]);
+      if(test_real > max_real){
+        max_real = test_real;
+        peak_x = x;
+        peak_y = y;
+      }
+      if(x==0&&y==0) continue;
+      if(test_real > next_real){
+        next_real = test_real;
+        next_x = x;
+        next_y = y;
+      }
+    }
+  }
+  // deal with aliasing (which causes a false peak at 0,0)
+  if(peak_x!=next_x&&next_x>1){
+    peak_x = next_x;
+    max_real = next_real;
+  }
+  if(peak_y!=next_y&&next_y>1){
+    peak_y = next_y;
+    max_real = next_real;
+  }
+  // three point parabola fit through the peak and its (periodic) neighbors
+  const scalar_t center = std::abs(surface_[peak_y*w_+peak_x]);
+  scalar_t sub_x = 0.0;
+  const scalar_t left = std::abs(surface_[peak_y*w_+(peak_x+w_-1)%w_]);
+  const scalar_t right = std::abs(surface_[peak_y*w_+(peak_x+1)%w_]);
+  const scalar_t denom_x = left - 2.0*center + right;
+  if(denom_x<0.0)
+    sub_x = 0.5*(left-right)/denom_x;
+  scalar_t sub_y = 0.0;
+  const scalar_t up = std::abs(surface_[((peak_y+h_-1)%h_)*w_+peak_x]);
+  const scalar_t down = std::abs(surface_[((peak_y+1)%h_)*w_+peak_x]);
+  const scalar_t denom_y = up - 2.0*center + down;
+  if(denom_y<0.0)
+    sub_y = 0.5*(up-down)/denom_y;
+  if(std::abs(sub_x)>0.5) sub_x = 0.0;
+  if(std::abs(sub_y)>0.5) sub_y = 0.0;
+  // convert back to image coordinates
+  u_x = peak_x >= w_/2 ? w_ - peak_x - sub_x : -peak_x - sub_x;
+  u_y = peak_y >= h_/2 ? h_ - peak_y - sub_y : -peak_y - sub_y;
+  return max_real;
+}
+
+template <typename S>
+void
+Phase_Correlator::set_reference(const Image_<S> & image,
+  const int_t origin_x,
+  const int_t origin_y){
+  load_window(image,origin_x,origin_y);
+  forward(&ref_spectrum_[0]);
+  ref_intensities_.swap(intensities_);
+  has_reference_ = true;
+}
+
+template <typename S>
+bool
+Phase_Correlator::reference_matches(const Image_<S> & image,
+  const int_t origin_x,
+  const int_t origin_y)const{
+  if(!has_reference_) return false;
+  if(origin_x<0||origin_y<0||origin_x+w_>image.width()||origin_y+h_>image.height()) return false;
+  for(int_t y=0;y<h_;++y)
+    for(int_t x=0;x<w_;++x)
+      if(ref_intensities_[y*w_+x]!=(scalar_t)image(origin_x+x,origin_y+y)) return false;
+  return true;
+}
+
+template <typename S>
+scalar_t
+Phase_Correlator::correlate(const Image_<S> & image,
+  scalar_t & u_x,
+  scalar_t & u_y,
+  const int_t origin_x,
+  const int_t origin_y,
+  const bool keep_as_reference){
+  TEUCHOS_TEST_FOR_EXCEPTION(!has_reference_,std::runtime_error,"Error, the phase correlation reference has not been set");
+  u_x = 0.0;
+  u_y = 0.0;
+  load_window(image,origin_x,origin_y);
+
+  // test that the windows don't have the same intensities (see phase_correlate_x_y())
+  const scalar_t diff_tol = 50.0;
+  scalar_t diff = 0.0;
+  for(int_t i=0;i<w_*h_;++i)
+    diff += (intensities_[i]-ref_intensities_[i])*(intensities_[i]-ref_intensities_[i]);
+  diff = std::sqrt(diff);
+  DEBUG_MSG("Phase_Correlator::correlate(): image diff test result: " << diff);
+  if(diff < diff_tol){
+    DEBUG_MSG("Phase_Correlator::correlate(): skipping phase correlation because images are the same.");
+    if(keep_as_reference){
+      forward(&ref_spectrum_[0]);
+      ref_intensities_.swap(intensities_);
+    }
+    return -1.0;
+  }
+
+  forward(&spectrum_[0]);
+  if(keep_as_reference)
+    ref_intensities_.swap(intensities_);
+
+  // normalized cross power spectrum, reference times the conjugate of the image
+  for(int_t i=0;i<h_*half_w_;++i){
+    const kiss_fft_cpx & a = ref_spectrum_[i];
+    kiss_fft_cpx & b = spectrum_[i];
+    const scalar_t r = a.r*b.r + a.i*b.i;
+    const scalar_t c = a.i*b.r - a.r*b.i;
+    const scalar_t mag = std::sqrt(r*r + c*c);
+    if(keep_as_reference)
+      ref_spectrum_[i] = b;
+    b.r = mag > 0.0 ? r/mag : 0.0;
+    b.i = mag > 0.0 ? c/mag : 0.0;
+  }
+  inverse();
+  return find_peak(u_x,u_y);
+}
+
+template <typename S>
+void
+Phase_Correlator::correlate_windows(const Image_<S> & ref,
+  const Image_<S> & def,
+  const int_t num_windows,
+  const int_t * origin_x,
+  const int_t * origin_y,
+  scalar_t * u_x,
+  scalar_t * u_y,
+  scalar_t * peak){
+  for(int_t i=0;i<num_windows;++i){
+    set_reference(ref,origin_x[i],origin_y[i]);
+    const scalar_t peak_value = correlate(def,u_x[i],u_y[i],origin_x[i],origin_y[i]);
+    if(peak) peak[i] = peak_value;
+  }
+}
+
+template DICE_LIB_DLL_EXPORT void Phase_Correlator::set_reference(const Image &,const int_t,const int_t);
+template DICE_LIB_DLL_EXPORT bool Phase_Correlator::reference_matches(const Image &,const int_t,const int_t)const;
+template DICE_LIB_DLL_EXPORT scalar_t Phase_Correlator::correlate(const Image &,scalar_t &,scalar_t &,const int_t,const int_t,const bool);
+template DICE_LIB_DLL_EXPORT void Phase_Correlator::correlate_windows(const Image &,const Image &,const int_t,const int_t *,const int_t *,scalar_t *,scalar_t *,scalar_t *);
+#ifndef STORAGE_SCALAR_SAME_TYPE
+template DICE_LIB_DLL_EXPORT void Phase_Correlator::set_reference(const Scalar_Image &,const int_t,const int_t);
+template DICE_LIB_DLL_EXPORT bool Phase_Correlator::reference_matches(const Scalar_Image &,const int_t,const int_t)const;
+template DICE_LIB_DLL_EXPORT scalar_t Phase_Correlator::correlate(const Scalar_Image &,scalar_t &,scalar_t &,const int_t,const int_t,const bool);
+template DICE_LIB_DLL_EXPORT void Phase_Correlator::correlate_windows(const Scalar_Image &,const Scalar_Image &,const int_t,const int_t *,const int_t *,scalar_t *,scalar_t *,scalar_t *);
+#endif
+
 
 DICE_LIB_DLL_EXPORT
 void
@@ -48,6 +48,7 @@
 #include <Teuchos_ArrayRCP.hpp>
 
 #include <cassert>
+#include <vector>
 
 namespace DICe {
 
@@ -116,6 +117,170 @@ phase_correlate_x_y(Teuchos::RCP<Image_<S>> image_a,
   scalar_t & u_y,
   const bool convert_to_r_theta=false);
 
+/// \class DICe::Phase_Correlator
+/// \brief Phase correlation of images (or windows of images) that all have the same size
+///
+/// The FFT plans, the hamming windows and all of the work buffers are allocated once in the constructor
+/// and the windowed spectrum of the reference image is kept between calls, so correlating an image against
+/// the reference costs one forward and one inverse transform. The images are real, so the transforms pack two
+/// rows into one complex row FFT and only the non-redundant w/2+1 columns of the spectrum are transformed
+/// along the columns. The integer peak is found the same way as phase_correlate_x_y() and is then
+/// refined with a three point parabola fit in each direction.
+class DICE_LIB_DLL_EXPORT
+Phase_Correlator{
+public:
+  /// \brief Constructor
+  /// \param width the width of the images or windows to correlate
+  /// \param height the height of the images or windows to correlate
+  /// \param hamming_filter true if a hamming filter should be applied before the transform
+  Phase_Correlator(const int_t width,
+    const int_t height,
+    const bool hamming_filter=true);
+
+  /// destructor
+  ~Phase_Correlator();
+
+  /// no copies allowed
+  Phase_Correlator(const Phase_Correlator &) = delete;
+  /// no copies allowed
+  Phase_Correlator & operator=(const Phase_Correlator &) = delete;
+
+  /// returns the width of the correlation window
+  int_t width()const{
+    return w_;
+  }
+
+  /// returns the height of the correlation window
+  int_t height()const{
+    return h_;
+  }
+
+  /// returns true if a reference spectrum has been set
+  bool has_reference()const{
+    return has_reference_;
+  }
+
+  /// \brief Transform a window of an image and store it as the reference
+  /// \param image the image
+  /// \param origin_x the x coordinate of the upper left corner of the window
+  /// \param origin_y the y coordinate of the upper left corner of the window
+  template <typename S>
+  void set_reference(const Image_<S> & image,
+    const int_t origin_x=0,
+    const int_t origin_y=0);
+
+  /// \brief Returns true if a window of an image has exactly the intensities of the reference
+  ///
+  /// This is much cheaper than a transform, so it can be used to skip set_reference() for an image
+  /// that was already transformed (for example by correlate() with keep_as_reference)
+  /// \param image the image
+  /// \param origin_x the x coordinate of the upper left corner of the window
+  /// \param origin_y the y coordinate of the upper left corner of the window
+  template <typename S>
+  bool reference_matches(const Image_<S> & image,
+    const int_t origin_x=0,
+    const int_t origin_y=0)const;
+
+  /// \brief Phase correlate a window of an image against the reference
+  ///
+  /// The return value is the peak value of the correlation surface (1.0 for a pure translation),
+  /// or -1.0 if the window has the same intensities as the reference (in which case u_x and u_y are zero)
+  /// \param image the image
+  /// \param u_x [out] the displacement in x of the image relative to the reference
+  /// \param u_y [out] the displacement in y of the image relative to the reference
+  /// \param origin_x the x coordinate of the upper left corner of the window
+  /// \param origin_y the y coordinate of the upper left corner of the window
+  /// \param keep_as_reference true if the spectrum of this window should replace the reference afterwards
+  /// (useful for image sequences where each frame is correlated with the one before it)
+  template <typename S>
+  scalar_t correlate(const Image_<S> & image,
+    scalar_t & u_x,
+    scalar_t & u_y,
+    const int_t origin_x=0,
+    const int_t origin_y=0,
+    const bool keep_as_reference=false);
+
+  /// \brief Phase correlate many windows of two images
+  ///
+  /// Each window of the reference image becomes the reference in turn, so the reference
+  /// set before the call is replaced by the last window
+  /// \param ref the reference image
+  /// \param def the image to correlate with the reference image
+  /// \param num_windows the number of windows
+  /// \param origin_x the x coordinates of the upper left corners of the windows
+  /// \param origin_y the y coordinates of the upper left corners of the windows
+  /// \param u_x [out] the displacement in x for each window
+  /// \param u_y [out] the displacement in y for each window
+  /// \param peak [out] the return value of correlate() for each window (can be null)
+  template <typename S>
+  void correlate_windows(const Image_<S> & ref,
+    const Image_<S> & def,
+    const int_t num_windows,
+    const int_t * origin_x,
+    const int_t * origin_y,
+    scalar_t * u_x,
+    scalar_t * u_y,
+    scalar_t * peak=NULL);
+
+private:
+  /// copy a window of an image into intensities_, throws if the window is not inside the image
+  template <typename S>
+  void load_window(const Image_<S> & image,
+    const int_t origin_x,
+    const int_t origin_y);
+
+  /// forward transform of intensities_ (with the hamming filter if enabled) into the h x (w/2+1) spectrum
+  void forward(kiss_fft_cpx * spectrum);
+
+  /// inverse transform of spectrum_ into the w x h real surface_ (spectrum_ is overwritten)
+  void inverse();
+
+  /// find the (subpixel) peak of surface_ and convert it to a displacement
+  scalar_t find_peak(scalar_t & u_x,
+    scalar_t & u_y)const;
+
+  /// width
+  int_t w_;
+  /// height
+  int_t h_;
+  /// number of non-redundant columns of the spectrum
+  int_t half_w_;
+  /// true if the hamming filter is applied
+  bool hamming_filter_;
+  /// true if the reference has been set
+  bool has_reference_;
+  /// forward plan for the rows
+  kiss_fft_cfg row_forward_;
+  /// inverse plan for the rows
+  kiss_fft_cfg row_inverse_;
+  /// forward plan for the columns
+  kiss_fft_cfg col_forward_;
+  /// inverse plan for the columns
+  kiss_fft_cfg col_inverse_;
+  /// hamming window in x
+  std::vector<scalar_t> hamming_x_;
+  /// hamming window in y
+  std::vector<scalar_t> hamming_y_;
+  /// intensities of the current window
+  std::vector<scalar_t> intensities_;
+  /// intensities of the reference window (used to skip identical images)
+  std::vector<scalar_t> ref_intensities_;
+  /// windowed spectrum of the reference
+  std::vector<kiss_fft_cpx> ref_spectrum_;
+  /// spectrum of the current window
+  std::vector<kiss_fft_cpx> spectrum_;
+  /// input buffer for the row transforms
+  std::vector<kiss_fft_cpx> row_;
+  /// output buffer for the row transforms (kiss_fft allocates a temporary for in place transforms)
+  std::vector<kiss_fft_cpx> row_out_;
+  /// input buffer for the column transforms
+  std::vector<kiss_fft_cpx> col_;
+  /// output buffer for the column transforms
+  std::vector<kiss_fft_cpx> col_out_;
+  /// correlation surface
+  std::vector<scalar_t> surface_;
+};
+
 /// Phase correlate a single row from two images
 /// \param image_a the first image
 /// \param image_b the second image
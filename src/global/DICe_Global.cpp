@@ -52,6 +52,59 @@ namespace DICe {
 
 namespace global{
 
+namespace {
+
+/// scratch storage for the computations of one element, each assembly thread has its own
+struct Element_Scratch{
+  Element_Scratch(const Teuchos::RCP<DICe::mesh::Shape_Function_Evaluator> & evaluator,
+    const int_t spa_dim,
+    const int_t natural_coord_dim):
+    shape_func_evaluator(evaluator),
+    N(evaluator->num_functions()),
+    DN(evaluator->num_functions()*spa_dim),
+    node_ids(evaluator->num_functions()),
+    nodal_coords(evaluator->num_functions()*spa_dim),
+    nodal_disp(evaluator->num_functions()*spa_dim),
+    jac(spa_dim*spa_dim),
+    inv_jac(spa_dim*spa_dim),
+    natural_coords(natural_coord_dim),
+    elem_stiffness(evaluator->num_functions()*spa_dim*evaluator->num_functions()*spa_dim),
+    elem_div_stiffness(evaluator->num_functions()*spa_dim*evaluator->num_functions()),
+    elem_stab_stiffness(evaluator->num_functions()*evaluator->num_functions()),
+    elem_force(evaluator->num_functions()*spa_dim),
+    elem_gray_diff(evaluator->num_functions()){}
+  Teuchos::RCP<DICe::mesh::Shape_Function_Evaluator> shape_func_evaluator;
+  std::vector<precision_t> N;
+  std::vector<precision_t> DN;
+  std::vector<int_t> node_ids;
+  std::vector<precision_t> nodal_coords;
+  std::vector<precision_t> nodal_disp;
+  std::vector<precision_t> jac;
+  std::vector<precision_t> inv_jac;
+  std::vector<precision_t> natural_coords;
+  std::vector<precision_t> elem_stiffness;
+  std::vector<precision_t> elem_div_stiffness;
+  std::vector<precision_t> elem_stab_stiffness;
+  std::vector<precision_t> elem_force;
+  std::vector<precision_t> elem_gray_diff;
+};
+
+/// create the scratch storage for each of the given number of threads
+std::vector<Element_Scratch> create_element_scratch(const int_t num_threads,
+  const DICe::mesh::Base_Element_Type element_type,
+  const int_t spa_dim,
+  const int_t natural_coord_dim){
+  // using P2-P1 element for velocity pressure, or P2 velocity if no constraint
+  DICe::mesh::Shape_Function_Evaluator_Factory shape_func_eval_factory;
+  std::vector<Element_Scratch> scratch;
+  for(int_t t=0;t<num_threads;++t)
+    scratch.push_back(Element_Scratch(element_type==DICe::mesh::TRI6 ? shape_func_eval_factory.create(DICe::mesh::TRI6):
+        shape_func_eval_factory.create(DICe::mesh::TRI3),spa_dim,natural_coord_dim));
+  return scratch;
+}
+
+}
+
 Global_Algorithm::Global_Algorithm(Schema * schema,
   const Teuchos::RCP<Teuchos::ParameterList> & params):
   schema_(schema),
@@ -65,7 +118,8 @@ Global_Algorithm::Global_Algorithm(Schema * schema,
   max_iterations_(25),
   element_type_(DICe::mesh::TRI6),
   use_fixed_point_iterations_(false),
-  stabilization_tau_(-1.0)
+  stabilization_tau_(-1.0),
+  num_threads_(1)
 {
   TEUCHOS_TEST_FOR_EXCEPTION(!schema,std::runtime_error,"Error, cannot have null schema in this constructor");
   default_constructor_tasks(params);
@@ -82,7 +136,8 @@ Global_Algorithm::Global_Algorithm(const Teuchos::RCP<Teuchos::ParameterList> &
   max_iterations_(25),
   element_type_(DICe::mesh::TRI6),
   use_fixed_point_iterations_(false),
-  stabilization_tau_(-1.0)
+  stabilization_tau_(-1.0),
+  num_threads_(1)
 {
   default_constructor_tasks(params);
 }
@@ -102,6 +157,18 @@ Global_Algorithm::default_constructor_tasks(const Teuchos::RCP<Teuchos::Paramete
 
   max_iterations_ = params->get<int_t>(DICe::max_solver_iterations_fast,25);
 
+  // with a schema the element assembly uses the schema's thread pool
+  if(!schema_){
+    num_threads_ = params->get<int_t>(DICe::num_threads,1);
+    TEUCHOS_TEST_FOR_EXCEPTION(num_threads_<0,std::runtime_error,"Error, num_threads must be 0 (use all hardware threads) or greater");
+    if(num_threads_==0) num_threads_ = Thread_Pool::hardware_threads();
+#ifndef HAVE_TEUCHOS_THREAD_SAFE
+    // the element computations copy Teuchos::RCPs, which are only thread safe if Trilinos was built with thread safety enabled
+    num_threads_ = 1;
+#endif
+    DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): num threads: " << num_threads_);
+  }
+
   global_solver_ = params->get<Global_Solver>(DICe::global_solver,CG_SOLVER);
   DEBUG_MSG("Global_Algorithm::default_constructor_tasks(): global solver type: " << to_string(global_solver_));
 
@@ -408,66 +475,112 @@ Global_Algorithm::pre_execution_tasks(){
   is_initialized_ = true;
 }
 
+const std::vector<std::vector<int_t> > &
+Global_Algorithm::element_colors(){
+  if(!element_colors_.empty()) return element_colors_;
+  TEUCHOS_TEST_FOR_EXCEPTION(mesh_==Teuchos::null,std::runtime_error,"Error, the mesh has not been created");
+  // greedy coloring in element order: each element gets the lowest color not already taken by an element
+  // that shares one of its nodes
+  const DICe::mesh::element_set & elements = *mesh_->get_element_set();
+  std::vector<std::vector<int_t> > node_colors(mesh_->get_scalar_node_overlap_map()->get_num_local_elements());
+  std::vector<bool> taken;
+  for(size_t elem=0;elem<elements.size();++elem){
+    const DICe::mesh::connectivity_vector & connectivity = *elements[elem]->connectivity();
+    taken.assign(element_colors_.size()+1,false);
+    for(size_t nd=0;nd<connectivity.size();++nd){
+      const std::vector<int_t> & colors = node_colors[connectivity[nd]->overlap_local_id()];
+      for(size_t i=0;i<colors.size();++i)
+        taken[colors[i]] = true;
+    }
+    const size_t color = std::find(taken.begin(),taken.end(),false) - taken.begin();
+    if(color==element_colors_.size())
+      element_colors_.push_back(std::vector<int_t>());
+    element_colors_[color].push_back(elem);
+    for(size_t nd=0;nd<connectivity.size();++nd)
+      node_colors[connectivity[nd]->overlap_local_id()].push_back(color);
+  }
+  DEBUG_MSG("Global_Algorithm::element_colors(): " << elements.size() << " elements in " << element_colors_.size() << " colors");
+  return element_colors_;
+}
+
+Teuchos::RCP<Thread_Pool>
+Global_Algorithm::assembly_thread_pool(){
+  if(schema_)
+    return schema_->thread_pool();
+  if(num_threads_>1&&thread_pool_==Teuchos::null)
+    thread_pool_ = Teuchos::rcp(new Thread_Pool(num_threads_));
+  return thread_pool_;
+}
+
+template <typename F>
+void
+Global_Algorithm::for_each_element(const F & func){
+  Teuchos::RCP<Thread_Pool> pool = assembly_thread_pool();
+  if(pool==Teuchos::null){
+    const int_t num_elem = mesh_->get_element_set()->size();
+    for(int_t elem=0;elem<num_elem;++elem)
+      func(elem,0);
+    return;
+  }
+  const std::vector<std::vector<int_t> > & colors = element_colors();
+  for(size_t color=0;color<colors.size();++color){
+    const std::vector<int_t> & elems = colors[color];
+    pool->parallel_for(0,elems.size(),[&](const int_t i, const int_t thread_id){
+      func(elems[i],thread_id);
+    },8);
+  }
+}
+
 Teuchos::RCP<DICe::MultiField_Matrix>
 Global_Algorithm::compute_tangent(const bool use_fixed_point){
 
   DEBUG_MSG("Global_Algorithm::compute_tangent(): Computing the tangent matrix");
   const int_t spa_dim = mesh_->spatial_dimension();
-  const int_t relations_size = mesh_->max_num_node_relations();
-  Teuchos::RCP<DICe::MultiField_Matrix> tangent;
-  if(is_mixed_formulation())
-    tangent = Teuchos::rcp(new DICe::MultiField_Matrix(*mesh_->get_mixed_vector_node_dist_map(),relations_size));
-  else
-    tangent = Teuchos::rcp(new DICe::MultiField_Matrix(*mesh_->get_vector_node_dist_map(),relations_size));
-  DEBUG_MSG("Global_Algorithm::execute(): Tangent has been allocated.");
   const int_t mgo = mixed_global_offset();
   DEBUG_MSG("Global_Algorithm::compute_tangent(): mixed global offset: " << mgo);
-
-  // assemble the distributed tangent matrix
-  Teuchos::RCP<DICe::MultiField_Matrix> tangent_overlap;
-  if(is_mixed_formulation())
-    tangent_overlap = Teuchos::rcp(new DICe::MultiField_Matrix(*mesh_->get_mixed_vector_node_overlap_map(),relations_size));
-  else
-    tangent_overlap = Teuchos::rcp(new DICe::MultiField_Matrix(*mesh_->get_vector_node_overlap_map(),relations_size));
+  Teuchos::RCP<MultiField_Map> overlap_map = is_mixed_formulation() ? mesh_->get_mixed_vector_node_overlap_map() :
+      mesh_->get_vector_node_overlap_map();
+
+  // the sparsity pattern only depends on the mesh connectivity and the boundary conditions so the
+  // graphs are built the first time the tangent is computed and only the values are refilled after that
+  const bool build_graph = tangent_==Teuchos::null;
+  if(build_graph){
+    const int_t relations_size = mesh_->max_num_node_relations();
+    if(is_mixed_formulation()){
+      tangent_ = Teuchos::rcp(new DICe::MultiField_Matrix(*mesh_->get_mixed_vector_node_dist_map(),relations_size));
+      tangent_overlap_ = Teuchos::rcp(new DICe::MultiField_Matrix(*mesh_->get_mixed_vector_node_overlap_map(),relations_size));
+    }
+    else{
+      tangent_ = Teuchos::rcp(new DICe::MultiField_Matrix(*mesh_->get_vector_node_dist_map(),relations_size));
+      tangent_overlap_ = Teuchos::rcp(new DICe::MultiField_Matrix(*mesh_->get_vector_node_overlap_map(),relations_size));
+    }
+    tangent_col_ids_.resize(tangent_overlap_->num_local_rows());
+    tangent_values_.resize(tangent_overlap_->num_local_rows());
+    DEBUG_MSG("Global_Algorithm::compute_tangent(): Tangent has been allocated.");
+  }
 
   // clear the jacobian values
-  tangent_overlap->put_scalar(0.0);
-  tangent->put_scalar(0.0);
-  // allocate simple temp arrays for holding values of the local jacobain contributions
-  // this will hopefully limit the number of calls to crsmatrix.insertGlobalValues
-  std::map<int_t,Teuchos::Array<int_t> > col_id_array_map;
-  std::map<int_t,Teuchos::Array<precision_t> > values_array_map;
-  for(int_t i=0;i<tangent_overlap->num_local_rows();++i)
-  {
-    Teuchos::Array<int_t> id_array;
-    Teuchos::Array<int_t> local_id_array;
-    const int_t row_gid = is_mixed_formulation() ? mesh_->get_mixed_vector_node_overlap_map()->get_global_element(i) :
-        mesh_->get_vector_node_overlap_map()->get_global_element(i);
-    col_id_array_map.insert(std::pair<int_t,Teuchos::Array<int_t> >(row_gid,id_array));
-    Teuchos::Array<precision_t> value_array;
-    values_array_map.insert(std::pair<int_t,Teuchos::Array<precision_t> >(row_gid,value_array));
+  tangent_overlap_->put_scalar(0.0);
+  tangent_->put_scalar(0.0);
+  // the local jacobian contributions are staged by overlap row to limit the number of calls to
+  // the crs matrix, the staging arrays keep their capacity between assemblies
+  for(size_t i=0;i<tangent_col_ids_.size();++i){
+    tangent_col_ids_[i].clear();
+    tangent_values_[i].clear();
   }
+  // stage a contribution to the given global row of the overlap tangent
+  auto stage_value = [&](const int_t global_row, const int_t global_col, const precision_t value){
+    const int_t local_row = overlap_map->get_local_element(global_row);
+    TEUCHOS_TEST_FOR_EXCEPTION(local_row<0,std::runtime_error,"Error, invalid row id " << global_row);
+    tangent_col_ids_[local_row].push_back(global_col);
+    tangent_values_[local_row].push_back(value);
+  };
   // establish the shape functions (using P2-P1 element for velocity pressure, or P2 velocity if no constraint):
   DICe::mesh::Shape_Function_Evaluator_Factory shape_func_eval_factory;
   Teuchos::RCP<DICe::mesh::Shape_Function_Evaluator> shape_func_evaluator = element_type_ ==DICe::mesh::TRI6 ?
       shape_func_eval_factory.create(DICe::mesh::TRI6):
       shape_func_eval_factory.create(DICe::mesh::TRI3);
   const int_t num_funcs = shape_func_evaluator->num_functions();
-  std::vector<precision_t> N(num_funcs);
-  std::vector<precision_t> DN(num_funcs*spa_dim);
-  std::vector<int_t> node_ids(num_funcs);
-  std::vector<precision_t> nodal_coords(num_funcs*spa_dim);
-  std::vector<precision_t> nodal_disp(num_funcs*spa_dim);
-  std::vector<precision_t> jac(spa_dim*spa_dim);
-  std::vector<precision_t> inv_jac(spa_dim*spa_dim);
-  precision_t J =0.0;
-  std::vector<precision_t> elem_stiffness(num_funcs*spa_dim*num_funcs*spa_dim);
-  std::vector<precision_t> elem_div_stiffness(num_funcs*spa_dim*num_funcs);
-  std::vector<precision_t> elem_stab_stiffness(num_funcs*num_funcs);
-
-  //precision_t grad_phi[spa_dim];
-  precision_t x=0.0,y=0.0;
-  precision_t bx=0.0,by=0.0;
 
   // get the natural integration points for this element:
   const int_t integration_order = 6;
@@ -476,7 +589,6 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
   int_t num_integration_points = -1;
   shape_func_evaluator->get_natural_integration_points(integration_order,gp_locs,gp_weights,num_integration_points);
   const int_t natural_coord_dim = gp_locs[0].size();
-  std::vector<precision_t> natural_coords(natural_coord_dim);
 
   const int_t image_integration_order = num_image_integration_points_;
   Teuchos::ArrayRCP<Teuchos::ArrayRCP<precision_t> > image_gp_locs;
@@ -492,13 +604,34 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
   MultiField & overlap_disp = *overlap_disp_ptr;
   Teuchos::ArrayRCP<const scalar_t> disp_values = overlap_disp.get_1d_view();
 
-  // element loop
-  DICe::mesh::element_set::iterator elem_it = mesh_->get_element_set()->begin();
-  DICe::mesh::element_set::iterator elem_end = mesh_->get_element_set()->end();
-  for(;elem_it!=elem_end;++elem_it)
+  // each assembly thread uses its own scratch storage
+  Teuchos::RCP<Thread_Pool> pool = assembly_thread_pool();
+  std::vector<Element_Scratch> scratch = create_element_scratch(pool==Teuchos::null ? 1 : pool->num_threads(),
+    element_type_,spa_dim,natural_coord_dim);
+  const DICe::mesh::element_set & elements = *mesh_->get_element_set();
+  // the maps are dereferenced once so that the element loop does not copy the pointers
+  MultiField_Map & vector_node_dist_map = *mesh_->get_vector_node_dist_map();
+  MultiField_Map & scalar_node_dist_map = *mesh_->get_scalar_node_dist_map();
+
+  // element loop (elements that are processed concurrently do not share nodes)
+  for_each_element([&](const int_t elem_index, const int_t thread_id)
   {
-    //std::cout << "*********ELEM: " << elem_it->get()->global_id() << std::endl;
-    const DICe::mesh::connectivity_vector & connectivity = *elem_it->get()->connectivity();
+    Element_Scratch & elem_scratch = scratch[thread_id];
+    std::vector<precision_t> & N = elem_scratch.N;
+    std::vector<precision_t> & DN = elem_scratch.DN;
+    std::vector<int_t> & node_ids = elem_scratch.node_ids;
+    std::vector<precision_t> & nodal_coords = elem_scratch.nodal_coords;
+    std::vector<precision_t> & nodal_disp = elem_scratch.nodal_disp;
+    std::vector<precision_t> & jac = elem_scratch.jac;
+    std::vector<precision_t> & inv_jac = elem_scratch.inv_jac;
+    std::vector<precision_t> & natural_coords = elem_scratch.natural_coords;
+    std::vector<precision_t> & elem_stiffness = elem_scratch.elem_stiffness;
+    std::vector<precision_t> & elem_div_stiffness = elem_scratch.elem_div_stiffness;
+    std::vector<precision_t> & elem_stab_stiffness = elem_scratch.elem_stab_stiffness;
+    precision_t J = 0.0;
+    precision_t x=0.0,y=0.0,bx=0.0,by=0.0;
+    //std::cout << "*********ELEM: " << elements[elem_index]->global_id() << std::endl;
+    const DICe::mesh::connectivity_vector & connectivity = *elements[elem_index]->connectivity();
     // compute the shape functions and derivatives for this element:
     for(int_t nd=0;nd<num_funcs;++nd){
       node_ids[nd] = connectivity[nd]->global_id();
@@ -527,8 +660,8 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
         //std::cout << " natural coords " << dim << " " << natural_coords[dim] << std::endl;
       }
       // evaluate the shape functions and derivatives:
-      shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
-      shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
+      elem_scratch.shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
+      elem_scratch.shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
 
       // physical gp location
       x = 0.0; y=0.0;
@@ -622,8 +755,8 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
         //std::cout << " natural coords " << dim << " " << natural_coords[dim] << std::endl;
       }
       // evaluate the shape functions and derivatives:
-      shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
-      shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
+      elem_scratch.shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
+      elem_scratch.shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
 
       // physical gp location
       x = 0.0; y=0.0;
@@ -656,15 +789,14 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
           const int_t col = node_ids[j] + mgo;
           //std::cout << "row " << row << " col " << col << std::endl;
           const precision_t value = elem_stab_stiffness[j*num_funcs + i];
-          const bool is_local_row_node =  mesh_->get_vector_node_dist_map()->is_node_global_elem(row); // using the non-mixed map because the row is a velocity row
+          const bool is_local_row_node =  vector_node_dist_map.is_node_global_elem(row); // using the non-mixed map because the row is a velocity row
           const bool row_is_bc_node = is_local_row_node ?
-              bc_manager_->is_row_bc(mesh_->get_vector_node_dist_map()->get_local_element(row)) : false; // same rationalle here
-          const bool is_local_mixed_row_node =  mesh_->get_scalar_node_dist_map()->is_node_global_elem(node_ids[i]); // using the non-mixed map because the row is a velocity row
+              bc_manager_->is_row_bc(vector_node_dist_map.get_local_element(row)) : false; // same rationalle here
+          const bool is_local_mixed_row_node =  scalar_node_dist_map.is_node_global_elem(node_ids[i]); // using the non-mixed map because the row is a velocity row
           const bool is_p_row = is_local_mixed_row_node ?
-              bc_manager_->is_mixed_bc(mesh_->get_scalar_node_dist_map()->get_local_element(node_ids[i])) : false;
+              bc_manager_->is_mixed_bc(scalar_node_dist_map.get_local_element(node_ids[i])) : false;
           if(!row_is_bc_node&&!is_p_row){// && !col_is_bc_node){
-            col_id_array_map.find(row)->second.push_back(col);
-            values_array_map.find(row)->second.push_back(value);
+            stage_value(row,col,value);
           }
         } // tri3_num_funcs
       }
@@ -676,23 +808,21 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
             const int_t col = node_ids[j] + mgo;
             //std::cout << "row " << row << " col " << col << std::endl;
             const precision_t value = elem_div_stiffness[j*num_funcs*spa_dim + i*spa_dim+m];
-            const bool is_local_row_node =  mesh_->get_vector_node_dist_map()->is_node_global_elem(row); // using the non-mixed map because the row is a velocity row
+            const bool is_local_row_node =  vector_node_dist_map.is_node_global_elem(row); // using the non-mixed map because the row is a velocity row
             const bool row_is_bc_node = is_local_row_node ?
-                bc_manager_->is_row_bc(mesh_->get_vector_node_dist_map()->get_local_element(row)) : false; // same rationalle here
-            const bool is_local_mixed_row_node =  mesh_->get_scalar_node_dist_map()->is_node_global_elem(node_ids[i]); // using the non-mixed map because the row is a velocity row
+                bc_manager_->is_row_bc(vector_node_dist_map.get_local_element(row)) : false; // same rationalle here
+            const bool is_local_mixed_row_node =  scalar_node_dist_map.is_node_global_elem(node_ids[i]); // using the non-mixed map because the row is a velocity row
             const bool is_p_row = is_local_mixed_row_node ?
-                bc_manager_->is_mixed_bc(mesh_->get_scalar_node_dist_map()->get_local_element(node_ids[i])) : false;
+                bc_manager_->is_mixed_bc(scalar_node_dist_map.get_local_element(node_ids[i])) : false;
             if(!row_is_bc_node&&!is_p_row){// && !col_is_bc_node){
-              col_id_array_map.find(row)->second.push_back(col);
-              values_array_map.find(row)->second.push_back(value);
+              stage_value(row,col,value);
               // transpose should be the same value
             }
-            const bool is_local_mixed_col_node =  mesh_->get_scalar_node_dist_map()->is_node_global_elem(node_ids[j]); // using the non-mixed map because the row is a velocity row
+            const bool is_local_mixed_col_node =  scalar_node_dist_map.is_node_global_elem(node_ids[j]); // using the non-mixed map because the row is a velocity row
             const bool is_p_col = is_local_mixed_col_node ?
-                bc_manager_->is_mixed_bc(mesh_->get_scalar_node_dist_map()->get_local_element(node_ids[j])) : false;
+                bc_manager_->is_mixed_bc(scalar_node_dist_map.get_local_element(node_ids[j])) : false;
             if(!is_p_col){
-              col_id_array_map.find(col)->second.push_back(row);
-              values_array_map.find(col)->second.push_back(value);
+              stage_value(col,row,value);
             }
           } // tri3_num_funcs
         }
@@ -702,25 +832,22 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
             const int_t row = node_ids[i]*spa_dim + m;
             const int_t col = node_ids[j]*spa_dim + n;
             const precision_t value = elem_stiffness[(i*spa_dim + m)*num_funcs*spa_dim + (j*spa_dim + n)];
-            const bool is_local_row_node = mesh_->get_vector_node_dist_map()->is_node_global_elem(row);
+            const bool is_local_row_node = vector_node_dist_map.is_node_global_elem(row);
             const bool row_is_bc_node = is_local_row_node ?
-                bc_manager_->is_row_bc(mesh_->get_vector_node_dist_map()->get_local_element(row)) : false;
+                bc_manager_->is_row_bc(vector_node_dist_map.get_local_element(row)) : false;
             if(!row_is_bc_node){// && !col_is_bc_node){
-              TEUCHOS_TEST_FOR_EXCEPTION(col_id_array_map.find(row)==col_id_array_map.end(),std::runtime_error,"Error, invalid col id");
-              col_id_array_map.find(row)->second.push_back(col);
-              values_array_map.find(row)->second.push_back(value);
+              stage_value(row,col,value);
             }
           } // spa dim
         } // num_funcs
       } // spa dim
     } // num_funcs
-  }  // elem
+  });  // elem
   // add ones to the diagonal for kinematic velocity bc nodes:
   for(int_t i=0;i<mesh_->get_vector_node_overlap_map()->get_num_local_elements();++i){
     if(bc_manager_->is_col_bc(i)){
       const int_t global_id = mesh_->get_vector_node_overlap_map()->get_global_element(i);
-      col_id_array_map.find(global_id)->second.push_back(global_id);
-      values_array_map.find(global_id)->second.push_back(1.0);
+      stage_value(global_id,global_id,1.0);
     }
   }
   /// lagrange multiplier bc
@@ -728,33 +855,37 @@ Global_Algorithm::compute_tangent(const bool use_fixed_point){
     for(int_t i=0;i<mesh_->get_scalar_node_overlap_map()->get_num_local_elements();++i){
       if(bc_manager_->is_mixed_bc(i)){
         const int_t global_id = mesh_->get_scalar_node_overlap_map()->get_global_element(i) + mgo;
-        col_id_array_map.find(global_id)->second.push_back(global_id);
-        values_array_map.find(global_id)->second.push_back(1.0);
+        stage_value(global_id,global_id,1.0);
       }
     }
   }
-  std::map<int_t,Teuchos::Array<int_t> >::iterator cmap_it = col_id_array_map.begin();
-  std::map<int_t,Teuchos::Array<int_t> >::iterator cmap_end = col_id_array_map.end();
-  for(;cmap_it!=cmap_end;++cmap_it){
-    int_t global_row = cmap_it->first;
-    const Teuchos::Array<int_t> ids_array = cmap_it->second;
-    const Teuchos::Array<precision_t> values_array = values_array_map.find(cmap_it->first)->second;
-    if(ids_array.empty()) continue;
-    // now do the insertGlobalValues calls:
-    tangent_overlap->insert_global_values(global_row,ids_array,values_array);
+  for(size_t i=0;i<tangent_col_ids_.size();++i){
+    if(tangent_col_ids_[i].empty()) continue;
+    const int_t global_row = overlap_map->get_global_element(i);
+    if(build_graph){
+      tangent_overlap_->insert_global_values(global_row,tangent_col_ids_[i],tangent_values_[i]);
+    }
+    else{
+      // the entries are already in the graph so the values can be summed in place
+      const int_t error_code = tangent_overlap_->sum_into_global_values(global_row,tangent_col_ids_[i],tangent_values_[i]);
+      TEUCHOS_TEST_FOR_EXCEPTION(error_code!=0,std::runtime_error,"Error, tangent entry not in the graph for row " << global_row);
+    }
   }
-  tangent_overlap->fill_complete();
+  if(build_graph)
+    tangent_overlap_->fill_complete();
+  // once the tangent has been filled the export sums into the existing entries
   if(is_mixed_formulation()){
     MultiField_Exporter exporter (*mesh_->get_mixed_vector_node_overlap_map(),*mesh_->get_mixed_vector_node_dist_map());
-    tangent->do_export(tangent_overlap, exporter, ADD);
+    tangent_->do_export(tangent_overlap_, exporter, ADD);
   }
   else{
     MultiField_Exporter exporter (*mesh_->get_vector_node_overlap_map(),*mesh_->get_vector_node_dist_map());
-    tangent->do_export(tangent_overlap, exporter, ADD);
+    tangent_->do_export(tangent_overlap_, exporter, ADD);
   }
-  tangent->fill_complete();
-  //tangent->describe();
-  return tangent;
+  if(build_graph)
+    tangent_->fill_complete();
+  //tangent_->describe();
+  return tangent_;
 }
 
 scalar_t
@@ -777,17 +908,6 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
       shape_func_eval_factory.create(DICe::mesh::TRI6) :
       shape_func_eval_factory.create(DICe::mesh::TRI3);
   const int_t num_funcs = shape_func_evaluator->num_functions();
-  std::vector<precision_t> N(num_funcs);
-  std::vector<precision_t> DN(num_funcs*spa_dim);
-  std::vector<precision_t> nodal_coords(num_funcs*spa_dim);
-  std::vector<precision_t> nodal_disp(num_funcs*spa_dim);
-  std::vector<precision_t> jac(spa_dim*spa_dim);
-  std::vector<precision_t> inv_jac(spa_dim*spa_dim);
-  precision_t J =0.0;
-  std::vector<precision_t> elem_force(num_funcs*spa_dim);
-  std::vector<precision_t> elem_gray_diff(num_funcs);
-  precision_t x=0.0,y=0.0,bx=0.0,by=0.0;
-  std::vector<precision_t> elem_stiffness(num_funcs*spa_dim*num_funcs*spa_dim);
 
   // get the natural integration points for this element:
   const int_t integration_order = 6;
@@ -796,7 +916,6 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
   int_t num_integration_points = -1;
   shape_func_evaluator->get_natural_integration_points(integration_order,gp_locs,gp_weights,num_integration_points);
   const int_t natural_coord_dim = gp_locs[0].size();
-  std::vector<precision_t> natural_coords(natural_coord_dim);
 
   const int_t image_integration_order = num_image_integration_points_;
   Teuchos::ArrayRCP<Teuchos::ArrayRCP<precision_t> > image_gp_locs;
@@ -814,13 +933,30 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
   MultiField & overlap_disp = *overlap_disp_ptr;
   Teuchos::ArrayRCP<const scalar_t> disp_values = overlap_disp.get_1d_view();
 
-  // element loop
-  DICe::mesh::element_set::iterator elem_it = mesh_->get_element_set()->begin();
-  DICe::mesh::element_set::iterator elem_end = mesh_->get_element_set()->end();
-  for(;elem_it!=elem_end;++elem_it)
+  // each assembly thread uses its own scratch storage
+  Teuchos::RCP<Thread_Pool> pool = assembly_thread_pool();
+  std::vector<Element_Scratch> scratch = create_element_scratch(pool==Teuchos::null ? 1 : pool->num_threads(),
+    element_type_,spa_dim,natural_coord_dim);
+  const DICe::mesh::element_set & elements = *mesh_->get_element_set();
+
+  // element loop (elements that are processed concurrently do not share nodes)
+  for_each_element([&](const int_t elem_index, const int_t thread_id)
   {
-    //std::cout << "ELEM: " << elem_it->get()->global_id() << std::endl;
-    const DICe::mesh::connectivity_vector & connectivity = *elem_it->get()->connectivity();
+    Element_Scratch & elem_scratch = scratch[thread_id];
+    std::vector<precision_t> & N = elem_scratch.N;
+    std::vector<precision_t> & DN = elem_scratch.DN;
+    std::vector<precision_t> & nodal_coords = elem_scratch.nodal_coords;
+    std::vector<precision_t> & nodal_disp = elem_scratch.nodal_disp;
+    std::vector<precision_t> & jac = elem_scratch.jac;
+    std::vector<precision_t> & inv_jac = elem_scratch.inv_jac;
+    std::vector<precision_t> & natural_coords = elem_scratch.natural_coords;
+    std::vector<precision_t> & elem_force = elem_scratch.elem_force;
+    std::vector<precision_t> & elem_gray_diff = elem_scratch.elem_gray_diff;
+    std::vector<precision_t> & elem_stiffness = elem_scratch.elem_stiffness;
+    precision_t J = 0.0;
+    precision_t x=0.0,y=0.0,bx=0.0,by=0.0;
+    //std::cout << "ELEM: " << elements[elem_index]->global_id() << std::endl;
+    const DICe::mesh::connectivity_vector & connectivity = *elements[elem_index]->connectivity();
     // compute the shape functions and derivatives for this element:
     for(int_t nd=0;nd<num_funcs;++nd){
       for(int_t dim=0;dim<spa_dim;++dim){
@@ -845,8 +981,8 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
           //std::cout << " natural coords " << dim << " " << natural_coords[dim] << std::endl;
         }
         // evaluate the shape functions and derivatives:
-        shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
-        shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
+        elem_scratch.shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
+        elem_scratch.shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
 
         // physical gp location
         x = 0.0; y=0.0;
@@ -879,8 +1015,8 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
         //std::cout << " natural coords " << dim << " " << natural_coords[dim] << std::endl;
       }
       // evaluate the shape functions and derivatives:
-      shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
-      shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
+      elem_scratch.shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
+      elem_scratch.shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
 
       // physical gp location
       x = 0.0; y=0.0;
@@ -926,8 +1062,8 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
           natural_coords[dim] = gp_locs[gp][dim];
         }
         // evaluate the shape functions and derivatives:
-        shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
-        shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
+        elem_scratch.shape_func_evaluator->evaluate_shape_functions(&natural_coords[0],&N[0]);
+        elem_scratch.shape_func_evaluator->evaluate_shape_function_derivatives(&natural_coords[0],&DN[0]);
         // compute the jacobian for this element:
         DICe::global::calc_jacobian(&nodal_coords[0],&DN[0],&jac[0],&inv_jac[0],J,num_funcs,spa_dim);
         // compute the elemental stiffness
@@ -963,7 +1099,7 @@ Global_Algorithm::compute_residual(const bool use_fixed_point){
         residual->global_value(row) += elem_force[i*spa_dim+dim];
       }
     } // num_funcs
-  }  // elem
+  });  // elem
 
   // export the overlap residual to the dist vector
   //mesh_->field_overlap_export(overlap_residual_ptr, mesh_::field_enums::RESIDUAL_FS, ADD);
@@ -1074,9 +1210,16 @@ Global_Algorithm::execute(){
     DEBUG_MSG("Global_Algorithm::execute(): Solving the linear system...");
     DEBUG_MSG("Global_Algorithm::execute(): Preconditioning");
     Preconditioner_Factory factory;
-    Teuchos::RCP<Teuchos::ParameterList> plist = factory.parameter_list_for_ifpack();
-    Teuchos::RCP<Ifpack_Preconditioner> Prec = factory.create (tangent->get(), plist);
-    Teuchos::RCP<Belos::EpetraPrecOp> belosPrec = Teuchos::rcp( new Belos::EpetraPrecOp( Prec ) );
+    // the tangent keeps the same graph for the whole analysis so the preconditioner is only created once,
+    // after that the factorization is recomputed with the new values
+    if(preconditioner_==Teuchos::null){
+      Teuchos::RCP<Teuchos::ParameterList> plist = factory.parameter_list_for_ifpack();
+      preconditioner_ = factory.create (tangent->get(), plist);
+    }
+    else{
+      factory.recompute(preconditioner_);
+    }
+    Teuchos::RCP<Belos::EpetraPrecOp> belosPrec = Teuchos::rcp( new Belos::EpetraPrecOp( preconditioner_ ) );
     linear_problem_->setLeftPrec( belosPrec );
     bool is_set = linear_problem_->setProblem(lhs->get(), residual->get());
     TEUCHOS_TEST_FOR_EXCEPTION(!is_set, std::logic_error,
@@ -46,6 +46,7 @@
 #include <DICe_GlobalUtils.h>
 #include <DICe_BCManager.h>
 #include <DICe_Image.h>
+#include <DICe_ThreadPool.h>
 
 #include <BelosBlockCGSolMgr.hpp>
 #include <BelosBlockGmresSolMgr.hpp>
@@ -59,6 +60,10 @@
 #endif
 
 
+#ifndef DICE_TPETRA
+class Ifpack_Preconditioner;
+#endif
+
 namespace DICe {
 
 // forward declaration of a schema
@@ -146,6 +151,12 @@ public:
     return mesh_;
   }
 
+  /// \brief Returns the indices of the elements in each color (computed the first time this is called)
+  ///
+  /// No two elements of the same color share a node so the elements of one color can be
+  /// assembled concurrently
+  const std::vector<std::vector<int_t> > & element_colors();
+
   /// add a term to the formulation
   void add_term(const Global_EQ_Term term){
     eq_terms_.insert(term);
@@ -190,6 +201,18 @@ public:
   }
 
 protected:
+  /// returns the pool of threads used to assemble the element contributions (null for serial assembly)
+  Teuchos::RCP<Thread_Pool> assembly_thread_pool();
+
+  /// \brief Execute func(elem_index,thread_id) for every element in the element set
+  /// \param func callable with signature void(const int_t elem_index, const int_t thread_id)
+  ///
+  /// If there is a thread pool the colors are processed one after the other and the elements of
+  /// each color are processed concurrently, so func can scatter into the rows of the element nodes
+  /// without locking
+  template <typename F>
+  void for_each_element(const F & func);
+
   /// protect the default constructor
   Global_Algorithm(const Global_Algorithm&);
   /// comparison operator
@@ -237,6 +260,24 @@ protected:
   bool use_fixed_point_iterations_;
   /// stabilization parameter set by user
   scalar_t stabilization_tau_;
+  /// number of threads used to assemble the tangent and residual if there is no schema
+  int_t num_threads_;
+  /// pool of worker threads used if there is no schema (the schema's pool is used otherwise)
+  Teuchos::RCP<Thread_Pool> thread_pool_;
+  /// element indices in each color, see element_colors()
+  std::vector<std::vector<int_t> > element_colors_;
+  /// tangent matrix, the graph is built the first time the tangent is computed and only the values are refilled after that
+  Teuchos::RCP<DICe::MultiField_Matrix> tangent_;
+  /// tangent matrix on the overlap map used to assemble the element contributions
+  Teuchos::RCP<DICe::MultiField_Matrix> tangent_overlap_;
+  /// column ids of the element contributions staged by local overlap row
+  std::vector<Teuchos::Array<int_t> > tangent_col_ids_;
+  /// values of the element contributions staged by local overlap row
+  std::vector<Teuchos::Array<precision_t> > tangent_values_;
+#ifndef DICE_TPETRA
+  /// preconditioner for the tangent (created with the first tangent and recomputed after that)
+  Teuchos::RCP<Ifpack_Preconditioner> preconditioner_;
+#endif
 };
 
 }// end global namespace
@@ -97,6 +97,21 @@ Preconditioner_Factory::create (Teuchos::RCP<matrix_type> A,
 
   return prec;
 }
+
+// Recompute an Ifpack preconditioner for new matrix values with the same graph.
+void
+Preconditioner_Factory::recompute (Teuchos::RCP<Ifpack_Preconditioner> prec) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(prec==Teuchos::null,std::runtime_error,"Error, null preconditioner");
+  // the symbolic factorization only depends on the graph so it is kept in serial, with more than one
+  // processor the overlapping rows are imported (values included) in Initialize() so it has to be redone
+  if(prec->Matrix().Comm().NumProc()>1){
+    DEBUG_MSG("Preconditioner_Factory::recompute(): initializing");
+    prec->Initialize();
+  }
+  DEBUG_MSG("Preconditioner_Factory::recompute(): computing");
+  prec->Compute();
+}
 #endif
 
 }// End DICe Namespace
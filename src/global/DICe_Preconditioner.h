@@ -65,6 +65,9 @@ public:
   Teuchos::RCP<Teuchos::ParameterList> parameter_list_for_ifpack () const;
   Teuchos::RCP<Ifpack_Preconditioner> create (Teuchos::RCP<matrix_type> A,
           const Teuchos::RCP<Teuchos::ParameterList> plist) const;
+  /// recompute a preconditioner created by create() after the values of its matrix changed,
+  /// the matrix graph must be the same
+  void recompute (Teuchos::RCP<Ifpack_Preconditioner> prec) const;
 };
 #endif
 
@@ -39,10 +39,14 @@
 // ************************************************************************
 // @HEADER
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <ctype.h>
+#include <type_traits>
+#include <vector>
 
 #include <DICe_ImageIO.h>
 #include <DICe_Rawi.h>
@@ -200,11 +204,11 @@ void read_image_dimensions(const char * file_name,
   }
 #if DICE_ENABLE_NETCDF
   else if(file_type==NETCDF){
-    netcdf::NetCDF_Reader netcdf_reader;
-    int_t num_time_steps = 0;
     const std::string netcdf_file = netcdf_file_name(file_name);
     DEBUG_MSG("read_image_dimensions(): netcdf file name: " << netcdf_file);
-    netcdf_reader.get_image_dimensions(netcdf_file,width,height,num_time_steps);
+    Teuchos::RCP<netcdf::NetCDF_Frame_Source> netcdf_source = netcdf::netcdf_frame_source(netcdf_file);
+    width = netcdf_source->width();
+    height = netcdf_source->height();
   }
 #endif
   else{
@@ -283,16 +287,27 @@ void read_image(const char * file_name,
     std::cerr << "Error, unrecognized image file type for file: " << file_name << "\n";
     throw std::exception();
   }
+  // the cine and video readers are shared, only one thread at a time can read a frame from them
+  std::unique_lock<std::recursive_mutex> video_lock;
+  if(file_type==CINE||file_type==VIDEO)
+    video_lock = std::unique_lock<std::recursive_mutex>(Video_Singleton::instance().mutex());
   if(file_type==RAWI){
     if(is_subimage){
       std::cerr << "Error, reading only a portion of an image is not supported for rawi, file name: " << file_name << "\n";
       throw std::exception();
     }
-    if(intensities.size()==0){
-      read_rawi_image_dimensions(file_name,width,height);
-      intensities = Teuchos::ArrayRCP<S>(width*height,0.0);
+    if(intensities.size()==0&&layout_right){
+      // zero-copy, the image views the mapped file (so the file must not be rewritten or
+      // truncated while the image exists, see map_rawi_image())
+      intensities = map_rawi_image<S>(file_name,width,height);
+    }
+    else{
+      if(intensities.size()==0){
+        read_rawi_image_dimensions(file_name,width,height);
+        intensities = Teuchos::ArrayRCP<S>(width*height,0.0);
+      }
+      read_rawi_image(file_name,intensities.getRawPtr(),layout_right);
     }
-    read_rawi_image(file_name,intensities.getRawPtr(),layout_right);
   }
   else if(file_type==VIDEO){
     const std::string video_file = video_file_name(file_name);
@@ -303,14 +318,13 @@ void read_image(const char * file_name,
     bool is_avg = false;
     video_index(file_name,start_index,end_index,is_avg);
     if(end_index<0) end_index = start_index;
-    Teuchos::RCP<cv::VideoCapture> vc = DICe::utils::Video_Singleton::instance().video_capture(video_file);
-    width = sub_w==0?(int_t)vc->get(cv::CAP_PROP_FRAME_WIDTH):sub_w;
-    height = sub_h==0?(int_t)vc->get(cv::CAP_PROP_FRAME_HEIGHT):sub_h;
-    const double fps = vc->get(cv::CAP_PROP_FPS);
+    Teuchos::RCP<Video_Frame_Cache> video_cache = DICe::utils::Video_Singleton::instance().video_frame_cache(video_file);
+    width = sub_w==0?video_cache->width():sub_w;
+    height = sub_h==0?video_cache->height():sub_h;
+    TEUCHOS_TEST_FOR_EXCEPTION(width>video_cache->width()||height>video_cache->height(),std::runtime_error,
+      "Error, requested image size is larger than the video frames");
     if(intensities.size()==0)
       intensities = Teuchos::ArrayRCP<S>(width*height,0.0);
-    for(int_t i=0;i<width*height;++i)
-      intensities[i] = 0.0;
     if(is_avg){
       TEUCHOS_TEST_FOR_EXCEPTION(params->isParameter(subimage_width),std::runtime_error,"no sub images allowed for avg frame");
       TEUCHOS_TEST_FOR_EXCEPTION(params->isParameter(subimage_height),std::runtime_error,"no sub images allowed for avg frame");
@@ -319,39 +333,33 @@ void read_image(const char * file_name,
     }
     const int_t num_frames = end_index - start_index + 1;
     DEBUG_MSG("utils::read_image(): video file num_frames to average: " << num_frames);
+    S * intens = intensities.getRawPtr();
     for(int_t i=start_index;i<=end_index;++i){
-      if((int_t)vc->get(cv::CAP_PROP_POS_FRAMES)!=i){ // only seek in thev video file if you need to, also use time to get frame instead of POS to avoid keyframe issue with mp4
-        TEUCHOS_TEST_FOR_EXCEPTION(fps<=0.0,std::runtime_error,"invalid frame rate");
-          const double frame_time = 1000.0 * i / fps;
-          vc->set(cv::CAP_PROP_POS_MSEC,frame_time);
-      }
-      cv::Mat frame;
-      if(!vc->read(frame)||frame.empty()){
-        TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"read image from video capture failed, frame " << i);
-      }
-      if(frame.channels()!=1)
-        cv::cvtColor(frame,frame,cv::COLOR_BGR2GRAY);
-      frame.convertTo(frame, CV_8UC1);
+      const cv::Mat frame = video_cache->frame(i);
       for(int_t y=0;y<height;++y){
-        for(int_t x=0;x<width;++x){
-          intensities[y*width + x] += frame.at<uchar>(y,x);
-        }
+        const uchar * row = frame.ptr<uchar>(y);
+        S * out = intens + y*width;
+        if(i==start_index)
+          std::copy(row,row+width,out);
+        else
+          for(int_t x=0;x<width;++x)
+            out[x] += row[x];
       }
     } // end avg loop
     if(num_frames>1){
-      for(int_t y=0;y<height;++y){
-        for(int_t x=0;x<width;++x){
-          intensities[y*width + x] /= num_frames;
-        }
-      }
+      for(int_t i=0;i<width*height;++i)
+        intens[i] /= num_frames;
     }
     static storage_t threshold = 255; // frames read from video files are always converted to 8 bit UC so max value is always 255
     if(filter_failed_pixels){
       if(threshold==255){
-        std::vector<storage_t> full_data(width*height,0.0);
-        for(int_t i=0;i<width*height;++i) full_data[i] = intensities[i];
-        std::sort(full_data.begin(),full_data.end());
-        threshold = 0.98*full_data[full_data.size()-1];
+        // the threshold is a fraction of the brightest intensity, the frames are 8 bit so a histogram finds it in one pass
+        std::vector<int_t> histogram(256,0);
+        for(int_t i=0;i<width*height;++i)
+          histogram[std::min(std::max((int_t)intens[i],0),255)]++;
+        int_t max_bin = 255;
+        while(max_bin>0&&histogram[max_bin]==0) --max_bin;
+        threshold = 0.98*max_bin;
       }
       cuttoff = threshold;
     }
@@ -425,24 +433,22 @@ void read_image(const char * file_name,
 #ifdef DICE_ENABLE_NETCDF
   /// check if the file is a netcdf file
     else if(file_type==NETCDF){
-      netcdf::NetCDF_Reader netcdf_reader;
+      // the file stays open across frames and the next frame is read ahead in the background
       const std::string netcdf_file = netcdf_file_name(file_name);
       const int_t index = netcdf_index(file_name);
-      if(sub_w>0||sub_h>0){
-        width = sub_w;
-        height = sub_h;
-      }else{
-        int_t num_time_steps = 0;
-        netcdf_reader.get_image_dimensions(netcdf_file.c_str(),width,height,num_time_steps);
-      }
+      Teuchos::RCP<netcdf::NetCDF_Frame_Source> netcdf_source = netcdf::netcdf_frame_source(netcdf_file);
+      TEUCHOS_TEST_FOR_EXCEPTION(sub_offset_x!=0&&sub_w==0,std::runtime_error,"offset_x cannot be nonzero if subimage_width is 0" << file_name);
+      TEUCHOS_TEST_FOR_EXCEPTION(sub_offset_y!=0&&sub_h==0,std::runtime_error,"offset_y cannot be nonzero if subimage_height is 0" << file_name);
+      width = sub_w>0?sub_w:netcdf_source->width();
+      height = sub_h>0?sub_h:netcdf_source->height();
       if(intensities.size()==0)
         intensities = Teuchos::ArrayRCP<S>(width*height,0);
       if(std::is_same<S,scalar_t>::value){
         scalar_t * intens_ptr = reinterpret_cast<scalar_t*>(intensities.getRawPtr()); // needed to get code to compile if scalar_t != storage_t (S)
-        netcdf_reader.read_netcdf_image(netcdf_file.c_str(),index,intens_ptr,sub_w,sub_h,sub_offset_x,sub_offset_y,layout_right);
+        netcdf_source->read(index,intens_ptr,sub_w,sub_h,sub_offset_x,sub_offset_y);
       }else{
         Teuchos::ArrayRCP<scalar_t> netcdf_intensities(width*height,0);
-        netcdf_reader.read_netcdf_image(netcdf_file.c_str(),index,netcdf_intensities.getRawPtr(),sub_w,sub_h,sub_offset_x,sub_offset_y,layout_right);
+        netcdf_source->read(index,netcdf_intensities.getRawPtr(),sub_w,sub_h,sub_offset_x,sub_offset_y);
         for(int_t i=0;i<netcdf_intensities.size();++i) // this conversion is needed since netcdf always stores values in float or double
           intensities[i] = static_cast<S>(netcdf_intensities[i]);
       }
@@ -490,6 +496,8 @@ void read_image(const char * file_name,
         }
     }
   }
+  if(video_lock.owns_lock())
+    video_lock.unlock();
   // apply any post processing of the images as requested
   if(file_type==CINE||file_type==VIDEO){
     if(filter_failed_pixels){
@@ -618,60 +626,113 @@ template
 DICE_LIB_DLL_EXPORT
 void floor_intensities(const int_t,const int_t,scalar_t *);
 
+namespace {
+
+/// bilinear remap table that undistorts the images for one calibration, each output pixel is
+/// a weighted sum of the 2x2 block of source pixels with the upper left corner at index
+struct Undistortion_Table{
+  /// index of the upper left pixel of the source block for each output pixel
+  std::vector<int_t> index;
+  /// four weights per output pixel (upper left, upper right, lower left, lower right),
+  /// source pixels outside the image have zero weight
+  std::vector<float> weights;
+};
+
+/// returns the remap table for the given camera, calibration and image size, there is one table per camera
+/// (the camera_id parameter of the sublist, 0 if not given) and image size, computed the first time it is
+/// requested and kept for the rest of the run (the tables are never removed, so the returned pointer stays valid)
+const Undistortion_Table *
+undistortion_table(const int_t width,
+  const int_t height,
+  const Teuchos::ParameterList & cal_sublist){
+  static std::mutex tables_mutex;
+  static std::map<std::vector<double>,Undistortion_Table> tables;
+
+  const char * const names[] = {"fx","fy","cx","cy","k1","k2"};
+  std::vector<double> key(9,0.0);
+  for(int_t i=0;i<6;++i){
+    TEUCHOS_TEST_FOR_EXCEPTION(!cal_sublist.isParameter(names[i]),std::runtime_error,
+      "Error, undistort_images requires parameter " << names[i]);
+    key[i] = cal_sublist.get<double>(names[i]);
+  }
+  key[6] = width;
+  key[7] = height;
+  key[8] = cal_sublist.isParameter("camera_id") ? cal_sublist.get<int_t>("camera_id") : 0;
+
+  std::lock_guard<std::mutex> lock(tables_mutex);
+  std::map<std::vector<double>,Undistortion_Table>::iterator it = tables.find(key);
+  if(it!=tables.end())
+    return &it->second;
+
+  DEBUG_MSG("utils::undistortion_table(): computing the undistortion table for camera " << key[8] << " fx " << key[0] << " fy " << key[1] <<
+    " cx " << key[2] << " cy " << key[3] << " k1 " << key[4] << " k2 " << key[5] << " image size " << width << " x " << height);
+  TEUCHOS_TEST_FOR_EXCEPTION(width<2||height<2,std::runtime_error,"Error, image is too small to undistort");
+  cv::Mat intrinsics = cv::Mat::zeros(3,3,CV_64FC1);
+  intrinsics.at<double>(0,0) = key[0];
+  intrinsics.at<double>(1,1) = key[1];
+  intrinsics.at<double>(0,2) = key[2];
+  intrinsics.at<double>(1,2) = key[3];
+  intrinsics.at<double>(2,2) = 1.0;
+  cv::Mat dist_coeffs = cv::Mat::zeros(1,4,CV_64FC1);
+  dist_coeffs.at<double>(0,0) = key[4];
+  dist_coeffs.at<double>(0,1) = key[5];
+  // same map that cv::undistort computes internally for every image
+  cv::Mat map_x, map_y;
+  cv::initUndistortRectifyMap(intrinsics,dist_coeffs,cv::Mat(),intrinsics,cv::Size(width,height),CV_32FC1,map_x,map_y);
+
+  Undistortion_Table & table = tables[key];
+  table.index.resize(width*height,0);
+  table.weights.resize(4*width*height,0.0f);
+  for(int_t y=0;y<height;++y){
+    for(int_t x=0;x<width;++x){
+      const int_t i = y*width+x;
+      const float px = map_x.at<float>(y,x);
+      const float py = map_y.at<float>(y,x);
+      const int_t x0 = (int_t)std::floor(px);
+      const int_t y0 = (int_t)std::floor(py);
+      // keep the 2x2 block inside the image, the corners that fall outside get zero weight
+      const int_t bx = std::min(std::max(x0,0),width-2);
+      const int_t by = std::min(std::max(y0,0),height-2);
+      table.index[i] = by*width+bx;
+      const float dx = px - x0;
+      const float dy = py - y0;
+      const float corner_weights[] = {(1.0f-dx)*(1.0f-dy),dx*(1.0f-dy),(1.0f-dx)*dy,dx*dy};
+      for(int_t c=0;c<4;++c){
+        const int_t cx = x0 + c%2;
+        const int_t cy = y0 + c/2;
+        if(cx<0||cx>=width||cy<0||cy>=height) continue;
+        table.weights[4*i+(cx-bx)+2*(cy-by)] += corner_weights[c];
+      }
+    }
+  }
+  return &table;
+}
+
+}// End anonymous namespace
+
 template <typename S>
 DICE_LIB_DLL_EXPORT
 void undistort_intensities(const int_t width,
   const int_t height,
   S * intensities,
   const Teuchos::RCP<Teuchos::ParameterList> & params){
+  // This param must exist, otherwise this method would not be called
+  TEUCHOS_TEST_FOR_EXCEPTION(params==Teuchos::null,std::runtime_error,"");
+  TEUCHOS_TEST_FOR_EXCEPTION(!params->isParameter(undistort_images),std::runtime_error,"");
+  // the tables are keyed by the camera and its calibration, each camera of a stereo run has its own table
+  const Undistortion_Table * table = undistortion_table(width,height,params->sublist(undistort_images));
 
-  static bool first_run = true;
-  static cv::Mat intrinsics = cv::Mat(3, 3, CV_32FC1);
-  static cv::Mat dist_coeffs = cv::Mat(1,4,CV_32FC1);
-  if(first_run){
-    DEBUG_MSG("utils::undistort_intensities(): manually undistorting images");
-    // This param must exist, otherwise this method would not be called
-    TEUCHOS_TEST_FOR_EXCEPTION(params==Teuchos::null,std::runtime_error,"");
-    params->print(std::cout);
-    TEUCHOS_TEST_FOR_EXCEPTION(!params->isParameter(undistort_images),std::runtime_error,"");
-    Teuchos::ParameterList cal_sublist = params->sublist(undistort_images);
-    TEUCHOS_TEST_FOR_EXCEPTION(!cal_sublist.isParameter("fx"),std::runtime_error,"");
-    const scalar_t fx = cal_sublist.get<double>("fx");
-    TEUCHOS_TEST_FOR_EXCEPTION(!cal_sublist.isParameter("fy"),std::runtime_error,"");
-    const scalar_t fy = cal_sublist.get<double>("fy");
-    TEUCHOS_TEST_FOR_EXCEPTION(!cal_sublist.isParameter("cx"),std::runtime_error,"");
-    const scalar_t cx = cal_sublist.get<double>("cx");
-    TEUCHOS_TEST_FOR_EXCEPTION(!cal_sublist.isParameter("cy"),std::runtime_error,"");
-    const scalar_t cy = cal_sublist.get<double>("cy");
-    TEUCHOS_TEST_FOR_EXCEPTION(!cal_sublist.isParameter("k1"),std::runtime_error,"");
-    const scalar_t k1 = cal_sublist.get<double>("k1");
-    TEUCHOS_TEST_FOR_EXCEPTION(!cal_sublist.isParameter("k2"),std::runtime_error,"");
-    const scalar_t k2 = cal_sublist.get<double>("k2");
-    intrinsics.at<float>(0,0) = fx;
-    intrinsics.at<float>(1,1) = fy;
-    intrinsics.at<float>(0,2) = cx;
-    intrinsics.at<float>(1,2) = cy;
-    intrinsics.at<float>(2,2) = 1.0;
-    dist_coeffs.at<float>(0,0) = k1;
-    dist_coeffs.at<float>(0,1) = k2;
-    dist_coeffs.at<float>(0,2) = 0.0;
-    dist_coeffs.at<float>(0,3) = 0.0;
-  }
-  first_run = false;
-  // convert intensity values to an opencv Mat
-  cv::Mat img(height,width,CV_8UC1,cv::Scalar(0));
-  cv::Mat out_img(height,width,CV_8UC1,cv::Scalar(0));
-  for(int_t y=0;y<height;++y){
-    for(int_t x=0;x<width;++x){
-      img.at<uchar>(y,x) = intensities[y*width + x];
-    }
-  }
-  // undistort the mat and replace the intensity values
-  cv::undistort(img,out_img,intrinsics,dist_coeffs);
-  for(int_t y=0;y<height;++y){
-    for(int_t x=0;x<width;++x){
-      intensities[y*width + x] = out_img.at<uchar>(y,x);
-    }
+  // remap at the native bit depth of the image
+  const int_t num_pixels = width*height;
+  std::vector<S> source(intensities,intensities+num_pixels);
+  const int_t * index = &table->index[0];
+  const float * weights = &table->weights[0];
+  const S * src = &source[0];
+  for(int_t i=0;i<num_pixels;++i){
+    const int_t j = index[i];
+    const float * w = weights + 4*i;
+    const float value = w[0]*src[j] + w[1]*src[j+1] + w[2]*src[j+width] + w[3]*src[j+width+1];
+    intensities[i] = std::is_integral<S>::value ? static_cast<S>(value + 0.5f) : static_cast<S>(value);
   }
 }
 
@@ -861,6 +922,7 @@ void write_image(const char *,const int_t,const int_t,scalar_t *,const bool);
 Teuchos::RCP<hypercine::HyperCine>
 Video_Singleton::hypercine(const std::string & id,
   hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type){
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if(hypercine_map_.find(std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type>(id,conversion_type))==hypercine_map_.end()){
     DEBUG_MSG("Video_Singleton::hypercine(): insering a new HyperCine for file " << id << " conversion type " << conversion_type);
     Teuchos::RCP<hypercine::HyperCine> hypercine = Teuchos::rcp(new hypercine::HyperCine(id.c_str(),conversion_type));
@@ -875,6 +937,7 @@ Video_Singleton::hypercine(const std::string & id,
 
 Teuchos::RCP<cv::VideoCapture>
 Video_Singleton::video_capture(const std::string & id){
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if(video_capture_map_.find(id)==video_capture_map_.end()){
     DEBUG_MSG("Video_Singleton::video_capture(): insering a new VideoCapture for file " << id );
     Teuchos::RCP<cv::VideoCapture> vc = Teuchos::rcp(new cv::VideoCapture(id));
@@ -887,6 +950,219 @@ Video_Singleton::video_capture(const std::string & id){
   }
 }
 
+Teuchos::RCP<Video_Frame_Cache>
+Video_Singleton::video_frame_cache(const std::string & id){
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::map<std::string,Teuchos::RCP<Video_Frame_Cache> >::iterator it = video_frame_cache_map_.find(id);
+  if(it==video_frame_cache_map_.end()){
+    DEBUG_MSG("Video_Singleton::video_frame_cache(): insering a new Video_Frame_Cache for file " << id );
+    Teuchos::RCP<Video_Frame_Cache> cache = Teuchos::rcp(new Video_Frame_Cache(id));
+    video_frame_cache_map_.insert(std::pair<std::string,Teuchos::RCP<Video_Frame_Cache> >(id,cache));
+    return cache;
+  }
+  return it->second;
+}
+
+Video_Frame_Cache::Video_Frame_Cache(const std::string & file_name,
+  const int_t capacity):
+  file_name_(file_name),
+  capture_(file_name),
+  fps_(0.0),
+  width_(0),
+  height_(0),
+  frame_count_(0),
+  capacity_(capacity),
+  next_decode_(0),
+  last_requested_(0),
+  seek_to_(-1),
+  end_of_file_(false),
+  stop_(false){
+  TEUCHOS_TEST_FOR_EXCEPTION(!capture_.isOpened(),std::runtime_error,"video capture load failed for " << file_name_);
+  TEUCHOS_TEST_FOR_EXCEPTION(capacity_<2,std::runtime_error,"Error, video frame cache capacity must be at least 2");
+  fps_ = capture_.get(cv::CAP_PROP_FPS);
+  width_ = (int_t)capture_.get(cv::CAP_PROP_FRAME_WIDTH);
+  height_ = (int_t)capture_.get(cv::CAP_PROP_FRAME_HEIGHT);
+  frame_count_ = (int_t)capture_.get(cv::CAP_PROP_FRAME_COUNT);
+  decoder_ = std::thread(&Video_Frame_Cache::decode_loop,this);
+}
+
+Video_Frame_Cache::~Video_Frame_Cache(){
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if(decoder_.joinable())
+    decoder_.join();
+}
+
+void
+Video_Frame_Cache::decode_loop(){
+  // index of the frame the capture will return next
+  int_t capture_pos = 0;
+  const int_t look_ahead = capacity_/2;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while(true){
+    cv_.wait(lock,[&]{return stop_||seek_to_>=0||(!end_of_file_&&next_decode_<=last_requested_+look_ahead);});
+    if(stop_) return;
+    if(seek_to_>=0){
+      const int_t target = seek_to_;
+      seek_to_ = -1;
+      frames_.clear();
+      next_decode_ = target;
+      end_of_file_ = false;
+      if(target!=capture_pos){
+        DEBUG_MSG("Video_Frame_Cache::decode_loop(): seeking to frame " << target << " in " << file_name_);
+        lock.unlock();
+        // use time to get frame instead of POS to avoid keyframe issue with mp4
+        if(fps_>0.0)
+          capture_.set(cv::CAP_PROP_POS_MSEC,1000.0*target/fps_);
+        else
+          capture_.set(cv::CAP_PROP_POS_FRAMES,target);
+        capture_pos = target;
+        lock.lock();
+      }
+      continue;
+    }
+    const int_t index = next_decode_;
+    lock.unlock();
+    cv::Mat frame;
+    const bool success = capture_.read(frame)&&!frame.empty();
+    if(success){
+      if(frame.channels()!=1)
+        cv::cvtColor(frame,frame,cv::COLOR_BGR2GRAY);
+      if(frame.type()!=CV_8UC1)
+        frame.convertTo(frame,CV_8UC1);
+      if(!frame.isContinuous())
+        frame = frame.clone();
+    }
+    ++capture_pos;
+    lock.lock();
+    // a seek was requested while decoding, this frame is no longer wanted
+    if(seek_to_>=0||next_decode_!=index) continue;
+    if(!success){
+      end_of_file_ = true;
+    }
+    else{
+      frames_.push_back(std::pair<int_t,cv::Mat>(index,frame));
+      if((int_t)frames_.size()>capacity_)
+        frames_.pop_front();
+      ++next_decode_;
+    }
+    cv_.notify_all();
+  }
+}
+
+cv::Mat
+Video_Frame_Cache::frame(const int_t index){
+  TEUCHOS_TEST_FOR_EXCEPTION(index<0,std::runtime_error,"Error, invalid video frame index " << index);
+  std::unique_lock<std::mutex> lock(mutex_);
+  last_requested_ = index;
+  cv_.notify_all();
+  while(true){
+    for(std::deque<std::pair<int_t,cv::Mat> >::const_reverse_iterator it=frames_.rbegin();it!=frames_.rend();++it)
+      if(it->first==index)
+        return it->second;
+    // the frame is not decoded yet, seek if the decoder will not get to it soon
+    const int_t base = seek_to_>=0 ? seek_to_ : next_decode_;
+    if(index<base||index>=base+capacity_){
+      seek_to_ = index;
+      cv_.notify_all();
+    }
+    else if(seek_to_<0&&end_of_file_){
+      TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"read image from video capture failed, frame " << index);
+    }
+    cv_.wait(lock);
+  }
+}
+
+void
+Video_Singleton::cine_read_ahead(const std::string & id,
+  hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
+  const int_t frame,
+  const int_t count,
+  const std::vector<Cine_Window> & windows){
+  const std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type> key(id,conversion_type);
+  // only one read ahead per reader at a time
+  std::shared_future<void> previous;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    previous = cine_read_ahead_map_[key].pending;
+  }
+  if(previous.valid())
+    previous.wait();
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  Cine_Read_Ahead & read_ahead = cine_read_ahead_map_[key];
+  if(read_ahead.hypercine==Teuchos::null){
+    DEBUG_MSG("Video_Singleton::cine_read_ahead(): creating a spare HyperCine for file " << id << " conversion type " << conversion_type);
+    read_ahead.hypercine = Teuchos::rcp(new hypercine::HyperCine(id.c_str(),conversion_type));
+  }
+  if(read_ahead_pool_==Teuchos::null)
+    read_ahead_pool_ = Teuchos::rcp(new Thread_Pool(2));
+  DEBUG_MSG("Video_Singleton::cine_read_ahead(): reading frames " << frame << " to " << frame + count - 1 << " of " << id << " in the background");
+  read_ahead.frame = frame;
+  read_ahead.windows = windows;
+  // the spare reader is only used by the background thread until the read is complete
+  hypercine::HyperCine * hc = read_ahead.hypercine.get();
+  read_ahead.pending = read_ahead_pool_->submit([hc,frame,count,windows](){
+    if(windows.empty()){
+      hc->hyperframe()->update_frames(frame,count);
+      hc->read_buffer();
+    }else{
+      hypercine::HyperCine::HyperFrame hf(frame,count);
+      for(size_t i=0;i<windows.size();++i)
+        hf.add_window(windows[i].x,windows[i].width,windows[i].y,windows[i].height);
+      hc->read_buffer(hf);
+    }
+  }).share();
+}
+
+bool
+Video_Singleton::cine_read_ahead_ready(const std::string & id,
+  hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
+  const int_t frame,
+  std::vector<Cine_Window> & windows){
+  const std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type> key(id,conversion_type);
+  std::shared_future<void> pending;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    std::map<std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type>,Cine_Read_Ahead>::iterator it = cine_read_ahead_map_.find(key);
+    if(it==cine_read_ahead_map_.end()||!it->second.pending.valid()||it->second.frame!=frame)
+      return false;
+    pending = it->second.pending;
+    windows = it->second.windows;
+  }
+  try{
+    pending.get();
+  }
+  catch(std::exception & e){
+    DEBUG_MSG("Video_Singleton::cine_read_ahead_ready(): read ahead of frame " << frame << " failed: " << e.what());
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    cine_read_ahead_map_[key].frame = -1;
+    return false;
+  }
+  return true;
+}
+
+void
+Video_Singleton::swap_cine_read_ahead(const std::string & id,
+  hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type){
+  const std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type> key(id,conversion_type);
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::map<std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type>,Cine_Read_Ahead>::iterator it = cine_read_ahead_map_.find(key);
+  TEUCHOS_TEST_FOR_EXCEPTION(it==cine_read_ahead_map_.end()||it->second.hypercine==Teuchos::null,std::runtime_error,
+    "Error, no cine read ahead exists for file " << id);
+  if(it->second.pending.valid())
+    it->second.pending.wait();
+  // make sure the active reader exists
+  hypercine(id,conversion_type);
+  DEBUG_MSG("Video_Singleton::swap_cine_read_ahead(): swapping in the read ahead buffer of frame " << it->second.frame << " for file " << id);
+  std::swap(hypercine_map_[key],it->second.hypercine);
+  it->second.frame = -1;
+  it->second.windows.clear();
+  it->second.pending = std::shared_future<void>();
+}
+
 DICE_LIB_DLL_EXPORT
 bool is_cine_file(const std::string & file_name){
   // check if the file is cine or mp4 or throw an exception
@@ -898,6 +1174,7 @@ bool is_cine_file(const std::string & file_name){
 
 void
 Video_Singleton::image_dimensions(const std::string & id, int_t & width, int_t & height)const{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
   if(is_cine_file(id)){
     std::map<std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type>,Teuchos::RCP<hypercine::HyperCine> >::const_iterator it = hypercine_map_.begin();
     for(;it!=hypercine_map_.end();++it){
@@ -914,6 +1191,14 @@ Video_Singleton::image_dimensions(const std::string & id, int_t & width, int_t &
     height = hc.height();
   }
   else{
+    // the frame cache already holds an open reader for this file
+    std::map<std::string,Teuchos::RCP<Video_Frame_Cache> >::const_iterator cache_it = video_frame_cache_map_.find(id);
+    if(cache_it!=video_frame_cache_map_.end()){
+      DEBUG_MSG("Video_Singleton::image_dimensions(): using dims from existing Video_Frame_Cache " << id);
+      width = cache_it->second->width();
+      height = cache_it->second->height();
+      return;
+    }
     std::map<std::string,Teuchos::RCP<cv::VideoCapture> >::const_iterator it = video_capture_map_.begin();
     for(;it!=video_capture_map_.end();++it){
       if(it->first==id){
@@ -937,7 +1222,8 @@ int_t video_file_frame_count(const std::string & video_name){
   if(is_cine_file(video_name))
     return DICe::utils::Video_Singleton::instance().hypercine(video_name)->file_frame_count();
   else{
-    return (int_t)(DICe::utils::Video_Singleton::instance().video_capture(video_name)->get(cv::CAP_PROP_FRAME_COUNT));
+    // use the frame cache so that the frames read later share the same reader
+    return DICe::utils::Video_Singleton::instance().video_frame_cache(video_name)->frame_count();
   }
 };
 
@@ -954,6 +1240,7 @@ DICE_LIB_DLL_EXPORT
 void cine_file_read_buffer(const std::string & cine_name,
   const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
   hypercine::HyperCine::HyperFrame & hf){
+  std::lock_guard<std::recursive_mutex> lock(DICe::utils::Video_Singleton::instance().mutex());
   DICe::utils::Video_Singleton::instance().hypercine(cine_name,conversion_type)->read_buffer(hf);
 }
 
@@ -962,11 +1249,33 @@ void cine_file_read_buffer(const std::string & cine_name,
   const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
   const int_t frame,
   const int_t count){
+  std::lock_guard<std::recursive_mutex> lock(DICe::utils::Video_Singleton::instance().mutex());
   DICe::utils::Video_Singleton::instance().hypercine(cine_name,conversion_type)->hyperframe()->update_frames(frame,count);
   DICe::utils::Video_Singleton::instance().hypercine(cine_name,conversion_type)->read_buffer();
 }
 
+DICE_LIB_DLL_EXPORT
+void cine_file_read_ahead(const std::string & cine_name,
+  const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
+  const int_t frame,
+  const int_t count,
+  const std::vector<Cine_Window> & windows){
+  DICe::utils::Video_Singleton::instance().cine_read_ahead(cine_name,conversion_type,frame,count,windows);
+}
 
+DICE_LIB_DLL_EXPORT
+bool cine_file_read_ahead_ready(const std::string & cine_name,
+  const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
+  const int_t frame,
+  std::vector<Cine_Window> & windows){
+  return DICe::utils::Video_Singleton::instance().cine_read_ahead_ready(cine_name,conversion_type,frame,windows);
+}
+
+DICE_LIB_DLL_EXPORT
+void cine_file_swap_read_ahead(const std::string & cine_name,
+  const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type){
+  DICe::utils::Video_Singleton::instance().swap_cine_read_ahead(cine_name,conversion_type);
+}
 
 } // end namespace utils
 } // end namespace DICe
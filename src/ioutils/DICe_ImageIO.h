@@ -43,6 +43,7 @@
 #define DICE_IMAGEIO_H
 
 #include <DICe.h>
+#include <DICe_ThreadPool.h>
 
 #include <hypercine.h>
 
@@ -58,6 +59,12 @@
 
 #include <string>
 #include <map>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <thread>
+#include <vector>
 
 namespace DICe{
 /*!
@@ -165,6 +172,9 @@ void floor_intensities(const int_t width,
   S * intensities);
 
 /// undistort image intensity values to correct for lens distortion
+/// (one bilinear remap table is computed per camera and image size, and reused for all of the
+/// images of that camera; the undistort_images sublist holds the calibration of one camera and
+/// an optional camera_id, 0 if not given)
 /// \param width
 /// \param height
 /// \param intensities
@@ -214,6 +224,102 @@ DICE_LIB_DLL_EXPORT
 cv::Mat read_image(const char * file_name);
 
 
+/// \class Video_Frame_Cache
+/// \brief Decodes the frames of a video file in order on a background thread
+///
+/// Seeking in compressed video (mp4, avi, etc.) re-decodes from the previous keyframe, so the frames
+/// are decoded strictly sequentially into a ring buffer of grayscale 8 bit frames and requests are
+/// served from the buffer. The decoder stays at most half the buffer ahead of the last requested frame
+/// so the frames just behind it are still cached. The decoder only seeks if a frame is requested
+/// that is behind the buffer or more than a full buffer ahead of the decoder.
+class DICE_LIB_DLL_EXPORT
+Video_Frame_Cache{
+public:
+  /// \brief Constructor, opens the video and starts decoding from the first frame
+  /// \param file_name the video file name
+  /// \param capacity the number of decoded frames kept in the buffer
+  Video_Frame_Cache(const std::string & file_name,
+    const int_t capacity=32);
+
+  /// destructor, stops the decoder thread
+  ~Video_Frame_Cache();
+
+  /// no copies allowed
+  Video_Frame_Cache(const Video_Frame_Cache &) = delete;
+  /// no copies allowed
+  Video_Frame_Cache & operator=(const Video_Frame_Cache &) = delete;
+
+  /// \brief Returns the given frame as a grayscale 8 bit image, blocks until the frame has been decoded
+  ///
+  /// The returned frame shares its memory with the buffer and must not be modified
+  /// \param index the index of the frame
+  cv::Mat frame(const int_t index);
+
+  /// returns the width of the frames
+  int_t width()const{
+    return width_;
+  }
+
+  /// returns the height of the frames
+  int_t height()const{
+    return height_;
+  }
+
+  /// returns the number of frames in the file
+  int_t frame_count()const{
+    return frame_count_;
+  }
+
+private:
+  /// decoder thread loop
+  void decode_loop();
+
+  /// video file name
+  std::string file_name_;
+  /// video reader, only used by the decoder thread after construction
+  cv::VideoCapture capture_;
+  /// frame rate used to seek
+  double fps_;
+  /// frame width
+  int_t width_;
+  /// frame height
+  int_t height_;
+  /// number of frames in the file
+  int_t frame_count_;
+  /// maximum number of frames in the buffer
+  int_t capacity_;
+  /// decoded frames in order (index, frame)
+  std::deque<std::pair<int_t,cv::Mat> > frames_;
+  /// index of the next frame the decoder will add to the buffer
+  int_t next_decode_;
+  /// index of the most recently requested frame
+  int_t last_requested_;
+  /// frame index to seek to (-1 if no seek is pending)
+  int_t seek_to_;
+  /// true if the decoder reached the end of the file (or a read failed)
+  bool end_of_file_;
+  /// true if the decoder thread should exit
+  bool stop_;
+  /// guards all of the members above that the decoder thread updates
+  std::mutex mutex_;
+  /// signaled when a frame is decoded or a request changes
+  std::condition_variable cv_;
+  /// decoder thread
+  std::thread decoder_;
+};
+
+/// window of a cine frame (upper left corner and size)
+struct Cine_Window{
+  /// x coordinate of the upper left corner
+  int_t x;
+  /// width
+  int_t width;
+  /// y coordinate of the upper left corner
+  int_t y;
+  /// height
+  int_t height;
+};
+
 // singleton class to keep track of image readers from video files:
 /// \class Video_Singleton
 /// NOTE: this singleton shouldn't be accessed directly from libraries external to diceioutils,
@@ -237,6 +343,43 @@ public:
   /// if the reader doesn't exist, it gets created
   Teuchos::RCP<cv::VideoCapture> video_capture(const std::string & id);
 
+  /// \param id the string name of the video file
+  /// if the frame cache doesn't exist, it gets created
+  Teuchos::RCP<Video_Frame_Cache> video_frame_cache(const std::string & id);
+
+  /// \brief Start reading frames into the spare buffer of a cine reader on a background thread
+  ///
+  /// Each cine reader has a spare reader of the same file whose buffer is filled while the frames in
+  /// the buffer of the active reader are used. The spare becomes the active reader in swap_cine_read_ahead().
+  /// \param id the string name of the cine file
+  /// \param conversion_type the bit depth conversion of the reader
+  /// \param frame the first frame to read
+  /// \param count the number of frames to read
+  /// \param windows the windows of each frame to read (the full frame if empty)
+  void cine_read_ahead(const std::string & id,
+    hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
+    const int_t frame,
+    const int_t count,
+    const std::vector<Cine_Window> & windows);
+
+  /// \brief Wait for the read ahead of a cine reader if it starts at the given frame
+  ///
+  /// Returns false if no read ahead was started for this frame (or it failed)
+  /// \param id the string name of the cine file
+  /// \param conversion_type the bit depth conversion of the reader
+  /// \param frame the first frame of the buffer that is needed
+  /// \param windows [out] the windows that were read ahead (empty for full frames)
+  bool cine_read_ahead_ready(const std::string & id,
+    hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
+    const int_t frame,
+    std::vector<Cine_Window> & windows);
+
+  /// \brief Make the spare reader filled by cine_read_ahead() the active reader (returned by hypercine())
+  /// \param id the string name of the cine file
+  /// \param conversion_type the bit depth conversion of the reader
+  void swap_cine_read_ahead(const std::string & id,
+    hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type);
+
   /// utility to get the image dimensions from a hypercine or video capture object if one exists with the same file name
   /// if no hypercine or video capture objects exist, the utility reads the dimensions without creating a new one
   /// \param id file name
@@ -244,6 +387,12 @@ public:
   /// \param heigh the height of the full frame image
   void image_dimensions(const std::string & id, int_t & width, int_t & height) const;
 
+  /// mutex that serializes access to the cine and video readers, the readers keep the
+  /// current frame and the frame buffer as state so only one thread can use them at a time
+  std::recursive_mutex & mutex()const{
+    return mutex_;
+  }
+
 private:
   /// constructor
   Video_Singleton(){};
@@ -255,6 +404,25 @@ private:
   std::map<std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type>,Teuchos::RCP<hypercine::HyperCine> > hypercine_map_;
   /// map of video capture readers
   std::map<std::string,Teuchos::RCP<cv::VideoCapture> > video_capture_map_;
+  /// spare cine reader that is filled in the background
+  struct Cine_Read_Ahead{
+    /// the spare reader
+    Teuchos::RCP<hypercine::HyperCine> hypercine;
+    /// first frame in the buffer of the spare reader
+    int_t frame;
+    /// windows in the buffer of the spare reader
+    std::vector<Cine_Window> windows;
+    /// completion of the background read
+    std::shared_future<void> pending;
+  };
+  /// map of spare cine readers
+  std::map<std::pair<std::string,hypercine::HyperCine::Bit_Depth_Conversion_Type>,Cine_Read_Ahead> cine_read_ahead_map_;
+  /// map of video frame caches
+  std::map<std::string,Teuchos::RCP<Video_Frame_Cache> > video_frame_cache_map_;
+  /// guards the maps above and the readers they hold
+  mutable std::recursive_mutex mutex_;
+  /// background thread for the cine read ahead (declared last so that it finishes before the readers are destroyed)
+  Teuchos::RCP<Thread_Pool> read_ahead_pool_;
 };
 
 DICE_LIB_DLL_EXPORT
@@ -281,6 +449,26 @@ void cine_file_read_buffer(const std::string & cine_name,
   const int_t frame,
   const int_t count);
 
+/// helper functions for hypercine (see Video_Singleton::cine_read_ahead())
+DICE_LIB_DLL_EXPORT
+void cine_file_read_ahead(const std::string & cine_name,
+  const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
+  const int_t frame,
+  const int_t count,
+  const std::vector<Cine_Window> & windows);
+
+/// helper functions for hypercine (see Video_Singleton::cine_read_ahead_ready())
+DICE_LIB_DLL_EXPORT
+bool cine_file_read_ahead_ready(const std::string & cine_name,
+  const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type,
+  const int_t frame,
+  std::vector<Cine_Window> & windows);
+
+/// helper functions for hypercine (see Video_Singleton::swap_cine_read_ahead())
+DICE_LIB_DLL_EXPORT
+void cine_file_swap_read_ahead(const std::string & cine_name,
+  const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type);
+
 } // end namespace utils
 } // end namespace DICe
 
@@ -42,25 +42,33 @@
 
 #include <Teuchos_RCP.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <type_traits>
 #include "netcdf.h"
 
 namespace DICe {
 namespace netcdf {
 
-void
-NetCDF_Reader::get_image_dimensions(const std::string & file_name,
+namespace {
+
+/// the NetCDF library is not thread safe, every call into it is made while holding this mutex
+std::recursive_mutex & netcdf_mutex(){
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
+/// acquire the image dimensions of an open file
+void inquire_dimensions(const int ncid,
+  const std::string & file_name,
   int_t & width,
   int_t & height,
   int_t & num_time_steps){
-
-  int error_int = 0;
-
-  // Open the file for read access
-  int ncid;
-  error_int = nc_open(file_name.c_str(), 0, &ncid);
-  TEUCHOS_TEST_FOR_EXCEPTION(error_int,std::runtime_error,"Error, could not open NetCDF file " << file_name);
-  // acquire the dimensions of the file
   int num_data_dims = 0;
   height = -1;
   width = -1;
@@ -68,10 +76,9 @@ NetCDF_Reader::get_image_dimensions(const std::string & file_name,
   nc_inq_ndims(ncid, &num_data_dims);
   DEBUG_MSG("NetCDF_Reader::get_image(): number of data dimensions: " <<  num_data_dims);
   for(int_t i=0;i<num_data_dims;++i){
-    char var_name[100];
+    char var_name[NC_MAX_NAME+1];
     size_t length = 0;
     nc_inq_dim(ncid,i,&var_name[0],&length);
-    std::string var_name_str = var_name;
     DEBUG_MSG("NetCDF_Reader::get_image(): found dimension " << var_name << " of size " << length);
     if(strcmp(var_name, "xc") == 0||strcmp(var_name, "imsize1") == 0||strcmp(var_name, "x") == 0){
       width = (int)length;
@@ -89,55 +96,27 @@ NetCDF_Reader::get_image_dimensions(const std::string & file_name,
   TEUCHOS_TEST_FOR_EXCEPTION(width <=0, std::runtime_error,"Error, could not find xc dimension in NetCDF file " << file_name);
   TEUCHOS_TEST_FOR_EXCEPTION(height <=0, std::runtime_error,"Error, could not find yc dimension in NetCDF file " << file_name);
   DEBUG_MSG("NetCDF_Reader::get_image(): image dimensions " << width << " x " << height << " num time steps: " << num_time_steps);
-
-  // close the nc_file
-  nc_close(ncid);
 }
 
-void
-NetCDF_Reader::read_netcdf_image(const char * file_name,
-  const size_t time_index,
-  scalar_t * intensities,
-  const int_t subimage_width,
-  const int_t subimage_height,
-  const int_t offset_x,
-  const int_t offset_y,
-  const bool is_layout_right){
-  TEUCHOS_TEST_FOR_EXCEPTION(offset_x!=0&&subimage_width==0,std::runtime_error,"offset_x cannot be nonzero if subimage_width is 0" << file_name);
-  TEUCHOS_TEST_FOR_EXCEPTION(offset_y!=0&&subimage_height==0,std::runtime_error,"offset_y cannot be nonzero if subimage_height is 0" << file_name);
-
-  int_t img_width = 0;
-  int_t img_height = 0;
-  int_t num_time_steps = 0;
-  get_image_dimensions(file_name,img_width,img_height,num_time_steps);
-  TEUCHOS_TEST_FOR_EXCEPTION(time_index < 0 || (int_t)time_index >= num_time_steps,std::runtime_error,"");
-  const int_t width = subimage_width>0?subimage_width:img_width;
-  const int_t height = subimage_height>0?subimage_height:img_height;
-  DEBUG_MSG("NetCDF_Reader::read_netcdf_image(): width " << width << " height " << height << " offset_x " << offset_x << " offset_y " << offset_y);
-
-  // Open the file for read access
-  int ncid;
-  int_t error_int = nc_open(file_name, 0, &ncid);
-  TEUCHOS_TEST_FOR_EXCEPTION(error_int,std::runtime_error,"Error, could not open NetCDF file " << file_name);
-
+/// find the id and type of the image data variable of an open file
+void find_data_variable(const int ncid,
+  const std::string & file_name,
+  int & data_var_index,
+  int & data_type){
   int num_vars = 0;
   nc_inq_nvars(ncid, &num_vars);
   DEBUG_MSG("NetCDF_Reader::get_image(): number of variables in the file: " << num_vars);
-
-  // get the variable names
-  int data_var_index = -1;
-  int data_type = -1;
+  data_var_index = -1;
+  data_type = -1;
   for(int_t i=0;i<num_vars;++i){
-    char var_name[100];
+    char var_name[NC_MAX_NAME+1];
     int nc_type;
     int num_dims = 0;
     int dim_ids[NC_MAX_VAR_DIMS]; // assume less than 100 ids
     int num_var_attr = 0;
     nc_inq_var(ncid,i, &var_name[0], &nc_type,&num_dims, dim_ids, &num_var_attr);
-    nc_inq_varname(ncid, i, &var_name[0]);
-    std::string var_name_str = var_name;
     // netcdf data types: 1: BYTE 2: CHAR 3: SHORT 4: INT 5: FLOAT 6: DOUBLE 7: UBYTE 8: USHORT 9: UINT 10: INT64 12: STRING
-    DEBUG_MSG("NetCDF_Reader::get_image(): found variable " << var_name_str << " type " << nc_type << " num dims " << num_dims << " num attributes " << num_var_attr);
+    DEBUG_MSG("NetCDF_Reader::get_image(): found variable " << var_name << " type " << nc_type << " num dims " << num_dims << " num attributes " << num_var_attr);
     if(strcmp(var_name, "data") == 0){
       data_var_index = i;
       assert(num_dims == 3);
@@ -151,8 +130,18 @@ NetCDF_Reader::read_netcdf_image(const char * file_name,
     }
   }
   TEUCHOS_TEST_FOR_EXCEPTION(data_var_index <0, std::runtime_error,"Error, could not find data or Rad variable in NetCDF file " << file_name);
-  // initialize storage for the data in the netcdf file (read the whole image)
-  //std::vector<storage_t> data(img_width*img_height);
+}
+
+/// read a region of one time step of the data variable (only the region is transferred)
+void read_hyperslab(const int ncid,
+  const int data_var_index,
+  const int data_type,
+  const size_t time_index,
+  const int_t width,
+  const int_t height,
+  const int_t offset_x,
+  const int_t offset_y,
+  scalar_t * intensities){
   std::vector<size_t> starts(3,0); // not all elements are used (assumes max dimension of 3)
   std::vector<size_t> counts(3,0);
   if(data_type==3){
@@ -174,24 +163,221 @@ NetCDF_Reader::read_netcdf_image(const char * file_name,
   else{
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"invalid nc data_type " << data_type);
   }
-
+  int error_int = 0;
   if(std::is_same<scalar_t,float>::value){
     // cast to avoid compiler error for the get var method that isn't used (it expects a pointer of type float)
     // if this if statement is true, this is a no-op, if not it never gets executed
     float * intens = (float *)intensities;
-    nc_get_vara_float(ncid,data_var_index,&starts[0],&counts[0],intens);
+    error_int = nc_get_vara_float(ncid,data_var_index,&starts[0],&counts[0],intens);
   }else if(std::is_same<scalar_t,double>::value){
     // cast to avoid compiler error for the get var method that isn't used (it expects a pointer of type double)
     double * intens = (double *)intensities;
-    nc_get_vara_double(ncid,data_var_index,&starts[0],&counts[0],intens);
+    error_int = nc_get_vara_double(ncid,data_var_index,&starts[0],&counts[0],intens);
   }else{
     TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"invalid intensity storage type for NetCDF (should be float or double)");
   }
+  TEUCHOS_TEST_FOR_EXCEPTION(error_int,std::runtime_error,"Error, NetCDF read failed: " << nc_strerror(error_int));
+}
 
+}// End anonymous namespace
+
+void
+NetCDF_Reader::get_image_dimensions(const std::string & file_name,
+  int_t & width,
+  int_t & height,
+  int_t & num_time_steps){
+  std::lock_guard<std::recursive_mutex> lock(netcdf_mutex());
+  // Open the file for read access
+  int ncid;
+  const int error_int = nc_open(file_name.c_str(), 0, &ncid);
+  TEUCHOS_TEST_FOR_EXCEPTION(error_int,std::runtime_error,"Error, could not open NetCDF file " << file_name);
+  try{
+    inquire_dimensions(ncid,file_name,width,height,num_time_steps);
+  }
+  catch(...){
+    nc_close(ncid);
+    throw;
+  }
   // close the nc_file
   nc_close(ncid);
 }
 
+void
+NetCDF_Reader::read_netcdf_image(const char * file_name,
+  const size_t time_index,
+  scalar_t * intensities,
+  const int_t subimage_width,
+  const int_t subimage_height,
+  const int_t offset_x,
+  const int_t offset_y,
+  const bool is_layout_right){
+  TEUCHOS_TEST_FOR_EXCEPTION(offset_x!=0&&subimage_width==0,std::runtime_error,"offset_x cannot be nonzero if subimage_width is 0" << file_name);
+  TEUCHOS_TEST_FOR_EXCEPTION(offset_y!=0&&subimage_height==0,std::runtime_error,"offset_y cannot be nonzero if subimage_height is 0" << file_name);
+  // reuse the open file of the frame source, but only read this frame
+  NetCDF_Frame_Source source(file_name,false);
+  source.read(time_index,intensities,subimage_width,subimage_height,offset_x,offset_y);
+}
+
+NetCDF_Frame_Source::NetCDF_Frame_Source(const std::string & file_name,
+  const bool read_ahead):
+  file_name_(file_name),
+  ncid_(-1),
+  var_id_(-1),
+  data_type_(-1),
+  width_(0),
+  height_(0),
+  num_time_steps_(0),
+  file_mtime_(0),
+  file_size_(-1),
+  read_ahead_(read_ahead){
+  pending_region_.time_index = -1;
+  pending_region_.width = 0;
+  pending_region_.height = 0;
+  pending_region_.offset_x = 0;
+  pending_region_.offset_y = 0;
+  std::lock_guard<std::recursive_mutex> lock(netcdf_mutex());
+  DEBUG_MSG("NetCDF_Frame_Source::NetCDF_Frame_Source(): opening NetCDF file " << file_name_);
+  struct stat file_stat;
+  if(stat(file_name_.c_str(),&file_stat)==0){
+    file_mtime_ = file_stat.st_mtime;
+    file_size_ = file_stat.st_size;
+  }
+  const int error_int = nc_open(file_name_.c_str(), 0, &ncid_);
+  TEUCHOS_TEST_FOR_EXCEPTION(error_int,std::runtime_error,"Error, could not open NetCDF file " << file_name_);
+  try{
+    inquire_dimensions(ncid_,file_name_,width_,height_,num_time_steps_);
+    find_data_variable(ncid_,file_name_,var_id_,data_type_);
+  }
+  catch(...){
+    nc_close(ncid_);
+    throw;
+  }
+  if(read_ahead_)
+    thread_pool_ = Teuchos::rcp(new Thread_Pool(2));
+}
+
+NetCDF_Frame_Source::~NetCDF_Frame_Source(){
+  if(pending_.valid())
+    pending_.wait();
+  thread_pool_ = Teuchos::null;
+  std::lock_guard<std::recursive_mutex> lock(netcdf_mutex());
+  nc_close(ncid_);
+}
+
+void
+NetCDF_Frame_Source::read_region(const Region & region,
+  scalar_t * intensities){
+  std::lock_guard<std::recursive_mutex> lock(netcdf_mutex());
+  read_hyperslab(ncid_,var_id_,data_type_,region.time_index,region.width,region.height,region.offset_x,region.offset_y,intensities);
+}
+
+void
+NetCDF_Frame_Source::read(const int_t time_index,
+  scalar_t * intensities,
+  const int_t width,
+  const int_t height,
+  const int_t offset_x,
+  const int_t offset_y){
+  Region region;
+  region.time_index = time_index;
+  region.width = width>0?width:width_;
+  region.height = height>0?height:height_;
+  region.offset_x = offset_x;
+  region.offset_y = offset_y;
+  TEUCHOS_TEST_FOR_EXCEPTION(time_index < 0 || time_index >= num_time_steps_,std::runtime_error,
+    "Error, invalid time index " << time_index << " for NetCDF file " << file_name_);
+  TEUCHOS_TEST_FOR_EXCEPTION(offset_x<0||offset_y<0||offset_x+region.width>width_||offset_y+region.height>height_,std::runtime_error,
+    "Error, requested region is outside the frame for NetCDF file " << file_name_);
+  DEBUG_MSG("NetCDF_Frame_Source::read(): time index " << time_index << " width " << region.width << " height " << region.height <<
+    " offset_x " << offset_x << " offset_y " << offset_y);
+
+  std::lock_guard<std::mutex> lock(read_mutex_);
+  bool served = false;
+  if(pending_.valid()){
+    bool pending_failed = false;
+    try{
+      pending_.get();
+    }
+    catch(std::exception &){
+      // only report the failure if this region was the one being read ahead (it is re-read below)
+      pending_failed = true;
+    }
+    if(!pending_failed&&pending_region_==region){
+      DEBUG_MSG("NetCDF_Frame_Source::read(): using the region that was read ahead");
+      std::copy(pending_intensities_.begin(),pending_intensities_.end(),intensities);
+      served = true;
+    }
+  }
+  if(!served)
+    read_region(region,intensities);
+
+  // start reading the same region of the next frame
+  if(read_ahead_&&time_index+1<num_time_steps_){
+    pending_region_ = region;
+    pending_region_.time_index = time_index+1;
+    pending_intensities_.resize(region.width*region.height);
+    pending_ = thread_pool_->submit([this](){read_region(pending_region_,&pending_intensities_[0]);});
+  }
+}
+
+namespace {
+
+/// the open frame sources, keyed by file name
+struct Frame_Source_Registry{
+  /// guards the map
+  std::mutex mutex;
+  /// the sources
+  std::map<std::string,Teuchos::RCP<NetCDF_Frame_Source> > sources;
+};
+
+/// returns the registry of frame sources
+Frame_Source_Registry & frame_source_registry(){
+  // the sources lock the NetCDF mutex when they are destroyed, constructing the mutex first
+  // guarantees that it is destroyed after the registry at exit
+  netcdf_mutex();
+  static Frame_Source_Registry registry;
+  return registry;
+}
+
+/// removes the frame source of a file from the registry so that the next request reopens the file
+/// (must not be called while holding the NetCDF mutex since the source waits for its read ahead)
+void drop_frame_source(const std::string & file_name){
+  Teuchos::RCP<NetCDF_Frame_Source> dropped;
+  Frame_Source_Registry & registry = frame_source_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::map<std::string,Teuchos::RCP<NetCDF_Frame_Source> >::iterator it = registry.sources.find(file_name);
+  if(it==registry.sources.end()) return;
+  DEBUG_MSG("drop_frame_source(): closing the frame source for NetCDF file " << file_name);
+  dropped = it->second;
+  registry.sources.erase(it);
+}
+
+}// End anonymous namespace
+
+bool
+NetCDF_Frame_Source::is_current()const{
+  struct stat file_stat;
+  if(stat(file_name_.c_str(),&file_stat)!=0) return false;
+  return file_stat.st_mtime==file_mtime_&&(int64_t)file_stat.st_size==file_size_;
+}
+
+DICE_LIB_DLL_EXPORT
+Teuchos::RCP<NetCDF_Frame_Source> netcdf_frame_source(const std::string & file_name){
+  Frame_Source_Registry & registry = frame_source_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::map<std::string,Teuchos::RCP<NetCDF_Frame_Source> >::iterator it = registry.sources.find(file_name);
+  if(it!=registry.sources.end()){
+    if(it->second->is_current())
+      return it->second;
+    // the file was modified since it was opened (e.g. frames were appended), reopen it
+    DEBUG_MSG("netcdf_frame_source(): NetCDF file " << file_name << " changed on disk, reopening it");
+    registry.sources.erase(it);
+  }
+  Teuchos::RCP<NetCDF_Frame_Source> source = Teuchos::rcp(new NetCDF_Frame_Source(file_name));
+  registry.sources.insert(std::pair<std::string,Teuchos::RCP<NetCDF_Frame_Source> >(file_name,source));
+  return source;
+}
+
 NetCDF_Writer::NetCDF_Writer(const std::string & file_name,
   const int_t & width,
   const int_t & height,
@@ -203,6 +389,9 @@ NetCDF_Writer::NetCDF_Writer(const std::string & file_name,
   dim_y_(height),
   num_time_steps_(num_time_steps),
   var_names_(var_names){
+  // the file is recreated, an open frame source for it would serve the old contents
+  drop_frame_source(file_name);
+  std::lock_guard<std::recursive_mutex> lock(netcdf_mutex());
 
   // create a netcdf file:
   int_t retval = 0;
@@ -250,6 +439,8 @@ void
 NetCDF_Writer::write_float_array(const std::string var_name,
   const size_t time_index,
   const std::vector<float> & array){
+  drop_frame_source(file_name_);
+  std::lock_guard<std::recursive_mutex> lock(netcdf_mutex());
   // search the list of names to ensure that one matches and get the id:
   int_t var_id = -1;
   for(size_t i=0;i<var_names_.size();++i){
@@ -285,6 +476,8 @@ void
 NetCDF_Writer::write_double_array(const std::string var_name,
   const size_t time_index,
   const std::vector<double> & array){
+  drop_frame_source(file_name_);
+  std::lock_guard<std::recursive_mutex> lock(netcdf_mutex());
 
   // search the list of names to ensure that one matches and get the id:
   int_t var_id = -1;
@@ -319,6 +512,7 @@ NetCDF_Writer::write_double_array(const std::string var_name,
 DICE_LIB_DLL_EXPORT
 Teuchos::ParameterList netcdf_to_lat_long_projection_parameters(const std::string & left_file,
   const std::string & right_file){
+  std::lock_guard<std::recursive_mutex> lock(netcdf_mutex());
 
   // Open the file for read access
   int ncid_left = 0, ncid_right = 0;
@@ -43,12 +43,18 @@
 #define DICE_NETCDF_H
 
 #include <DICe.h>
+#include <DICe_ThreadPool.h>
 
+#include <Teuchos_RCP.hpp>
 #include <Teuchos_ParameterList.hpp>
 #include <Teuchos_XMLParameterListHelpers.hpp>
 
 #include <cassert>
+#include <ctime>
+#include <future>
 #include <iostream>
+#include <mutex>
+#include <string>
 #include <vector>
 
 #if defined(WIN32)
@@ -100,6 +106,125 @@ public:
 };
 
 
+/// \class DICe::netcdf::NetCDF_Frame_Source
+/// \brief Reads the frames of one NetCDF file keeping the file open between frames
+///
+/// The file is opened and the data variable is located once in the constructor. Each read only
+/// transfers the requested region (hyperslab) of the frame. After each read, the same region of the
+/// next time step is read on a background thread so that it is ready when the next frame is requested.
+/// The NetCDF library is not thread safe, so all of the NetCDF calls in this file are serialized.
+class DICE_LIB_DLL_EXPORT
+NetCDF_Frame_Source
+{
+public:
+  /// \brief Constructor, opens the file
+  /// \param file_name the name of the NetCDF file
+  /// \param read_ahead true if the next frame should be read in the background after each read
+  NetCDF_Frame_Source(const std::string & file_name,
+    const bool read_ahead=true);
+
+  /// destructor, waits for a pending read and closes the file
+  ~NetCDF_Frame_Source();
+
+  /// no copies allowed
+  NetCDF_Frame_Source(const NetCDF_Frame_Source &) = delete;
+  /// no copies allowed
+  NetCDF_Frame_Source & operator=(const NetCDF_Frame_Source &) = delete;
+
+  /// returns the width of the full frame
+  int_t width()const{
+    return width_;
+  }
+
+  /// returns the height of the full frame
+  int_t height()const{
+    return height_;
+  }
+
+  /// returns the number of time steps in the file
+  int_t num_time_steps()const{
+    return num_time_steps_;
+  }
+
+  /// returns true if the file has not been modified (time stamp and size) since it was opened
+  bool is_current()const;
+
+  /// \brief Read a region of a frame
+  /// \param time_index the time frame to retrieve
+  /// \param intensities pointer to the intensity array (must be pre-allocated to the size of the region)
+  /// \param width width of the region (0 for the full frame width)
+  /// \param height height of the region (0 for the full frame height)
+  /// \param offset_x offset of the region in x
+  /// \param offset_y offset of the region in y
+  void read(const int_t time_index,
+    scalar_t * intensities,
+    const int_t width=0,
+    const int_t height=0,
+    const int_t offset_x=0,
+    const int_t offset_y=0);
+
+private:
+  /// region of a frame
+  struct Region{
+    /// time index
+    int_t time_index;
+    /// width
+    int_t width;
+    /// height
+    int_t height;
+    /// offset x
+    int_t offset_x;
+    /// offset y
+    int_t offset_y;
+    /// true if both regions are the same
+    bool operator==(const Region & rhs)const{
+      return time_index==rhs.time_index&&width==rhs.width&&height==rhs.height&&offset_x==rhs.offset_x&&offset_y==rhs.offset_y;
+    }
+  };
+
+  /// read a region from the file
+  void read_region(const Region & region,
+    scalar_t * intensities);
+
+  /// name of the file
+  std::string file_name_;
+  /// id of the open file
+  int ncid_;
+  /// id of the data variable
+  int var_id_;
+  /// NetCDF type of the data variable
+  int data_type_;
+  /// full frame width
+  int_t width_;
+  /// full frame height
+  int_t height_;
+  /// number of time steps
+  int_t num_time_steps_;
+  /// modification time of the file when it was opened
+  time_t file_mtime_;
+  /// size of the file in bytes when it was opened
+  int64_t file_size_;
+  /// true if the next frame is read in the background
+  bool read_ahead_;
+  /// serializes calls to read()
+  std::mutex read_mutex_;
+  /// region that is being read ahead
+  Region pending_region_;
+  /// intensities of the region that is being read ahead
+  std::vector<scalar_t> pending_intensities_;
+  /// completion of the read ahead
+  std::future<void> pending_;
+  /// background thread for the read ahead (declared last so it is joined before the buffers are destroyed)
+  Teuchos::RCP<Thread_Pool> thread_pool_;
+};
+
+/// returns the frame source for a NetCDF file, the sources are created on first use and
+/// kept open for the rest of the run. A source is reopened if the file's time stamp or size
+/// changed since it was opened, and dropped when the file is written by a NetCDF_Writer.
+/// \param file_name the name of the NetCDF file
+DICE_LIB_DLL_EXPORT
+Teuchos::RCP<NetCDF_Frame_Source> netcdf_frame_source(const std::string & file_name);
+
 /// class to write float arrays out a netcdf file
 class DICE_LIB_DLL_EXPORT
 NetCDF_Writer
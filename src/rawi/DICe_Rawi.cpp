@@ -39,31 +39,123 @@
 // ************************************************************************
 // @HEADER
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <fstream>
 #include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include <DICe_Rawi.h>
 
 namespace DICe{
 namespace utils{
 
+namespace{
+
+/// size of the header in bytes (width, height and bytes per value)
+const size_t rawi_header_size = 3*sizeof(uint32_t);
+
+/// tile size used for transposing the values to or from layout left
+const int_t transpose_block_size = 32;
+
+/// check the bytes per value word of a rawi header against the size of type S
+/// \param num_bytes the third word of the header
+/// \param file_name the name of the file (for error messages)
+template <typename S>
+void check_rawi_value_size(const uint32_t num_bytes,
+  const char * file_name){
+  // check that the byte size of the intensity values in the file is compatible with the current
+  // size used to store intensity_t values
+  if(num_bytes!=sizeof(S))
+    throw std::runtime_error("Error, can't read rawi file because it was saved using a different basic type for the value storage: " + (std::string)file_name);
+}
+
+/// read the header of a rawi file and check that the values are stored as type S,
+/// leaves the stream positioned at the first value
+template <typename S>
+void read_rawi_header(std::ifstream & rawi_file,
+  const char * file_name,
+  uint32_t & w,
+  uint32_t & h){
+  uint32_t num_bytes = 0;
+  rawi_file.read(reinterpret_cast<char*>(&w), sizeof(uint32_t));
+  rawi_file.read(reinterpret_cast<char*>(&h), sizeof(uint32_t));
+  rawi_file.read(reinterpret_cast<char*>(&num_bytes), sizeof(uint32_t));
+  if(!rawi_file)
+    throw std::runtime_error("Error, can't read the header of rawi file: " + (std::string)file_name);
+  check_rawi_value_size<S>(num_bytes,file_name);
+}
+
+/// copy a rows x cols row-major array into column-major order (dst[c*rows+r] = src[r*cols+c])
+/// one tile at a time so that the strided side of the copy stays in cache
+template <typename S>
+void transpose_blocked(const S * src,
+  S * dst,
+  const int_t rows,
+  const int_t cols){
+  for(int_t r0=0;r0<rows;r0+=transpose_block_size){
+    const int_t r1 = std::min(r0+transpose_block_size,rows);
+    for(int_t c0=0;c0<cols;c0+=transpose_block_size){
+      const int_t c1 = std::min(c0+transpose_block_size,cols);
+      for(int_t r=r0;r<r1;++r)
+        for(int_t c=c0;c<c1;++c)
+          dst[c*rows+r] = src[r*cols+c];
+    }
+  }
+}
+
+#if !defined(WIN32)
+/// releases the file mapping behind an array returned by map_rawi_image()
+template <typename S>
+class Rawi_Unmap{
+public:
+  /// type of the pointer being released
+  typedef S ptr_t;
+  /// constructor
+  /// \param address the start of the mapping
+  /// \param length the length of the mapping in bytes
+  Rawi_Unmap(void * address,
+    const size_t length):
+  address_(address),
+  length_(length){};
+  /// unmap the file
+  void free(S * ptr){
+    munmap(address_,length_);
+  }
+private:
+  /// the start of the mapping
+  void * address_;
+  /// the length of the mapping in bytes
+  size_t length_;
+};
+#endif
+
+} // end anonymous namespace
+
 DICE_LIB_DLL_EXPORT
 void read_rawi_image_dimensions(const char * file_name,
   int_t & width,
   int_t & height){
 
   std::ifstream rawi_file (file_name, std::ifstream::in | std::ifstream::binary);
-  if (rawi_file.fail()){
-    std::cerr << "ERROR: Can't open the file: " + (std::string)file_name << std::endl;
-    exit(1);
-  }
+  if (rawi_file.fail())
+    throw std::runtime_error("Error, can't open the file: " + (std::string)file_name);
   // read the file details
   uint32_t w = 0;
   uint32_t h = 0;
   rawi_file.read(reinterpret_cast<char*>(&w), sizeof(w));
   rawi_file.read(reinterpret_cast<char*>(&h), sizeof(h));
+  if(!rawi_file)
+    throw std::runtime_error("Error, can't read the header of rawi file: " + (std::string)file_name);
   width = w;
   height = h;
   rawi_file.close();
@@ -76,34 +168,24 @@ void read_rawi_image(const char * file_name,
   const bool is_layout_right){
 
   std::ifstream rawi_file (file_name, std::ifstream::in | std::ifstream::binary);
-  if (!rawi_file.is_open()){
-    std::cerr << "ERROR: Can't open the file: " + (std::string)file_name << std::endl;
-    exit(1);
-  }
+  if (!rawi_file.is_open())
+    throw std::runtime_error("Error, can't open the file: " + (std::string)file_name);
   // read the file details
   uint32_t w = 0;
   uint32_t h = 0;
-  uint32_t num_bytes = 0;
-  rawi_file.read(reinterpret_cast<char*>(&w), sizeof(uint32_t));
-  rawi_file.read(reinterpret_cast<char*>(&h), sizeof(uint32_t));
-  rawi_file.read(reinterpret_cast<char*>(&num_bytes), sizeof(uint32_t));
-  // check that the byte size of the intensity values in the file is compatible with the current
-  // size used to store intensity_t values
-  if(num_bytes!=sizeof(S)){
-    std::cerr << "Can't read rawi file because it was saved using a different basic type for the value storage: " + (std::string)file_name << std::endl;
-    exit(1);
-  }
-  // read the image data:
-  for (uint32_t y=0; y<h; ++y) {
-    if(is_layout_right)
-      for (uint32_t x=0; x<w;++x){
-        rawi_file.read(reinterpret_cast<char*>(&intensities[y*w+x]),sizeof(S));
-      }
-    else // otherwise assume layout left
-      for (uint32_t x=0; x<w;++x){
-        rawi_file.read(reinterpret_cast<char*>(&intensities[x*h+y]),sizeof(S));
-      }
+  read_rawi_header<S>(rawi_file,file_name,w,h);
+  const size_t num_values = (size_t)w*h;
+  // read the image data in one call:
+  if(is_layout_right)
+    rawi_file.read(reinterpret_cast<char*>(intensities),num_values*sizeof(S));
+  else{ // otherwise assume layout left
+    std::vector<S> row_major(num_values);
+    rawi_file.read(reinterpret_cast<char*>(row_major.data()),num_values*sizeof(S));
+    if(rawi_file)
+      transpose_blocked(row_major.data(),intensities,h,w);
   }
+  if(!rawi_file)
+    throw std::runtime_error("Error, rawi file is truncated: " + (std::string)file_name);
   rawi_file.close();
 }
 
@@ -116,6 +198,62 @@ template
 DICE_LIB_DLL_EXPORT
 void read_rawi_image(const char *,scalar_t *,const bool);
 
+template <typename S>
+DICE_LIB_DLL_EXPORT
+Teuchos::ArrayRCP<S> map_rawi_image(const char * file_name,
+  int_t & width,
+  int_t & height){
+  read_rawi_image_dimensions(file_name,width,height);
+  const size_t num_values = (size_t)width*height;
+#if !defined(WIN32)
+  // the values start right after the 12 byte header and the mapping itself is page aligned, so
+  // the values can only be viewed in place for types of up to 4 bytes (8 byte values would be
+  // misaligned and are read with a copy instead)
+  if(num_values>0&&rawi_header_size%alignof(S)==0){
+    const int fd = open(file_name,O_RDONLY);
+    if(fd<0)
+      throw std::runtime_error("Error, can't open the file: " + (std::string)file_name);
+    uint32_t header[3] = {0,0,0};
+    if(pread(fd,header,sizeof(header),0)!=(ssize_t)sizeof(header)){
+      close(fd);
+      throw std::runtime_error("Error, can't read the header of rawi file: " + (std::string)file_name);
+    }
+    try{
+      check_rawi_value_size<S>(header[2],file_name);
+    }
+    catch(...){
+      close(fd);
+      throw;
+    }
+    struct stat file_stat;
+    const size_t length = rawi_header_size + num_values*sizeof(S);
+    if(fstat(fd,&file_stat)!=0||(size_t)file_stat.st_size<length){
+      close(fd);
+      throw std::runtime_error("Error, rawi file is truncated: " + (std::string)file_name);
+    }
+    // private mapping so that in place operations on the image (filters, etc.) do not modify the file
+    void * address = mmap(NULL,length,PROT_READ|PROT_WRITE,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(address!=MAP_FAILED){
+      S * values = reinterpret_cast<S*>(static_cast<char*>(address) + rawi_header_size);
+      return Teuchos::arcp(values,0,num_values,Rawi_Unmap<S>(address,length),true);
+    }
+  }
+#endif
+  Teuchos::ArrayRCP<S> intensities(num_values,0.0);
+  read_rawi_image(file_name,intensities.getRawPtr(),true);
+  return intensities;
+}
+
+#ifndef STORAGE_SCALAR_SAME_TYPE
+template
+DICE_LIB_DLL_EXPORT
+Teuchos::ArrayRCP<storage_t> map_rawi_image(const char *,int_t &,int_t &);
+#endif
+template
+DICE_LIB_DLL_EXPORT
+Teuchos::ArrayRCP<scalar_t> map_rawi_image(const char *,int_t &,int_t &);
+
 template <typename S>
 DICE_LIB_DLL_EXPORT
 void write_rawi_image(const char * file_name,
@@ -132,27 +270,24 @@ void write_rawi_image(const char * file_name,
   uint32_t num_bytes = sizeof(S);
   //create a new file:
   std::ofstream rawi_file (file_name, std::ofstream::out | std::ofstream::binary);
-  if (!rawi_file.is_open()){
-    std::cerr << "ERROR: Can't open the file: " + (std::string)file_name << std::endl;
-    exit(1);
-  }
+  if (!rawi_file.is_open())
+    throw std::runtime_error("Error, can't open the file: " + (std::string)file_name);
   // write the file details
   rawi_file.write(reinterpret_cast<char*>(&w), sizeof(uint32_t));
   rawi_file.write(reinterpret_cast<char*>(&h), sizeof(uint32_t));
   rawi_file.write(reinterpret_cast<char*>(&num_bytes), sizeof(uint32_t));
 
-  // write the image data:
-  for (int_t y=0; y<height; ++y) {
-    if(is_layout_right){
-      for (int_t x=0; x<width;++x){
-        rawi_file.write(reinterpret_cast<char*>(&intensities[y*width + x]),sizeof(S));
-      }
-    }
-    else // otherwise assume layout left
-      for (int_t x=0; x<width;++x){
-        rawi_file.write(reinterpret_cast<char*>(&intensities[x*height+y]),sizeof(S));
-      }
+  // write the image data in one call:
+  const size_t num_values = (size_t)width*height;
+  if(is_layout_right)
+    rawi_file.write(reinterpret_cast<const char*>(intensities),num_values*sizeof(S));
+  else{ // otherwise assume layout left
+    std::vector<S> row_major(num_values);
+    transpose_blocked(intensities,row_major.data(),width,height);
+    rawi_file.write(reinterpret_cast<const char*>(row_major.data()),num_values*sizeof(S));
   }
+  if(!rawi_file)
+    throw std::runtime_error("Error, failed to write the file: " + (std::string)file_name);
   rawi_file.close();
 }
 #ifndef STORAGE_SCALAR_SAME_TYPE
@@ -44,6 +44,8 @@
 
 #include <DICe.h>
 
+#include <Teuchos_ArrayRCP.hpp>
+
 #include <string>
 
 namespace DICe{
@@ -52,6 +54,10 @@ namespace utils{
 /// Raw Intensity Format (.rawi), allows saving decimal numbers
 /// as well as negative numbers, neither of which are enabled for
 /// standard image file formats
+///
+/// The file is a 12 byte header (width, height and the number of bytes
+/// per value as uint32_t) followed by the values in row-major order.
+/// Errors are reported by throwing std::runtime_error.
 
 /// read the image dimensions
 /// \param file_name the .rawi file name
@@ -72,6 +78,28 @@ void read_rawi_image(const char * file_name,
   S * intensities,
   const bool is_layout_right = true);
 
+/// Map the values of an image into memory without copying them
+/// \param file_name the name of the .rawi file
+/// \param width [out] returned as the width of the image
+/// \param height [out] returned as the height of the image
+///
+/// The returned array is in LayoutRight (row-major) and views the file mapping,
+/// which is released when the last copy of the array goes away. The mapping is
+/// private, so changes to the values are not written back to the file. If the
+/// file cannot be mapped (on Windows, or for 8 byte values, which are not
+/// aligned after the 12 byte header) the values are read into a new array instead.
+///
+/// The values are paged in from the file as they are accessed, so the file must
+/// not be truncated or rewritten while the array is alive: pages that have not
+/// been touched yet would show the new contents, and accessing values past the
+/// end of a truncated file raises SIGBUS. Use read_rawi_image() to read files
+/// that may change while the image is in use.
+template <typename S>
+DICE_LIB_DLL_EXPORT
+Teuchos::ArrayRCP<S> map_rawi_image(const char * file_name,
+  int_t & width,
+  int_t & height);
+
 /// write an image to disk
 /// \param file_name the name of the .rawi file
 /// \param width the width of the image to write
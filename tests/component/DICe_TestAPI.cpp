@@ -54,6 +54,8 @@
 #include <Teuchos_RCP.hpp>
 
 #include <cassert>
+#include <thread>
+#include <vector>
 
 int main(int argc, char *argv[]) {
 
@@ -236,6 +238,68 @@ int main(int argc, char *argv[]) {
 
   } // image loop
 
+  *outStream << "correlating all the images as one batch in two concurrent contexts" << std::endl;
+  std::vector<Teuchos::ArrayRCP<storage_t> > def_arrays;
+  std::vector<const storage_t *> def_ptrs;
+  for(size_t img=0;img<def_names.size();++img){
+    Teuchos::RCP<DICe::Image> defImg = Teuchos::rcp( new DICe::Image(def_names[img].c_str()));
+    def_arrays.push_back(defImg->intensities());
+    def_ptrs.push_back(def_arrays[img].get());
+  }
+  std::vector<scalar_t> init_points(num_subsets*DICE_API_STRIDE,0.0);
+  for(int_t subsetIt=0;subsetIt<num_subsets;++subsetIt){
+    init_points[subsetIt*DICE_API_STRIDE + 0] = subset_centroids_x[subsetIt];
+    init_points[subsetIt*DICE_API_STRIDE + 1] = subset_centroids_y[subsetIt];
+  }
+  const int_t num_contexts = 2;
+  std::vector<dice_context*> contexts(num_contexts,0);
+  contexts[0] = dice_create_context(&init_points[0],num_subsets,subset_size,ref_img.get(),ref_w,ref_h);
+  contexts[1] = dice_create_context(&init_points[0],num_subsets,subset_size,ref_img.get(),ref_w,ref_h,params.getRawPtr());
+  std::vector<int_t> batch_status(num_contexts,-1);
+  std::vector<std::thread> threads;
+  for(int_t c=0;c<num_contexts;++c){
+    if(contexts[c]==0){
+      *outStream << "Error, context " << c << " could not be created" << std::endl;
+      errorFlag++;
+      continue;
+    }
+    threads.push_back(std::thread([&,c](){
+      batch_status[c] = dice_correlate_frames(contexts[c],&def_ptrs[0],def_ptrs.size(),ref_w,ref_h);
+    }));
+  }
+  for(size_t t=0;t<threads.size();++t)
+    threads[t].join();
+  std::vector<scalar_t> batch_points(num_subsets*DICE_API_STRIDE,0.0);
+  for(int_t c=0;c<num_contexts;++c){
+    if(contexts[c]==0) continue;
+    if(batch_status[c]!=0){
+      *outStream << "Error, batch correlation failed for context " << c << std::endl;
+      errorFlag++;
+    }
+    for(size_t img=0;img<def_names.size();++img){
+      if(dice_fetch_results(contexts[c],img,&batch_points[0])!=0){
+        *outStream << "Error, results not available for context " << c << " image " << img << std::endl;
+        errorFlag++;
+        continue;
+      }
+      for(int_t i=0;i<num_subsets;++i){
+        *outStream << "     context " << c << " image " << img << " subset " << i <<
+            " u " << batch_points[i*DICE_API_STRIDE + 2] <<
+            " v " << batch_points[i*DICE_API_STRIDE + 3] << std::endl;
+        if ( std::abs(batch_points[i*DICE_API_STRIDE + 2] - img) > errtol ||
+            std::abs(batch_points[i*DICE_API_STRIDE + 3] - img) > errtol) {
+          *outStream << "Error, batch displacement is not correct for context " << c << " image: " << img << std::endl;
+          errorFlag++;
+        };
+      }
+    }
+    if(dice_fetch_results(contexts[c],def_names.size(),&batch_points[0])==0){
+      *outStream << "Error, results should not be available past the end of the batch" << std::endl;
+      errorFlag++;
+    }
+    dice_destroy_context(contexts[c]);
+  }
+
 
   if (errorFlag != 0)
     std::cout << "End Result: TEST FAILED\n";
@@ -0,0 +1,177 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+#include <DICe.h>
+#include <DICe_Image.h>
+#include <DICe_ImageIO.h>
+#include <DICe_Schema.h>
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_oblackholestream.hpp>
+#include <Teuchos_ParameterList.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace DICe;
+
+/// name of a frame of the test cine file
+std::string frame_name(const int_t frame){
+  std::stringstream name;
+  name << "./images/phantom_v1610_" << frame << ".cine";
+  return name.str();
+}
+
+/// compare the deformed image of a schema with the same window of a frame that was read directly
+int_t compare_to_direct(Teuchos::RCP<Image> img,
+  const std::vector<storage_t> & direct,
+  const int_t full_width,
+  const int_t frame,
+  Teuchos::RCP<std::ostream> & outStream){
+  for(int_t y=0;y<img->height();++y){
+    for(int_t x=0;x<img->width();++x){
+      if((*img)(x,y)!=direct[(y+img->offset_y())*full_width+x+img->offset_x()]){
+        *outStream << "Error, the intensities of frame " << frame << " do not match the direct read" << std::endl;
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+  DICe::initialize(argc, argv);
+
+  // only print output if args are given (for testing the output is quiet)
+  int_t iprint     = argc - 1;
+  int_t errorFlag  = 0;
+  Teuchos::RCP<std::ostream> outStream;
+  Teuchos::oblackholestream bhs; // outputs nothing
+  if (iprint > 0)
+    outStream = Teuchos::rcp(&std::cout, false);
+  else
+    outStream = Teuchos::rcp(&bhs, false);
+
+  *outStream << "--- Begin test ---" << std::endl;
+
+  const std::string cine_file = "./images/phantom_v1610.cine";
+  const hypercine::HyperCine::Bit_Depth_Conversion_Type conversion_type = hypercine::HyperCine::TO_8_BIT;
+  const int_t first_frame = DICe::utils::video_file_first_frame_id(cine_file);
+  const int_t num_frames = DICe::utils::video_file_frame_count(cine_file);
+  int_t w = 0, h = 0;
+  DICe::utils::read_image_dimensions(frame_name(first_frame).c_str(),w,h);
+  *outStream << "cine file has " << num_frames << " frames of " << w << " x " << h << std::endl;
+
+  *outStream << "reading each frame with a synchronous buffer read" << std::endl;
+  std::vector<std::vector<storage_t> > direct(num_frames);
+  for(int_t frame=0;frame<num_frames;++frame){
+    DICe::utils::cine_file_read_buffer(cine_file,conversion_type,first_frame+frame,1);
+    storage_t * data = DICe::utils::Video_Singleton::instance().hypercine(cine_file,conversion_type)->data(first_frame+frame,0,w,0,h);
+    direct[frame].assign(data,data+w*h);
+  }
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  params->set(DICe::gauss_filter_images,false);
+  params->set(DICe::filter_failed_cine_pixels,false);
+  params->set(DICe::convert_cine_to_8_bit,true);
+  const int_t subset_size = 21;
+
+  *outStream << "testing full frame buffers of two frames (crossing two buffer boundaries)" << std::endl;
+  {
+    Teuchos::ArrayRCP<scalar_t> coords_x(1,w/2);
+    Teuchos::ArrayRCP<scalar_t> coords_y(1,h/2);
+    Teuchos::RCP<Schema> schema = Teuchos::rcp(new Schema(coords_x,coords_y,subset_size,Teuchos::null,Teuchos::null,params));
+    schema->set_cine_buffer_num_frames(2);
+    schema->set_frame_range(first_frame,num_frames,1);
+    schema->set_ref_image(frame_name(first_frame));
+    for(int_t frame=0;frame<num_frames;++frame){
+      schema->set_def_image(frame_name(first_frame+frame));
+      if(schema->def_img()->width()!=w||schema->def_img()->height()!=h){
+        *outStream << "Error, frame " << frame << " should be a full frame" << std::endl;
+        errorFlag++;
+      }
+      errorFlag += compare_to_direct(schema->def_img(),direct[frame],w,frame,outStream);
+      schema->update_frame_id();
+    }
+  }
+
+  *outStream << "testing extents with the read ahead window hit and missed" << std::endl;
+  {
+    // the extents are the subset positions plus 100 pixels, offsets within 100 pixels of the image boundary are
+    // not used, so only the x offset changes for this image. Frame 1 and the last frames use the window that
+    // was read ahead (the previous window plus 50 pixels), frame 2 moves outside of the predicted window
+    TEUCHOS_TEST_FOR_EXCEPTION(num_frames<4,std::runtime_error,"Error, the test cine file should have at least 4 frames");
+    Teuchos::ArrayRCP<scalar_t> coords_x(1,210);
+    Teuchos::ArrayRCP<scalar_t> coords_y(1,h/2);
+    Teuchos::RCP<Schema> schema = Teuchos::rcp(new Schema(coords_x,coords_y,subset_size,Teuchos::null,Teuchos::null,params));
+    schema->set_frame_range(first_frame,num_frames,1);
+    schema->set_ref_image(frame_name(first_frame));
+    for(int_t frame=0;frame<num_frames;++frame){
+      schema->local_field_value(0,DICe::field_enums::SUBSET_DISPLACEMENT_X_FS) = frame<2 ? 0.0 : -130.0;
+      schema->update_extents();
+      schema->set_def_image(frame_name(first_frame+frame));
+      // frame 0 is read with the extents, frame 1 with the window read ahead, frame 2 misses the
+      // predicted window and is read with the extents, after that the window is the full width
+      const int_t expected_offset_x = frame==0 ? 110 : frame==1 ? 60 : 0;
+      if(schema->def_img()->offset_x()!=expected_offset_x||schema->def_img()->width()!=w-expected_offset_x){
+        *outStream << "Error, frame " << frame << " has offset x " << schema->def_img()->offset_x() << " and width " <<
+            schema->def_img()->width() << " but should have offset x " << expected_offset_x << " and width " << w-expected_offset_x << std::endl;
+        errorFlag++;
+      }
+      errorFlag += compare_to_direct(schema->def_img(),direct[frame],w,frame,outStream);
+      schema->update_frame_id();
+    }
+  }
+
+  *outStream << "--- End test ---" << std::endl;
+
+  DICe::finalize();
+
+  if (errorFlag != 0)
+    std::cout << "End Result: TEST FAILED\n";
+  else
+    std::cout << "End Result: TEST PASSED\n";
+
+  return 0;
+
+}
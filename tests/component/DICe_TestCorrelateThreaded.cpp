@@ -0,0 +1,219 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+/*! \file  DICe_TestCorrelateThreaded.cpp
+    \brief Test that correlating the subsets and post processing the strains with
+    multiple threads gives the same results as the serial loops
+*/
+
+#include <DICe.h>
+#include <DICe_Schema.h>
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_oblackholestream.hpp>
+#include <Teuchos_ParameterList.hpp>
+#include <Teuchos_XMLParameterListHelpers.hpp>
+
+#include <iostream>
+#include <cstdio>
+
+#include <cassert>
+
+using namespace DICe;
+using namespace DICe::field_enums;
+
+int main(int argc, char *argv[]) {
+
+  DICe::initialize(argc, argv);
+
+  int_t iprint     = argc - 1;
+  Teuchos::RCP<std::ostream> outStream;
+  Teuchos::oblackholestream bhs; // outputs nothing
+  if (iprint > 0)
+    outStream = Teuchos::rcp(&std::cout, false);
+  else
+    outStream = Teuchos::rcp(&bhs, false);
+  int_t errorFlag  = 0;
+
+  *outStream << "--- Begin test ---" << std::endl;
+
+  Image img("./images/refSpeckled.tif");
+  const int_t roi_w = img.width();
+  const int_t roi_h = img.height();
+  const int_t step_size = 21;
+  const int_t subset_size = 31;
+
+  // the fields that have to match exactly between the serial and threaded runs
+  std::vector<Field_Spec> specs;
+  specs.push_back(SUBSET_DISPLACEMENT_X_FS);
+  specs.push_back(SUBSET_DISPLACEMENT_Y_FS);
+  specs.push_back(ROTATION_Z_FS);
+  specs.push_back(SIGMA_FS);
+  specs.push_back(GAMMA_FS);
+  specs.push_back(BETA_FS);
+  specs.push_back(STATUS_FLAG_FS);
+  specs.push_back(ITERATIONS_FS);
+
+  // neighbor values exercises the dependency aware scheduler
+  const int_t num_init_methods = 3;
+  const Initialization_Method init_methods[num_init_methods] = {USE_FIELD_VALUES,USE_ZEROS,USE_NEIGHBOR_VALUES};
+  for(int_t m=0;m<num_init_methods;++m){
+    *outStream << "testing initialization method " << initializationMethodStrings[init_methods[m]] << std::endl;
+    std::vector<Teuchos::RCP<Schema> > schemas;
+    const int_t num_threads[2] = {1,4};
+    for(int_t t=0;t<2;++t){
+      Teuchos::RCP<Teuchos::ParameterList> params = rcp(new Teuchos::ParameterList());
+      params->set(DICe::initialization_method,init_methods[m]);
+      params->set(DICe::interpolation_method,DICe::KEYS_FOURTH);
+      params->set(DICe::enable_rotation,true);
+      params->set(DICe::output_beta,true);
+      params->set(DICe::num_threads,num_threads[t]);
+      Teuchos::RCP<Schema> schema = Teuchos::rcp(new Schema(roi_w,roi_h,step_size,step_size,subset_size,params));
+      schema->set_ref_image("./images/refSpeckled.tif");
+      schema->set_def_image("./images/defSpeckled.tif");
+      schema->execute_correlation();
+      *outStream << "num_threads requested: " << num_threads[t] << " used: " << schema->num_threads() << std::endl;
+      schemas.push_back(schema);
+    }
+    if(schemas[0]->local_num_subsets()!=schemas[1]->local_num_subsets()){
+      *outStream << "Error, the number of subsets does not match" << std::endl;
+      errorFlag++;
+      continue;
+    }
+    int_t num_mismatch = 0;
+    for(int_t i=0;i<schemas[0]->local_num_subsets();++i){
+      for(size_t j=0;j<specs.size();++j){
+        const scalar_t serial_value = schemas[0]->local_field_value(i,specs[j]);
+        const scalar_t threaded_value = schemas[1]->local_field_value(i,specs[j]);
+        if(serial_value!=threaded_value){
+          *outStream << "Error, subset " << i << " field " << specs[j].get_name_label() << " serial value " << serial_value <<
+              " threaded value " << threaded_value << std::endl;
+          num_mismatch++;
+        }
+      }
+      const scalar_t disp_x = schemas[1]->local_field_value(i,SUBSET_DISPLACEMENT_X_FS);
+      const scalar_t disp_y = schemas[1]->local_field_value(i,SUBSET_DISPLACEMENT_Y_FS);
+      if(disp_x<0.1||disp_x>0.8||disp_y<0.1||disp_y>0.8){
+        *outStream << "Error, subset " << i << " displacement is out of the expected range " << disp_x << " " << disp_y << std::endl;
+        num_mismatch++;
+      }
+    }
+    if(num_mismatch>0){
+      *outStream << "Error, the threaded and serial results differ" << std::endl;
+      errorFlag++;
+    }
+  }
+
+  *outStream << "testing the VSG and NLVC strain post processors" << std::endl;
+#if defined(WIN32)
+  std::string params_file = ".\\decomp\\params.xml";
+#else
+  std::string params_file = "./decomp/params.xml";
+#endif
+  // the strain fields that have to match exactly between the serial and threaded post processors
+  std::vector<Field_Spec> strain_specs;
+  strain_specs.push_back(VSG_STRAIN_XX_FS);
+  strain_specs.push_back(VSG_STRAIN_YY_FS);
+  strain_specs.push_back(VSG_STRAIN_XY_FS);
+  strain_specs.push_back(VSG_DUDX_FS);
+  strain_specs.push_back(VSG_DUDY_FS);
+  strain_specs.push_back(VSG_DVDX_FS);
+  strain_specs.push_back(VSG_DVDY_FS);
+  strain_specs.push_back(NLVC_STRAIN_XX_FS);
+  strain_specs.push_back(NLVC_STRAIN_YY_FS);
+  strain_specs.push_back(NLVC_STRAIN_XY_FS);
+  strain_specs.push_back(NLVC_DUDX_FS);
+  strain_specs.push_back(NLVC_DUDY_FS);
+  strain_specs.push_back(NLVC_DVDX_FS);
+  strain_specs.push_back(NLVC_DVDY_FS);
+  {
+    std::vector<Teuchos::RCP<Schema> > schemas;
+    const int_t num_threads[2] = {1,4};
+    for(int_t t=0;t<2;++t){
+      Teuchos::RCP<Teuchos::ParameterList> params = rcp(new Teuchos::ParameterList());
+      Teuchos::Ptr<Teuchos::ParameterList> paramsPtr(params.get());
+      Teuchos::updateParametersFromXmlFile(params_file,paramsPtr);
+      params->set(DICe::num_threads,num_threads[t]);
+      Teuchos::RCP<Schema> schema = Teuchos::rcp(new Schema(roi_w,roi_h,step_size,step_size,subset_size,params));
+      schema->set_ref_image("./images/refSpeckled.tif");
+      schema->set_def_image("./images/defSpeckled.tif");
+      schema->execute_correlation();
+      schema->execute_post_processors();
+      *outStream << "num_threads requested: " << num_threads[t] << " used: " << schema->num_threads() << std::endl;
+      schemas.push_back(schema);
+    }
+    int_t num_mismatch = 0;
+    int_t num_nonzero = 0;
+    for(int_t i=0;i<schemas[0]->local_num_subsets();++i){
+      for(size_t j=0;j<strain_specs.size();++j){
+        const scalar_t serial_value = schemas[0]->local_field_value(i,strain_specs[j]);
+        const scalar_t threaded_value = schemas[1]->local_field_value(i,strain_specs[j]);
+        if(serial_value!=0.0) num_nonzero++;
+        if(serial_value!=threaded_value){
+          *outStream << "Error, subset " << i << " field " << strain_specs[j].get_name_label() << " serial value " << serial_value <<
+              " threaded value " << threaded_value << std::endl;
+          num_mismatch++;
+        }
+      }
+    }
+    if(num_mismatch>0){
+      *outStream << "Error, the threaded and serial strains differ" << std::endl;
+      errorFlag++;
+    }
+    // make sure the comparison is not trivially between two empty fields
+    if(num_nonzero==0){
+      *outStream << "Error, the strain post processors did not compute any values" << std::endl;
+      errorFlag++;
+    }
+  }
+
+  *outStream << "--- End test ---" << std::endl;
+
+  DICe::finalize();
+
+  if (errorFlag != 0)
+    std::cout << "End Result: TEST FAILED\n";
+  else
+    std::cout << "End Result: TEST PASSED\n";
+
+  return 0;
+
+}
@@ -50,7 +50,9 @@
 #include <Teuchos_oblackholestream.hpp>
 #include <Teuchos_XMLParameterListHelpers.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 using namespace DICe;
 
@@ -118,6 +120,54 @@ int main(int argc, char *argv[]) {
     *outStream << "Error, wrong number of global subsets" << std::endl;
   }
 
+  *outStream << "testing the recursive coordinate bisection" << std::endl;
+  // grid of points where the left half has three times the weight of the right half
+  const int_t grid_w = 20;
+  const int_t grid_h = 15;
+  std::vector<scalar_t> grid_x;
+  std::vector<scalar_t> grid_y;
+  std::vector<scalar_t> grid_weights;
+  scalar_t total_weight = 0.0;
+  for(int_t j=0;j<grid_h;++j){
+    for(int_t i=0;i<grid_w;++i){
+      grid_x.push_back(i*10.0);
+      grid_y.push_back(j*10.0);
+      grid_weights.push_back(i<grid_w/2 ? 3.0 : 1.0);
+      total_weight += grid_weights.back();
+    }
+  }
+  const int_t num_parts = 4;
+  const std::vector<int_t> parts = recursive_coordinate_bisection(grid_x,grid_y,grid_weights,num_parts);
+  std::vector<scalar_t> part_weights(num_parts,0.0);
+  std::vector<scalar_t> part_min_x(num_parts,1.0E10);
+  std::vector<scalar_t> part_max_x(num_parts,-1.0E10);
+  std::vector<scalar_t> part_min_y(num_parts,1.0E10);
+  std::vector<scalar_t> part_max_y(num_parts,-1.0E10);
+  for(size_t i=0;i<parts.size();++i){
+    part_weights[parts[i]] += grid_weights[i];
+    part_min_x[parts[i]] = std::min(part_min_x[parts[i]],grid_x[i]);
+    part_max_x[parts[i]] = std::max(part_max_x[parts[i]],grid_x[i]);
+    part_min_y[parts[i]] = std::min(part_min_y[parts[i]],grid_y[i]);
+    part_max_y[parts[i]] = std::max(part_max_y[parts[i]],grid_y[i]);
+  }
+  scalar_t parts_area = 0.0;
+  for(int_t p=0;p<num_parts;++p){
+    *outStream << "part " << p << " weight " << part_weights[p] << " x " << part_min_x[p] << " to " << part_max_x[p] <<
+        " y " << part_min_y[p] << " to " << part_max_y[p] << std::endl;
+    if(std::abs(part_weights[p] - total_weight/num_parts) > 3.0){
+      errorFlag++;
+      *outStream << "Error, the weight of part " << p << " is not balanced" << std::endl;
+    }
+    parts_area += (part_max_x[p] - part_min_x[p])*(part_max_y[p] - part_min_y[p]);
+  }
+  // compact parts have bounding boxes that hardly overlap
+  const scalar_t grid_area = (grid_w-1)*10.0*(grid_h-1)*10.0;
+  *outStream << "area of the part bounding boxes " << parts_area << " grid area " << grid_area << std::endl;
+  if(parts_area > 1.1*grid_area){
+    errorFlag++;
+    *outStream << "Error, the parts are not spatially compact" << std::endl;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
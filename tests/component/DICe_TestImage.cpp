@@ -48,6 +48,7 @@
 #include <Teuchos_oblackholestream.hpp>
 #include <Teuchos_ParameterList.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace DICe;
@@ -233,6 +234,38 @@ int main(int argc, char *argv[]) {
   }
   *outStream << "hierarchical image gradients have been checked" << std::endl;
 
+  // check the smoothed gradients against a direct 5x5 convolution of the finite difference gradients
+  Teuchos::RCP<Teuchos::ParameterList> smooth_params = rcp(new Teuchos::ParameterList());
+  smooth_params->set(DICe::compute_image_gradients,true);
+  smooth_params->set(DICe::gradient_method,CONVOLUTION_5_POINT);
+  Scalar_Image smooth_img(array_w,array_h,intensities,smooth_params);
+  const scalar_t smooth_weights[] = {0.0625,0.25,0.375,0.25,0.0625};
+  scalar_t max_smooth_error = 0.0;
+  for(int_t y=0;y<array_h;++y){
+    for(int_t x=0;x<array_w;++x){
+      scalar_t exact_x = array_img.grad_x(x,y);
+      scalar_t exact_y = array_img.grad_y(x,y);
+      if(x>=2&&x<array_w-2&&y>=2&&y<array_h-2){
+        exact_x = 0.0;
+        exact_y = 0.0;
+        for(int_t j=0;j<5;++j){
+          for(int_t i=0;i<5;++i){
+            exact_x += smooth_weights[i]*smooth_weights[j]*array_img.grad_x(x+i-2,y+j-2);
+            exact_y += smooth_weights[i]*smooth_weights[j]*array_img.grad_y(x+i-2,y+j-2);
+          }
+        }
+      }
+      max_smooth_error = std::max(max_smooth_error,std::abs(exact_x - smooth_img.grad_x(x,y)));
+      max_smooth_error = std::max(max_smooth_error,std::abs(exact_y - smooth_img.grad_y(x,y)));
+    }
+  }
+  *outStream << "max error in the smoothed gradients: " << max_smooth_error << std::endl;
+  if(max_smooth_error > 1.0E-4){
+    *outStream << "Error, the smoothed gradient values are wrong" << std::endl;
+    errorFlag++;
+  }
+  *outStream << "smoothed image gradients have been checked" << std::endl;
+
   // test image transform:
   *outStream << "testing an image transform" << std::endl;
 #ifdef DICE_USE_DOUBLE
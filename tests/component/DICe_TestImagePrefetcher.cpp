@@ -0,0 +1,186 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+#include <DICe.h>
+#include <DICe_Image.h>
+#include <DICe_ImageIO.h>
+#include <DICe_ImagePrefetcher.h>
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_oblackholestream.hpp>
+#include <Teuchos_ParameterList.hpp>
+
+#include <iostream>
+#include <sstream>
+
+using namespace DICe;
+
+/// compare an image loaded by the prefetcher with one that was loaded directly
+int_t compare_images(Teuchos::RCP<Image> prefetched,
+  Teuchos::RCP<Image> direct,
+  Teuchos::RCP<std::ostream> & outStream){
+  if(prefetched->width()!=direct->width()||prefetched->height()!=direct->height()){
+    *outStream << "Error, the prefetched image " << direct->file_name() << " has the wrong dimensions" << std::endl;
+    return 1;
+  }
+  if(prefetched->file_name()!=direct->file_name()){
+    *outStream << "Error, the prefetched image should be " << direct->file_name() << " but is " << prefetched->file_name() << std::endl;
+    return 1;
+  }
+  if(!prefetched->has_gradients()||!prefetched->has_gauss_filter()){
+    *outStream << "Error, the prefetched image " << direct->file_name() << " should be filtered and have gradients" << std::endl;
+    return 1;
+  }
+  for(int_t y=0;y<direct->height();++y){
+    for(int_t x=0;x<direct->width();++x){
+      if((*prefetched)(x,y)!=(*direct)(x,y)||prefetched->grad_x(x,y)!=direct->grad_x(x,y)||prefetched->grad_y(x,y)!=direct->grad_y(x,y)){
+        *outStream << "Error, the prefetched image " << direct->file_name() << " does not match the image read directly" << std::endl;
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+  DICe::initialize(argc, argv);
+
+  // only print output if args are given (for testing the output is quiet)
+  int_t iprint     = argc - 1;
+  int_t errorFlag  = 0;
+  Teuchos::RCP<std::ostream> outStream;
+  Teuchos::oblackholestream bhs; // outputs nothing
+  if (iprint > 0)
+    outStream = Teuchos::rcp(&std::cout, false);
+  else
+    outStream = Teuchos::rcp(&bhs, false);
+
+  *outStream << "--- Begin test ---" << std::endl;
+
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  params->set(DICe::gauss_filter_images,true);
+  params->set(DICe::compute_image_gradients,true);
+  params->set(DICe::filter_failed_cine_pixels,false);
+  params->set(DICe::convert_cine_to_8_bit,true);
+
+  *outStream << "testing a sequence of tiff images" << std::endl;
+  std::vector<std::string> image_files;
+  image_files.push_back("./images/ImageA.tif");
+  image_files.push_back("./images/ImageB.tif");
+  image_files.push_back("./images/InitRef.tif");
+  image_files.push_back("./images/InitDef.tif");
+  image_files.push_back("./images/baboon.tif");
+  image_files.push_back("./images/ImageA.tif");
+  for(int_t queue_size=1;queue_size<=3;++queue_size){
+    *outStream << "queue size " << queue_size << std::endl;
+    // skip the first image like the frame loop does with the reference image
+    Image_Prefetcher prefetcher(image_files,1,*params,queue_size);
+    for(size_t i=1;i<image_files.size();++i){
+      if(!prefetcher.has_next()){
+        *outStream << "Error, the prefetcher ran out of images too early" << std::endl;
+        errorFlag++;
+        break;
+      }
+      Teuchos::RCP<Image> direct = Teuchos::rcp(new Image(image_files[i].c_str(),params));
+      errorFlag += compare_images(prefetcher.next(),direct,outStream);
+    }
+    if(prefetcher.has_next()){
+      *outStream << "Error, the prefetcher should not have any images left" << std::endl;
+      errorFlag++;
+    }
+  }
+
+  *outStream << "testing a sequence of cine frames" << std::endl;
+  const std::string cine_file = "./images/phantom_v1610.cine";
+  const int_t first_frame_id = DICe::utils::video_file_first_frame_id(cine_file);
+  const int_t frame_count = DICe::utils::video_file_frame_count(cine_file);
+  std::vector<std::string> cine_frames;
+  for(int_t frame=0;frame<frame_count;++frame){
+    std::stringstream markup_name;
+    markup_name << "./images/phantom_v1610_" << frame + first_frame_id << ".cine";
+    cine_frames.push_back(markup_name.str());
+  }
+  {
+    Image_Prefetcher prefetcher(cine_frames,0,*params,2);
+    for(size_t i=0;i<cine_frames.size();++i){
+      Teuchos::RCP<Image> prefetched = prefetcher.next();
+      Teuchos::RCP<Image> direct = Teuchos::rcp(new Image(cine_frames[i].c_str(),params));
+      errorFlag += compare_images(prefetched,direct,outStream);
+    }
+  }
+
+  *outStream << "testing that a read failure is reported for the right image" << std::endl;
+  std::vector<std::string> bad_files;
+  bad_files.push_back("./images/ImageA.tif");
+  bad_files.push_back("./images/no_such_image.xyz");
+  bad_files.push_back("./images/ImageB.tif");
+  {
+    Image_Prefetcher prefetcher(bad_files,0,*params,2);
+    prefetcher.next();
+    bool exception_thrown = false;
+    try{
+      prefetcher.next();
+    }
+    catch(std::exception &){
+      exception_thrown = true;
+    }
+    if(!exception_thrown){
+      *outStream << "Error, an exception should have been thrown for the missing image" << std::endl;
+      errorFlag++;
+    }
+    Teuchos::RCP<Image> direct = Teuchos::rcp(new Image(bad_files[2].c_str(),params));
+    errorFlag += compare_images(prefetcher.next(),direct,outStream);
+  }
+
+  *outStream << "--- End test ---" << std::endl;
+
+  DICe::finalize();
+
+  if (errorFlag != 0)
+    std::cout << "End Result: TEST FAILED\n";
+  else
+    std::cout << "End Result: TEST PASSED\n";
+
+  return 0;
+
+}
+
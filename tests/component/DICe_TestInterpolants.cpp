@@ -47,6 +47,7 @@
 #include <Teuchos_oblackholestream.hpp>
 #include <Teuchos_ParameterList.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace DICe;
@@ -127,6 +128,48 @@ int main(int argc, char *argv[]) {
     errorFlag++;
   }
 
+  *outStream << "testing the precomputed interpolation coefficients" << std::endl;
+  Teuchos::RCP<Teuchos::ParameterList> grad_params = Teuchos::rcp(new Teuchos::ParameterList());
+  grad_params->set(DICe::compute_image_gradients,true);
+  Teuchos::RCP<Scalar_Image> cached_img = Teuchos::rcp(new Scalar_Image(array_w,array_h,intensities,grad_params));
+  const Interpolation_Method cached_methods[] = {BICUBIC,KEYS_FOURTH};
+  const Interpolation_Cache caches[] = {INTENSITY_INTERPOLATION_CACHE,FULL_INTERPOLATION_CACHE};
+  for(int_t m=0;m<2;++m){
+    for(int_t c=0;c<2;++c){
+      cached_img->compute_interpolation_coefficients(cached_methods[m],caches[c]);
+      if(!cached_img->has_interpolation_coefficients(cached_methods[m])||cached_img->has_interpolation_coefficients(BILINEAR)){
+        *outStream << "Error, the interpolation coefficients were not stored for the right method" << std::endl;
+        errorFlag++;
+      }
+      scalar_t max_diff = 0.0;
+      for(int_t i=0;i<subset_keys.num_pixels();++i){
+        shape_function->map(subset_keys.x(i),subset_keys.y(i),cx,cy,px,py);
+        scalar_t intensity = 0.0, gx = 0.0, gy = 0.0;
+        scalar_t cached_intensity = 0.0, cached_gx = 0.0, cached_gy = 0.0;
+        if(cached_methods[m]==BICUBIC)
+          cached_img->interpolate_bicubic_all(intensity,gx,gy,true,px,py);
+        else
+          cached_img->interpolate_keys_fourth_all(intensity,gx,gy,true,px,py);
+        cached_img->interpolate_cached_all(cached_intensity,cached_gx,cached_gy,true,px,py);
+        // relative differences since the intensities go up to 255^2
+        const scalar_t one = 1.0;
+        max_diff = std::max(max_diff,std::abs(intensity-cached_intensity)/std::max(one,std::abs(intensity)));
+        max_diff = std::max(max_diff,std::abs(gx-cached_gx)/std::max(one,std::abs(gx)));
+        max_diff = std::max(max_diff,std::abs(gy-cached_gy)/std::max(one,std::abs(gy)));
+      }
+      *outStream << "max relative difference for cached " << cached_methods[m] << " interpolation (cache type " << caches[c] << "): " << max_diff << std::endl;
+      if(max_diff > 1.0E-4){
+        *outStream << "Error, the cached interpolation values do not match the direct interpolants" << std::endl;
+        errorFlag++;
+      }
+    }
+  }
+  cached_img->compute_interpolation_coefficients(KEYS_FOURTH,NO_INTERPOLATION_CACHE);
+  if(cached_img->interpolation_cache()!=NO_INTERPOLATION_CACHE||cached_img->has_interpolation_coefficients(KEYS_FOURTH)){
+    *outStream << "Error, the interpolation coefficients were not cleared" << std::endl;
+    errorFlag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
@@ -296,6 +296,39 @@ int main(int argc, char *argv[]) {
     error_flag++;
   }
 
+  *outStream << "testing cholesky solve" << std::endl;
+  Matrix<double,4> spd = {{4.0,1.0,0.5,0.0},{1.0,3.0,0.2,0.1},{0.5,0.2,2.0,0.3},{0.0,0.1,0.3,1.5}};
+  Vector<double,4> spd_x_gold = {{1.0},{-2.0},{0.5},{3.0}};
+  Vector<double,4> spd_b = spd*spd_x_gold;
+  Matrix<double,4> spd_factor = spd;
+  if(!cholesky_solve(spd_factor,spd_b)){
+    *outStream << "***error: cholesky_solve() failed for a positive definite matrix" << std::endl;
+    error_flag++;
+  }
+  scalar_t chol_error = norm(spd_b - spd_x_gold);
+  *outStream << "cholesky solve error norm: " << chol_error << std::endl;
+  if(chol_error>error_tol){
+    *outStream << "***error: cholesky solve error norm too high" << std::endl;
+    error_flag++;
+  }
+  *outStream << "testing cholesky solve with a run-time sized matrix" << std::endl;
+  Matrix<double> spd_dyn(2,2);
+  spd_dyn(0,0) = 2.0; spd_dyn(0,1) = 1.0;
+  spd_dyn(1,0) = 1.0; spd_dyn(1,1) = 2.0;
+  Vector<double> spd_dyn_b(2);
+  spd_dyn_b(0) = 3.0; spd_dyn_b(1) = 3.0;
+  if(!cholesky_solve(spd_dyn,spd_dyn_b)||std::abs(spd_dyn_b(0)-1.0)>error_tol||std::abs(spd_dyn_b(1)-1.0)>error_tol){
+    *outStream << "***error: cholesky solve for run-time sized matrix failed" << std::endl;
+    error_flag++;
+  }
+  *outStream << "testing cholesky solve detects a singular matrix" << std::endl;
+  Matrix<double,2> singular = {{1.0,1.0},{1.0,1.0}};
+  Vector<double,2> singular_b = {{1.0},{1.0}};
+  if(cholesky_solve(singular,singular_b)){
+    *outStream << "***error: cholesky_solve() should fail for a singular matrix" << std::endl;
+    error_flag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
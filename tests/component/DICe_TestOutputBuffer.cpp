@@ -0,0 +1,189 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+#include <DICe.h>
+#include <DICe_Schema.h>
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_oblackholestream.hpp>
+#include <Teuchos_ParameterList.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace DICe;
+
+/// returns the contents of a file (empty if the file does not exist)
+std::string read_file(const std::string & file_name){
+  std::ifstream in(file_name.c_str(),std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+/// name of a test file
+std::string file_name(const std::string & prefix,
+  const int_t i){
+  std::stringstream name;
+  name << prefix << "_" << i << ".txt";
+  return name.str();
+}
+
+int main(int argc, char *argv[]) {
+
+  DICe::initialize(argc, argv);
+
+  // only print output if args are given (for testing the output is quiet)
+  int_t iprint     = argc - 1;
+  int_t errorFlag  = 0;
+  Teuchos::RCP<std::ostream> outStream;
+  Teuchos::oblackholestream bhs; // outputs nothing
+  if (iprint > 0)
+    outStream = Teuchos::rcp(&std::cout, false);
+  else
+    outStream = Teuchos::rcp(&bhs, false);
+
+  *outStream << "--- Begin test ---" << std::endl;
+
+  const int_t num_files = 3;
+  const int_t num_rows = 200;
+  for(int_t i=0;i<num_files;++i){
+    std::remove(file_name("direct",i).c_str());
+    std::remove(file_name("small_buffer",i).c_str());
+    std::remove(file_name("large_buffer",i).c_str());
+  }
+
+  *outStream << "writing the same rows directly and through a buffer that flushes often and one that never fills" << std::endl;
+  {
+    Output_File_Buffer small_buffer(1000);
+    Output_File_Buffer large_buffer(1024*1024);
+    for(int_t row=0;row<num_rows;++row){
+      for(int_t i=0;i<num_files;++i){
+        std::stringstream text;
+        text << row << " " << i << " " << 0.5*row*(i+1) << "\n";
+        std::FILE * filePtr = fopen(file_name("direct",i).c_str(),"a");
+        fprintf(filePtr,"%s",text.str().c_str());
+        fclose(filePtr);
+        small_buffer.append(file_name("small_buffer",i),text.str());
+        large_buffer.append(file_name("large_buffer",i),text.str());
+      }
+      const size_t size_before = small_buffer.size();
+      small_buffer.flush_if_full();
+      if(size_before>=1000&&small_buffer.size()!=0){
+        *outStream << "Error, the buffer size was not reset when the buffer was handed off for writing" << std::endl;
+        errorFlag++;
+      }
+      if(size_before<1000&&small_buffer.size()!=size_before){
+        *outStream << "Error, the buffer size changed although the buffer was not full" << std::endl;
+        errorFlag++;
+      }
+      large_buffer.flush_if_full();
+    }
+    if(read_file(file_name("large_buffer",0)).size()!=0){
+      *outStream << "Error, the large buffer should not have written anything before it was destroyed" << std::endl;
+      errorFlag++;
+    }
+  } // the buffers write the rest of the rows when they are destroyed
+  for(int_t i=0;i<num_files;++i){
+    const std::string direct = read_file(file_name("direct",i));
+    if(read_file(file_name("small_buffer",i))!=direct){
+      *outStream << "Error, the output written by the buffer that flushes often differs from the direct output for file " << i << std::endl;
+      errorFlag++;
+    }
+    if(read_file(file_name("large_buffer",i))!=direct){
+      *outStream << "Error, the rows held by the buffer were not all written when the buffer was destroyed for file " << i << std::endl;
+      errorFlag++;
+    }
+  }
+
+  *outStream << "comparing the buffered and direct output of a schema" << std::endl;
+  const int_t num_frames = 4;
+  int_t num_subsets = 0;
+  for(int_t buffered=0;buffered<2;++buffered){
+    Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+    if(buffered)
+      params->set(DICe::output_buffer_size,1);
+    Teuchos::RCP<Schema> schema = Teuchos::rcp(new Schema(200,200,40,40,21,params));
+    schema->set_ref_image("./images/refSpeckled.tif");
+    schema->set_def_image("./images/refSpeckled.tif");
+    schema->set_frame_range(0,num_frames,1);
+    num_subsets = schema->local_num_subsets();
+    for(int_t frame=0;frame<num_frames;++frame){
+      for(int_t i=0;i<schema->local_num_subsets();++i){
+        schema->local_field_value(i,DICe::field_enums::SUBSET_DISPLACEMENT_X_FS) = frame + 0.01*i;
+        schema->local_field_value(i,DICe::field_enums::SUBSET_DISPLACEMENT_Y_FS) = -frame - 0.02*i;
+      }
+      schema->update_frame_id(); // the output is written after the frame is updated
+      schema->write_output("./",buffered ? "schema_buffered" : "schema_direct",true,true);
+    }
+    // the buffered rows are only written when the schema (and its buffer) is destroyed
+  }
+  // 16 subsets so the file names have two digits
+  if(num_subsets!=16){
+    *outStream << "Error, the schema should have 16 subsets but has " << num_subsets << std::endl;
+    errorFlag++;
+  }
+  for(int_t i=0;i<num_subsets;++i){
+    std::stringstream direct_name, buffered_name;
+    direct_name << "schema_direct_" << (i<10?"0":"") << i << ".txt";
+    buffered_name << "schema_buffered_" << (i<10?"0":"") << i << ".txt";
+    const std::string direct = read_file(direct_name.str());
+    if(direct.empty()||read_file(buffered_name.str())!=direct){
+      *outStream << "Error, the buffered schema output " << buffered_name.str() << " differs from the direct output" << std::endl;
+      errorFlag++;
+    }
+  }
+
+  *outStream << "--- End test ---" << std::endl;
+
+  DICe::finalize();
+
+  if (errorFlag != 0)
+    std::cout << "End Result: TEST FAILED\n";
+  else
+    std::cout << "End Result: TEST PASSED\n";
+
+  return 0;
+
+}
@@ -129,6 +129,9 @@ int main(int argc, char *argv[]) {
   exact_ux[10] = -11; exact_uy[10] =  10;
   exact_ux[11] =   8; exact_uy[11] =  14;
 
+  // FFT plans and buffers reused for all of the images
+  Phase_Correlator phase_correlator(ref->width(),ref->height());
+
   // cycle through the pc_ images
   for(int_t i=0;i<12;++i){
     std::stringstream name;
@@ -186,6 +189,15 @@ int main(int argc, char *argv[]) {
     scalar_t u_x180 = 0.0;
     scalar_t u_y180 = 0.0;
     const scalar_t test_180 = phase_correlate_x_y(rot_ref_180,img,u_x180,u_y180);
+    // the cached phase correlator should find the same peak as phase_correlate_x_y (to within the subpixel fit)
+    scalar_t cached_ux = 0.0;
+    scalar_t cached_uy = 0.0;
+    phase_correlator.set_reference(*rot_ref_0);
+    phase_correlator.correlate(*img,cached_ux,cached_uy);
+    if(std::abs(cached_ux - u_x0) > 0.5 || std::abs(cached_uy - u_y0) > 0.5){
+      *outStream << "Error, the cached phase correlation of image " << i << " does not match: " << cached_ux << " " << cached_uy << std::endl;
+      errorFlag++;
+    }
     scalar_t final_theta = theta;
     scalar_t final_ux = u_x0;
     scalar_t final_uy = u_y0;
@@ -47,7 +47,10 @@
 #include <Teuchos_oblackholestream.hpp>
 #include <Teuchos_ParameterList.hpp>
 
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <vector>
 
 using namespace DICe;
 
@@ -106,6 +109,79 @@ int main(int argc, char *argv[]) {
   }
   *outStream << "checked the image intensity values " << std::endl;
 
+  *outStream << "testing the layout left transpose for a non-square image" << std::endl;
+  // sizes that are not a multiple of the transpose tile size in either direction
+  const int_t tw = 70;
+  const int_t th = 37;
+  std::vector<scalar_t> row_major(tw*th,0.0);
+  std::vector<scalar_t> col_major(tw*th,0.0);
+  for(int_t y=0;y<th;++y){
+    for(int_t x=0;x<tw;++x){
+      row_major[y*tw+x] = y*tw + x + 0.25;
+      col_major[x*th+y] = row_major[y*tw+x];
+    }
+  }
+  utils::write_rawi_image("LayoutLeft.rawi",tw,th,&col_major[0],false);
+  std::vector<scalar_t> read_right(tw*th,0.0);
+  std::vector<scalar_t> read_left(tw*th,0.0);
+  utils::read_rawi_image("LayoutLeft.rawi",&read_right[0],true);
+  utils::read_rawi_image("LayoutLeft.rawi",&read_left[0],false);
+  if(read_right!=row_major){
+    *outStream << "Error, the layout left write did not store the values in row-major order" << std::endl;
+    errorFlag++;
+  }
+  if(read_left!=col_major){
+    *outStream << "Error, the layout left read did not return the values in column-major order" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "testing the mapped read against the bulk read" << std::endl;
+  int_t map_w = 0, map_h = 0;
+  Teuchos::ArrayRCP<scalar_t> mapped = utils::map_rawi_image<scalar_t>("LayoutLeft.rawi",map_w,map_h);
+  if(map_w!=tw||map_h!=th||(int_t)mapped.size()!=tw*th){
+    *outStream << "Error, the mapped image has the wrong dimensions" << std::endl;
+    errorFlag++;
+  }else{
+    for(int_t i=0;i<tw*th;++i){
+      if(mapped[i]!=read_right[i]){
+        *outStream << "Error, the mapped values do not match the bulk read" << std::endl;
+        errorFlag++;
+        break;
+      }
+    }
+  }
+  // the file layout is the 12 byte header followed by the values for every value type
+  {
+    std::ifstream rawi_file("LayoutLeft.rawi",std::ifstream::binary|std::ifstream::ate);
+    if((size_t)rawi_file.tellg()!=12+tw*th*sizeof(scalar_t)){
+      *outStream << "Error, the rawi file has the wrong size for a 12 byte header" << std::endl;
+      errorFlag++;
+    }
+  }
+
+  *outStream << "testing a file written outside of DICe with the 12 byte header" << std::endl;
+  {
+    std::ofstream external_file("External.rawi",std::ofstream::binary);
+    const uint32_t header[3] = {(uint32_t)tw,(uint32_t)th,(uint32_t)sizeof(scalar_t)};
+    external_file.write(reinterpret_cast<const char*>(header),sizeof(header));
+    external_file.write(reinterpret_cast<const char*>(&row_major[0]),tw*th*sizeof(scalar_t));
+  }
+  std::vector<scalar_t> external_read(tw*th,0.0);
+  utils::read_rawi_image("External.rawi",&external_read[0],true);
+  // 8 byte values are misaligned after the header, so this also covers the copying fallback
+  Teuchos::ArrayRCP<scalar_t> external_mapped = utils::map_rawi_image<scalar_t>("External.rawi",map_w,map_h);
+  if(external_read!=row_major){
+    *outStream << "Error, the values of the external file were not read correctly" << std::endl;
+    errorFlag++;
+  }
+  for(int_t i=0;i<tw*th;++i){
+    if(external_mapped[i]!=row_major[i]){
+      *outStream << "Error, the mapped values of the external file are not correct" << std::endl;
+      errorFlag++;
+      break;
+    }
+  }
+
 
   *outStream << "--- End test ---" << std::endl;
 
@@ -353,6 +353,71 @@ int main(int argc, char *argv[]) {
   }
   *outStream << "gradient values have been tested" << std::endl;
 
+  *outStream << "checking the batched map against the point-wise map" << std::endl;
+  Teuchos::RCP<Local_Shape_Function> affine_sf = Teuchos::rcp(new Affine_Shape_Function(true,true,true));
+  affine_sf->insert_motion(3.25,-2.5,0.05);
+  Teuchos::RCP<Local_Shape_Function> quad_sf = Teuchos::rcp(new Quadratic_Shape_Function());
+  quad_sf->insert_motion(3.25,-2.5,0.05);
+  std::vector<scalar_t> batch_x(square.num_pixels(),0.0);
+  std::vector<scalar_t> batch_y(square.num_pixels(),0.0);
+  std::vector<int_t> sq_x(square.num_pixels(),0);
+  std::vector<int_t> sq_y(square.num_pixels(),0);
+  for(int_t i=0;i<square.num_pixels();++i){
+    sq_x[i] = square.x(i);
+    sq_y[i] = square.y(i);
+  }
+  bool batch_map_error = false;
+  std::vector<Teuchos::RCP<Local_Shape_Function> > batch_sfs;
+  batch_sfs.push_back(affine_sf);
+  batch_sfs.push_back(quad_sf);
+  for(size_t sf=0;sf<batch_sfs.size();++sf){
+    batch_sfs[sf]->batch_map(square.num_pixels(),&sq_x[0],&sq_y[0],cx,cy,&batch_x[0],&batch_y[0]);
+    for(int_t i=0;i<square.num_pixels();++i){
+      scalar_t map_x = 0.0, map_y = 0.0;
+      batch_sfs[sf]->map(sq_x[i],sq_y[i],cx,cy,map_x,map_y);
+      if(map_x!=batch_x[i]||map_y!=batch_y[i])
+        batch_map_error = true;
+    }
+  }
+  if(batch_map_error){
+    *outStream << "Error, the batched map does not match the point-wise map" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "checking the batched interpolation against the point-wise interpolant" << std::endl;
+  square.initialize(image,DEF_INTENSITIES,affine_sf,BICUBIC);
+  bool batch_interp_error = false;
+  for(int_t i=0;i<square.num_pixels();++i){
+    scalar_t map_x = 0.0, map_y = 0.0;
+    affine_sf->map(square.x(i),square.y(i),cx,cy,map_x,map_y);
+    scalar_t intensity = 0.0, gx = 0.0, gy = 0.0;
+    image->interpolate_bicubic_all(intensity,gx,gy,false,map_x,map_y);
+    if(square.is_deactivated_this_step(i)||square.def_intensities(i)!=intensity)
+      batch_interp_error = true;
+  }
+  if(batch_interp_error){
+    *outStream << "Error, the batched interpolation does not match the point-wise interpolant" << std::endl;
+    errorFlag++;
+  }
+
+  *outStream << "checking the pixel mask" << std::endl;
+  std::set<std::pair<int_t,int_t> > mask_coords;
+  mask_coords.insert(std::pair<int_t,int_t>(12,7));
+  mask_coords.insert(std::pair<int_t,int_t>(12,70));
+  mask_coords.insert(std::pair<int_t,int_t>(40,-3));
+  Pixel_Mask mask;
+  mask.assign(mask_coords);
+  if(mask.size()!=3||!mask.contains(7,12)||!mask.contains(70,12)||!mask.contains(-3,40)
+      ||mask.contains(12,7)||mask.contains(8,12)||mask.contains(7,41)||mask.contains(1000,1000)){
+    *outStream << "Error, the pixel mask lookups are not correct" << std::endl;
+    errorFlag++;
+  }
+  mask.clear();
+  if(!mask.empty()||mask.contains(7,12)){
+    *outStream << "Error, the pixel mask was not cleared" << std::endl;
+    errorFlag++;
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
@@ -47,12 +47,76 @@
 #include <Teuchos_RCP.hpp>
 #include <Teuchos_oblackholestream.hpp>
 #include <Teuchos_ParameterList.hpp>
+#include <Teuchos_LAPACK.hpp>
+#include <Teuchos_SerialDenseMatrix.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 using namespace DICe;
 
+/// reference stereo triangulation of one point that solves the least squares system M^T M X = M^T r
+/// with LAPACK GETRF/GETRS (independent of the closed form solve in Triangulation)
+void lapack_triangulate(Teuchos::RCP<Triangulation> tri,
+  scalar_t x0,
+  scalar_t y0,
+  scalar_t x1,
+  scalar_t y1,
+  const bool correct_lens_distortion,
+  scalar_t & xw,
+  scalar_t & yw,
+  scalar_t & zw){
+  if(correct_lens_distortion){
+    tri->correct_lens_distortion_radial(x0,y0,0);
+    tri->correct_lens_distortion_radial(x1,y1,1);
+  }
+  const std::vector<std::vector<scalar_t> > & intrinsics = *tri->cal_intrinsics();
+  const Matrix<scalar_t,4> & T = *tri->cam_0_to_cam_1();
+  const Matrix<scalar_t,4> & W = *tri->cam_0_to_world();
+  Teuchos::SerialDenseMatrix<int,double> M(4,3,true);
+  std::vector<double> r(4,0.0);
+  const double cmx = intrinsics[1][Camera::CX] - x1;
+  const double cmy = intrinsics[1][Camera::CY] - y1;
+  M(0,0) = intrinsics[0][Camera::FX];
+  M(0,1) = intrinsics[0][Camera::FS];
+  M(0,2) = intrinsics[0][Camera::CX] - x0;
+  M(1,1) = intrinsics[0][Camera::FY];
+  M(1,2) = intrinsics[0][Camera::CY] - y0;
+  for(int_t j=0;j<3;++j){
+    M(2,j) = cmx*T(2,j) + intrinsics[1][Camera::FX]*T(0,j) + intrinsics[1][Camera::FS]*T(1,j);
+    M(3,j) = cmy*T(2,j) + intrinsics[1][Camera::FY]*T(1,j);
+  }
+  r[2] = -intrinsics[1][Camera::FX]*T(0,3) - intrinsics[1][Camera::FS]*T(1,3) - cmx*T(2,3);
+  r[3] = -intrinsics[1][Camera::FY]*T(1,3) - cmy*T(2,3);
+  Teuchos::SerialDenseMatrix<int,double> MTM(3,3,true);
+  std::vector<double> MTr(3,0.0);
+  for(int_t i=0;i<3;++i){
+    for(int_t k=0;k<4;++k){
+      MTr[i] += M(k,i)*r[k];
+      for(int_t j=0;j<3;++j)
+        MTM(i,j) += M(k,i)*M(k,j);
+    }
+  }
+  Teuchos::LAPACK<int,double> lapack;
+  std::vector<int> IPIV(3,0);
+  int INFO = 0;
+  lapack.GETRF(3,3,MTM.values(),3,&IPIV[0],&INFO);
+  TEUCHOS_TEST_FOR_EXCEPTION(INFO!=0,std::runtime_error,"Error, GETRF failed in the reference triangulation");
+  lapack.GETRS('N',3,1,MTM.values(),3,&IPIV[0],&MTr[0],3,&INFO);
+  TEUCHOS_TEST_FOR_EXCEPTION(INFO!=0,std::runtime_error,"Error, GETRS failed in the reference triangulation");
+  // camera 0 to world coordinates
+  const double XYZc0[4] = {MTr[0],MTr[1],MTr[2],1.0};
+  double XYZ[3] = {0.0,0.0,0.0};
+  for(int_t i=0;i<3;++i)
+    for(int_t j=0;j<4;++j)
+      XYZ[i] += W(i,j)*XYZc0[j];
+  xw = XYZ[0];
+  yw = XYZ[1];
+  zw = XYZ[2];
+}
+
 int main(int argc, char *argv[]) {
 
   DICe::initialize(argc, argv);
@@ -360,6 +424,48 @@ int main(int argc, char *argv[]) {
     *outStream << "Error, triangulation z coord is wrong. Should be " << global_z_gold << " is " << zw_out << std::endl;
   }
 
+  *outStream << "testing batched triangulation of 3d points" << std::endl;
+  // enough points for several blocks, the batch should match an independent LAPACK solve of each point
+  const int_t num_batch_points = 1000;
+  std::vector<scalar_t> batch_x_0(num_batch_points),batch_y_0(num_batch_points);
+  std::vector<scalar_t> batch_x_1(num_batch_points),batch_y_1(num_batch_points);
+  for(int_t i=0;i<num_batch_points;++i){
+    batch_x_0[i] = x_0 + (i%40) - 20;
+    batch_y_0[i] = y_0 + (i/40) - 12;
+    batch_x_1[i] = x_1 + (i%40) - 20 + 0.01*(i%7);
+    batch_y_1[i] = y_1 + (i/40) - 12;
+  }
+  Teuchos::RCP<Thread_Pool> thread_pool = Teuchos::rcp(new Thread_Pool(4));
+  for(int_t lens=0;lens<2;++lens){
+    std::vector<scalar_t> batch_xw,batch_yw,batch_zw,batch_max_m;
+    tri->triangulate(batch_x_0,batch_y_0,batch_x_1,batch_y_1,batch_xw,batch_yw,batch_zw,&batch_max_m,lens==1,thread_pool);
+    scalar_t max_batch_diff = 0.0;
+    scalar_t max_single_diff = 0.0;
+    for(int_t i=0;i<num_batch_points;++i){
+      scalar_t xw_ref = 0.0, yw_ref = 0.0, zw_ref = 0.0;
+      lapack_triangulate(tri,batch_x_0[i],batch_y_0[i],batch_x_1[i],batch_y_1[i],lens==1,xw_ref,yw_ref,zw_ref);
+      max_batch_diff = std::max(max_batch_diff,std::abs(batch_xw[i]-xw_ref));
+      max_batch_diff = std::max(max_batch_diff,std::abs(batch_yw[i]-yw_ref));
+      max_batch_diff = std::max(max_batch_diff,std::abs(batch_zw[i]-zw_ref));
+      // the single point version should agree with the batch, including the max M value
+      const scalar_t max_m = tri->triangulate(batch_x_0[i],batch_y_0[i],batch_x_1[i],batch_y_1[i],
+        xc_out,yc_out,zc_out,xw_out,yw_out,zw_out,lens==1);
+      max_single_diff = std::max(max_single_diff,std::abs(batch_xw[i]-xw_out));
+      max_single_diff = std::max(max_single_diff,std::abs(batch_yw[i]-yw_out));
+      max_single_diff = std::max(max_single_diff,std::abs(batch_zw[i]-zw_out));
+      max_single_diff = std::max(max_single_diff,std::abs(batch_max_m[i]-max_m));
+    }
+    *outStream << "max difference between batched and LAPACK triangulation (lens distortion " << lens << "): " << max_batch_diff << std::endl;
+    if(max_batch_diff > errorTol){
+      errorFlag++;
+      *outStream << "Error, the batched triangulation does not match the LAPACK solution" << std::endl;
+    }
+    if(max_single_diff > errorTol){
+      errorFlag++;
+      *outStream << "Error, the batched triangulation does not match the single point triangulation" << std::endl;
+    }
+  }
+
   *outStream << "triangulation of 3d points completed and tested" << std::endl;
 
   *outStream << "testing projective transforms" << std::endl;
@@ -48,6 +48,7 @@
 #include "opencv2/opencv.hpp"
 
 #include <iostream>
+#include <vector>
 
 
 using namespace DICe;
@@ -120,6 +121,61 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  *outStream << "testing the frame count and dimensions from the frame cache" << std::endl;
+  if(DICe::utils::video_file_frame_count("./images/cup.mp4")!=num_frames){
+    errorFlag++;
+    *outStream << "Error, video_file_frame_count " << DICe::utils::video_file_frame_count("./images/cup.mp4") << " is not correct" << std::endl;
+  }
+  int_t cache_w = 0, cache_h = 0;
+  DICe::utils::Video_Singleton::instance().image_dimensions("./images/cup.mp4",cache_w,cache_h);
+  if(cache_w!=w||cache_h!=h){
+    errorFlag++;
+    *outStream << "Error, image_dimensions " << cache_w << " x " << cache_h << " is not correct" << std::endl;
+  }
+
+  *outStream << "testing a backward and a far forward seek" << std::endl;
+  // gold frames decoded sequentially from a separate reader
+  const int_t num_seek_frames = 3;
+  const int_t seek_frames[num_seek_frames] = {45,10,200};
+  std::vector<cv::Mat> seek_golds(num_seek_frames);
+  {
+    cv::VideoCapture gold_cap("./images/cup.mp4");
+    cv::Mat gold_frame;
+    for(int_t i=0;i<=200&&gold_cap.read(gold_frame);++i){
+      for(int_t j=0;j<num_seek_frames;++j){
+        if(seek_frames[j]!=i) continue;
+        if(gold_frame.channels()!=1)
+          cv::cvtColor(gold_frame,seek_golds[j],cv::COLOR_BGR2GRAY);
+        else
+          seek_golds[j] = gold_frame.clone();
+      }
+    }
+  }
+  for(int_t j=0;j<num_seek_frames;++j){
+    if(seek_golds[j].empty()){
+      errorFlag++;
+      *outStream << "Error, could not read gold frame " << seek_frames[j] << std::endl;
+      continue;
+    }
+    std::stringstream filename;
+    filename << "./images/cup_" << seek_frames[j] << ".mp4";
+    Teuchos::RCP<DICe::Image> img = Teuchos::rcp(new DICe::Image(filename.str().c_str()));
+    if(img->width()!=seek_golds[j].cols||img->height()!=seek_golds[j].rows){
+      errorFlag++;
+      *outStream << "Error, frame " << seek_frames[j] << " has the wrong dimensions" << std::endl;
+      continue;
+    }
+    scalar_t diff = 0.0;
+    for(int_t y=0;y<img->height();++y)
+      for(int_t x=0;x<img->width();++x)
+        diff += std::abs((*img)(x,y) - (scalar_t)seek_golds[j].at<uchar>(y,x));
+    *outStream << "Testing seek to frame " << seek_frames[j] << " diff " << diff << std::endl;
+    if(diff > w*h){
+      errorFlag++;
+      *outStream << "Error, the frame read after the seek does not match the VideoCapture frame" << std::endl;
+    }
+  }
+
   *outStream << "--- End test ---" << std::endl;
 
   DICe::finalize();
@@ -49,6 +49,7 @@
 #include <Teuchos_ParameterList.hpp>
 
 #include <iostream>
+#include <set>
 
 using namespace DICe;
 
@@ -147,6 +148,56 @@ int main(int argc, char *argv[]) {
     }
   } // end formulation loop
 
+  // the threaded assembly should give the same solution as the serial assembly
+  for(size_t i=0;i<formulation.size();++i){
+    scalar_t error_bx = 0.0;
+    scalar_t error_by = 0.0;
+    scalar_t error_lambda = 0.0;
+    scalar_t max_error_bx = 0.0;
+    scalar_t max_error_by = 0.0;
+    scalar_t max_error_lambda = 0.0;
+    *outStream << " TESTING " << to_string(formulation[i]) << " FORMULATION WITH THREADED ASSEMBLY" << std::endl;
+    global_params->set(DICe::num_threads,4);
+    global_params->set(DICe::global_regularization_alpha,alpha[i]);
+    global_params->set(DICe::global_formulation,formulation[i]);
+    global_params->set(DICe::output_prefix,mms_problem_name[i]+"_threaded");
+    mms_sublist.set(DICe::problem_name,mms_problem_name[i]);
+    mms_sublist.set(DICe::b_coeff,alpha[i]);
+    global_params->set(DICe::mms_spec,mms_sublist);
+    Teuchos::RCP<DICe::global::Global_Algorithm> global_alg = Teuchos::rcp(new DICe::global::Global_Algorithm(global_params));
+    global_alg->execute();
+    global_alg->post_execution_tasks(1.0);
+    global_alg->evaluate_mms_error(error_bx,error_by,error_lambda,max_error_bx,max_error_by,max_error_lambda);
+    *outStream << "threaded error x: " << error_bx << " error y: " << error_by << " error l: " << error_lambda << std::endl;
+    if(std::abs(error_bx-error_x[i]) > 1.0E-8 || std::abs(error_by-error_y[i]) > 1.0E-8){
+      *outStream << "error, the threaded assembly solution does not match the serial one for " << to_string(formulation[i]) << std::endl;
+      errorFlag++;
+    }
+    // no two elements of the same color can share a node
+    const std::vector<std::vector<int_t> > & colors = global_alg->element_colors();
+    const DICe::mesh::element_set & elements = *global_alg->mesh()->get_element_set();
+    size_t num_colored = 0;
+    for(size_t c=0;c<colors.size();++c){
+      std::set<int_t> color_nodes;
+      for(size_t e=0;e<colors[c].size();++e){
+        const DICe::mesh::connectivity_vector & connectivity = *elements[colors[c][e]]->connectivity();
+        for(size_t nd=0;nd<connectivity.size();++nd){
+          if(!color_nodes.insert(connectivity[nd]->global_id()).second){
+            *outStream << "error, elements of color " << c << " share node " << connectivity[nd]->global_id() << std::endl;
+            errorFlag++;
+          }
+        }
+      }
+      num_colored += colors[c].size();
+    }
+    *outStream << "number of element colors: " << colors.size() << std::endl;
+    if(num_colored!=elements.size()){
+      *outStream << "error, not every element has a color" << std::endl;
+      errorFlag++;
+    }
+  }
+  global_params->set(DICe::num_threads,1);
+
   *outStream << "-----------------------------------------------------------------------------------------------------------" << std::endl;
   *outStream << "Results Summary:" << std::endl;
   *outStream << "-----------------------------------------------------------------------------------------------------------" << std::endl;
@@ -47,6 +47,7 @@
 #include <Teuchos_ParameterList.hpp>
 
 #include <iostream>
+#include <vector>
 
 #include "netcdf.h"
 
@@ -124,6 +125,93 @@ int main(int argc, char *argv[]) {
     *outStream << "Error, the NetCDF image created from scratch was not read correctly" << std::endl;
   }
 
+  *outStream << "testing the frame source with a multi-frame file" << std::endl;
+  // each pixel of each frame gets a unique value so that a frame or region mix up is detected
+  const int_t frames_w = 31;
+  const int_t frames_h = 23;
+  const int_t num_frames = 5;
+  Teuchos::RCP<DICe::netcdf::NetCDF_Writer> frames_writer = Teuchos::rcp(new DICe::netcdf::NetCDF_Writer("frames.nc",frames_w,frames_h,num_frames+1,var_names));
+  std::vector<float> frame_vec(frames_w*frames_h);
+  for(int_t t=0;t<num_frames;++t){
+    for(int_t j=0;j<frames_h;++j)
+      for(int_t i=0;i<frames_w;++i)
+        frame_vec[j*frames_w+i] = t*1000.0f + j*frames_w + i;
+    frames_writer->write_float_array("data",t,frame_vec);
+  }
+  Teuchos::RCP<DICe::netcdf::NetCDF_Frame_Source> source = DICe::netcdf::netcdf_frame_source("frames.nc");
+  if(source->num_time_steps()!=num_frames){
+    errorFlag++;
+    *outStream << "Error, the frame source has the wrong number of time steps " << source->num_time_steps() << std::endl;
+  }
+  // (time index, width, height, offset x, offset y) for each read: in order with the same region (read ahead hits),
+  // out of order (misses), and with a region change between reads
+  const int_t num_reads = 9;
+  const int_t reads[num_reads][5] = {
+    {0,0,0,0,0},
+    {1,0,0,0,0},
+    {2,0,0,0,0},
+    {4,0,0,0,0},
+    {1,0,0,0,0},
+    {2,12,9,5,7},
+    {3,12,9,5,7},
+    {4,20,6,3,15},
+    {0,20,6,3,15}};
+  for(int_t r=0;r<num_reads;++r){
+    const int_t t = reads[r][0];
+    const int_t w = reads[r][1]==0 ? frames_w : reads[r][1];
+    const int_t h = reads[r][2]==0 ? frames_h : reads[r][2];
+    const int_t ox = reads[r][3];
+    const int_t oy = reads[r][4];
+    std::vector<scalar_t> region(w*h,-1.0);
+    source->read(t,&region[0],reads[r][1],reads[r][2],ox,oy);
+    bool region_error = false;
+    for(int_t j=0;j<h;++j)
+      for(int_t i=0;i<w;++i)
+        if(region[j*w+i]!=t*1000.0 + (j+oy)*frames_w + i + ox)
+          region_error = true;
+    if(region_error){
+      errorFlag++;
+      *outStream << "Error, read " << r << " (frame " << t << ") returned the wrong intensities" << std::endl;
+    }
+  }
+  if(DICe::netcdf::netcdf_frame_source("frames.nc")!=source){
+    errorFlag++;
+    *outStream << "Error, the frame source of an unchanged file was not reused" << std::endl;
+  }
+  *outStream << "testing that the frame source is refreshed when the file is written" << std::endl;
+  // the writer closes the registered source, release this handle so the file is not held open
+  source = Teuchos::null;
+  for(int_t j=0;j<frames_h;++j)
+    for(int_t i=0;i<frames_w;++i)
+      frame_vec[j*frames_w+i] = num_frames*1000.0f + j*frames_w + i;
+  frames_writer->write_float_array("data",num_frames,frame_vec);
+  source = DICe::netcdf::netcdf_frame_source("frames.nc");
+  if(source->num_time_steps()!=num_frames+1){
+    errorFlag++;
+    *outStream << "Error, the frame source was not refreshed after a frame was appended" << std::endl;
+  }else{
+    std::vector<scalar_t> frame(frames_w*frames_h,-1.0);
+    source->read(num_frames,&frame[0]);
+    if(frame[frames_w*frames_h-1]!=num_frames*1000.0 + frames_w*frames_h-1){
+      errorFlag++;
+      *outStream << "Error, the appended frame was not read correctly" << std::endl;
+    }
+  }
+  // recreating the file must not serve the old frames
+  source = Teuchos::null;
+  frames_writer = Teuchos::rcp(new DICe::netcdf::NetCDF_Writer("frames.nc",frames_w,frames_h,1,var_names));
+  for(size_t i=0;i<frame_vec.size();++i)
+    frame_vec[i] = 7.0f;
+  frames_writer->write_float_array("data",0,frame_vec);
+  source = DICe::netcdf::netcdf_frame_source("frames.nc");
+  std::vector<scalar_t> rewritten(frames_w*frames_h,-1.0);
+  source->read(0,&rewritten[0]);
+  if(source->num_time_steps()!=1||rewritten[0]!=7.0||rewritten[frames_w*frames_h-1]!=7.0){
+    errorFlag++;
+    *outStream << "Error, the frame source served stale data after the file was rewritten" << std::endl;
+  }
+  source = Teuchos::null;
+
 //  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
 //  params->set(remove_outlier_pixels,true);
 //  params->set(outlier_replacement_value,0.0);
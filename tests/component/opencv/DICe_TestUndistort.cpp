@@ -0,0 +1,259 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+#include <DICe.h>
+#include <DICe_ImageIO.h>
+#include <DICe_Schema.h>
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_oblackholestream.hpp>
+#include <Teuchos_ParameterList.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace DICe;
+
+/// returns the largest difference between the undistorted values (divided by scale) and the opencv 8 bit result
+template <typename S>
+scalar_t max_diff(const std::vector<S> & values,
+  const cv::Mat & gold,
+  const scalar_t scale){
+  scalar_t diff = 0.0;
+  for(int_t y=0;y<gold.rows;++y)
+    for(int_t x=0;x<gold.cols;++x)
+      diff = std::max(diff,(scalar_t)std::abs(values[y*gold.cols+x]/scale - gold.at<uchar>(y,x)));
+  return diff;
+}
+
+/// returns the largest difference between the intensities of an image and the opencv 8 bit result
+scalar_t max_image_diff(const Teuchos::RCP<Image> & img,
+  const cv::Mat & gold){
+  scalar_t diff = 0.0;
+  for(int_t y=0;y<gold.rows;++y)
+    for(int_t x=0;x<gold.cols;++x)
+      diff = std::max(diff,(scalar_t)std::abs((*img)(x,y) - gold.at<uchar>(y,x)));
+  return diff;
+}
+
+/// undistort an 8 bit image with opencv
+cv::Mat opencv_undistort(const cv::Mat & img,
+  const double fx,
+  const double fy,
+  const double cx,
+  const double cy,
+  const double k1,
+  const double k2){
+  cv::Mat intrinsics = cv::Mat::zeros(3,3,CV_64FC1);
+  intrinsics.at<double>(0,0) = fx;
+  intrinsics.at<double>(1,1) = fy;
+  intrinsics.at<double>(0,2) = cx;
+  intrinsics.at<double>(1,2) = cy;
+  intrinsics.at<double>(2,2) = 1.0;
+  cv::Mat dist_coeffs = cv::Mat::zeros(1,4,CV_64FC1);
+  dist_coeffs.at<double>(0,0) = k1;
+  dist_coeffs.at<double>(0,1) = k2;
+  cv::Mat out;
+  cv::undistort(img,out,intrinsics,dist_coeffs);
+  return out;
+}
+
+int main(int argc, char *argv[]) {
+
+  DICe::initialize(argc, argv);
+
+  // only print output if args are given (for testing the output is quiet)
+  int_t iprint     = argc - 1;
+  int_t errorFlag  = 0;
+  scalar_t errorTol = 1.0;
+  Teuchos::RCP<std::ostream> outStream;
+  Teuchos::oblackholestream bhs; // outputs nothing
+  if (iprint > 0)
+    outStream = Teuchos::rcp(&std::cout, false);
+  else
+    outStream = Teuchos::rcp(&bhs, false);
+
+  *outStream << "--- Begin test ---" << std::endl;
+
+  // smooth 8 bit pattern so that the fixed point weights opencv uses stay within a grey level
+  const int_t w = 160;
+  const int_t h = 120;
+  cv::Mat img(h,w,CV_8UC1,cv::Scalar(0));
+  for(int_t y=0;y<h;++y)
+    for(int_t x=0;x<w;++x)
+      img.at<uchar>(y,x) = (uchar)std::round(127.5 + 100.0*std::sin(x/9.0)*std::cos(y/11.0));
+
+  const double fx = 150.0, fy = 155.0, cx = 82.0, cy = 57.0, k1 = -0.25, k2 = 0.06;
+  Teuchos::RCP<Teuchos::ParameterList> params = Teuchos::rcp(new Teuchos::ParameterList());
+  Teuchos::ParameterList & cal_sublist = params->sublist(undistort_images);
+  cal_sublist.set("fx",fx);
+  cal_sublist.set("fy",fy);
+  cal_sublist.set("cx",cx);
+  cal_sublist.set("cy",cy);
+  cal_sublist.set("k1",k1);
+  cal_sublist.set("k2",k2);
+
+  *outStream << "undistorting the image with opencv" << std::endl;
+  cv::Mat gold = opencv_undistort(img,fx,fy,cx,cy,k1,k2);
+
+  *outStream << "comparing the 8 bit undistortion with opencv" << std::endl;
+  std::vector<scalar_t> values(w*h,0.0);
+  for(int_t y=0;y<h;++y)
+    for(int_t x=0;x<w;++x)
+      values[y*w+x] = img.at<uchar>(y,x);
+  utils::undistort_intensities(w,h,&values[0],params);
+  const scalar_t diff_8 = max_diff(values,gold,1.0);
+  *outStream << "max diff from opencv: " << diff_8 << std::endl;
+  if(diff_8>errorTol){
+    errorFlag++;
+    *outStream << "Error, the undistorted intensities do not match opencv" << std::endl;
+  }
+
+  *outStream << "checking that 16 bit intensities are not truncated" << std::endl;
+  // the same pattern scaled to the full 16 bit range, the result scaled back must match the 8 bit result
+  const scalar_t scale_16 = 257.0;
+  std::vector<scalar_t> values_16(w*h,0.0);
+  for(int_t y=0;y<h;++y)
+    for(int_t x=0;x<w;++x)
+      values_16[y*w+x] = scale_16*img.at<uchar>(y,x);
+  utils::undistort_intensities(w,h,&values_16[0],params);
+  const scalar_t max_16 = *std::max_element(values_16.begin(),values_16.end());
+  const scalar_t diff_16 = max_diff(values_16,gold,scale_16);
+  *outStream << "max 16 bit intensity: " << max_16 << " max diff from opencv: " << diff_16 << std::endl;
+  if(max_16<=255.0||diff_16>errorTol){
+    errorFlag++;
+    *outStream << "Error, the 16 bit intensities were truncated or not undistorted correctly" << std::endl;
+  }
+
+#ifndef STORAGE_SCALAR_SAME_TYPE
+  *outStream << "checking that 12 bit intensities are not truncated in the storage type" << std::endl;
+  const scalar_t scale_12 = 16.0;
+  std::vector<storage_t> values_12(w*h,0);
+  for(int_t y=0;y<h;++y)
+    for(int_t x=0;x<w;++x)
+      values_12[y*w+x] = (storage_t)(scale_12*img.at<uchar>(y,x));
+  utils::undistort_intensities(w,h,&values_12[0],params);
+  const scalar_t max_12 = *std::max_element(values_12.begin(),values_12.end());
+  const scalar_t diff_12 = max_diff(values_12,gold,scale_12);
+  *outStream << "max 12 bit intensity: " << max_12 << " max diff from opencv: " << diff_12 << std::endl;
+  if(max_12<=255.0||diff_12>errorTol){
+    errorFlag++;
+    *outStream << "Error, the 12 bit intensities were truncated or not undistorted correctly" << std::endl;
+  }
+#endif
+
+  *outStream << "checking that each camera of a stereo pair is undistorted with its own calibration" << std::endl;
+  {
+    const double fx_1 = 160.0, fy_1 = 158.0, cx_1 = 76.0, cy_1 = 63.0, k1_1 = 0.18, k2_1 = -0.04;
+    Teuchos::RCP<Teuchos::ParameterList> stereo_params = Teuchos::rcp(new Teuchos::ParameterList());
+    Teuchos::ParameterList & stereo_sublist = stereo_params->sublist(undistort_images);
+    Teuchos::ParameterList & cam_0_sublist = stereo_sublist.sublist("camera_0");
+    cam_0_sublist.set("fx",fx);
+    cam_0_sublist.set("fy",fy);
+    cam_0_sublist.set("cx",cx);
+    cam_0_sublist.set("cy",cy);
+    cam_0_sublist.set("k1",k1);
+    cam_0_sublist.set("k2",k2);
+    Teuchos::ParameterList & cam_1_sublist = stereo_sublist.sublist("camera_1");
+    cam_1_sublist.set("fx",fx_1);
+    cam_1_sublist.set("fy",fy_1);
+    cam_1_sublist.set("cx",cx_1);
+    cam_1_sublist.set("cy",cy_1);
+    cam_1_sublist.set("k1",k1_1);
+    cam_1_sublist.set("k2",k2_1);
+    const cv::Mat gold_1 = opencv_undistort(img,fx_1,fy_1,cx_1,cy_1,k1_1,k2_1);
+    cv::imwrite("undistort_stereo.png",img);
+
+    // the left schema reads the right image as the deformed image during the cross correlation
+    Schema left_schema(w,h,20,20,21,stereo_params);
+    left_schema.set_camera_ids(0,1);
+    left_schema.set_ref_image("undistort_stereo.png");
+    left_schema.set_def_image("undistort_stereo.png");
+    // the stereo schema reads all of its images from the right camera
+    Schema right_schema(w,h,20,20,21,stereo_params);
+    right_schema.set_camera_ids(1,1);
+    right_schema.set_ref_image("undistort_stereo.png");
+
+    const scalar_t diff_left = max_image_diff(left_schema.ref_img(),gold);
+    const scalar_t diff_cross = max_image_diff(left_schema.def_img(),gold_1);
+    const scalar_t diff_right = max_image_diff(right_schema.ref_img(),gold_1);
+    *outStream << "max diff from opencv left: " << diff_left << " cross: " << diff_cross << " right: " << diff_right << std::endl;
+    if(diff_left>errorTol||diff_cross>errorTol||diff_right>errorTol){
+      errorFlag++;
+      *outStream << "Error, a camera was not undistorted with its own calibration" << std::endl;
+    }
+    // make sure the two calibrations actually give different remaps
+    const scalar_t diff_cameras = max_image_diff(left_schema.ref_img(),gold_1);
+    *outStream << "max diff between the left and right remaps: " << diff_cameras << std::endl;
+    if(diff_cameras<10.0){
+      errorFlag++;
+      *outStream << "Error, the left and right cameras were remapped with the same table" << std::endl;
+    }
+
+    // a single calibration cannot be used for the right camera
+    bool exception_thrown = false;
+    try{
+      Schema single_cal_schema(w,h,20,20,21,params);
+      single_cal_schema.set_camera_ids(1,1);
+      single_cal_schema.set_ref_image("undistort_stereo.png");
+    }
+    catch(std::exception &){
+      exception_thrown = true;
+    }
+    if(!exception_thrown){
+      errorFlag++;
+      *outStream << "Error, the right camera should require its own calibration" << std::endl;
+    }
+  }
+
+  *outStream << "--- End test ---" << std::endl;
+
+  DICe::finalize();
+
+  if (errorFlag != 0)
+    std::cout << "End Result: TEST FAILED\n";
+  else
+    std::cout << "End Result: TEST PASSED\n";
+
+  return 0;
+
+}
@@ -41,6 +41,7 @@
 
 #include <DICe.h>
 #include <DICe_ImageUtils.h>
+#include <DICe_ParameterUtilities.h>
 
 #include <Teuchos_RCP.hpp>
 #include <Teuchos_oblackholestream.hpp>
@@ -49,6 +50,7 @@
 
 #include <iostream>
 #include <random>
+#include <vector>
 
 using namespace DICe;
 
@@ -168,6 +170,53 @@ int main(int argc, char *argv[]) {
       }
     } // frame loop
   }
+
+  // interpolation time for each interpolation cache mode
+  {
+    std::vector<scalar_t> local_x;
+    std::vector<scalar_t> local_y;
+    for(int_t y=subset_start_y;y<subset_end_y;++y){
+      for(int_t x=subset_start_x;x<subset_end_x;++x){
+        local_x.push_back(x + distr(eng)/100.0);
+        local_y.push_back(y + distr(eng)/100.0);
+      }
+    }
+    const int_t num_points = local_x.size();
+    std::vector<int_t> indices(num_points,0);
+    for(int_t i=0;i<num_points;++i)
+      indices[i] = i;
+    std::vector<scalar_t> intensities(num_points,0.0);
+    std::vector<scalar_t> grad_x(num_points,0.0);
+    std::vector<scalar_t> grad_y(num_points,0.0);
+    // repeat the evaluations to mimic the solver iterations for all the subsets that share one deformed image
+    const int_t num_repeats = 50;
+    const Interpolation_Method methods[] = {BICUBIC,KEYS_FOURTH};
+    for(int_t m=0;m<2;++m){
+      for(int_t c=0;c<MAX_INTERPOLATION_CACHE;++c){
+        const Interpolation_Cache cache = static_cast<Interpolation_Cache>(c);
+        const std::string mode = to_string(methods[m]) + " " + to_string(cache);
+        Teuchos::RCP<Teuchos::Time> cache_time = Teuchos::TimeMonitor::getNewCounter("cache build time " + mode);
+        Teuchos::RCP<Teuchos::Time> mode_interp_time = Teuchos::TimeMonitor::getNewCounter("interp time " + mode);
+        Teuchos::RCP<Teuchos::ParameterList> cacheParams = Teuchos::rcp(new Teuchos::ParameterList());
+        cacheParams->set(DICe::compute_image_gradients,true);
+        for(int_t i = start_frame; i<=end_frame; ++i){
+          std::stringstream name;
+          name << stripped_fileName << "_" << i << ".cine";
+          Teuchos::RCP<Image> image = Teuchos::rcp(new Image(name.str().c_str(),cacheParams));
+          {
+            Teuchos::TimeMonitor cache_time_monitor(*cache_time);
+            image->compute_interpolation_coefficients(methods[m],cache);
+          }
+          {
+            Teuchos::TimeMonitor mode_interp_time_monitor(*mode_interp_time);
+            for(int_t r=0;r<num_repeats;++r)
+              image->interpolate_batch(methods[m],num_points,&indices[0],&local_x[0],&local_y[0],
+                &intensities[0],&grad_x[0],&grad_y[0],true);
+          }
+        } // frame loop
+      } // cache loop
+    } // method loop
+  }
   Teuchos::TimeMonitor::summarize(*outStream,false,true,false/*zero timers*/);
 
   *outStream << "--- End performance test ---" << std::endl;
@@ -0,0 +1,223 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+/*! \file  DICe_PerformanceTangent.cpp
+    \brief Compare the vectorized tangent accumulation used by Objective_ZNSSD::computeUpdateFast()
+    to the per-pixel loop it replaced
+*/
+
+#include <DICe.h>
+#include <DICe_LocalShapeFunction.h>
+#include <DICe_Tangent.h>
+
+#include <Teuchos_RCP.hpp>
+#include <Teuchos_oblackholestream.hpp>
+#include <Teuchos_TimeMonitor.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <cassert>
+
+using namespace DICe;
+
+// Usage DICe_PerformanceTangent [<subset_size> <num_repeats>]
+
+int main(int argc, char *argv[]) {
+
+  DICe::initialize(argc, argv);
+
+  // only print output if args are given (for testing the output is quiet)
+  Teuchos::oblackholestream bhs; // outputs nothing
+  Teuchos::RCP<std::ostream> outStream = Teuchos::rcp(&bhs, false);
+  if(argc>1) // anything but the default cases, writes output to screen
+    outStream = Teuchos::rcp(&std::cout, false);
+  int_t errorFlag = 0;
+  const scalar_t error_tol = 1.0E-4;
+
+  *outStream << "--- Begin performance test ---" << std::endl;
+
+  int_t subset_size = 41;
+  if(argc>1) subset_size = std::strtol(argv[1],NULL,0);
+  int_t num_repeats = 200;
+  if(argc>2) num_repeats = std::strtol(argv[2],NULL,0);
+  assert(subset_size>0&&num_repeats>0);
+  *outStream << "subset size:    " << subset_size << std::endl;
+  *outStream << "num repeats:    " << num_repeats << std::endl;
+
+  // synthetic subset data in the same layout as DICe::Subset
+  const int_t num_pixels = subset_size*subset_size;
+  const scalar_t cx = subset_size/2;
+  const scalar_t cy = subset_size/2;
+  std::vector<int_t> x(num_pixels,0);
+  std::vector<int_t> y(num_pixels,0);
+  std::vector<scalar_t> gx(num_pixels,0.0);
+  std::vector<scalar_t> gy(num_pixels,0.0);
+  std::vector<scalar_t> gmf(num_pixels,0.0);
+  Teuchos::ArrayRCP<bool> is_active(num_pixels,true);
+  Teuchos::ArrayRCP<bool> is_deactivated_this_step(num_pixels,false);
+  std::srand(1234);
+  for(int_t j=0;j<subset_size;++j){
+    for(int_t i=0;i<subset_size;++i){
+      const int_t index = j*subset_size+i;
+      x[index] = i;
+      y[index] = j;
+      gx[index] = 100.0*(static_cast<scalar_t>(std::rand())/RAND_MAX - 0.5);
+      gy[index] = 100.0*(static_cast<scalar_t>(std::rand())/RAND_MAX - 0.5);
+      gmf[index] = 20.0*(static_cast<scalar_t>(std::rand())/RAND_MAX - 0.5);
+      // knock out a few pixels to exercise the active mask
+      if(std::rand()%10==0) is_active[index] = false;
+      if(std::rand()%20==0) is_deactivated_this_step[index] = true;
+    }
+  }
+
+  std::vector<Teuchos::RCP<Local_Shape_Function> > shape_functions;
+  Teuchos::RCP<Local_Shape_Function> affine = Teuchos::rcp(new Affine_Shape_Function(true,true,true));
+  (*affine)(DICe::field_enums::ROTATION_Z_FS) = 0.05;
+  (*affine)(DICe::field_enums::NORMAL_STRETCH_XX_FS) = 0.01;
+  shape_functions.push_back(affine);
+  shape_functions.push_back(Teuchos::rcp(new Quadratic_Shape_Function()));
+
+  for(size_t sf=0;sf<shape_functions.size();++sf){
+    Teuchos::RCP<Local_Shape_Function> shape_function = shape_functions[sf];
+    const int_t N = shape_function->num_params();
+    *outStream << "---------------------------------------------------------------------------" << std::endl;
+    *outStream << "shape function with " << N << " parameters" << std::endl;
+    std::stringstream loop_name, vec_name;
+    loop_name << "per-pixel loop (" << N << " params)";
+    vec_name << "vectorized (" << N << " params)";
+    Teuchos::RCP<Teuchos::Time> loop_time = Teuchos::TimeMonitor::getNewCounter(loop_name.str());
+    Teuchos::RCP<Teuchos::Time> vec_time = Teuchos::TimeMonitor::getNewCounter(vec_name.str());
+
+    // the loop that computeUpdateFast() used before the tangent kernels
+    std::vector<double> H_loop(N*N,0.0);
+    std::vector<double> q_loop(N,0.0);
+    {
+      Teuchos::TimeMonitor loop_time_monitor(*loop_time);
+      std::vector<scalar_t> residuals(N,0.0);
+      for(int_t r=0;r<num_repeats;++r){
+        for(int_t i=0;i<N*N;++i) H_loop[i] = 0.0;
+        for(int_t i=0;i<N;++i) q_loop[i] = 0.0;
+        for(int_t index=0;index<num_pixels;++index){
+          if(is_deactivated_this_step[index]||!is_active[index]) continue;
+          for(int_t i=0;i<N;++i)
+            residuals[i] = 0.0;
+          shape_function->residuals(x[index],y[index],cx,cy,gx[index],gy[index],residuals,true);
+          for(int_t i=0;i<N;++i){
+            q_loop[i] += gmf[index]*residuals[i];
+            for(int_t j=0;j<N;++j)
+              H_loop[i*N+j] += residuals[i]*residuals[j];
+          }
+        }
+      }
+    }
+
+    // packed blocks of active pixels, batched residuals and the symmetric accumulation
+    std::vector<double> H_vec(N*N,0.0);
+    std::vector<double> q_vec(N,0.0);
+    {
+      Teuchos::TimeMonitor vec_time_monitor(*vec_time);
+      int_t block_x[DICE_TANGENT_BLOCK_SIZE];
+      int_t block_y[DICE_TANGENT_BLOCK_SIZE];
+      scalar_t block_gx[DICE_TANGENT_BLOCK_SIZE];
+      scalar_t block_gy[DICE_TANGENT_BLOCK_SIZE];
+      scalar_t block_gmf[DICE_TANGENT_BLOCK_SIZE];
+      std::vector<scalar_t> block_residuals(N*DICE_TANGENT_BLOCK_SIZE,0.0);
+      for(int_t r=0;r<num_repeats;++r){
+        for(int_t i=0;i<N*N;++i) H_vec[i] = 0.0;
+        for(int_t i=0;i<N;++i) q_vec[i] = 0.0;
+        int_t block_size = 0;
+        auto accumulate_block = [&](){
+          shape_function->batch_residuals(block_size,block_x,block_y,cx,cy,block_gx,block_gy,&block_residuals[0],DICE_TANGENT_BLOCK_SIZE,true);
+          accumulate_tangent<0>(N,block_size,&block_residuals[0],DICE_TANGENT_BLOCK_SIZE,block_gmf,&H_vec[0],&q_vec[0]);
+          block_size = 0;
+        };
+        for(int_t index=0;index<num_pixels;++index){
+          if(is_deactivated_this_step[index]||!is_active[index]) continue;
+          block_x[block_size] = x[index];
+          block_y[block_size] = y[index];
+          block_gx[block_size] = gx[index];
+          block_gy[block_size] = gy[index];
+          block_gmf[block_size] = gmf[index];
+          if(++block_size==DICE_TANGENT_BLOCK_SIZE) accumulate_block();
+        }
+        if(block_size>0) accumulate_block();
+        tangent_fill_lower(N,&H_vec[0]);
+      }
+    }
+
+    // the two have to agree to within round off
+    double H_norm = 0.0, H_diff = 0.0;
+    for(int_t i=0;i<N*N;++i){
+      H_norm += H_loop[i]*H_loop[i];
+      H_diff += (H_loop[i]-H_vec[i])*(H_loop[i]-H_vec[i]);
+    }
+    double q_norm = 0.0, q_diff = 0.0;
+    for(int_t i=0;i<N;++i){
+      q_norm += q_loop[i]*q_loop[i];
+      q_diff += (q_loop[i]-q_vec[i])*(q_loop[i]-q_vec[i]);
+    }
+    const double H_error = H_norm > 0.0 ? std::sqrt(H_diff/H_norm) : std::sqrt(H_diff);
+    const double q_error = q_norm > 0.0 ? std::sqrt(q_diff/q_norm) : std::sqrt(q_diff);
+    *outStream << "relative difference in the tangent:  " << H_error << std::endl;
+    *outStream << "relative difference in the gradient: " << q_error << std::endl;
+    if(H_error>error_tol||q_error>error_tol){
+      *outStream << "Error, the vectorized tangent does not match the per-pixel loop" << std::endl;
+      errorFlag++;
+    }
+    *outStream << "per-pixel loop time:  " << loop_time->totalElapsedTime() << " (s)" << std::endl;
+    *outStream << "vectorized time:      " << vec_time->totalElapsedTime() << " (s)" << std::endl;
+  }
+
+  Teuchos::TimeMonitor::summarize(*outStream,false,true,false/*zero timers*/);
+
+  *outStream << "--- End performance test ---" << std::endl;
+
+  DICe::finalize();
+
+  if (errorFlag != 0)
+    std::cout << "End Result: TEST FAILED\n";
+  else
+    std::cout << "End Result: TEST PASSED\n";
+
+  return 0;
+}
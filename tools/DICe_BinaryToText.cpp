@@ -0,0 +1,274 @@
+// @HEADER
+// ************************************************************************
+//
+//               Digital Image Correlation Engine (DICe)
+//                 Copyright 2021 National Technology & Engineering Solutions of Sandia, LLC (NTESS).
+//
+// Under the terms of Contract DE-NA0003525 with NTESS,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY NTESS "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL NTESS OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact: Dan Turner (dzturne@sandia.gov)
+//
+// ************************************************************************
+// @HEADER
+
+
+/*! \file  DICe_BinaryToText.cpp
+    \brief Utility for converting the binary columnar output files (.dbin) to the text output format
+*/
+
+#include <DICe.h>
+#include <DICe_Schema.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace DICe;
+
+/// read a value of type T from the file buffer and advance the offset
+template <typename T>
+T read_value(const std::vector<char> & buffer,
+  size_t & offset){
+  TEUCHOS_TEST_FOR_EXCEPTION(offset+sizeof(T)>buffer.size(),std::runtime_error,"Error, unexpected end of the binary file header");
+  T value;
+  std::memcpy(&value,&buffer[offset],sizeof(T));
+  offset += sizeof(T);
+  return value;
+}
+
+/// read a length prefixed string from the file buffer and advance the offset
+std::string read_string(const std::vector<char> & buffer,
+  size_t & offset){
+  const int32_t length = read_value<int32_t>(buffer,offset);
+  TEUCHOS_TEST_FOR_EXCEPTION(length<0||offset+length>buffer.size(),std::runtime_error,"Error, unexpected end of the binary file header");
+  std::string str(&buffer[offset],length);
+  offset += length;
+  return str;
+}
+
+/// number of digits in a non-negative integer
+int_t num_digits(int_t value){
+  int_t digits = 1;
+  while(value>=10){value/=10; digits++;}
+  return digits;
+}
+
+/// zero padded file name in the same form as the text output files
+std::string text_file_name(const std::string & prefix,
+  const int_t id,
+  const int_t total_digits){
+  std::stringstream name;
+  name << prefix << "_";
+  for(int_t i=num_digits(id<0?-id:id);i<total_digits;++i)
+    name << "0";
+  name << id << ".txt";
+  return name.str();
+}
+
+/// write one row in the same format as Output_Spec::write_frame()
+void write_row(std::FILE * file,
+  const bool omit_row_id,
+  const std::string & delimiter,
+  const int_t row_id,
+  const std::vector<const double *> & columns,
+  const size_t row){
+  if(!omit_row_id)
+    fprintf(file,"%i%s",row_id,delimiter.c_str());
+  for(size_t i=0;i<columns.size();++i){
+    if(i==0)
+      fprintf(file,"%4.4E",columns[i][row]);
+    else
+      fprintf(file,"%s%4.4E",delimiter.c_str(),columns[i][row]);
+  }
+  fprintf(file,"\n");
+}
+
+/// write the column labels in the same format as Output_Spec::write_header()
+void write_header(std::FILE * file,
+  const bool omit_row_id,
+  const std::string & delimiter,
+  const std::string & row_id,
+  const std::vector<std::string> & field_names){
+  if(!omit_row_id)
+    fprintf(file,"%s%s",row_id.c_str(),delimiter.c_str());
+  for(size_t i=0;i<field_names.size();++i){
+    if(i==0)
+      fprintf(file,"%s",field_names[i].c_str());
+    else
+      fprintf(file,"%s%s",delimiter.c_str(),field_names[i].c_str());
+  }
+  fprintf(file,"\n");
+}
+
+int main(int argc, char *argv[]) {
+
+  /// usage ./DICe_BinaryToText <binary_file> [-p <prefix>] [-s] [-v]
+
+  DICe::initialize(argc, argv);
+
+  if(argc==1||(argc==2&&strcmp(argv[1],"-h")==0)){
+    std::cout << " DICe_BinaryToText (converts a DICe binary columnar output file (.dbin) to the text output files) " << std::endl;
+    std::cout << " Syntax: DICe_BinaryToText <binary_file> [options] " << std::endl;
+    std::cout << " Options: -h show help message " << std::endl;
+    std::cout << "          -v verbose " << std::endl;
+    std::cout << "          -p <prefix> prefix for the text files (default is the binary file name without .dbin)" << std::endl;
+    std::cout << "          -s write one file per subset listing each frame on a new row (default is one file per frame)" << std::endl;
+    std::cout << " Note: the run information (normally at the top of the text files or in the .info file) is not" << std::endl;
+    std::cout << " stored in the binary file so only the column labels and the values are written" << std::endl;
+    DICe::finalize();
+    exit(argc==1 ? 1 : 0);
+  }
+
+  const std::string binary_file = argv[1];
+  std::string prefix = binary_file;
+  if(prefix.size()>5&&prefix.substr(prefix.size()-5)==".dbin")
+    prefix.erase(prefix.size()-5);
+  bool separate_files_per_subset = false;
+  bool verbose = false;
+  for(int_t i=2;i<argc;++i){
+    char safe_argv[MAX_BUFFER_SIZE];
+    safe_buffer_copy(argv[i],safe_argv);
+    if(strcmp(safe_argv,"-v")==0){
+      verbose = true;
+    }
+    else if(strcmp(safe_argv,"-s")==0){
+      separate_files_per_subset = true;
+    }
+    else if(strcmp(safe_argv,"-p")==0){
+      TEUCHOS_TEST_FOR_EXCEPTION(argc<=i+1,std::runtime_error,"Error, prefix must be specified for -p option");
+      prefix = argv[i+1];
+      i++;
+    }
+    else{
+      TEUCHOS_TEST_FOR_EXCEPTION(true,std::runtime_error,"Error, unrecognized option " << safe_argv);
+    }
+  }
+
+  // read the whole file
+  std::ifstream in(binary_file.c_str(),std::ios::binary|std::ios::ate);
+  TEUCHOS_TEST_FOR_EXCEPTION(!in.good(),std::runtime_error,"Error, could not open binary file " << binary_file);
+  const std::streamsize file_size = in.tellg();
+  in.seekg(0,std::ios::beg);
+  TEUCHOS_TEST_FOR_EXCEPTION(file_size<(std::streamsize)sizeof(binary_output_magic),std::runtime_error,
+    "Error, " << binary_file << " is not a DICe binary output file");
+  // use a double buffer so the columns are aligned
+  std::vector<double> data((file_size+sizeof(double)-1)/sizeof(double),0.0);
+  in.read(reinterpret_cast<char*>(&data[0]),file_size);
+  TEUCHOS_TEST_FOR_EXCEPTION(!in.good(),std::runtime_error,"Error, failed reading binary file " << binary_file);
+  in.close();
+  const std::vector<char> bytes(reinterpret_cast<const char*>(&data[0]),reinterpret_cast<const char*>(&data[0])+file_size);
+
+  // parse the header (see Output_Spec::write_binary_header())
+  size_t offset = 0;
+  TEUCHOS_TEST_FOR_EXCEPTION(bytes.size()<sizeof(binary_output_magic)||
+    std::memcmp(&bytes[0],binary_output_magic,sizeof(binary_output_magic))!=0,std::runtime_error,
+    "Error, " << binary_file << " is not a DICe binary output file");
+  offset += sizeof(binary_output_magic);
+  const int32_t version = read_value<int32_t>(bytes,offset);
+  TEUCHOS_TEST_FOR_EXCEPTION(version!=binary_output_version,std::runtime_error,"Error, unsupported binary output version " << version);
+  const int32_t num_cols = read_value<int32_t>(bytes,offset);
+  const int32_t num_rows = read_value<int32_t>(bytes,offset);
+  TEUCHOS_TEST_FOR_EXCEPTION(num_cols<0||num_rows<0,std::runtime_error,"Error, invalid number of columns or rows in " << binary_file);
+  const bool omit_row_id = read_value<int32_t>(bytes,offset)!=0;
+  const std::string delimiter = read_string(bytes,offset);
+  std::vector<std::string> field_names(num_cols);
+  for(int32_t i=0;i<num_cols;++i)
+    field_names[i] = read_string(bytes,offset);
+  std::vector<int_t> row_ids(num_rows,0);
+  int_t max_row_id = 0;
+  for(int32_t i=0;i<num_rows;++i){
+    row_ids[i] = read_value<int32_t>(bytes,offset);
+    max_row_id = std::max(max_row_id,row_ids[i]);
+  }
+  offset = (offset+7)/8*8;
+  TEUCHOS_TEST_FOR_EXCEPTION(offset>(size_t)file_size,std::runtime_error,"Error, " << binary_file << " is truncated in the header");
+
+  const size_t chunk_size = 1 + (size_t)num_cols*num_rows; // in doubles
+  const size_t num_frames = (file_size-offset)/sizeof(double)/chunk_size;
+  if((file_size-offset)%(chunk_size*sizeof(double))!=0)
+    std::cout << "Warning, the last frame in " << binary_file << " is incomplete and will be skipped" << std::endl;
+  if(verbose){
+    std::cout << "binary file:  " << binary_file << std::endl;
+    std::cout << "num fields:   " << num_cols << std::endl;
+    std::cout << "num subsets:  " << num_rows << std::endl;
+    std::cout << "num frames:   " << num_frames << std::endl;
+  }
+
+  // frame numbers and column pointers for each chunk
+  std::vector<int_t> frames(num_frames,0);
+  std::vector<std::vector<const double *> > columns(num_frames,std::vector<const double *>(num_cols,NULL));
+  int_t max_frame = 0;
+  for(size_t f=0;f<num_frames;++f){
+    const double * chunk = &data[offset/sizeof(double) + f*chunk_size];
+    int64_t frame = 0;
+    std::memcpy(&frame,chunk,sizeof(int64_t));
+    frames[f] = (int_t)frame;
+    max_frame = std::max(max_frame,frames[f]);
+    for(int32_t i=0;i<num_cols;++i)
+      columns[f][i] = chunk + 1 + (size_t)i*num_rows;
+  }
+
+  if(separate_files_per_subset){
+    const int_t total_digits = num_digits(max_row_id+1);
+    for(int32_t row=0;row<num_rows;++row){
+      const std::string file_name = text_file_name(prefix,row_ids[row],total_digits);
+      std::FILE * filePtr = fopen(file_name.c_str(),"w");
+      TEUCHOS_TEST_FOR_EXCEPTION(filePtr==NULL,std::runtime_error,"Error, could not open output file " << file_name);
+      write_header(filePtr,omit_row_id,delimiter,"FRAME",field_names);
+      for(size_t f=0;f<num_frames;++f)
+        write_row(filePtr,omit_row_id,delimiter,frames[f],columns[f],row);
+      fclose(filePtr);
+    }
+  }
+  else{
+    const int_t total_digits = num_digits(max_frame);
+    for(size_t f=0;f<num_frames;++f){
+      const std::string file_name = text_file_name(prefix,frames[f],total_digits);
+      std::FILE * filePtr = fopen(file_name.c_str(),"w");
+      TEUCHOS_TEST_FOR_EXCEPTION(filePtr==NULL,std::runtime_error,"Error, could not open output file " << file_name);
+      write_header(filePtr,omit_row_id,delimiter,"SUBSET_ID",field_names);
+      for(int32_t row=0;row<num_rows;++row)
+        write_row(filePtr,omit_row_id,delimiter,row_ids[row],columns[f],row);
+      fclose(filePtr);
+    }
+  }
+  if(verbose)
+    std::cout << "wrote the text files with prefix " << prefix << std::endl;
+
+  DICe::finalize();
+
+  return 0;
+}
+